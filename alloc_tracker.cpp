@@ -0,0 +1,518 @@
+// Replacement operator new/delete and malloc family that count every
+// allocation (see alloc_tracker.h). Link this file in to opt in.
+#include "alloc_tracker.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <cxxabi.h>
+#include <new>
+
+#include <dlfcn.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+// glibc exports its allocator under these names too: forwarding to them
+// avoids the dlsym(RTLD_NEXT, "malloc") bootstrap problem (dlsym allocates)
+extern "C" {
+void* __libc_malloc(std::size_t size) noexcept;
+void* __libc_calloc(std::size_t count, std::size_t size) noexcept;
+void* __libc_realloc(void* ptr, std::size_t size) noexcept;
+void* __libc_memalign(std::size_t alignment, std::size_t size) noexcept;
+void __libc_free(void* ptr) noexcept;
+}
+
+// ============================================================================
+// Counters - always on
+// ============================================================================
+// A few relaxed atomic adds per allocation. The per-thread counter needs no
+// atomics at all: only its own thread reads it (AllocationGuard).
+
+namespace {
+
+struct alignas(64) Totals {
+    std::atomic<std::uint64_t> allocations{0};
+    std::atomic<std::uint64_t> frees{0};
+    std::atomic<std::uint64_t> bytes_requested{0};
+    std::atomic<std::int64_t> live_bytes{0};
+    std::atomic<std::int64_t> peak_live_bytes{0};
+};
+
+Totals g_totals;
+std::atomic<std::uint64_t> g_guard_failures{0};
+
+// initial-exec: a plain %fs-relative access, no __tls_get_addr call (which
+// could itself allocate the first time)
+__attribute__((tls_model("initial-exec"))) thread_local std::uint64_t t_allocations = 0;
+// Set while the tracker itself runs (stack bounds lookup, reporting):
+// allocations made then are counted but never profiled, so the tracker can't
+// recurse into itself
+__attribute__((tls_model("initial-exec"))) thread_local bool t_busy = false;
+// One past the highest address of this thread's stack, looked up on the
+// thread's first profiled allocation
+__attribute__((tls_model("initial-exec"))) thread_local std::uintptr_t t_stack_top = 0;
+
+// ============================================================================
+// Profiling tables - fixed size, static, so recording never allocates
+// ============================================================================
+//
+//   g_sites  open addressing on the stack hash      4096 call sites
+//   g_live   open addressing on the block address   262144 live blocks
+//            (pointer -> site, size, birth time), linear probing with
+//            backward-shift deletion: no tombstones to clean up
+
+constexpr std::size_t kMaxSites = 4096;
+constexpr std::size_t kMaxLive = std::size_t(1) << 18;
+
+struct LiveBlock {
+    void* ptr;
+    std::uint64_t size;
+    std::int64_t born_ns;
+    std::uint32_t site;
+};
+
+AllocSite g_sites[kMaxSites];
+LiveBlock g_live[kMaxLive];
+std::atomic<std::size_t> g_live_count{0};
+std::atomic<std::uint64_t> g_dropped{0};
+std::atomic<bool> g_profiling{false};
+int g_depth = 4;
+
+// Both tables are touched only on the profiling path. The stack walk and
+// the hash run before the lock is taken: it covers the table updates only.
+std::atomic_flag g_lock = ATOMIC_FLAG_INIT;
+
+struct SpinGuard {
+    SpinGuard() {
+        while (g_lock.test_and_set(std::memory_order_acquire)) sched_yield();
+    }
+    ~SpinGuard() { g_lock.clear(std::memory_order_release); }
+};
+
+std::int64_t now_ns() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return std::int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int size_bucket(std::uint64_t size) {
+    if (size <= 16) return 0;
+    int log2_ceil = 64 - __builtin_clzll(size - 1);
+    return std::min(log2_ceil - 4, kAllocSizeBuckets - 1);
+}
+
+std::size_t live_slot(void* ptr) {
+    return std::size_t((reinterpret_cast<std::uintptr_t>(ptr) >> 4) * 0x9e3779b97f4a7c15ull >> 46);  // 18 bits
+}
+
+std::uintptr_t stack_top() {
+    if (!t_stack_top) {
+        pthread_attr_t attr;
+        void* base = nullptr;
+        std::size_t size = 0;
+        if (pthread_getattr_np(pthread_self(), &attr) == 0) {  // the main thread's reads /proc/self/maps
+            pthread_attr_getstack(&attr, &base, &size);
+            pthread_attr_destroy(&attr);
+        }
+        t_stack_top = reinterpret_cast<std::uintptr_t>(base) + size;
+    }
+    return t_stack_top;
+}
+
+// Capture the return addresses above the allocation by following the saved
+// frame pointers:
+//
+//   fp ──▶ [ saved fp ]──▶ [ saved fp ]──▶ ...     one frame per call,
+//          [ return   ]    [ return   ]            innermost first
+//
+// That is two loads per frame, where backtrace() (libgcc's DWARF unwinder)
+// took microseconds. It needs frame pointers: alloc_tracker.cpp and the
+// code being profiled are compiled with -fno-omit-frame-pointer. Without
+// them the chain breaks early - every link is checked to move up the
+// thread's own stack, so a bogus one ends the walk rather than faulting -
+// and call sites get fewer frames. `caller` is the return address of
+// malloc/new itself: the walk is trimmed so it starts there, however many
+// tracker frames were inlined.
+int capture_stack(void* caller, void** frames) {
+    // Our own frames below `caller`: capture_stack, profile_alloc,
+    // record_alloc, new_impl and operator new/malloc when nothing is
+    // inlined - 5, plus slack. More means `caller` isn't on the chain.
+    constexpr int kTrackerFrames = 8;
+    std::uintptr_t top = stack_top();
+    auto fp = reinterpret_cast<std::uintptr_t>(__builtin_frame_address(0));
+    int depth = 0;
+    for (int skipped = 0; depth < g_depth && skipped <= kTrackerFrames;) {
+        const auto* frame = reinterpret_cast<void* const*>(fp);
+        void* ret = frame[1];
+        if (depth > 0 || ret == caller) frames[depth++] = ret;
+        else ++skipped;
+        auto next = reinterpret_cast<std::uintptr_t>(frame[0]);
+        if (next <= fp || next % sizeof(void*) != 0 || next + 2 * sizeof(void*) > top) break;
+        fp = next;
+    }
+    if (depth == 0) frames[depth++] = caller;  // chain broken below malloc/new: the direct caller only
+    return depth;
+}
+
+std::uint64_t stack_hash(void* const* frames, int depth) {
+    std::uint64_t hash = 0xcbf29ce484222325ull;
+    for (int i = 0; i < depth; ++i) {
+        hash = (hash ^ reinterpret_cast<std::uintptr_t>(frames[i])) * 0x100000001b3ull;
+    }
+    return hash | 1;  // 0 marks an empty slot
+}
+
+// The site slot for this stack (caller holds the lock)
+std::uint32_t find_site(std::uint64_t hash, void* const* frames, int depth) {
+    std::size_t mask = kMaxSites - 1;
+    for (std::size_t i = hash & mask, probes = 0; probes < kMaxSites; i = (i + 1) & mask, ++probes) {
+        AllocSite& s = g_sites[i];
+        if (s.hash == hash) return std::uint32_t(i);
+        if (s.hash == 0) {
+            s.hash = hash;
+            s.depth = depth;
+            std::memcpy(s.frames, frames, sizeof(void*) * std::size_t(depth));
+            return std::uint32_t(i);
+        }
+    }
+    return std::uint32_t(kMaxSites);  // table full
+}
+
+void profile_alloc(void* ptr, std::size_t size, void* caller) {
+    t_busy = true;
+    std::int64_t born = now_ns();
+    void* frames[kAllocMaxFrames];
+    int depth = capture_stack(caller, frames);
+    std::uint64_t hash = stack_hash(frames, depth);
+    SpinGuard lock;
+    std::uint32_t site = find_site(hash, frames, depth);
+    if (site == kMaxSites) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+        t_busy = false;
+        return;
+    }
+    AllocSite& s = g_sites[site];
+    ++s.count;
+    s.bytes += size;
+    ++s.size_histogram[size_bucket(size)];
+    if (g_live_count.load(std::memory_order_relaxed) < kMaxLive - kMaxLive / 8) {  // keep probes short
+        std::size_t i = live_slot(ptr);
+        while (g_live[i].ptr) i = (i + 1) & (kMaxLive - 1);
+        g_live[i] = LiveBlock{ptr, size, born, site};
+        g_live_count.fetch_add(1, std::memory_order_relaxed);
+        ++s.live;
+    } else {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    t_busy = false;
+}
+
+void profile_free(void* ptr) {
+    t_busy = true;
+    SpinGuard lock;
+    const std::size_t mask = kMaxLive - 1;
+    std::size_t i = live_slot(ptr);
+    while (g_live[i].ptr && g_live[i].ptr != ptr) i = (i + 1) & mask;
+    if (g_live[i].ptr == ptr) {
+        AllocSite& s = g_sites[g_live[i].site];
+        std::uint64_t age = std::uint64_t(now_ns() - g_live[i].born_ns);
+        ++s.frees;
+        --s.live;
+        s.lifetime_ns += age;
+        s.max_lifetime_ns = std::max(s.max_lifetime_ns, age);
+        // Backward-shift deletion: pull later entries of the same probe run
+        // into the hole so lookups never stop early at it
+        std::size_t hole = i;
+        for (std::size_t j = (i + 1) & mask; g_live[j].ptr; j = (j + 1) & mask) {
+            std::size_t home = live_slot(g_live[j].ptr);
+            if (((j - home) & mask) >= ((j - hole) & mask)) {
+                g_live[hole] = g_live[j];
+                hole = j;
+            }
+        }
+        g_live[hole].ptr = nullptr;
+        g_live_count.fetch_sub(1, std::memory_order_relaxed);
+    }
+    t_busy = false;
+}
+
+// ============================================================================
+// The hooks every allocation goes through
+// ============================================================================
+
+void* record_alloc(void* ptr, std::size_t size, void* caller) {
+    if (!ptr) return ptr;
+    ++t_allocations;
+    g_totals.allocations.fetch_add(1, std::memory_order_relaxed);
+    g_totals.bytes_requested.fetch_add(size, std::memory_order_relaxed);
+    auto usable = std::int64_t(malloc_usable_size(ptr));
+    std::int64_t live = g_totals.live_bytes.fetch_add(usable, std::memory_order_relaxed) + usable;
+    std::int64_t peak = g_totals.peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !g_totals.peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+    if (g_profiling.load(std::memory_order_relaxed) && !t_busy) profile_alloc(ptr, size, caller);
+    return ptr;
+}
+
+void record_free(void* ptr) {
+    if (!ptr) return;
+    g_totals.frees.fetch_add(1, std::memory_order_relaxed);
+    g_totals.live_bytes.fetch_sub(std::int64_t(malloc_usable_size(ptr)), std::memory_order_relaxed);
+    // Keeps matching frees after alloc_profile_stop(), so lifetimes complete
+    if (g_live_count.load(std::memory_order_relaxed) != 0 && !t_busy) profile_free(ptr);
+}
+
+// operator new must retry through the new_handler, then throw
+void* new_impl(std::size_t size, std::size_t alignment, void* caller) {
+    if (size == 0) size = 1;
+    while (true) {
+        void* p = alignment > alignof(std::max_align_t) ? __libc_memalign(alignment, size) : __libc_malloc(size);
+        if (p) return record_alloc(p, size, caller);
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+}
+
+void* new_nothrow(std::size_t size, std::size_t alignment, void* caller) noexcept {
+    try {
+        return new_impl(size, alignment, caller);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void delete_impl(void* ptr) noexcept {
+    record_free(ptr);
+    __libc_free(ptr);
+}
+
+}  // namespace
+
+#define CALLER __builtin_return_address(0)
+
+// ----- C allocation functions -----
+
+extern "C" {
+
+void* malloc(std::size_t size) noexcept { return record_alloc(__libc_malloc(size), size, CALLER); }
+
+void* calloc(std::size_t count, std::size_t size) noexcept {
+    return record_alloc(__libc_calloc(count, size), count * size, CALLER);  // overflow -> NULL, nothing recorded
+}
+
+// Counted as a free of the old block plus an allocation of the new one.
+// (If the realloc fails the old block stays valid but is no longer counted.)
+void* realloc(void* ptr, std::size_t size) noexcept {
+    record_free(ptr);
+    return record_alloc(__libc_realloc(ptr, size), size, CALLER);
+}
+
+void* reallocarray(void* ptr, std::size_t count, std::size_t size) noexcept {
+    std::size_t total;
+    if (__builtin_mul_overflow(count, size, &total)) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    record_free(ptr);
+    return record_alloc(__libc_realloc(ptr, total), total, CALLER);
+}
+
+void free(void* ptr) noexcept { delete_impl(ptr); }
+
+void* memalign(std::size_t alignment, std::size_t size) noexcept {
+    return record_alloc(__libc_memalign(alignment, size), size, CALLER);
+}
+
+void* aligned_alloc(std::size_t alignment, std::size_t size) noexcept {
+    return record_alloc(__libc_memalign(alignment, size), size, CALLER);
+}
+
+int posix_memalign(void** out, std::size_t alignment, std::size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* p = record_alloc(__libc_memalign(alignment, size), size, CALLER);
+    if (!p) return ENOMEM;
+    *out = p;
+    return 0;
+}
+
+void* valloc(std::size_t size) noexcept {
+    return record_alloc(__libc_memalign(std::size_t(sysconf(_SC_PAGESIZE)), size), size, CALLER);
+}
+
+}  // extern "C"
+
+// ----- C++ replaceable allocation functions (all of them, C++17) -----
+
+void* operator new(std::size_t size) { return new_impl(size, 0, CALLER); }
+void* operator new[](std::size_t size) { return new_impl(size, 0, CALLER); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return new_nothrow(size, 0, CALLER); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return new_nothrow(size, 0, CALLER); }
+void* operator new(std::size_t size, std::align_val_t al) { return new_impl(size, std::size_t(al), CALLER); }
+void* operator new[](std::size_t size, std::align_val_t al) { return new_impl(size, std::size_t(al), CALLER); }
+void* operator new(std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return new_nothrow(size, std::size_t(al), CALLER);
+}
+void* operator new[](std::size_t size, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return new_nothrow(size, std::size_t(al), CALLER);
+}
+
+void operator delete(void* ptr) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr) noexcept { delete_impl(ptr); }
+void operator delete(void* ptr, std::size_t) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr, std::size_t) noexcept { delete_impl(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { delete_impl(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { delete_impl(ptr); }
+void operator delete(void* ptr, std::size_t, std::align_val_t) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr, std::size_t, std::align_val_t) noexcept { delete_impl(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { delete_impl(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { delete_impl(ptr); }
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+AllocStats alloc_stats() {
+    return AllocStats{g_totals.allocations.load(std::memory_order_relaxed),
+                      g_totals.frees.load(std::memory_order_relaxed),
+                      g_totals.bytes_requested.load(std::memory_order_relaxed),
+                      g_totals.live_bytes.load(std::memory_order_relaxed),
+                      g_totals.peak_live_bytes.load(std::memory_order_relaxed)};
+}
+
+std::uint64_t thread_allocations() { return t_allocations; }
+
+void alloc_profile_start(int depth) {
+    g_depth = std::max(1, std::min(depth, kAllocMaxFrames));
+    g_profiling.store(true, std::memory_order_relaxed);
+}
+
+void alloc_profile_stop() { g_profiling.store(false, std::memory_order_relaxed); }
+
+void alloc_profile_reset() {
+    SpinGuard lock;
+    std::memset(static_cast<void*>(g_sites), 0, sizeof(g_sites));
+    std::memset(static_cast<void*>(g_live), 0, sizeof(g_live));
+    g_live_count.store(0, std::memory_order_relaxed);
+    g_dropped.store(0, std::memory_order_relaxed);
+}
+
+std::size_t alloc_profile_sites(AllocSite* out, std::size_t max) {
+    std::size_t n = 0;
+    SpinGuard lock;
+    for (const AllocSite& s : g_sites) {
+        if (s.hash == 0) continue;
+        // Insertion into the sorted top-`max` list
+        std::size_t pos = n;
+        while (pos > 0 && out[pos - 1].count < s.count) --pos;
+        if (pos >= max) continue;
+        std::size_t last = std::min(n, max - 1);
+        for (std::size_t k = last; k > pos; --k) out[k] = out[k - 1];
+        out[pos] = s;
+        n = std::min(n + 1, max);
+    }
+    return n;
+}
+
+std::uint64_t alloc_profile_dropped() { return g_dropped.load(std::memory_order_relaxed); }
+
+const char* alloc_symbol_name(void* address, char* buf, std::size_t size) {
+    bool was_busy = t_busy;
+    t_busy = true;
+    Dl_info info;
+    // address is a RETURN address: look up address - 1, inside the call
+    // instruction, in case the call was the last one in its function.
+    // info is only filled in when dladdr() returns non-zero.
+    bool found = dladdr(static_cast<char*>(address) - 1, &info) != 0;
+    if (found && info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::snprintf(buf, size, "%s+0x%lx", status == 0 ? demangled : info.dli_sname,
+                      static_cast<unsigned long>(static_cast<char*>(address) - static_cast<char*>(info.dli_saddr)));
+        std::free(demangled);
+    } else if (found && info.dli_fname) {
+        std::snprintf(buf, size, "? (%s+0x%lx)", info.dli_fname,
+                      static_cast<unsigned long>(static_cast<char*>(address) - static_cast<char*>(info.dli_fbase)));
+    } else {
+        std::snprintf(buf, size, "?");
+    }
+    t_busy = was_busy;
+    return buf;
+}
+
+void alloc_profile_report(std::FILE* out, std::size_t top) {
+    static AllocSite sites[64];
+    std::size_t n = alloc_profile_sites(sites, std::min<std::size_t>(top, 64));
+    std::fprintf(out, "%-4s %10s %12s %9s %8s %12s  size histogram\n", "site", "allocs", "bytes", "avg size", "live",
+                 "avg life");
+    for (std::size_t i = 0; i < n; ++i) {
+        const AllocSite& s = sites[i];
+        double life_us = s.frees ? double(s.lifetime_ns) / double(s.frees) / 1000.0 : 0.0;
+        std::fprintf(out, "#%-3zu %10llu %12llu %9llu %8llu %9.1f us ", i + 1, (unsigned long long)s.count,
+                     (unsigned long long)s.bytes, (unsigned long long)(s.count ? s.bytes / s.count : 0),
+                     (unsigned long long)s.live, life_us);
+        for (int b = 0; b < kAllocSizeBuckets; ++b) {
+            if (!s.size_histogram[b]) continue;
+            if (b == kAllocSizeBuckets - 1) std::fprintf(out, " >256K:%llu", (unsigned long long)s.size_histogram[b]);
+            else if (b < 6) std::fprintf(out, " <=%d:%llu", 16 << b, (unsigned long long)s.size_histogram[b]);
+            else std::fprintf(out, " <=%dK:%llu", (16 << b) / 1024, (unsigned long long)s.size_histogram[b]);
+        }
+        std::fprintf(out, "\n");
+        char name[256];
+        for (int f = 0; f < s.depth; ++f) {
+            std::fprintf(out, "       %s %s\n", f == 0 ? "at" : "by", alloc_symbol_name(s.frames[f], name, sizeof(name)));
+        }
+    }
+    if (alloc_profile_dropped()) {
+        std::fprintf(out, "(%llu allocations not attributed: tables full)\n", (unsigned long long)alloc_profile_dropped());
+    }
+}
+
+// ----- AllocationGuard -----
+
+AllocationGuard::AllocationGuard(const char* what, std::uint64_t allowed, GuardAction action)
+    : what_(what), allowed_(allowed), action_(action), start_(t_allocations) {}
+
+std::uint64_t AllocationGuard::allocations() const { return t_allocations - start_; }
+
+AllocationGuard::~AllocationGuard() {
+    std::uint64_t made = allocations();
+    if (made <= allowed_) return;
+    std::fprintf(stderr, "AllocationGuard '%s': %llu allocations (allowed %llu)\n", what_, (unsigned long long)made,
+                 (unsigned long long)allowed_);
+    if (action_ == GuardAction::Abort) std::abort();
+    g_guard_failures.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::uint64_t alloc_guard_failures() { return g_guard_failures.load(std::memory_order_relaxed); }
+
+// ============================================================================
+// Field use without code changes: ALLOC_TRACKER_PROFILE=<depth> profiles the
+// whole run and prints the report to stderr at exit
+// ============================================================================
+
+namespace {
+
+void report_at_exit() {
+    AllocStats st = alloc_stats();
+    std::fprintf(stderr, "\n=== alloc_tracker: %llu allocations, %llu frees, %llu bytes requested, peak %lld bytes live ===\n",
+                 (unsigned long long)st.allocations, (unsigned long long)st.frees,
+                 (unsigned long long)st.bytes_requested, (long long)st.peak_live_bytes);
+    alloc_profile_report(stderr, 10);
+}
+
+__attribute__((constructor)) void profile_from_environment() {
+    const char* depth = std::getenv("ALLOC_TRACKER_PROFILE");
+    if (!depth || !*depth) return;
+    alloc_profile_start(std::atoi(depth));
+    std::atexit(report_at_exit);
+}
+
+}  // namespace
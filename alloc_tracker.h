@@ -0,0 +1,129 @@
+// alloc_tracker.h - opt-in heap allocation counting, call-site profiling and
+// allocation-free assertions
+//
+// memory_visualization.cpp shows WHERE one object lives; this answers HOW
+// MANY heap allocations a code path makes, and from where. Linking
+// alloc_tracker.cpp into a program is the opt-in: it replaces the global
+// operator new/delete (every form) and malloc/calloc/realloc/free and the
+// aligned variants. Every replacement forwards to glibc's allocator and
+// counts on the way through. Programs that don't link it pay nothing.
+//
+//   program ──new/malloc──▶ alloc_tracker.cpp ──__libc_malloc──▶ glibc
+//                             │
+//                             ├─ always: process and per-thread counters
+//                             │          (a few relaxed atomic adds)
+//                             └─ profiling: stack hash ──▶ per-call-site table
+//                                           pointer ──▶ (site, size, birth time)
+//
+// Three levels of detail:
+//
+//   alloc_stats()          process-wide totals, always on
+//   AllocationGuard        "this block allocates N times at most" on THIS
+//                          thread - for tests and for hot paths
+//   alloc_profile_start()  per call site: count, bytes, frees, lifetimes and
+//                          a power-of-two size histogram. Call sites are
+//                          identified by hashing the first few return
+//                          addresses of the stack, found by walking frame
+//                          pointers; slower than counting (a stack walk and a
+//                          locked table update per allocation), so switch it
+//                          on around the code under study
+//
+// glibc-specific (__libc_malloc and friends); link with -rdynamic so the
+// report can name functions of the executable itself, and compile with
+// -fno-omit-frame-pointer so profiling sees more than the direct caller.
+
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+
+struct AllocStats {
+    std::uint64_t allocations;      // successful allocations of every kind
+    std::uint64_t frees;            // non-null frees
+    std::uint64_t bytes_requested;  // sum of requested sizes
+    std::int64_t live_bytes;        // usable bytes currently allocated
+    std::int64_t peak_live_bytes;
+};
+
+// Process-wide totals since start
+AllocStats alloc_stats();
+
+// Allocations made by the calling thread since it started
+std::uint64_t thread_allocations();
+
+// ----- Per-call-site profiling -----
+
+constexpr int kAllocMaxFrames = 8;
+constexpr int kAllocSizeBuckets = 16;  // <=16 B, <=32 B, ..., <=256 KiB, bigger
+
+struct AllocSite {
+    std::uint64_t hash;
+    void* frames[kAllocMaxFrames];  // return addresses, innermost first (the caller of new/malloc)
+    int depth;
+    std::uint64_t count;
+    std::uint64_t bytes;
+    std::uint64_t frees;            // frees of blocks allocated here while profiling
+    std::uint64_t live;             // still allocated
+    std::uint64_t lifetime_ns;      // summed over the freed blocks
+    std::uint64_t max_lifetime_ns;
+    std::uint64_t size_histogram[kAllocSizeBuckets];
+};
+
+// Start recording call sites, hashing `depth` return addresses (1..8).
+// Blocks allocated before this are counted but not attributed.
+void alloc_profile_start(int depth = 4);
+void alloc_profile_stop();
+void alloc_profile_reset();  // forget all sites (profiling must be stopped)
+
+// Copy up to max sites, most allocations first; returns how many
+std::size_t alloc_profile_sites(AllocSite* out, std::size_t max);
+
+// Sites and pointers the fixed-size tables had no room for (0 = complete)
+std::uint64_t alloc_profile_dropped();
+
+// Human-readable table of the top sites, with symbol names where dladdr()
+// finds them
+void alloc_profile_report(std::FILE* out, std::size_t top = 10);
+
+// Name of the function containing a return address ("?" if unknown)
+const char* alloc_symbol_name(void* address, char* buf, std::size_t size);
+
+// ----- Scoped assertions -----
+
+// Counts the allocations the CURRENT thread makes during its lifetime and
+// complains on destruction if there were more than `allowed`:
+//
+//   {
+//       AllocationGuard guard("order book update");  // allowed = 0
+//       book.apply(update);
+//   }   // -> "AllocationGuard 'order book update': 3 allocations (allowed 0)"
+//
+// Guards nest. With GuardAction::Abort a violation calls abort() - a test
+// fails at the exact scope; with Report it is printed and counted in
+// alloc_guard_failures().
+enum class GuardAction { Report, Abort };
+
+class AllocationGuard {
+public:
+    explicit AllocationGuard(const char* what, std::uint64_t allowed = 0, GuardAction action = GuardAction::Report);
+    ~AllocationGuard();
+
+    AllocationGuard(const AllocationGuard&) = delete;
+    AllocationGuard& operator=(const AllocationGuard&) = delete;
+
+    std::uint64_t allocations() const;  // so far in this scope
+    bool ok() const { return allocations() <= allowed_; }
+
+private:
+    const char* what_;
+    std::uint64_t allowed_;
+    GuardAction action_;
+    std::uint64_t start_;
+};
+
+// Guards that ended over their limit (GuardAction::Report), process-wide
+std::uint64_t alloc_guard_failures();
+
+#endif  // ALLOC_TRACKER_H
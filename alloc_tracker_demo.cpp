@@ -0,0 +1,366 @@
+// Counting heap allocations per code path, per call site, and asserting
+// allocation-free hot paths (link with alloc_tracker.cpp)
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "alloc_tracker.h"
+#include "async_logger.h"
+#include "bench_util.h"
+#include "c_functions.h"  // struct Point
+#include "output_sink.h"
+#include "spsc_ring.h"
+
+extern "C" void* __libc_malloc(std::size_t size) noexcept;
+extern "C" void __libc_free(void* ptr) noexcept;
+
+// ============================================================================
+// HOW IT WORKS
+// ============================================================================
+//
+//   std::vector<int> v;        v.push_back(1)
+//                                  │ std::allocator<int>::allocate
+//                                  ▼
+//                              ::operator new(4)      <- replaced in alloc_tracker.cpp
+//                                  │ ++thread count, ++process count
+//                                  │ [profiling: hash the return addresses
+//                                  │  above this frame -> call-site record]
+//                                  ▼
+//                              __libc_malloc(4)       <- glibc's real allocator
+//
+// memory_visualization.cpp prints WHERE a Vector's elements live. This
+// counts how many allocations happened - which is what a hot path should
+// keep at zero.
+
+// Allocations the calling thread makes inside f()
+template <typename F>
+std::uint64_t count_allocations(F&& f) {
+    std::uint64_t before = thread_allocations();
+    f();
+    return thread_allocations() - before;
+}
+
+// ============================================================================
+// 1. HOW MANY ALLOCATIONS DOES THIS LINE MAKE?
+// ============================================================================
+
+void row(const char* what, std::uint64_t n) {
+    std::printf("  %-46s %6llu\n", what, static_cast<unsigned long long>(n));
+}
+
+void census() {
+    std::cout << "=== Allocations per code path (this thread) ===" << std::endl;
+    std::cout << std::flush;
+
+    auto sso = count_allocations([] {
+        std::string s("short");  // fits the small-string buffer inside the object
+        do_not_optimize(s);
+    });
+    auto heap_string = count_allocations([] {
+        std::string s("a string too long for the small-string buffer");
+        do_not_optimize(s);
+    });
+    auto grow = count_allocations([] {
+        std::vector<int> v;
+        for (int i = 0; i < 1000; ++i) v.push_back(i);  // capacity doubles: 1, 2, 4, ... 1024
+        do_not_optimize(v);
+    });
+    auto reserved = count_allocations([] {
+        std::vector<int> v;
+        v.reserve(1000);
+        for (int i = 0; i < 1000; ++i) v.push_back(i);
+        do_not_optimize(v);
+    });
+    auto map = count_allocations([] {
+        std::map<int, int> m;
+        for (int i = 0; i < 1000; ++i) m[i] = i;  // one tree node per key
+        do_not_optimize(m);
+    });
+    auto hash_map = count_allocations([] {
+        std::unordered_map<int, int> m;
+        for (int i = 0; i < 1000; ++i) m[i] = i;  // one node per key + bucket arrays on rehash
+        do_not_optimize(m);
+    });
+    auto hash_map_reserved = count_allocations([] {
+        std::unordered_map<int, int> m;
+        m.reserve(1000);
+        for (int i = 0; i < 1000; ++i) m[i] = i;
+        do_not_optimize(m);
+    });
+    auto small_function = count_allocations([] {
+        int x = 42;
+        std::function<int()> f = [x] { return x; };  // fits std::function's local buffer
+        do_not_optimize(f);
+    });
+    auto big_function = count_allocations([] {
+        double a[8] = {};
+        std::function<double()> f = [a] { return a[0]; };  // 64-byte capture goes to the heap
+        do_not_optimize(f);
+    });
+    auto shared_new = count_allocations([] {
+        std::shared_ptr<int> p(new int(7));  // object + separate control block
+        do_not_optimize(p);
+    });
+    auto make_shared = count_allocations([] {
+        auto p = std::make_shared<int>(7);  // object and control block in one allocation
+        do_not_optimize(p);
+    });
+    auto stream = count_allocations([] {
+        std::ostringstream os;
+        os << "x = " << 42 << ", y = " << 3.5;
+        std::string s = os.str();
+        do_not_optimize(s);
+    });
+
+    row("std::string(\"short\")", sso);
+    row("std::string(45 chars)", heap_string);
+    row("vector<int>: 1000 x push_back", grow);
+    row("vector<int>: reserve(1000) + 1000 x push_back", reserved);
+    row("map<int,int>: 1000 inserts", map);
+    row("unordered_map<int,int>: 1000 inserts", hash_map);
+    row("unordered_map<int,int>: reserve + 1000 inserts", hash_map_reserved);
+    row("std::function, 4-byte capture", small_function);
+    row("std::function, 64-byte capture", big_function);
+    row("shared_ptr<int>(new int)", shared_new);
+    row("make_shared<int>", make_shared);
+    row("ostringstream: format two numbers + str()", stream);
+    std::fflush(stdout);
+
+    check(sso == 0, "short std::string: no allocation (SSO)");
+    check(heap_string == 1, "long std::string: one allocation");
+    check(grow == 11, "push_back without reserve: 11 allocations (capacity 1..1024)");
+    check(reserved == 1, "with reserve: exactly one");
+    check(map == 1000, "std::map: one node per key");
+    check(hash_map > hash_map_reserved && hash_map_reserved > 1000, "unordered_map: reserve removes the rehash allocations");
+    check(small_function == 0 && big_function == 1, "std::function: small captures stay inline");
+    check(shared_new == 2 && make_shared == 1, "make_shared saves the separate control block");
+}
+
+// ============================================================================
+// 2. ALLOCATION-FREE HOT PATHS, ENFORCED
+// ============================================================================
+// Earlier days claimed "no allocation after construction" for OutputSink,
+// SpscRing and the AsyncLogger call. AllocationGuard turns the claim into a
+// check that fails the moment someone adds a std::string to the hot path.
+
+void hot_paths() {
+    std::cout << std::endl << "=== AllocationGuard on this repo's hot paths ===" << std::endl;
+
+    int devnull = open("/dev/null", O_WRONLY);
+    // Note: check()'s message is a std::string - build it OUTSIDE the guarded
+    // scope, or the guard counts it
+    std::uint64_t made = 0;
+    {
+        OutputSink sink(devnull);
+        double x = 1.0;
+        {
+            AllocationGuard guard("OutputSink formatting");
+            for (int i = 0; i < 100000; ++i) {
+                sink.print(SINK_FMT("elem[{}] = {} at {}\n"), i, x, &x);
+                x *= 1.0001;
+            }
+            sink.flush();
+            made = guard.allocations();
+        }
+        check(made == 0, "OutputSink: 100000 formatted lines, 0 allocations");
+    }
+    {
+        SpscRing<Point> ring(1024);
+        Point batch[64] = {};
+        Point out[64];
+        long moved = 0;
+        {
+            AllocationGuard guard("SpscRing push/pop");
+            for (int i = 0; i < 10000; ++i) {
+                ring.push_n(batch, 64);
+                moved += long(ring.pop_n(out, 64));
+            }
+            made = guard.allocations();
+        }
+        check(made == 0 && moved == 640000, "SpscRing: 640000 Points through push_n/pop_n, 0 allocations");
+    }
+    {
+        LoggerOptions opts;
+        opts.fd = devnull;
+        AsyncLogger log(opts);
+        LOG_INFO(log, "warm-up: registers this thread's ring {}", 0);  // first call allocates the ring
+        std::string venue = "XNAS";
+        {
+            AllocationGuard guard("AsyncLogger call");
+            for (int i = 0; i < 10000; ++i) LOG_INFO(log, "order {} filled px {} venue {}", i, 101.25, venue);
+            made = guard.allocations();
+        }
+        check(made == 0, "AsyncLogger: 10000 LOG_INFO calls after the first, 0 allocations");
+    }
+    close(devnull);
+
+    // A guard that is violated: reported on stderr and counted
+    std::uint64_t failed_before = alloc_guard_failures();
+    std::cerr << std::flush;
+    {
+        AllocationGuard guard("vector without reserve");
+        std::vector<int> v;
+        for (int i = 0; i < 100; ++i) v.push_back(i);
+        do_not_optimize(v);
+    }
+    check(alloc_guard_failures() == failed_before + 1, "a violated guard is reported and counted");
+    bool ok = false;
+    {
+        AllocationGuard guard("one allowed", 1);
+        std::vector<int> v;
+        v.reserve(100);
+        do_not_optimize(v);
+        ok = guard.ok() && guard.allocations() == 1;
+    }
+    check(ok, "AllocationGuard(what, 1) accepts exactly one allocation");
+}
+
+// ============================================================================
+// 3. PER-CALL-SITE PROFILE
+// ============================================================================
+// Three functions with distinct allocation behaviour. Non-static, so that
+// with -rdynamic dladdr() can name them in the report.
+
+struct Node {
+    Node* next;
+    double payload[6];
+};
+
+__attribute__((noinline)) std::vector<Node*> make_nodes(int n) {
+    std::vector<Node*> nodes;
+    nodes.reserve(std::size_t(n));
+    for (int i = 0; i < n; ++i) nodes.push_back(new Node{nullptr, {double(i)}});
+    return nodes;
+}
+
+__attribute__((noinline)) std::size_t format_labels(int n) {
+    std::size_t total = 0;
+    for (int i = 0; i < n; ++i) {
+        std::string label = "sensor/channel/" + std::to_string(i) + "/calibrated-reading";  // temporary
+        total += label.size();
+    }
+    return total;
+}
+
+__attribute__((noinline)) double* grow_buffer(int steps) {
+    double* buf = nullptr;
+    for (int i = 1; i <= steps; ++i) {
+        buf = static_cast<double*>(std::realloc(buf, sizeof(double) * std::size_t(1) << i));
+        buf[0] = i;
+    }
+    return buf;
+}
+
+void profile() {
+    std::cout << std::endl << "=== Per-call-site profile (depth 4) ===" << std::endl;
+    alloc_profile_reset();
+    alloc_profile_start(4);
+    std::vector<Node*> nodes = make_nodes(1000);
+    std::size_t label_bytes = format_labels(500);
+    double* buf = grow_buffer(12);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));  // the nodes live >= 5 ms
+    for (Node* n : nodes) delete n;
+    std::free(buf);
+    alloc_profile_stop();
+    do_not_optimize(label_bytes);
+
+    std::cout << std::flush;
+    alloc_profile_report(stdout, 6);
+    std::fflush(stdout);
+
+    AllocSite sites[64];
+    std::size_t n = alloc_profile_sites(sites, 64);
+    const AllocSite* node_site = nullptr;
+    for (std::size_t i = 0; i < n; ++i) {
+        if (sites[i].count == 1000 && sites[i].bytes == 1000 * sizeof(Node)) node_site = &sites[i];
+    }
+    check(node_site != nullptr, "one site with exactly 1000 x sizeof(Node) = " + std::to_string(1000 * sizeof(Node)) +
+                                    " bytes");
+    if (node_site) {
+        char name[256];
+        std::string where = alloc_symbol_name(node_site->frames[0], name, sizeof(name));
+        check(where.find("make_nodes") != std::string::npos, "...attributed to make_nodes (" + where + ")");
+        check(node_site->frees == 1000 && node_site->live == 0, "...all 1000 frees matched to it");
+        check(node_site->lifetime_ns / 1000 >= 5000000, "...mean lifetime >= 5 ms");
+        check(node_site->size_histogram[2] == 1000, "...all in the <=64 B size bucket");
+    }
+    check(alloc_profile_dropped() == 0, "nothing dropped (tables big enough)");
+}
+
+// ============================================================================
+// 4. WHAT THE TRACKER COSTS
+// ============================================================================
+
+void overhead(long n) {
+    std::cout << std::endl << "=== Cost per allocate + free pair (" << n << " pairs, 48 bytes) ===" << std::endl;
+    double raw = time_ms([&] {
+        for (long i = 0; i < n; ++i) {
+            void* p = __libc_malloc(48);
+            do_not_optimize(p);
+            __libc_free(p);
+        }
+    });
+    double counted = time_ms([&] {
+        for (long i = 0; i < n; ++i) {
+            void* p = ::operator new(48);
+            do_not_optimize(p);
+            ::operator delete(p);
+        }
+    });
+    long m = n / 20;
+    alloc_profile_start(4);
+    double profiled = time_ms([&] {
+        for (long i = 0; i < m; ++i) {
+            void* p = ::operator new(48);
+            do_not_optimize(p);
+            ::operator delete(p);
+        }
+    });
+    alloc_profile_stop();
+    alloc_profile_reset();
+    std::cout << "  glibc malloc/free directly:   " << raw * 1e6 / double(n) << " ns" << std::endl;
+    std::cout << "  new/delete, counting:         " << counted * 1e6 / double(n) << " ns" << std::endl;
+    std::cout << "  new/delete, profiling:        " << profiled * 1e6 / double(m) << " ns  (frame-pointer walk + table)"
+              << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Heap Allocation Tracker ===" << std::endl;
+    std::cout << std::endl;
+    long n = argc > 1 ? std::atol(argv[1]) : 2000000;
+
+    census();
+    hot_paths();
+    profile();
+    overhead(n);
+
+    AllocStats st = alloc_stats();
+    std::cout << std::endl << "=== Process totals ===" << std::endl;
+    std::cout << "  allocations: " << st.allocations << ", frees: " << st.frees
+              << ", bytes requested: " << st.bytes_requested << ", peak live: " << st.peak_live_bytes << " bytes"
+              << std::endl;
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• Replacing global operator new/delete and malloc sees every allocation," << std::endl;
+    std::cout << "  including the ones hidden inside the standard library" << std::endl;
+    std::cout << "• reserve(), make_shared and small-buffer optimizations are countable wins" << std::endl;
+    std::cout << "• AllocationGuard turns \"this path doesn't allocate\" into a test that fails" << std::endl;
+    std::cout << "• Counting costs tens of ns; attributing to call sites costs a stack walk -" << std::endl;
+    std::cout << "  profile a window, not the whole run (or ALLOC_TRACKER_PROFILE=4 in the field)" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
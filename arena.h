@@ -0,0 +1,84 @@
+// arena.h - bump allocator for parse trees (demangler.cpp, brace_init_engine.cpp)
+//
+// A parser makes many small nodes that all die together, when the next input
+// starts. malloc/free per node pays for bookkeeping nobody needs; the arena
+// hands out consecutive bytes from big chunks instead:
+//
+//   chunk 0 [node|node|list....|node|   free   ]   allocate(): round up, bump
+//   chunk 1 [node|node|...                    ]   full: go to the next chunk
+//
+// reset() rewinds to the start of chunk 0 without freeing anything, so a
+// steady stream of inputs stops allocating once the chunks are big enough.
+// Nothing is destroyed: only trivially destructible objects belong here.
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+class Arena {
+public:
+    explicit Arena(std::size_t chunk_bytes = 32 * 1024) : chunk_bytes_(chunk_bytes) {}
+    ~Arena() {
+        for (Chunk& c : chunks_) std::free(c.data);
+    }
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void* allocate(std::size_t bytes, std::size_t align) {
+        while (current_ < chunks_.size()) {
+            Chunk& c = chunks_[current_];
+            std::size_t at = (used_ + align - 1) & ~(align - 1);
+            if (at + bytes <= c.size) {
+                used_ = at + bytes;
+                return c.data + at;
+            }
+            ++current_;  // too small for this request: move on (after reset() the next chunk may fit)
+            used_ = 0;
+        }
+        std::size_t size = std::max(chunk_bytes_, bytes + align);
+        char* data = static_cast<char*>(std::malloc(size));  // malloc: aligned for any node
+        if (!data) throw std::bad_alloc();
+        chunks_.push_back(Chunk{data, size});
+        current_ = chunks_.size() - 1;
+        used_ = bytes;
+        return data;
+    }
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        static_assert(std::is_trivially_destructible<T>::value, "the arena never runs destructors");
+        return new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    void reset() {
+        current_ = 0;
+        used_ = 0;
+    }
+
+    // bytes held in chunks
+    std::size_t reserved() const {
+        std::size_t n = 0;
+        for (const Chunk& c : chunks_) n += c.size;
+        return n;
+    }
+
+private:
+    struct Chunk {
+        char* data;
+        std::size_t size;
+    };
+    std::vector<Chunk> chunks_;
+    std::size_t current_ = 0;  // chunk being filled
+    std::size_t used_ = 0;     // bytes used in it
+    std::size_t chunk_bytes_;
+};
+
+#endif  // ARENA_H
@@ -0,0 +1,60 @@
+/* Atomic primitives written in assembly (asm_atomics_x86_64.s, asm_atomics_arm64.S)
+ *
+ * asm_swap() in asm_functions.s is NOT atomic: another thread can run between
+ * its loads and its stores. These functions do each operation as ONE
+ * indivisible step, using the CPU's atomic instructions:
+ *
+ *   operation       x86-64                ARM64 with LSE (v8.1+)   ARM64 without LSE
+ *   exchange        xchg                  swpal                    ldaxr/stlxr loop
+ *   compare-exch.   lock cmpxchg          casal                    ldaxr/stlxr loop
+ *   fetch-add       lock xadd             ldaddal                  ldaxr/stlxr loop
+ *   128-bit CAS     lock cmpxchg16b       caspal                   ldaxp/stlxp loop
+ *   load            mov                   ldar
+ *   store           mov                   stlr
+ *
+ * ORDERING: the read-modify-write operations are sequentially consistent (full
+ * barriers). asm_atomic_load is an ACQUIRE load and asm_atomic_store a RELEASE
+ * store - enough to publish data from one thread to another. Each call is
+ * opaque to the compiler, so it also acts as a compiler barrier.
+ *
+ * All pointers must be naturally aligned: 8 bytes for int64_t, 16 for AsmPair.
+ */
+#ifndef ASM_ATOMICS_H
+#define ASM_ATOMICS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#define ASM_ALIGN16 alignas(16)
+#else
+#define ASM_ALIGN16 _Alignas(16)
+#endif
+
+/* Two 64-bit words updated together by asm_atomic_cas128 (e.g. pointer + ABA tag) */
+typedef struct AsmPair {
+    ASM_ALIGN16 uint64_t lo;
+    uint64_t hi;
+} AsmPair;
+
+/* *p = value; returns the old value */
+int64_t asm_atomic_exchange(int64_t* p, int64_t value);
+
+/* If *p == *expected: *p = desired, return 1.
+ * Otherwise: *expected = current *p, return 0 (ready for the next retry). */
+int asm_atomic_cas(int64_t* p, int64_t* expected, int64_t desired);
+
+/* *p += delta; returns the old value */
+int64_t asm_atomic_fetch_add(int64_t* p, int64_t delta);
+
+/* Same as asm_atomic_cas, on both words at once (double-width CAS) */
+int asm_atomic_cas128(AsmPair* p, AsmPair* expected, uint64_t desired_lo, uint64_t desired_hi);
+
+int64_t asm_atomic_load(const int64_t* p);          /* acquire */
+void asm_atomic_store(int64_t* p, int64_t value);   /* release */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASM_ATOMICS_H */
@@ -0,0 +1,54 @@
+// Load-time selection of the LSE or LL/SC atomics on ARM64 Linux (see asm_atomics_arm64.S)
+// Not needed on x86-64 (one version) or macOS (all Apple Silicon has LSE).
+#include "asm_atomics.h"
+
+#if defined(__aarch64__) && defined(__linux__)
+
+#ifndef HWCAP_ATOMICS
+#define HWCAP_ATOMICS (1 << 8)      // from <asm/hwcap.h>
+#endif
+
+int64_t asm_atomic_exchange_lse(int64_t* p, int64_t value);
+int64_t asm_atomic_exchange_llsc(int64_t* p, int64_t value);
+int asm_atomic_cas_lse(int64_t* p, int64_t* expected, int64_t desired);
+int asm_atomic_cas_llsc(int64_t* p, int64_t* expected, int64_t desired);
+int64_t asm_atomic_fetch_add_lse(int64_t* p, int64_t delta);
+int64_t asm_atomic_fetch_add_llsc(int64_t* p, int64_t delta);
+int asm_atomic_cas128_lse(AsmPair* p, AsmPair* expected, uint64_t lo, uint64_t hi);
+int asm_atomic_cas128_llsc(AsmPair* p, AsmPair* expected, uint64_t lo, uint64_t hi);
+
+typedef int64_t (*ExchangeFn)(int64_t*, int64_t);
+typedef int (*CasFn)(int64_t*, int64_t*, int64_t);
+typedef int64_t (*FetchAddFn)(int64_t*, int64_t);
+typedef int (*Cas128Fn)(AsmPair*, AsmPair*, uint64_t, uint64_t);
+
+// On AArch64, glibc passes AT_HWCAP to the resolver as its first argument:
+// the resolver runs during relocation, before it's safe to call getauxval()
+
+static ExchangeFn resolve_exchange(uint64_t hwcap) {
+    return (hwcap & HWCAP_ATOMICS) ? asm_atomic_exchange_lse : asm_atomic_exchange_llsc;
+}
+
+static CasFn resolve_cas(uint64_t hwcap) {
+    return (hwcap & HWCAP_ATOMICS) ? asm_atomic_cas_lse : asm_atomic_cas_llsc;
+}
+
+static FetchAddFn resolve_fetch_add(uint64_t hwcap) {
+    return (hwcap & HWCAP_ATOMICS) ? asm_atomic_fetch_add_lse : asm_atomic_fetch_add_llsc;
+}
+
+static Cas128Fn resolve_cas128(uint64_t hwcap) {
+    return (hwcap & HWCAP_ATOMICS) ? asm_atomic_cas128_lse : asm_atomic_cas128_llsc;
+}
+
+int64_t asm_atomic_exchange(int64_t* p, int64_t value) __attribute__((ifunc("resolve_exchange")));
+int asm_atomic_cas(int64_t* p, int64_t* expected, int64_t desired) __attribute__((ifunc("resolve_cas")));
+int64_t asm_atomic_fetch_add(int64_t* p, int64_t delta) __attribute__((ifunc("resolve_fetch_add")));
+int asm_atomic_cas128(AsmPair* p, AsmPair* expected, uint64_t lo, uint64_t hi)
+    __attribute__((ifunc("resolve_cas128")));
+
+#else
+
+typedef int asm_atomics_arm64_unused;   // ISO C: a translation unit may not be empty
+
+#endif
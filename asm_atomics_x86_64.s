@@ -0,0 +1,90 @@
+# Atomic primitives for x86-64 Linux (System V ABI) - see asm_atomics.h
+# GNU assembler, AT&T syntax
+#
+# The `lock` prefix makes the following read-modify-write instruction atomic:
+# the core holds the cache line exclusively until the instruction finishes.
+# Locked instructions are also full memory barriers. xchg with a memory
+# operand is always locked, even without the prefix.
+#
+# x86 is TSO (total store order): plain loads already have acquire semantics
+# and plain stores release semantics, so load/store are just `mov`.
+
+.text
+
+# int64_t asm_atomic_exchange(int64_t* p, int64_t value)     rdi = p, rsi = value
+.global asm_atomic_exchange
+.type asm_atomic_exchange, @function
+asm_atomic_exchange:
+    mov     %rsi, %rax
+    xchg    %rax, (%rdi)            # swap rax and *p (implicitly locked)
+    ret                             # old value in rax
+.size asm_atomic_exchange, .-asm_atomic_exchange
+
+# int asm_atomic_cas(int64_t* p, int64_t* expected, int64_t desired)
+#   rdi = p, rsi = expected, rdx = desired
+# cmpxchg compares rax with *p: equal -> *p = rdx, ZF=1; else rax = *p, ZF=0
+.global asm_atomic_cas
+.type asm_atomic_cas, @function
+asm_atomic_cas:
+    mov     (%rsi), %rax            # rax = *expected
+    lock cmpxchg %rdx, (%rdi)
+    je      1f
+    mov     %rax, (%rsi)            # failed: report what was there
+    xor     %eax, %eax
+    ret
+1:
+    mov     $1, %eax
+    ret
+.size asm_atomic_cas, .-asm_atomic_cas
+
+# int64_t asm_atomic_fetch_add(int64_t* p, int64_t delta)    rdi = p, rsi = delta
+.global asm_atomic_fetch_add
+.type asm_atomic_fetch_add, @function
+asm_atomic_fetch_add:
+    mov     %rsi, %rax
+    lock xadd %rax, (%rdi)          # tmp = *p; *p += rax; rax = tmp
+    ret
+.size asm_atomic_fetch_add, .-asm_atomic_fetch_add
+
+# int asm_atomic_cas128(AsmPair* p, AsmPair* expected, uint64_t desired_lo, uint64_t desired_hi)
+#   rdi = p, rsi = expected, rdx = desired_lo, rcx = desired_hi
+# cmpxchg16b compares rdx:rax with the 16 bytes at p: equal -> store rcx:rbx;
+# else rdx:rax = current value. p must be 16-byte aligned (or it faults).
+# rbx is callee-saved in System V, so it is pushed and restored.
+.global asm_atomic_cas128
+.type asm_atomic_cas128, @function
+asm_atomic_cas128:
+    push    %rbx
+    mov     %rdx, %rbx              # rcx:rbx = desired (hi:lo)
+    mov     (%rsi), %rax            # rdx:rax = *expected
+    mov     8(%rsi), %rdx
+    lock cmpxchg16b (%rdi)
+    je      1f
+    mov     %rax, (%rsi)
+    mov     %rdx, 8(%rsi)
+    xor     %eax, %eax
+    pop     %rbx
+    ret
+1:
+    mov     $1, %eax
+    pop     %rbx
+    ret
+.size asm_atomic_cas128, .-asm_atomic_cas128
+
+# int64_t asm_atomic_load(const int64_t* p)                  rdi = p
+.global asm_atomic_load
+.type asm_atomic_load, @function
+asm_atomic_load:
+    mov     (%rdi), %rax            # aligned 8-byte loads are atomic; TSO makes them acquire
+    ret
+.size asm_atomic_load, .-asm_atomic_load
+
+# void asm_atomic_store(int64_t* p, int64_t value)           rdi = p, rsi = value
+.global asm_atomic_store
+.type asm_atomic_store, @function
+asm_atomic_store:
+    mov     %rsi, (%rdi)            # release store (a seq_cst store would need xchg)
+    ret
+.size asm_atomic_store, .-asm_atomic_store
+
+.section .note.GNU-stack,"",@progbits
@@ -0,0 +1,389 @@
+// Do the "same machine code" claims hold? Compile both forms, diff the assembly
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+
+// ============================================================================
+// THE CLAIMS
+// ============================================================================
+// Three files promise that a nicer spelling costs nothing:
+//
+//   brace_init_compiler.cpp   int arr[]{1, 2, 3};  ==  int arr[] = {1, 2, 3};
+//                             "Both produce IDENTICAL assembly"
+//   operator_grammar.cpp      d + 5  ==  d.operator+(5)
+//                             "Both compile to the same machine code!"
+//   brace_initialization.cpp  int x{5};  ==  int x = 5;
+//
+// A comment can't notice when a compiler upgrade breaks its promise. This
+// program checks: each pair is written out as two translation units that
+// differ only in the spelling, compiled with -S at -O0, -O2 and -O3 by
+// every compiler it finds, and the assembly is normalized and compared:
+//
+//   snippet ─┬─ form A ──g++ -S──▶ asm ──normalize──▶ ┐
+//            └─ form B ──g++ -S──▶ asm ──normalize──▶ ┴─ identical?
+//
+// Any difference fails the run (exit code 1). A control pair that really
+// differs (d + 5 vs d + 6) must be reported as different - otherwise the
+// normalizer is hiding too much and every "identical" is worthless.
+
+// ============================================================================
+// THE SNIPPETS
+// ============================================================================
+// FORM in `code` is replaced by form_a or form_b. Everything a snippet
+// needs is declared in it, and opaque calls (consume) keep the optimizer
+// from deleting the code under test. Globals and functions have the same
+// names in both forms, so only the spelling can make a difference.
+
+struct Pair {
+    const char* name;
+    const char* claim;  // where the promise is made
+    const char* code;
+    const char* form_a;
+    const char* form_b;
+    bool same;          // false: the control, which must differ
+};
+
+const Pair kPairs[] = {
+    {"array: braces vs = braces",
+     "brace_init_compiler.cpp",
+     "void consume(const int*);\n"
+     "int global_arrFORM;\n"
+     "void local() {\n"
+     "    int arrFORM;\n"
+     "    consume(arr);\n"
+     "}\n",
+     "[]{1, 2, 3}", "[] = {1, 2, 3}", true},
+    {"operator: d + 5 vs d.operator+(5)",
+     "operator_grammar.cpp",
+     "class Demo {\n"
+     "public:\n"
+     "    int value = 10;\n"
+     "    int operator+(int x) { return value + x; }\n"
+     "};\n"
+     "int add(Demo& d) { return FORM; }\n"
+     "int add_temporary() { Demo d; return FORM; }\n",
+     "d + 5", "d.operator+(5)", true},
+    {"scalar: x{v} vs x = v",
+     "brace_initialization.cpp",
+     "void consume(const int*);\n"
+     "void scalar(int v) {\n"
+     "    int xFORM;\n"
+     "    consume(&x);\n"
+     "}\n",
+     "{v}", " = v", true},
+    {"control: d + 5 vs d + 6",
+     "(must differ)",
+     "class Demo {\n"
+     "public:\n"
+     "    int value = 10;\n"
+     "    int operator+(int x) { return value + x; }\n"
+     "};\n"
+     "int add(Demo& d) { return FORM; }\n",
+     "d + 5", "d + 6", false},
+};
+
+std::string instantiate(const Pair& pair, const char* form) {
+    std::string code = pair.code;
+    std::string spelling = form;
+    for (std::size_t at = code.find("FORM"); at != std::string::npos; at = code.find("FORM", at + spelling.size()))
+        code.replace(at, 4, spelling);
+    return code;
+}
+
+// ============================================================================
+// COMPILING AND NORMALIZING
+// ============================================================================
+
+// Output of `command`; *ok (if given) says whether it exited with status 0
+std::string run(const std::string& command, bool* ok = nullptr) {
+    std::string text;
+    if (ok) *ok = false;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return text;
+    char buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof buf, pipe)) > 0) text.append(buf, n);
+    int status = pclose(pipe);
+    if (ok) *ok = status != -1 && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    return text;
+}
+
+// Assembly for `source`; empty if the compiler failed
+std::string compile(const std::string& compiler, const std::string& level, const std::string& source) {
+    char path[] = "/tmp/asm_equivalence_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return "";
+    bool written = write(fd, source.data(), source.size()) == ssize_t(source.size());
+    close(fd);
+    std::string cpp = std::string(path) + ".cpp";
+    std::string s = std::string(path) + ".s";
+    std::rename(path, cpp.c_str());
+    // No unwind tables or .ident: they're noise, not code
+    std::string flags = " -std=c++17 " + level + " -S -fno-asynchronous-unwind-tables -fno-ident -o " + s + " " + cpp;
+    // The exit status decides success; stderr alone may just be warnings
+    bool ok = false;
+    std::string messages = written ? run(compiler + flags + " 2>&1", &ok) : "not written";
+    std::string assembly;
+    if (FILE* f = std::fopen(s.c_str(), "r")) {
+        char buf[4096];
+        std::size_t n;
+        while ((n = std::fread(buf, 1, sizeof buf, f)) > 0) assembly.append(buf, n);
+        std::fclose(f);
+    }
+    unlink(cpp.c_str());
+    unlink(s.c_str());
+    if (!messages.empty()) {
+        std::cout << "  " << compiler << " " << level << (ok ? " (warnings): " : " failed: ")
+                  << messages.substr(0, 200) << std::endl;
+    }
+    return ok ? assembly : "";
+}
+
+// What's left is instructions, labels and data:
+//
+//   .L3:                  ->  L1:        local labels renumbered in order
+//   	movl	$1, -20(%rbp)   ->  movl $1, -20(%rbp)
+//   	.cfi_def_cfa 7, 8   ->  (dropped)  bookkeeping directives
+//   	.long	1           ->  .long 1    data stays: arr's contents matter
+//   	# comment           ->  (dropped)
+//
+// Function names are the same in both forms (see above), so they stay and
+// a diff can say where it is.
+std::vector<std::string> normalize(const std::string& assembly) {
+    static const char* const kDataDirectives[] = {".byte", ".value", ".short", ".long", ".quad", ".zero",
+                                                  ".string", ".ascii", ".float", ".double", ".set"};
+    std::vector<std::string> lines;
+    std::map<std::string, std::string> labels;
+    auto label = [&](const std::string& name) {
+        auto found = labels.find(name);
+        if (found != labels.end()) return found->second;
+        std::string renamed = "L" + std::to_string(labels.size() + 1);
+        labels.emplace(name, renamed);
+        return renamed;
+    };
+
+    std::size_t start = 0;
+    while (start < assembly.size()) {
+        std::size_t stop = assembly.find('\n', start);
+        if (stop == std::string::npos) stop = assembly.size();
+        std::string line = assembly.substr(start, stop - start);
+        start = stop + 1;
+
+        std::size_t comment = line.find('#');  // AT&T comments (no '#' in operands)
+        if (comment != std::string::npos) line.erase(comment);
+        std::string out;
+        bool space = false;
+        for (char c : line) {  // collapse tabs and runs of spaces
+            if (c == ' ' || c == '\t') {
+                space = !out.empty();
+            } else {
+                if (space) out += ' ';
+                out += c;
+                space = false;
+            }
+        }
+        if (out.empty()) continue;
+        // .LFB0:/.LFE0: mark function bounds for the unwinder and nothing else
+        if (out.back() == ':' && (out.compare(0, 4, ".LFB") == 0 || out.compare(0, 4, ".LFE") == 0)) continue;
+
+        if (out[0] == '.' && out.find(':') == std::string::npos) {
+            bool data = false;
+            for (const char* d : kDataDirectives)
+                data |= out.compare(0, std::string(d).size(), d) == 0 &&
+                        (out.size() == std::string(d).size() || out[std::string(d).size()] == ' ');
+            if (!data) continue;  // .text, .globl, .type, .size, .p2align, .cfi_*, .section
+        }
+        // Local labels (.L3, .LFB0, .LC1) wherever they appear
+        std::string renamed;
+        for (std::size_t i = 0; i < out.size();) {
+            bool at_label = out.compare(i, 2, ".L") == 0 &&
+                            (i == 0 || !(std::isalnum(static_cast<unsigned char>(out[i - 1])) || out[i - 1] == '_'));
+            if (!at_label) {
+                renamed += out[i++];
+                continue;
+            }
+            std::size_t end = i + 2;
+            while (end < out.size() && (std::isalnum(static_cast<unsigned char>(out[end])) || out[end] == '_')) ++end;
+            renamed += label(out.substr(i, end - i));
+            i = end;
+        }
+        lines.push_back(renamed);
+    }
+    return lines;
+}
+
+// Index of the first differing line, or -1 when equal
+long first_difference(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    std::size_t n = std::min(a.size(), b.size());
+    for (std::size_t i = 0; i < n; ++i)
+        if (a[i] != b[i]) return long(i);
+    return a.size() == b.size() ? -1 : long(n);
+}
+
+void show_difference(const std::vector<std::string>& a, const std::vector<std::string>& b, long at) {
+    std::size_t from = std::size_t(std::max(0L, at - 2));
+    for (std::size_t i = from; i < std::size_t(at) + 3 && (i < a.size() || i < b.size()); ++i) {
+        std::string left = i < a.size() ? a[i] : "";
+        std::string right = i < b.size() ? b[i] : "";
+        std::cout << "      " << (left == right ? "  " : "! ") << left;
+        if (left != right) std::cout << std::string(left.size() < 32 ? 32 - left.size() : 1, ' ') << "| " << right;
+        std::cout << std::endl;
+    }
+}
+
+// ============================================================================
+// COMPARING
+// ============================================================================
+
+void compare_all(const std::vector<std::string>& compilers) {
+    const char* const levels[] = {"-O0", "-O2", "-O3"};
+    for (const Pair& pair : kPairs) {
+        std::cout << "--- " << pair.name << "  [" << pair.claim << "] ---" << std::endl;
+        std::cout << "    A: " << pair.form_a << "    B: " << pair.form_b << std::endl;
+        for (const std::string& compiler : compilers) {
+            for (const char* level : levels) {
+                std::string asm_a = compile(compiler, level, instantiate(pair, pair.form_a));
+                std::string asm_b = compile(compiler, level, instantiate(pair, pair.form_b));
+                std::string what = compiler + " " + level;
+                if (asm_a.empty() || asm_b.empty()) {
+                    check(false, what + ": compiles");
+                    continue;
+                }
+                std::vector<std::string> a = normalize(asm_a);
+                std::vector<std::string> b = normalize(asm_b);
+                long at = first_difference(a, b);
+                std::string size = " (" + std::to_string(a.size()) + " lines)";
+                if (pair.same) {
+                    check(at < 0, what + ": identical" + size);
+                } else {
+                    check(at >= 0, what + ": the control differs, so differences do show" + size);
+                }
+                if (at >= 0 && pair.same) show_difference(a, b, at);
+            }
+        }
+        std::cout << std::endl;
+    }
+}
+
+// ============================================================================
+// AND AT RUN TIME
+// ============================================================================
+// Identical assembly means identical speed, but the timing is what a reader
+// of the claim cares about - and what a divergence would cost. Both forms,
+// compiled into this program, called through a pointer so neither inlines.
+
+class Demo {
+public:
+    int value = 10;
+    int operator+(int x) { return value + x; }
+};
+
+__attribute__((noinline)) int array_braced(int k) {
+    int arr[]{1, 2, k};
+    do_not_optimize(arr);
+    return arr[0] + arr[1] + arr[2];
+}
+
+__attribute__((noinline)) int array_assigned(int k) {
+    int arr[] = {1, 2, k};
+    do_not_optimize(arr);
+    return arr[0] + arr[1] + arr[2];
+}
+
+__attribute__((noinline)) int operator_sugar(int k) {
+    Demo d;
+    d.value = k;
+    do_not_optimize(d);
+    return d + 5;
+}
+
+__attribute__((noinline)) int operator_explicit(int k) {
+    Demo d;
+    d.value = k;
+    do_not_optimize(d);
+    return d.operator+(5);
+}
+
+double ns_per_call(int (*fn)(int), long calls) {
+    double best = 1e30;
+    for (int round = 0; round < 5; ++round) {
+        int sum = 0;
+        best = std::min(best, time_ms([&] {
+                            for (long i = 0; i < calls; ++i) sum += fn(int(i));
+                        }));
+        do_not_optimize(sum);
+    }
+    return best * 1e6 / double(calls);
+}
+
+void benchmark(long calls) {
+    std::cout << "=== Run Time, " << calls << " Calls Each (best of 5) ===" << std::endl;
+    struct Timed {
+        const char* name;
+        int (*a)(int);
+        int (*b)(int);
+    };
+    const Timed timed[] = {
+        {"int arr[]{1, 2, k}  vs  int arr[] = {1, 2, k}", array_braced, array_assigned},
+        {"d + 5               vs  d.operator+(5)       ", operator_sugar, operator_explicit},
+    };
+    for (const Timed& t : timed) {
+        check(t.a(7) == t.b(7), std::string(t.name) + ": same result");
+        double a = ns_per_call(t.a, calls);
+        double b = ns_per_call(t.b, calls);
+        std::cout << "    " << t.name << "   " << a << " ns  vs  " << b << " ns" << std::endl;
+    }
+    // Not a check: at ~1 ns per call, timer noise is bigger than any real
+    // difference. The assembly diff above is the test; this is the reading.
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Zero Overhead, Verified: Assembly of Equivalent Spellings ===" << std::endl;
+    std::cout << std::endl;
+    long calls = argc > 1 ? std::atol(argv[1]) : 50000000;
+
+    std::vector<std::string> compilers;
+    for (const char* c : {"g++", "clang++"}) {
+        if (run(std::string("command -v ") + c + " 2>/dev/null").empty()) {
+            std::cout << "(" << c << " not found - skipped)" << std::endl;
+        } else {
+            compilers.push_back(c);
+            std::string version = run(std::string(c) + " --version 2>/dev/null");
+            std::cout << version.substr(0, version.find('\n')) << std::endl;
+        }
+    }
+    std::cout << std::endl;
+    if (compilers.empty()) {
+        std::cout << "No compiler to check with." << std::endl;
+        return 1;
+    }
+
+    compare_all(compilers);
+    benchmark(calls);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• {} vs = {} and d + 5 vs d.operator+(5) are spellings: the compiler sees the same thing after parsing"
+              << std::endl;
+    std::cout << "• Even at -O0: the difference is gone before code generation, not optimized away"
+              << std::endl;
+    std::cout << "• Diffing assembly needs normalizing: label numbers and .cfi bookkeeping differ between runs"
+              << std::endl;
+    std::cout << "• A control pair that must differ proves the normalizer isn't hiding real differences"
+              << std::endl;
+    std::cout << "• Run this after a compiler upgrade: a claim in a comment can't fail, this can" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,47 @@
+# Assembly functions for x86-64 Linux (System V ABI) - same API as asm_functions.s
+# GNU assembler, AT&T syntax: `op source, destination`, registers start with %
+#
+# System V: integer/pointer arguments in rdi, rsi, rdx, rcx, r8, r9
+#           (32-bit halves: edi, esi, edx, ...)
+# Return value in rax (or eax for 32-bit)
+# No underscore prefix on Linux (ELF), unlike macOS (Mach-O)
+
+.global asm_add
+.global asm_multiply
+.global asm_swap
+
+.text
+
+# int asm_add(int a, int b)
+# a is in edi (32-bit register)
+# b is in esi (32-bit register)
+.type asm_add, @function
+asm_add:
+    lea     (%rdi,%rsi), %eax   # eax = a + b (lea does the add without touching flags)
+    ret                         # Return (value in eax)
+.size asm_add, .-asm_add
+
+# long asm_multiply(long a, long b)
+# a is in rdi (64-bit register)
+# b is in rsi (64-bit register)
+.type asm_multiply, @function
+asm_multiply:
+    mov     %rdi, %rax          # rax = a
+    imul    %rsi, %rax          # rax = rax * b
+    ret                         # Return (value in rax)
+.size asm_multiply, .-asm_multiply
+
+# void asm_swap(int* a, int* b)
+# a is in rdi (pointer)
+# b is in rsi (pointer)
+.type asm_swap, @function
+asm_swap:
+    mov     (%rdi), %eax        # Load value at *a into eax
+    mov     (%rsi), %edx        # Load value at *b into edx
+    mov     %edx, (%rdi)        # Store edx to *a
+    mov     %eax, (%rsi)        # Store eax to *b
+    ret
+.size asm_swap, .-asm_swap
+
+# No executable stack needed (otherwise the linker warns and marks the stack executable)
+.section .note.GNU-stack,"",@progbits
@@ -3,7 +3,8 @@
 
 // Declare assembly functions using extern "C"
 extern "C" {
-    // These functions are defined in asm_functions.s
+    // These functions are defined in asm_functions.s (ARM64, macOS)
+    // or asm_functions_x86_64.s (x86-64, Linux) - same names, same signatures
     int asm_add(int a, int b);
     long asm_multiply(long a, long b);
     void asm_swap(int* a, int* b);
@@ -13,7 +14,7 @@ int main() {
     std::cout << "=== C++ and Assembly Interoperability Example ===" << std::endl;
     std::cout << std::endl;
     
-    // Call assembly function - arguments passed in registers (x86_64 calling convention)
+    // Call assembly function - arguments passed in registers (ARM64: w0/w1, x86-64 System V: edi/esi)
     int sum = asm_add(15, 25);
     std::cout << "Assembly asm_add(15, 25) = " << sum << std::endl;
     
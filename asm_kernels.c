@@ -0,0 +1,104 @@
+// Generic C versions of the bulk kernels + load-time dispatch (see asm_kernels.h)
+#include "asm_kernels.h"
+
+// ============================================================================
+// Generic versions - plain loops, whatever the compiler makes of them
+// ============================================================================
+
+void asm_swap_n_generic(int* a, int* b, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        int tmp = a[i];
+        a[i] = b[i];
+        b[i] = tmp;
+    }
+}
+
+void* asm_memset_generic(void* dst, int value, size_t n) {
+    // GCC/Clang recognize this loop and usually turn it into a call to memset
+    unsigned char* p = (unsigned char*)dst;
+    for (size_t i = 0; i < n; i++) {
+        p[i] = (unsigned char)value;
+    }
+    return dst;
+}
+
+double asm_sum_generic(const double* a, size_t n) {
+    // Strict left-to-right order: without -ffast-math the compiler may NOT
+    // reorder these additions, so this loop stays scalar
+    double sum = 0.0;
+    for (size_t i = 0; i < n; i++) {
+        sum += a[i];
+    }
+    return sum;
+}
+
+// ============================================================================
+// Dispatch
+// ============================================================================
+
+#if defined(__x86_64__) && defined(__ELF__) && defined(__GNUC__)
+
+// GNU ifunc: the resolver runs while the dynamic loader processes relocations,
+// BEFORE constructors and main(). __builtin_cpu_init() must come first because
+// libgcc's CPU model may not be initialized yet. __builtin_cpu_supports also
+// checks that the OS saves the wide registers (XGETBV), not just CPUID bits.
+
+enum Isa { ISA_GENERIC, ISA_AVX2, ISA_AVX512 };
+
+static enum Isa detect_isa(void) {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return ISA_AVX512;
+    if (__builtin_cpu_supports("avx2")) return ISA_AVX2;
+    return ISA_GENERIC;
+}
+
+typedef void (*SwapFn)(int*, int*, size_t);
+typedef void* (*MemsetFn)(void*, int, size_t);
+typedef double (*SumFn)(const double*, size_t);
+
+static SwapFn resolve_swap_n(void) {
+    switch (detect_isa()) {
+        case ISA_AVX512: return asm_swap_n_avx512;
+        case ISA_AVX2:   return asm_swap_n_avx2;
+        default:         return asm_swap_n_generic;
+    }
+}
+
+static MemsetFn resolve_memset(void) {
+    switch (detect_isa()) {
+        case ISA_AVX512: return asm_memset_avx512;
+        case ISA_AVX2:   return asm_memset_avx2;
+        default:         return asm_memset_generic;
+    }
+}
+
+static SumFn resolve_sum(void) {
+    switch (detect_isa()) {
+        case ISA_AVX512: return asm_sum_avx512;
+        case ISA_AVX2:   return asm_sum_avx2;
+        default:         return asm_sum_generic;
+    }
+}
+
+void asm_swap_n(int* a, int* b, size_t n) __attribute__((ifunc("resolve_swap_n")));
+void* asm_memset(void* dst, int value, size_t n) __attribute__((ifunc("resolve_memset")));
+double asm_sum(const double* a, size_t n) __attribute__((ifunc("resolve_sum")));
+
+const char* asm_kernels_isa(void) {
+    switch (detect_isa()) {
+        case ISA_AVX512: return "avx512";
+        case ISA_AVX2:   return "avx2";
+        default:         return "generic";
+    }
+}
+
+#else
+
+// No ifunc (macOS, ARM64, ...): the plain names are the generic versions
+
+void asm_swap_n(int* a, int* b, size_t n) { asm_swap_n_generic(a, b, n); }
+void* asm_memset(void* dst, int value, size_t n) { return asm_memset_generic(dst, value, n); }
+double asm_sum(const double* a, size_t n) { return asm_sum_generic(a, n); }
+const char* asm_kernels_isa(void) { return "generic"; }
+
+#endif
@@ -0,0 +1,56 @@
+/* Bulk kernels with hand-written AVX2 / AVX-512 versions (asm_kernels_x86_64.s)
+ *
+ * Call the plain names (asm_swap_n, asm_memset, asm_sum). On x86-64 Linux each
+ * one is an ifunc: the dynamic loader runs a resolver ONCE, at load time, which
+ * checks CPUID and binds the symbol to the best version for this CPU. After
+ * that every call is a plain indirect call through the GOT/PLT, no checks.
+ *
+ *   asm_sum(a, n) ──▶ PLT ──▶ asm_sum_avx512   (CPU has AVX-512)
+ *                         └─▶ asm_sum_avx2     (CPU has AVX2)
+ *                         └─▶ asm_sum_generic  (anything else, plain C)
+ *
+ * Elsewhere (ARM64, macOS) the plain names are the generic C versions.
+ */
+#ifndef ASM_KERNELS_H
+#define ASM_KERNELS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Swap a[i] and b[i] for i in [0, n); the arrays must not overlap */
+void asm_swap_n(int* a, int* b, size_t n);
+
+/* Like memset: fill n bytes at dst with (unsigned char)value, return dst */
+void* asm_memset(void* dst, int value, size_t n);
+
+/* Sum of a[0..n-1]. The SIMD versions add in a different order than a
+ * left-to-right loop, so the last bits of the result may differ. */
+double asm_sum(const double* a, size_t n);
+
+/* Name of the version the dispatcher picked: "avx512", "avx2" or "generic" */
+const char* asm_kernels_isa(void);
+
+/* Individual versions, for benchmarks and tests. Only call the AVX ones
+ * after checking the CPU (e.g. __builtin_cpu_supports("avx2")). */
+void asm_swap_n_generic(int* a, int* b, size_t n);
+void* asm_memset_generic(void* dst, int value, size_t n);
+double asm_sum_generic(const double* a, size_t n);
+
+#if defined(__x86_64__)
+void asm_swap_n_avx2(int* a, int* b, size_t n);
+void* asm_memset_avx2(void* dst, int value, size_t n);
+double asm_sum_avx2(const double* a, size_t n);
+
+void asm_swap_n_avx512(int* a, int* b, size_t n);
+void* asm_memset_avx512(void* dst, int value, size_t n);
+double asm_sum_avx512(const double* a, size_t n);
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ASM_KERNELS_H */
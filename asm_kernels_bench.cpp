@@ -0,0 +1,276 @@
+// Hand-written AVX2 / AVX-512 assembly vs compiler-generated code
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include "asm_kernels.h"
+#include "bench_util.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+// For each kernel (bulk swap, memset, double sum):
+//
+//   compiler  - a plain C/C++ loop (asm_kernels.c, or std:: algorithms)
+//   libc      - memset from the C library (itself hand-written assembly!)
+//   avx2      - asm_kernels_x86_64.s, 256-bit registers
+//   avx512    - asm_kernels_x86_64.s, 512-bit registers
+//   dispatch  - the plain name, bound by the ifunc resolver at load time
+//
+// Three sizes: fits in L1, fits in L2, far bigger than the caches (DRAM).
+// Once the data comes from DRAM every version hits the same memory bandwidth
+// limit - hand-written SIMD mostly wins when the data is already in cache.
+//
+// Compile the benchmark with -O2 and again with -O3 -march=native: the
+// compiler's versions get better, the assembly stays the same.
+
+// Eight independent partial sums: no reassociation needed, so the compiler
+// is allowed to vectorize this one (unlike the strict left-to-right loop)
+double sum_unrolled(const double* a, std::size_t n) {
+    double acc[8] = {};
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        for (int k = 0; k < 8; ++k) acc[k] += a[i + k];
+    }
+    double sum = 0.0;
+    for (; i < n; ++i) sum += a[i];
+    for (double v : acc) sum += v;
+    return sum;
+}
+
+void swap_ranges_std(int* a, int* b, std::size_t n) {
+    std::swap_ranges(a, a + n, b);
+}
+
+void* memset_libc(void* dst, int value, std::size_t n) {
+    return std::memset(dst, value, n);
+}
+
+double sum_accumulate(const double* a, std::size_t n) {
+    return std::accumulate(a, a + n, 0.0);
+}
+
+template <typename Fn>
+struct Variant {
+    std::string name;
+    Fn fn;
+};
+
+using SwapFn = void (*)(int*, int*, std::size_t);
+using MemsetFn = void* (*)(void*, int, std::size_t);
+using SumFn = double (*)(const double*, std::size_t);
+
+bool has_avx2() { return __builtin_cpu_supports("avx2"); }
+bool has_avx512() { return __builtin_cpu_supports("avx512f"); }
+
+std::vector<Variant<SwapFn>> swap_variants() {
+    std::vector<Variant<SwapFn>> v{{"compiler loop", asm_swap_n_generic},
+                                   {"std::swap_ranges", swap_ranges_std}};
+    if (has_avx2()) v.push_back({"asm avx2", asm_swap_n_avx2});
+    if (has_avx512()) v.push_back({"asm avx512", asm_swap_n_avx512});
+    v.push_back({"dispatch", asm_swap_n});
+    return v;
+}
+
+std::vector<Variant<MemsetFn>> memset_variants() {
+    std::vector<Variant<MemsetFn>> v{{"compiler loop", asm_memset_generic},
+                                     {"libc memset", memset_libc}};
+    if (has_avx2()) v.push_back({"asm avx2", asm_memset_avx2});
+    if (has_avx512()) v.push_back({"asm avx512", asm_memset_avx512});
+    v.push_back({"dispatch", asm_memset});
+    return v;
+}
+
+std::vector<Variant<SumFn>> sum_variants() {
+    std::vector<Variant<SumFn>> v{{"compiler loop", asm_sum_generic},
+                                  {"std::accumulate", sum_accumulate},
+                                  {"compiler 8 acc", sum_unrolled}};
+    if (has_avx2()) v.push_back({"asm avx2", asm_sum_avx2});
+    if (has_avx512()) v.push_back({"asm avx512", asm_sum_avx512});
+    v.push_back({"dispatch", asm_sum});
+    return v;
+}
+
+// ============================================================================
+// CORRECTNESS: every size 0..300 at every misalignment 0..7 elements,
+// with guard elements around the range to catch out-of-bounds writes
+// ============================================================================
+
+int check_all() {
+    const std::size_t kGuard = 64;
+    int mismatches = 0;
+    Lcg rng{7};
+
+    for (std::size_t n = 0; n <= 300; ++n) {
+        for (std::size_t offset = 0; offset < 8; ++offset) {
+            // swap
+            std::vector<int> a0(n + 2 * kGuard), b0(n + 2 * kGuard);
+            for (auto& x : a0) x = static_cast<int>(rng.next());
+            for (auto& x : b0) x = static_cast<int>(rng.next());
+            for (auto& v : swap_variants()) {
+                std::vector<int> a = a0, b = b0;
+                v.fn(a.data() + offset, b.data() + offset, n);
+                bool ok = true;
+                for (std::size_t i = 0; i < a.size(); ++i) {
+                    bool inside = i >= offset && i < offset + n;
+                    ok &= a[i] == (inside ? b0[i] : a0[i]) && b[i] == (inside ? a0[i] : b0[i]);
+                }
+                if (!ok && mismatches++ < 10)
+                    std::cout << "  FAIL swap " << v.name << " n=" << n << " offset=" << offset << std::endl;
+            }
+
+            // memset (offset in bytes)
+            for (auto& v : memset_variants()) {
+                std::vector<unsigned char> buf(n + 2 * kGuard, 0xAA);
+                void* ret = v.fn(buf.data() + offset, 0x5C, n);
+                bool ok = ret == buf.data() + offset;
+                for (std::size_t i = 0; i < buf.size(); ++i) {
+                    bool inside = i >= offset && i < offset + n;
+                    ok &= buf[i] == (inside ? 0x5C : 0xAA);
+                }
+                if (!ok && mismatches++ < 10)
+                    std::cout << "  FAIL memset " << v.name << " n=" << n << " offset=" << offset << std::endl;
+            }
+
+            // sum: small integers are exact in any order, so all versions must agree exactly
+            std::vector<double> d(n + 2 * kGuard);
+            for (auto& x : d) x = double(int(rng.next() % 2001) - 1000);
+            double expected = asm_sum_generic(d.data() + offset, n);
+            for (auto& v : sum_variants()) {
+                double got = v.fn(d.data() + offset, n);
+                if (got != expected && mismatches++ < 10)
+                    std::cout << "  FAIL sum " << v.name << " n=" << n << " offset=" << offset
+                              << " got " << got << " expected " << expected << std::endl;
+            }
+        }
+    }
+
+    // Large memset: exercises the non-temporal path
+    {
+        const std::size_t n = (std::size_t(8) << 20) + 13;
+        for (auto& v : memset_variants()) {
+            std::vector<unsigned char> buf(n + 2, 0xAA);
+            v.fn(buf.data() + 1, 0x33, n);
+            bool ok = buf.front() == 0xAA && buf.back() == 0xAA &&
+                      std::all_of(buf.begin() + 1, buf.end() - 1, [](unsigned char c) { return c == 0x33; });
+            if (!ok && mismatches++ < 10) std::cout << "  FAIL large memset " << v.name << std::endl;
+        }
+    }
+    return mismatches;
+}
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+
+// Repeat the kernel until about `target_bytes` have been processed, report GB/s
+template <typename Body>
+double gb_per_s(std::size_t bytes_per_call, Body&& body) {
+    const double target_bytes = 2e9;
+    int reps = std::max(1, static_cast<int>(target_bytes / double(bytes_per_call)));
+    body();  // warm up: page faults, caches, frequency
+    double ms = time_ms([&] {
+        for (int r = 0; r < reps; ++r) body();
+    });
+    return double(bytes_per_call) * reps / (ms * 1e6);
+}
+
+void print_row(const std::string& name, double gbs) {
+    std::string padded = name;
+    padded.resize(18, ' ');
+    std::cout << "    " << padded << gbs << " GB/s" << std::endl;
+}
+
+void bench_size(const char* label, std::size_t bytes) {
+    std::cout << std::endl << "--- " << label << ": " << bytes / 1024 << " KiB per array ---" << std::endl;
+
+    const std::size_t ints = bytes / sizeof(int);
+    std::vector<int> a(ints, 1), b(ints, 2);
+    std::cout << "  swap (" << ints << " ints, bytes read+written counted once per array):" << std::endl;
+    for (auto& v : swap_variants()) {
+        print_row(v.name, gb_per_s(2 * bytes, [&] {
+            v.fn(a.data(), b.data(), ints);
+            do_not_optimize(a[0]);
+        }));
+    }
+
+    std::vector<unsigned char> buf(bytes);
+    std::cout << "  memset (" << bytes << " bytes):" << std::endl;
+    for (auto& v : memset_variants()) {
+        int value = 0;
+        print_row(v.name, gb_per_s(bytes, [&] {
+            v.fn(buf.data(), ++value, bytes);
+            do_not_optimize(buf[0]);
+        }));
+    }
+
+    const std::size_t doubles = bytes / sizeof(double);
+    std::vector<double> d(doubles);
+    Lcg rng{42};
+    for (auto& x : d) x = rng.next() / 4294967296.0;
+    std::cout << "  sum (" << doubles << " doubles):" << std::endl;
+    for (auto& v : sum_variants()) {
+        double result = 0;
+        double gbs = gb_per_s(bytes, [&] {
+            result = v.fn(d.data(), doubles);
+            do_not_optimize(result);
+        });
+        print_row(v.name, gbs);
+    }
+}
+
+void show_rounding() {
+    std::cout << std::endl << "=== Summation order ===" << std::endl;
+    const std::size_t n = 1000003;
+    std::vector<double> d(n);
+    Lcg rng{1};
+    for (auto& x : d) x = 1.0 / double(1 + rng.next() % 1000);  // not exactly representable
+
+    std::cout.precision(17);
+    for (auto& v : sum_variants()) {
+        std::string padded = v.name;
+        padded.resize(18, ' ');
+        std::cout << "  " << padded << v.fn(d.data(), n) << std::endl;
+    }
+    std::cout.precision(6);
+    std::cout << "Different addition order -> last digits differ. None is \"wrong\";" << std::endl;
+    std::cout << "the compiler keeps strict order unless told otherwise (-ffast-math)." << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Hand-written SIMD Assembly vs Compiler Code ===" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "CPU: avx2=" << (has_avx2() ? "yes" : "no")
+              << "  avx512f=" << (has_avx512() ? "yes" : "no") << std::endl;
+    std::cout << "ifunc resolver picked: " << asm_kernels_isa() << std::endl;
+
+    std::cout << std::endl << "=== Correctness (sizes 0..300, 8 alignments, guard zones) ===" << std::endl;
+    int mismatches = check_all();
+    std::cout << (mismatches == 0 ? "All versions agree." : "MISMATCHES FOUND!") << std::endl;
+    if (mismatches) return 1;
+
+    std::cout << std::endl << "=== Throughput ===" << std::endl;
+    bench_size("L1", 16 * 1024);
+    bench_size("L2", 256 * 1024);
+    std::size_t big = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : std::size_t(64) << 20;
+    bench_size("DRAM", big);
+
+    show_rounding();
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• ifunc: CPUID is checked once at load time, then every call is direct" << std::endl;
+    std::cout << "• In cache, wide registers + several accumulators beat a scalar loop" << std::endl;
+    std::cout << "• From DRAM everyone waits for memory: the SIMD advantage shrinks" << std::endl;
+    std::cout << "• libc memset is already hand-tuned assembly - hard to beat" << std::endl;
+    std::cout << "• Independent chains (8 acc) help the compiler too - try -O3 -march=native" << std::endl;
+    std::cout << "• AVX-512 masks handle loop tails without a scalar loop" << std::endl;
+
+    return 0;
+}
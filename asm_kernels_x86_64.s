@@ -0,0 +1,330 @@
+# Hand-written AVX2 and AVX-512 bulk kernels for x86-64 Linux (System V ABI)
+# GNU assembler, AT&T syntax. Declared in asm_kernels.h, dispatched in asm_kernels.c
+#
+# Register reminders:
+#   arguments: rdi, rsi, rdx (integers/pointers), xmm0 (double return)
+#   scratch (caller-saved, free to clobber): rax, rcx, rdx, rsi, rdi, r8-r11,
+#                                            all xmm/ymm/zmm, k1-k7
+#   ymm = 256 bits = 8 ints / 4 doubles,  zmm = 512 bits = 16 ints / 8 doubles
+#
+# Every function that touched ymm/zmm ends with vzeroupper: leaving the upper
+# halves dirty makes later SSE code (e.g. in libc) pay a transition penalty.
+
+.text
+
+# ============================================================================
+# void asm_swap_n_avx2(int* a, int* b, size_t n)      rdi = a, rsi = b, rdx = n
+# ============================================================================
+.global asm_swap_n_avx2
+.type asm_swap_n_avx2, @function
+.p2align 4
+asm_swap_n_avx2:
+    xor     %ecx, %ecx                  # i = 0
+    mov     %rdx, %r8
+    and     $-8, %r8                    # r8 = n rounded down to a multiple of 8
+    jz      2f
+1:                                      # 8 ints per iteration
+    vmovdqu (%rdi,%rcx,4), %ymm0        # ymm0 = a[i..i+7]
+    vmovdqu (%rsi,%rcx,4), %ymm1        # ymm1 = b[i..i+7]
+    vmovdqu %ymm1, (%rdi,%rcx,4)
+    vmovdqu %ymm0, (%rsi,%rcx,4)
+    add     $8, %rcx
+    cmp     %r8, %rcx
+    jb      1b
+2:                                      # 0..7 left: one int at a time
+    cmp     %rdx, %rcx
+    jae     3f
+    mov     (%rdi,%rcx,4), %eax
+    mov     (%rsi,%rcx,4), %r9d
+    mov     %r9d, (%rdi,%rcx,4)
+    mov     %eax, (%rsi,%rcx,4)
+    inc     %rcx
+    jmp     2b
+3:
+    vzeroupper
+    ret
+.size asm_swap_n_avx2, .-asm_swap_n_avx2
+
+# ============================================================================
+# void asm_swap_n_avx512(int* a, int* b, size_t n)    rdi = a, rsi = b, rdx = n
+# ============================================================================
+# The tail uses a MASK register instead of a scalar loop: k1 has one bit per
+# int lane, masked loads read only the enabled lanes and masked stores write
+# only those - lanes past the end are never touched, and never fault.
+.global asm_swap_n_avx512
+.type asm_swap_n_avx512, @function
+.p2align 4
+asm_swap_n_avx512:
+    xor     %eax, %eax                  # i = 0
+    mov     %rdx, %r8
+    and     $-16, %r8                   # r8 = n rounded down to a multiple of 16
+    jz      2f
+1:                                      # 16 ints per iteration
+    vmovdqu32 (%rdi,%rax,4), %zmm0
+    vmovdqu32 (%rsi,%rax,4), %zmm1
+    vmovdqu32 %zmm1, (%rdi,%rax,4)
+    vmovdqu32 %zmm0, (%rsi,%rax,4)
+    add     $16, %rax
+    cmp     %r8, %rax
+    jb      1b
+2:
+    mov     %edx, %ecx
+    sub     %eax, %ecx                  # ecx = n - i = 0..15 lanes left
+    jz      3f
+    mov     $1, %r9d
+    shl     %cl, %r9d
+    dec     %r9d                        # r9d = (1 << left) - 1
+    kmovw   %r9d, %k1
+    vmovdqu32 (%rdi,%rax,4), %zmm0{%k1}{z}
+    vmovdqu32 (%rsi,%rax,4), %zmm1{%k1}{z}
+    vmovdqu32 %zmm1, (%rdi,%rax,4){%k1}
+    vmovdqu32 %zmm0, (%rsi,%rax,4){%k1}
+3:
+    vzeroupper
+    ret
+.size asm_swap_n_avx512, .-asm_swap_n_avx512
+
+# ============================================================================
+# void* asm_memset_avx2(void* dst, int value, size_t n)   rdi = dst, esi = value, rdx = n
+# ============================================================================
+# Large fills: one unaligned store at the head, one at the tail (they may
+# overlap the middle - writing a byte twice is harmless for memset), and
+# ALIGNED stores in between, so no store ever splits a cache line.
+#
+#   dst                                                       dst+n
+#   [head 32 ][ aligned 32 | aligned 32 | ... | aligned 32 ][tail 32]
+#         └ overlap ┘                                 └ overlap ┘
+#
+# Fills bigger than NT_THRESHOLD use non-temporal stores: they bypass the
+# cache, so a huge fill doesn't evict everything else.
+.set NT_THRESHOLD, 4194304              # 4 MiB
+
+.global asm_memset_avx2
+.type asm_memset_avx2, @function
+.p2align 4
+asm_memset_avx2:
+    mov     %rdi, %rax                  # memset returns dst
+    vmovd   %esi, %xmm0
+    vpbroadcastb %xmm0, %ymm0           # 32 copies of the byte
+    cmp     $32, %rdx
+    jb      .Lset_small
+    vmovdqu %ymm0, (%rdi)               # head
+    vmovdqu %ymm0, -32(%rdi,%rdx)       # tail
+    lea     32(%rdi), %rcx
+    and     $-32, %rcx                  # rcx = first 32-aligned address after the head
+    lea     -32(%rdi,%rdx), %r8         # r8 = tail start; aligned stores stop before it
+    cmp     $NT_THRESHOLD, %rdx
+    jae     .Lset_nt
+    lea     -128(%r8), %r9
+.Lset_loop4:                            # 128 bytes per iteration
+    cmp     %r9, %rcx
+    jae     .Lset_loop1
+    vmovdqa %ymm0, (%rcx)
+    vmovdqa %ymm0, 32(%rcx)
+    vmovdqa %ymm0, 64(%rcx)
+    vmovdqa %ymm0, 96(%rcx)
+    sub     $-128, %rcx                 # (sub -128 has a shorter encoding than add 128)
+    jmp     .Lset_loop4
+.Lset_loop1:
+    cmp     %r8, %rcx
+    jae     .Lset_done
+    vmovdqa %ymm0, (%rcx)
+    add     $32, %rcx
+    jmp     .Lset_loop1
+.Lset_nt:
+    cmp     %r8, %rcx
+    jae     .Lset_nt_done
+    vmovntdq %ymm0, (%rcx)
+    add     $32, %rcx
+    jmp     .Lset_nt
+.Lset_nt_done:
+    sfence                              # order the weakly-ordered NT stores before returning
+.Lset_done:
+    vzeroupper
+    ret
+
+.Lset_small:                            # n < 32: two overlapping stores of the largest fitting size
+    cmp     $16, %rdx
+    jb      1f
+    vmovdqu %xmm0, (%rdi)
+    vmovdqu %xmm0, -16(%rdi,%rdx)
+    jmp     .Lset_done
+1:
+    vmovq   %xmm0, %rcx                 # 8 copies of the byte in a GPR
+    cmp     $8, %rdx
+    jb      2f
+    mov     %rcx, (%rdi)
+    mov     %rcx, -8(%rdi,%rdx)
+    jmp     .Lset_done
+2:
+    cmp     $4, %rdx
+    jb      3f
+    mov     %ecx, (%rdi)
+    mov     %ecx, -4(%rdi,%rdx)
+    jmp     .Lset_done
+3:                                      # 0..3 bytes
+    test    %rdx, %rdx
+    jz      .Lset_done
+    mov     %cl, (%rdi)
+    mov     %cl, -1(%rdi,%rdx)
+    cmp     $3, %rdx
+    jb      .Lset_done
+    mov     %cl, 1(%rdi)
+    jmp     .Lset_done
+.size asm_memset_avx2, .-asm_memset_avx2
+
+# ============================================================================
+# void* asm_memset_avx512(void* dst, int value, size_t n)   rdi = dst, esi = value, rdx = n
+# ============================================================================
+# Same shape as the AVX2 version with 64-byte stores (one per cache line).
+# Fills under 256 bytes go to the AVX2 version: a few ymm stores are just as
+# fast there, and on some Intel CPUs zmm code lowers the clock for a while.
+.global asm_memset_avx512
+.type asm_memset_avx512, @function
+.p2align 4
+asm_memset_avx512:
+    cmp     $256, %rdx
+    jb      asm_memset_avx2             # tail call: same arguments, same return
+    mov     %rdi, %rax
+    movzbl  %sil, %ecx
+    imul    $0x01010101, %ecx, %ecx     # byte -> 4 copies in a 32-bit register
+    vpbroadcastd %ecx, %zmm0            # -> 64 copies
+    vmovdqu64 %zmm0, (%rdi)             # head
+    vmovdqu64 %zmm0, -64(%rdi,%rdx)     # tail
+    lea     64(%rdi), %rcx
+    and     $-64, %rcx
+    lea     -64(%rdi,%rdx), %r8
+    cmp     $NT_THRESHOLD, %rdx
+    jae     .Lset512_nt
+.Lset512_loop:
+    cmp     %r8, %rcx
+    jae     .Lset512_done
+    vmovdqa64 %zmm0, (%rcx)
+    add     $64, %rcx
+    jmp     .Lset512_loop
+.Lset512_nt:
+    cmp     %r8, %rcx
+    jae     .Lset512_nt_done
+    vmovntdq %zmm0, (%rcx)
+    add     $64, %rcx
+    jmp     .Lset512_nt
+.Lset512_nt_done:
+    sfence
+.Lset512_done:
+    vzeroupper
+    ret
+.size asm_memset_avx512, .-asm_memset_avx512
+
+# ============================================================================
+# double asm_sum_avx2(const double* a, size_t n)       rdi = a, rsi = n -> xmm0
+# ============================================================================
+# FOUR independent accumulators: vaddpd has ~4 cycles latency but the CPU can
+# start one or two per cycle. With a single accumulator every add waits for
+# the previous one; with four, four dependency chains run in parallel.
+#
+#   ymm0 += a[i+0..3]   ymm1 += a[i+4..7]   ymm2 += a[i+8..11]   ymm3 += a[i+12..15]
+.global asm_sum_avx2
+.type asm_sum_avx2, @function
+.p2align 4
+asm_sum_avx2:
+    vxorpd  %ymm0, %ymm0, %ymm0
+    vxorpd  %ymm1, %ymm1, %ymm1
+    vxorpd  %ymm2, %ymm2, %ymm2
+    vxorpd  %ymm3, %ymm3, %ymm3
+    xor     %eax, %eax                  # i = 0
+    mov     %rsi, %rcx
+    and     $-16, %rcx                  # 16 doubles per iteration
+    jz      2f
+1:
+    vaddpd  (%rdi,%rax,8), %ymm0, %ymm0
+    vaddpd  32(%rdi,%rax,8), %ymm1, %ymm1
+    vaddpd  64(%rdi,%rax,8), %ymm2, %ymm2
+    vaddpd  96(%rdi,%rax,8), %ymm3, %ymm3
+    add     $16, %rax
+    cmp     %rcx, %rax
+    jb      1b
+2:
+    vaddpd  %ymm1, %ymm0, %ymm0         # combine the accumulators
+    vaddpd  %ymm3, %ymm2, %ymm2
+    vaddpd  %ymm2, %ymm0, %ymm0
+    mov     %rsi, %rcx
+    and     $-4, %rcx
+3:                                      # 4 doubles at a time
+    cmp     %rcx, %rax
+    jae     4f
+    vaddpd  (%rdi,%rax,8), %ymm0, %ymm0
+    add     $4, %rax
+    jmp     3b
+4:                                      # horizontal sum: 4 lanes -> 1
+    vextractf128 $1, %ymm0, %xmm1
+    vaddpd  %xmm1, %xmm0, %xmm0
+    vunpckhpd %xmm0, %xmm0, %xmm1
+    vaddsd  %xmm1, %xmm0, %xmm0
+5:                                      # 0..3 left
+    cmp     %rsi, %rax
+    jae     6f
+    vaddsd  (%rdi,%rax,8), %xmm0, %xmm0
+    inc     %rax
+    jmp     5b
+6:
+    vzeroupper
+    ret
+.size asm_sum_avx2, .-asm_sum_avx2
+
+# ============================================================================
+# double asm_sum_avx512(const double* a, size_t n)     rdi = a, rsi = n -> xmm0
+# ============================================================================
+.global asm_sum_avx512
+.type asm_sum_avx512, @function
+.p2align 4
+asm_sum_avx512:
+    vxorpd  %xmm0, %xmm0, %xmm0         # VEX xor zeroes the whole zmm
+    vxorpd  %xmm1, %xmm1, %xmm1
+    vxorpd  %xmm2, %xmm2, %xmm2
+    vxorpd  %xmm3, %xmm3, %xmm3
+    xor     %eax, %eax
+    mov     %rsi, %rcx
+    and     $-32, %rcx                  # 32 doubles per iteration
+    jz      2f
+1:
+    vaddpd  (%rdi,%rax,8), %zmm0, %zmm0
+    vaddpd  64(%rdi,%rax,8), %zmm1, %zmm1
+    vaddpd  128(%rdi,%rax,8), %zmm2, %zmm2
+    vaddpd  192(%rdi,%rax,8), %zmm3, %zmm3
+    add     $32, %rax
+    cmp     %rcx, %rax
+    jb      1b
+2:
+    vaddpd  %zmm1, %zmm0, %zmm0
+    vaddpd  %zmm3, %zmm2, %zmm2
+    vaddpd  %zmm2, %zmm0, %zmm0
+    mov     %rsi, %rcx
+    and     $-8, %rcx
+3:                                      # 8 doubles at a time
+    cmp     %rcx, %rax
+    jae     4f
+    vaddpd  (%rdi,%rax,8), %zmm0, %zmm0
+    add     $8, %rax
+    jmp     3b
+4:                                      # 0..7 left: one masked load
+    mov     %esi, %ecx
+    sub     %eax, %ecx
+    jz      5f
+    mov     $1, %edx
+    shl     %cl, %edx
+    dec     %edx
+    kmovw   %edx, %k1
+    vmovupd (%rdi,%rax,8), %zmm1{%k1}{z}    # masked-off lanes read as 0.0
+    vaddpd  %zmm1, %zmm0, %zmm0
+5:                                      # horizontal sum: 8 lanes -> 1
+    vextractf64x4 $1, %zmm0, %ymm1
+    vaddpd  %ymm1, %ymm0, %ymm0
+    vextractf128 $1, %ymm0, %xmm1
+    vaddpd  %xmm1, %xmm0, %xmm0
+    vunpckhpd %xmm0, %xmm0, %xmm1
+    vaddsd  %xmm1, %xmm0, %xmm0
+    vzeroupper
+    ret
+.size asm_sum_avx512, .-asm_sum_avx512
+
+.section .note.GNU-stack,"",@progbits
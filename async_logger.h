@@ -0,0 +1,459 @@
+// async_logger.h - asynchronous logger: per-thread lock-free rings, one formatter thread
+//
+// Logging through a shared std::cout serializes every thread on one lock and
+// one write() per line. AsyncLogger moves all of that off the hot path:
+//
+//   thread 1 ──► [ring 1: binary records] ──┐
+//   thread 2 ──► [ring 2: binary records] ──┼──► backend thread: decode,
+//   thread 3 ──► [ring 3: binary records] ──┘    format, OutputSink, write()
+//
+// A log call does NOT format anything. It writes a binary record into the
+// calling thread's own ring:
+//
+//   ┌──────┬───────┬─────────┬───────┬──────────────────────────────┐
+//   │ size │ level │ decoder │ ticks │ arguments, raw bytes          │
+//   └──────┴───────┴─────────┴───────┴──────────────────────────────┘
+//
+// `decoder` is a pointer to a function template instantiated for this call
+// site's format string and argument types - it plays the role of a "format
+// id": the backend calls it to turn the raw bytes back into text. The format
+// string itself never travels; it is a compile-time constant (SINK_FMT from
+// output_sink.h), and its {} count is checked against the arguments at
+// compile time.
+//
+// Each ring has exactly one producer (its thread) and one consumer (the
+// backend), so it needs no CAS: the producer publishes with a release store
+// of `head`, the backend frees space with a release store of `tail`. Both
+// counters sit on their own cache lines.
+//
+// When a ring is full:
+//   FullPolicy::Drop   the record is discarded and counted; the backend
+//                      reports "N messages dropped". The log call never waits.
+//   FullPolicy::Block  backpressure: the thread yields until the backend has
+//                      made room. Nothing is lost; a slow sink slows the app.
+//
+// Arguments: integers, floating point (stored as double), pointers (printed
+// as addresses) and strings (const char*, std::string, std::string_view -
+// the characters are COPIED, so the caller's buffer may change right after
+// the call).
+//
+// Rules:
+//   - Records from one thread come out in order. Records from different
+//     threads are interleaved by drain order, not sorted by time.
+//   - A ring is created the first time a thread logs and lives as long as the
+//     logger: the logger must outlive every thread that uses it.
+//   - A record must fit in half a ring.
+
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#include "output_sink.h"
+
+enum class LogLevel : std::uint16_t { Debug, Info, Warn, Error };
+enum class FullPolicy { Drop, Block };
+
+// Hot-path timestamp: the TSC costs a few ns, steady_clock (vDSO) ~20 ns
+inline std::uint64_t log_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::uint64_t(std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// ----------------------------------------------------------------------------
+// Argument encoding: what a log argument is stored as in the ring
+// ----------------------------------------------------------------------------
+
+struct LogString {};  // marker: stored as uint32 length + characters
+
+template <typename T, typename = void>
+struct LogStored {
+    using type = void;  // unsupported: rejected by a static_assert in log()
+};
+template <typename T>
+struct LogStored<T, std::enable_if_t<std::is_integral_v<T>>> {
+    using type = T;
+};
+template <typename T>
+struct LogStored<T, std::enable_if_t<std::is_floating_point_v<T>>> {
+    using type = double;
+};
+template <typename T>
+struct LogStored<T*, std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>> {
+    using type = const void*;
+};
+template <>
+struct LogStored<const char*> {
+    using type = LogString;
+};
+template <>
+struct LogStored<char*> {
+    using type = LogString;
+};
+template <>
+struct LogStored<std::string> {
+    using type = LogString;
+};
+template <>
+struct LogStored<std::string_view> {
+    using type = LogString;
+};
+
+template <typename T>
+using log_stored_t = typename LogStored<std::decay_t<T>>::type;
+
+inline std::string_view log_as_view(const char* s) { return s ? std::string_view(s) : std::string_view("(null)"); }
+inline std::string_view log_as_view(std::string_view s) { return s; }
+
+template <typename T>
+std::size_t log_encoded_size(const T& arg) {
+    if constexpr (std::is_same_v<log_stored_t<T>, LogString>) return sizeof(std::uint32_t) + log_as_view(arg).size();
+    else return sizeof(log_stored_t<T>);
+}
+
+template <typename T>
+char* log_encode(char* p, const T& arg) {
+    using Stored = log_stored_t<T>;
+    if constexpr (std::is_same_v<Stored, LogString>) {
+        std::string_view s = log_as_view(arg);
+        std::uint32_t n = std::uint32_t(s.size());
+        std::memcpy(p, &n, sizeof(n));
+        std::memcpy(p + sizeof(n), s.data(), n);
+        return p + sizeof(n) + n;
+    } else {
+        Stored v = Stored(arg);
+        std::memcpy(p, &v, sizeof(v));
+        return p + sizeof(v);
+    }
+}
+
+template <typename Stored>
+auto log_decode(const char*& p) {
+    if constexpr (std::is_same_v<Stored, LogString>) {
+        std::uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        std::string_view s(p + sizeof(n), n);
+        p += sizeof(n) + n;
+        return s;
+    } else {
+        Stored v;
+        std::memcpy(&v, p, sizeof(v));
+        p += sizeof(v);
+        return v;
+    }
+}
+
+// ----------------------------------------------------------------------------
+// Records and the per-thread ring
+// ----------------------------------------------------------------------------
+
+using LogDecodeFn = void (*)(OutputSink& out, const char* args);
+
+struct LogRecordHeader {
+    std::uint32_t size;     // whole record, multiple of 8
+    std::uint16_t level;
+    std::uint16_t padding;  // 1: filler up to the end of the ring, skip it
+    LogDecodeFn decode;
+    std::uint64_t ticks;
+};
+
+class LogRing {
+public:
+    LogRing(std::size_t capacity, std::uint32_t thread_index)
+        : buf_(static_cast<char*>(std::aligned_alloc(64, capacity))), cap_(capacity), thread_index_(thread_index) {
+        std::memset(buf_, 0, cap_);  // touch every page now: no page faults on the hot path
+    }
+    ~LogRing() { std::free(buf_); }
+
+    // Producer: room for `bytes` contiguous bytes, or nullptr if the ring is full
+    char* begin_write(std::size_t bytes) {
+        std::uint64_t h = head_.load(std::memory_order_relaxed);
+        std::size_t off = std::size_t(h) & (cap_ - 1);
+        std::size_t contiguous = cap_ - off;
+        std::size_t need = contiguous < bytes ? contiguous + bytes : bytes;  // wrap: skip the tail end
+        if (h + need - cached_tail_ > cap_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);  // refresh only when it looks full
+            if (h + need - cached_tail_ > cap_) return nullptr;
+        }
+        if (contiguous < bytes) {
+            LogRecordHeader filler{};
+            filler.size = std::uint32_t(contiguous);
+            filler.padding = 1;
+            std::memcpy(buf_ + off, &filler, 8);  // size + level + padding: 8 bytes always fit
+            h += contiguous;
+            off = 0;
+        }
+        pending_ = h;
+        return buf_ + off;
+    }
+
+    // Producer: publish the record written at begin_write()
+    void commit(std::size_t bytes) { head_.store(pending_ + bytes, std::memory_order_release); }
+
+    void count_drop() { dropped_.fetch_add(1, std::memory_order_relaxed); }
+
+    // Consumer: call f(header, args) for every published record, then free them
+    template <typename F>
+    std::size_t drain(F&& f) {
+        std::uint64_t t = tail_.load(std::memory_order_relaxed);
+        const std::uint64_t h = head_.load(std::memory_order_acquire);
+        std::size_t records = 0;
+        while (t < h) {
+            const char* rec = buf_ + (std::size_t(t) & (cap_ - 1));
+            LogRecordHeader hdr;
+            std::memcpy(&hdr, rec, 8);
+            if (!hdr.padding) {
+                std::memcpy(&hdr, rec, sizeof(hdr));
+                f(hdr, rec + sizeof(hdr));
+                ++records;
+            }
+            t += hdr.size;
+        }
+        tail_.store(t, std::memory_order_release);
+        return records;
+    }
+
+    std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    std::uint32_t thread_index() const { return thread_index_; }
+    std::size_t capacity() const { return cap_; }
+
+private:
+    alignas(64) std::atomic<std::uint64_t> head_{0};  // producer: bytes published
+    std::uint64_t cached_tail_ = 0;                   // producer's last view of tail_
+    std::uint64_t pending_ = 0;
+    alignas(64) std::atomic<std::uint64_t> tail_{0};  // consumer: bytes freed
+    alignas(64) std::atomic<std::uint64_t> dropped_{0};
+    char* buf_;
+    std::size_t cap_;
+    std::uint32_t thread_index_;
+};
+
+// ----------------------------------------------------------------------------
+// The logger
+// ----------------------------------------------------------------------------
+
+struct LoggerOptions {
+    int fd = STDOUT_FILENO;
+    std::size_t ring_bytes = 1 << 20;  // per thread, rounded up to a power of two
+    FullPolicy policy = FullPolicy::Drop;
+    LogLevel min_level = LogLevel::Debug;
+    std::chrono::microseconds idle_sleep{200};  // backend poll interval when all rings are empty
+};
+
+class AsyncLogger {
+public:
+    explicit AsyncLogger(LoggerOptions options = {})
+        : opts_(options), id_(next_id().fetch_add(1) + 1), out_(options.fd, FlushPolicy::WhenFull) {
+        std::size_t cap = 256;
+        while (cap < opts_.ring_bytes) cap <<= 1;
+        opts_.ring_bytes = cap;
+        calibrate();
+        backend_ = std::thread([this] { run(); });
+    }
+
+    ~AsyncLogger() { stop(); }
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    // Drain everything still in the rings, flush, and end the backend thread
+    void stop() {
+        if (running_.exchange(false)) backend_.join();
+    }
+
+    void set_min_level(LogLevel level) { min_level_.store(level, std::memory_order_relaxed); }
+
+    // The hot path. Use through the LOG_* macros so the format is a SINK_FMT.
+    template <typename Format, typename... Args>
+    void log(LogLevel level, Format, const Args&... args) {
+        constexpr int holes = count_placeholders(Format::text());
+        static_assert(holes >= 0, "format string: unmatched '{' or '}'");
+        static_assert(holes == int(sizeof...(Args)), "format string: number of {} != number of arguments");
+        static_assert((!std::is_void_v<log_stored_t<Args>> && ...), "unsupported log argument type");
+
+        if (level < min_level_.load(std::memory_order_relaxed)) return;
+
+        std::size_t bytes = (sizeof(LogRecordHeader) + (std::size_t(0) + ... + log_encoded_size(args)) + 7) & ~std::size_t(7);
+        LogRing* ring = ring_for_this_thread();
+        if (bytes > ring->capacity() / 2) {
+            ring->count_drop();
+            return;
+        }
+
+        char* p = ring->begin_write(bytes);
+        while (!p) {
+            if (opts_.policy == FullPolicy::Drop) {
+                ring->count_drop();
+                return;
+            }
+            std::this_thread::yield();  // backpressure: wait for the backend
+            p = ring->begin_write(bytes);
+        }
+
+        LogRecordHeader hdr;
+        hdr.size = std::uint32_t(bytes);
+        hdr.level = std::uint16_t(level);
+        hdr.padding = 0;
+        hdr.decode = &decode<Format, log_stored_t<Args>...>;
+        hdr.ticks = log_ticks();
+        std::memcpy(p, &hdr, sizeof(hdr));
+        char* a = p + sizeof(hdr);
+        ((a = log_encode(a, args)), ...);
+        static_cast<void>(a);
+        ring->commit(bytes);
+    }
+
+    std::uint64_t dropped() const {
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        std::uint64_t total = 0;
+        for (const auto& r : rings_) total += r->dropped();
+        return total;
+    }
+
+    std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+
+    // Threads that have logged through this logger (one ring each)
+    std::size_t rings() const { return ring_count_.load(std::memory_order_acquire); }
+
+private:
+    LoggerOptions opts_;
+    std::uint64_t id_;
+    std::atomic<LogLevel> min_level_{opts_.min_level};
+    OutputSink out_;  // backend thread only
+
+    mutable std::mutex rings_mutex_;  // taken when a thread registers, and by the backend's snapshot
+    std::vector<std::unique_ptr<LogRing>> rings_;
+    std::vector<std::thread::id> ring_owners_;  // rings_[i] belongs to ring_owners_[i]
+    std::atomic<std::size_t> ring_count_{0};
+
+    std::atomic<bool> running_{true};
+    std::atomic<std::uint64_t> written_{0};
+    std::uint64_t start_ticks_ = 0;
+    double ns_per_tick_ = 1.0;
+    std::thread backend_;
+
+    static std::atomic<std::uint64_t>& next_id() {
+        static std::atomic<std::uint64_t> id{0};
+        return id;
+    }
+
+    // One ring per (thread, logger). The thread_local cache remembers the
+    // last logger this thread used, so a thread that sticks to one logger pays
+    // one compare. The cache is shared by all loggers: a thread alternating
+    // between two misses on every switch, and must find its existing ring
+    // under the mutex rather than register a new one each time. Logger ids are
+    // never reused, so a stale cache entry can't match a new logger.
+    LogRing* ring_for_this_thread() {
+        thread_local std::uint64_t cached_id = 0;
+        thread_local LogRing* cached_ring = nullptr;
+        if (cached_id == id_) return cached_ring;
+
+        std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(rings_mutex_);
+        std::size_t i = 0;
+        while (i < ring_owners_.size() && ring_owners_[i] != self) ++i;
+        // A thread that has exited may pass its id on to a new thread, which
+        // then inherits the ring: still one producer at a time.
+        if (i == rings_.size()) {  // first call from this thread
+            rings_.push_back(std::make_unique<LogRing>(opts_.ring_bytes, std::uint32_t(rings_.size() + 1)));
+            ring_owners_.push_back(self);
+            ring_count_.store(rings_.size(), std::memory_order_release);
+        }
+        cached_id = id_;
+        cached_ring = rings_[i].get();
+        return cached_ring;
+    }
+
+    template <typename Format, typename... Stored>
+    static void decode(OutputSink& out, const char* p) {
+        // Braced init: arguments are decoded left to right
+        std::tuple<decltype(log_decode<Stored>(p))...> values{log_decode<Stored>(p)...};
+        std::apply([&](const auto&... v) { out.print(Format{}, v...); }, values);
+    }
+
+    // Ticks -> nanoseconds, measured against steady_clock over a few ms
+    void calibrate() {
+#if defined(__x86_64__) || defined(__i386__)
+        auto t0 = std::chrono::steady_clock::now();
+        std::uint64_t c0 = log_ticks();
+        while (std::chrono::steady_clock::now() - t0 < std::chrono::milliseconds(5)) {
+        }
+        std::uint64_t c1 = log_ticks();
+        double ns = double(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t0).count());
+        ns_per_tick_ = ns / double(c1 - c0);
+#endif
+        start_ticks_ = log_ticks();
+    }
+
+    std::size_t drain_all(std::vector<LogRing*>& snapshot, std::vector<std::uint64_t>& reported_drops) {
+        std::size_t n = ring_count_.load(std::memory_order_acquire);
+        if (snapshot.size() != n) {  // a thread registered since the last pass
+            std::lock_guard<std::mutex> lock(rings_mutex_);
+            snapshot.clear();
+            for (const auto& r : rings_) snapshot.push_back(r.get());
+            reported_drops.resize(snapshot.size(), 0);
+        }
+
+        static const char* const kLevelNames[] = {"DEBUG", "INFO ", "WARN ", "ERROR"};
+        std::size_t records = 0;
+        for (std::size_t i = 0; i < snapshot.size(); ++i) {
+            LogRing* ring = snapshot[i];
+            records += ring->drain([&](const LogRecordHeader& hdr, const char* args) {
+                std::uint64_t us = std::uint64_t(double(hdr.ticks - start_ticks_) * ns_per_tick_ / 1000.0);
+                out_ << '[' << us << " us] [T" << ring->thread_index() << "] " << kLevelNames[hdr.level & 3] << ' ';
+                hdr.decode(out_, args);
+                out_ << '\n';
+            });
+            std::uint64_t dropped = ring->dropped();
+            if (dropped != reported_drops[i]) {
+                out_ << "[T" << ring->thread_index() << "] " << dropped - reported_drops[i]
+                     << " messages dropped (ring full)\n";
+                reported_drops[i] = dropped;
+            }
+        }
+        written_.fetch_add(records, std::memory_order_relaxed);
+        return records;
+    }
+
+    void run() {
+        std::vector<LogRing*> snapshot;
+        std::vector<std::uint64_t> reported_drops;
+        while (running_.load(std::memory_order_acquire)) {
+            if (drain_all(snapshot, reported_drops) == 0) {
+                out_.flush();  // idle: push out what we have, then nap
+                std::this_thread::sleep_for(opts_.idle_sleep);
+            }
+        }
+        drain_all(snapshot, reported_drops);  // records logged before stop()
+        out_.flush();
+    }
+};
+
+// The format must be a string literal: SINK_FMT turns it into a type
+#define LOG_AT(logger, level, literal, ...) (logger).log((level), SINK_FMT(literal), ##__VA_ARGS__)
+#define LOG_DEBUG(logger, literal, ...) LOG_AT(logger, LogLevel::Debug, literal, ##__VA_ARGS__)
+#define LOG_INFO(logger, literal, ...) LOG_AT(logger, LogLevel::Info, literal, ##__VA_ARGS__)
+#define LOG_WARN(logger, literal, ...) LOG_AT(logger, LogLevel::Warn, literal, ##__VA_ARGS__)
+#define LOG_ERROR(logger, literal, ...) LOG_AT(logger, LogLevel::Error, literal, ##__VA_ARGS__)
+
+#endif  // ASYNC_LOGGER_H
@@ -0,0 +1,360 @@
+// AsyncLogger vs logging through std::cout / fprintf from many threads
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "async_logger.h"
+#include "bench_util.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+// T threads each log N lines like
+//
+//   "order 1234 filled: qty 17 px 101.25 venue XNAS"
+//
+//   cout + mutex      std::cout with a lock around each line (without it,
+//                     lines from different threads interleave mid-line)
+//   fprintf           C stdio: the FILE lock is taken inside every call
+//   AsyncLogger       binary record into the thread's own ring; formatting
+//                     and write() happen on the backend thread
+//
+// The interesting number for the async logger is the cost of the CALL: what
+// the application thread pays. The backend's formatting work still happens -
+// just not on the thread that matters.
+
+template <typename Body>
+void run_threads(int threads, Body&& body) {
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t) pool.emplace_back([&, t] { body(t); });
+    for (auto& th : pool) th.join();
+}
+
+std::string read_file(const char* path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+// ============================================================================
+// DEMO
+// ============================================================================
+
+void demo() {
+    std::cout << "=== Demo: 3 threads, one logger ===" << std::endl;
+    std::cout.flush();  // the logger writes to the same fd
+    {
+        AsyncLogger log;
+        int on_stack = 7;
+        std::string venue = "XNAS";
+        run_threads(3, [&](int t) {
+            LOG_INFO(log, "worker {} starting, stack var at {}", t, &on_stack);
+            LOG_DEBUG(log, "order {} filled: qty {} px {} venue {}", 1000 + t, 17 * (t + 1), 101.25 + t, venue);
+            if (t == 2) LOG_WARN(log, "worker {} saw a {{slow}} tick", t);
+        });
+        LOG_ERROR(log, "all workers done");
+        // LOG_INFO(log, "{} {}", 1);        // compile error: 2 placeholders, 1 argument
+        // LOG_INFO(log, "{}", std::vector<int>{});  // compile error: unsupported argument type
+    }  // destructor: drain, flush, join the backend
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// CORRECTNESS
+// ============================================================================
+
+void test_block_policy() {
+    const int threads = 4;
+    const int per_thread = 100000;
+    const char* path = "/tmp/async_logger_block.txt";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    {
+        LoggerOptions opts;
+        opts.fd = fd;
+        opts.ring_bytes = 4096;  // tiny: forces producers to wait constantly
+        opts.policy = FullPolicy::Block;
+        AsyncLogger log(opts);
+        run_threads(threads, [&](int t) {
+            for (int i = 0; i < per_thread; ++i) LOG_INFO(log, "seq {} {} {}", t, i, std::string(i % 50, 'x'));
+        });
+    }
+    close(fd);
+
+    // Every (thread, seq) exactly once, each thread's records in order
+    std::vector<int> next(threads, 0);
+    bool in_order = true;
+    long lines = 0;
+    std::istringstream in(read_file(path));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::size_t at = line.find("seq ");
+        if (at == std::string::npos) continue;
+        int t = 0, i = 0;
+        char tail[64] = {};
+        if (std::sscanf(line.c_str() + at, "seq %d %d %63s", &t, &i, tail) < 2 || t < 0 || t >= threads) continue;
+        in_order &= i == next[t]++ && std::string(tail).size() == std::size_t(i % 50);
+        ++lines;
+    }
+    unlink(path);
+    check(lines == long(threads) * per_thread && in_order,
+          "Block, 4 KiB rings: all " + std::to_string(lines) + " records, per-thread order kept, strings intact");
+}
+
+void test_drop_policy() {
+    const int per_thread = 200000;
+    const char* path = "/tmp/async_logger_drop.txt";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    std::uint64_t dropped = 0, written = 0;
+    {
+        LoggerOptions opts;
+        opts.fd = fd;
+        opts.ring_bytes = 4096;
+        opts.policy = FullPolicy::Drop;
+        opts.idle_sleep = std::chrono::milliseconds(5);  // slow backend: the rings will overflow
+        AsyncLogger log(opts);
+        run_threads(2, [&](int t) {
+            for (int i = 0; i < per_thread; ++i) LOG_INFO(log, "drop test {} {}", t, i);
+        });
+        log.stop();
+        dropped = log.dropped();
+        written = log.written();
+    }
+    close(fd);
+    std::string text = read_file(path);
+    unlink(path);
+    bool reported = text.find("messages dropped (ring full)") != std::string::npos;
+    check(dropped + written == 2u * per_thread && dropped > 0 && reported,
+          "Drop: written " + std::to_string(written) + " + dropped " + std::to_string(dropped) +
+              " = every call, drops reported in the log");
+}
+
+void test_levels() {
+    const char* path = "/tmp/async_logger_levels.txt";
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    {
+        LoggerOptions opts;
+        opts.fd = fd;
+        opts.min_level = LogLevel::Warn;
+        AsyncLogger log(opts);
+        LOG_DEBUG(log, "hidden {}", 1);
+        LOG_INFO(log, "hidden {}", 2);
+        LOG_WARN(log, "shown {}", 3);
+        LOG_ERROR(log, "shown {}", 4.5);
+    }
+    close(fd);
+    std::string text = read_file(path);
+    unlink(path);
+    check(text.find("hidden") == std::string::npos && text.find("WARN  shown 3") != std::string::npos &&
+              text.find("ERROR shown 4.5") != std::string::npos,
+          "min_level = Warn: Debug/Info cost one compare, Warn/Error are written");
+}
+
+void test_two_loggers() {
+    int fd = open("/dev/null", O_WRONLY);
+    std::size_t rings_a = 0, rings_b = 0;
+    std::uint64_t written = 0;
+    {
+        LoggerOptions opts;
+        opts.fd = fd;
+        opts.policy = FullPolicy::Block;
+        AsyncLogger a(opts), b(opts);
+        for (int i = 0; i < 1000; ++i) {  // every call misses the one-entry thread_local cache
+            LOG_INFO(a, "a {}", i);
+            LOG_INFO(b, "b {}", i);
+        }
+        rings_a = a.rings();
+        rings_b = b.rings();
+        a.stop();
+        b.stop();
+        written = a.written() + b.written();
+    }
+    close(fd);
+    check(rings_a == 1 && rings_b == 1 && written == 2000,
+          "one thread alternating between two loggers keeps one ring in each");
+}
+
+// ============================================================================
+// THROUGHPUT AND CALL COST
+// ============================================================================
+
+struct Stats {
+    double ns_per_call;
+    double p50, p99, p999;
+};
+
+Stats summarize(double total_ms, long calls, std::vector<std::uint32_t>& samples) {
+    std::sort(samples.begin(), samples.end());
+    auto pct = [&](double p) { return samples.empty() ? 0.0 : double(samples[std::size_t(p * (samples.size() - 1))]); };
+    return {total_ms * 1e6 / double(calls), pct(0.50), pct(0.99), pct(0.999)};
+}
+
+// Every 64th call is timed on its own with steady_clock, for percentiles
+template <typename LogOne>
+Stats measure(int threads, long per_thread, LogOne&& log_one) {
+    std::vector<std::vector<std::uint32_t>> samples(threads);
+    double ms = time_ms([&] {
+        run_threads(threads, [&](int t) {
+            samples[t].reserve(std::size_t(per_thread / 64 + 1));
+            for (long i = 0; i < per_thread; ++i) {
+                if ((i & 63) == 0) {
+                    auto a = std::chrono::steady_clock::now();
+                    log_one(t, i);
+                    auto b = std::chrono::steady_clock::now();
+                    samples[t].push_back(std::uint32_t(std::chrono::duration_cast<std::chrono::nanoseconds>(b - a).count()));
+                } else {
+                    log_one(t, i);
+                }
+            }
+        });
+    });
+    std::vector<std::uint32_t> all;
+    for (auto& s : samples) all.insert(all.end(), s.begin(), s.end());
+    return summarize(ms, long(threads) * per_thread, all);
+}
+
+void print_stats(const char* name, const Stats& s, const std::string& note = "") {
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-22s %8.1f ns/call   p50 %6.0f  p99 %7.0f  p99.9 %8.0f ns  %s", name,
+                  s.ns_per_call, s.p50, s.p99, s.p999, note.c_str());
+    std::cout << line << std::endl;
+}
+
+// Only what the application thread pays: bursts that fit in a cache-sized
+// ring, timed while the backend sleeps; between bursts the backend drains
+void bench_hot_path(long calls) {
+    const long burst = 4000;  // ~200 KB of records: stays in L2
+    LoggerOptions opts;
+    opts.fd = open("/dev/null", O_WRONLY);
+    opts.ring_bytes = 512 * 1024;
+    opts.idle_sleep = std::chrono::milliseconds(1);
+    const std::string venue = "XNAS";
+
+    auto timed_bursts = [&](AsyncLogger& log, auto&& one_call) {
+        double ms = 0;
+        for (long done = 0; done < calls; done += burst) {
+            while (log.written() < std::uint64_t(done + 1)) std::this_thread::yield();  // backend drained the last burst
+            std::this_thread::sleep_for(std::chrono::microseconds(100));              // ...and went back to sleep
+            ms += time_ms([&] {
+                for (long i = 0; i < burst; ++i) one_call(i);
+            });
+        }
+        return ms * 1e6 / double((calls + burst - 1) / burst * burst);
+    };
+
+    double ns_ints = 0, ns_mixed = 0;
+    {
+        AsyncLogger log(opts);
+        LOG_INFO(log, "warm-up: registers this thread's ring");
+        ns_ints = timed_bursts(log, [&](long i) { LOG_INFO(log, "tick {} {}", i, 42); });
+    }
+    {
+        AsyncLogger log(opts);
+        LOG_INFO(log, "warm-up: registers this thread's ring");
+        ns_mixed = timed_bursts(log, [&](long i) { LOG_INFO(log, "order {} filled: qty {} px {} venue {}", i, 17, 101.25, venue); });
+    }
+    close(opts.fd);
+
+    volatile std::uint64_t last = 0;
+    double tsc_ns = time_ms([&] {
+        for (int i = 0; i < 1000000; ++i) last = log_ticks();
+    });  // ms for 10^6 reads == ns per read
+    std::cout << "--- hot path alone (bursts of " << burst << ", backend asleep meanwhile) ---" << std::endl;
+    std::cout << "  two ints:                " << ns_ints << " ns/call" << std::endl;
+    std::cout << "  ints + double + string:  " << ns_mixed << " ns/call" << std::endl;
+    std::cout << "  of which the timestamp:  " << tsc_ns << " ns (rdtsc; ~7 ns on bare metal, more in some VMs)" << std::endl;
+}
+
+void bench(int threads, long per_thread) {
+    std::cout << "--- " << threads << " thread(s) x " << per_thread << " lines -> /dev/null ---" << std::endl;
+    const std::string venue = "XNAS";
+
+    // cout and fprintf write to fd 1: point it at /dev/null meanwhile
+    std::cout.flush();
+    std::fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int devnull = open("/dev/null", O_WRONLY);
+    dup2(devnull, STDOUT_FILENO);
+
+    std::mutex cout_mutex;
+    Stats cout_stats = measure(threads, per_thread, [&](int t, long i) {
+        std::lock_guard<std::mutex> lock(cout_mutex);
+        std::cout << "[T" << t << "] INFO  order " << i << " filled: qty " << 17 << " px " << 101.25 << " venue "
+                  << venue << '\n';
+    });
+    std::cout.flush();
+
+    Stats printf_stats = measure(threads, per_thread, [&](int t, long i) {
+        std::fprintf(stdout, "[T%d] INFO  order %ld filled: qty %d px %g venue %s\n", t, i, 17, 101.25, venue.c_str());
+    });
+    std::fflush(stdout);
+
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+
+    Stats async_stats{};
+    std::uint64_t dropped = 0;
+    double drain_ms = time_ms([&] {
+        LoggerOptions opts;
+        opts.fd = devnull;
+        opts.ring_bytes = 8 << 20;
+        opts.policy = FullPolicy::Block;
+        AsyncLogger log(opts);
+        async_stats = measure(threads, per_thread, [&](int, long i) {
+            LOG_INFO(log, "order {} filled: qty {} px {} venue {}", i, 17, 101.25, venue);
+        });
+        log.stop();
+        dropped = log.dropped();
+    });
+    close(devnull);
+
+    print_stats("cout + mutex", cout_stats);
+    print_stats("fprintf", printf_stats);
+    print_stats("AsyncLogger (Block)", async_stats,
+                "(backend done after " + std::to_string(int(drain_ms)) + " ms, dropped " + std::to_string(dropped) + ")");
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Asynchronous MPSC Logger ===" << std::endl;
+    std::cout << "CPUs online: " << sysconf(_SC_NPROCESSORS_ONLN) << std::endl << std::endl;
+
+    demo();
+
+    std::cout << "=== Correctness ===" << std::endl;
+    test_block_policy();
+    test_drop_policy();
+    test_levels();
+    test_two_loggers();
+    std::cout << std::endl;
+
+    long per_thread = argc > 1 ? std::atol(argv[1]) : 1000000;
+    std::cout << "=== Call cost ===" << std::endl;
+    bench_hot_path(std::min(per_thread, 1000000L));
+    bench(1, per_thread);
+    bench(4, per_thread / 4);
+    std::cout << "(percentiles include the steady_clock reads around the sampled call, ~20-40 ns;" << std::endl;
+    std::cout << " with fewer CPUs than threads, ns/call also includes the backend's formatting time)" << std::endl;
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• The log call copies a few raw bytes; formatting moves to the backend thread" << std::endl;
+    std::cout << "• One ring per thread: no shared lock, no shared cache line on the hot path" << std::endl;
+    std::cout << "• The format string never travels: a decoder pointer identifies the call site" << std::endl;
+    std::cout << "• Drop keeps latency flat under bursts; Block never loses a line but can stall" << std::endl;
+    std::cout << "• Strings are copied at the call: the caller may reuse its buffer immediately" << std::endl;
+    std::cout << "• Per-thread order is kept; global order would need a merge by timestamp" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
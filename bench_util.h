@@ -0,0 +1,61 @@
+// bench_util.h - the timer, optimizer barrier, checks and random numbers every demo uses
+//
+//   double ms = time_ms([&] { ... });     wall time of one call, in ms
+//   do_not_optimize(sum);                 "sum is used": the loop that made
+//                                         it can't be deleted or hoisted
+//   check(a == b, "what a == b means");   prints "ok" or "FAIL", counts failures
+//   Lcg rng{42};  rng.next()              fast, reproducible, not crypto
+//
+// A demo ends with
+//
+//   std::cout << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+//   return failures == 0 ? 0 : 1;
+//
+// so a broken claim fails the run, not just the printout.
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+template <typename F>
+double time_ms(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count();
+}
+
+// The value must exist (in a register or in memory) and memory may have
+// been read or written: nothing the compiler can prove is unused
+template <typename T>
+inline void do_not_optimize(T const& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+inline int failures = 0;
+
+inline void check(bool ok, const std::string& what) {
+    std::cout << "  " << (ok ? "ok   " : "FAIL ") << what << std::endl;
+    if (!ok) ++failures;
+}
+
+// 64-bit linear congruential generator (Knuth's MMIX constants). The low
+// bits of an LCG repeat with short periods; next() returns the high 32.
+struct Lcg {
+    std::uint64_t state;
+
+    std::uint64_t next64() {
+        state = state * 6364136223846793005ull + 1442695040888963407ull;
+        return state;
+    }
+    std::uint32_t next() { return static_cast<std::uint32_t>(next64() >> 32); }
+    // In [lo, hi)
+    int range(int lo, int hi) { return lo + static_cast<int>(next() % std::uint32_t(hi - lo)); }
+    float uniform(float lo, float hi) { return lo + (hi - lo) * float(next() >> 8) * 0x1p-24f; }
+};
+
+#endif  // BENCH_UTIL_H
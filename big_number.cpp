@@ -0,0 +1,876 @@
+// BigNumber: arbitrary-precision integers with the same operators as Number
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+
+// Number in operator_keyword.cpp wraps one int: 2147483647 + 1 silently
+// wraps to -2147483648. BigNumber grows instead: the magnitude is an array of
+// 64-bit LIMBS (digits in base 2^64), least significant first, plus a sign.
+//
+//   value = -(limb[0] + limb[1]*2^64 + limb[2]*2^128 + ...)
+//            ┌──────────┬──────────┬──────────┐
+//   limbs:   │ limb[0]  │ limb[1]  │ limb[2]  │   neg = true
+//            └──────────┴──────────┴──────────┘
+//
+// Small values (up to 2 limbs) live INSIDE the object: no heap allocation.
+// + - * on values that fit in an int64 take a fast path with the CPU's
+// overflow flag (__builtin_add_overflow) and never touch the limb loops.
+
+using Limb = std::uint64_t;
+using DoubleLimb = unsigned __int128;  // GCC/Clang: holds a full limb * limb product
+
+// ============================================================================
+// LIMB ARITHMETIC on magnitudes (little-endian arrays, no sign)
+// ============================================================================
+
+// r[0..n) = a[0..n) + b[0..n), returns the carry out (0 or 1)
+Limb add_n(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        Limb s = a[i] + carry;
+        Limb c1 = s < carry;
+        Limb t = s + b[i];
+        Limb c2 = t < s;
+        r[i] = t;
+        carry = c1 | c2;
+    }
+    return carry;
+}
+
+// r[0..na) = a[0..na) + b[0..nb), na >= nb, returns the carry out
+Limb add(Limb* r, const Limb* a, std::size_t na, const Limb* b, std::size_t nb) {
+    Limb carry = add_n(r, a, b, nb);
+    for (std::size_t i = nb; i < na; ++i) {
+        r[i] = a[i] + carry;
+        carry = r[i] < carry;
+    }
+    return carry;
+}
+
+// r[0..nr) += b[0..nb), nb <= nr, returns the carry out of r[nr-1]
+Limb add_into(Limb* r, std::size_t nr, const Limb* b, std::size_t nb) {
+    Limb carry = add_n(r, r, b, nb);
+    for (std::size_t i = nb; carry && i < nr; ++i) {
+        r[i] += 1;
+        carry = r[i] == 0;
+    }
+    return carry;
+}
+
+// r[0..na) = a[0..na) - b[0..nb), requires a >= b
+void sub(Limb* r, const Limb* a, std::size_t na, const Limb* b, std::size_t nb) {
+    Limb borrow = 0;
+    for (std::size_t i = 0; i < na; ++i) {
+        Limb bi = i < nb ? b[i] : 0;
+        Limb d = a[i] - bi;
+        Limb b1 = a[i] < bi;
+        r[i] = d - borrow;
+        borrow = b1 | (d < borrow);
+    }
+}
+
+// r[0..nr) -= b[0..nb), requires r >= b
+void sub_from(Limb* r, std::size_t nr, const Limb* b, std::size_t nb) {
+    sub(r, r, nr, b, nb);
+}
+
+// r[0..n) += a[0..n) * m, returns the limb carried out
+Limb addmul_1(Limb* r, const Limb* a, std::size_t n, Limb m) {
+    Limb carry = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        // (2^64-1)^2 + 2*(2^64-1) = 2^128-1: never overflows
+        DoubleLimb t = DoubleLimb(a[i]) * m + r[i] + carry;
+        r[i] = Limb(t);
+        carry = Limb(t >> 64);
+    }
+    return carry;
+}
+
+std::size_t normalized(const Limb* a, std::size_t n) {
+    while (n > 0 && a[n - 1] == 0) --n;
+    return n;
+}
+
+int compare_mag(const Limb* a, std::size_t na, const Limb* b, std::size_t nb) {
+    if (na != nb) return na < nb ? -1 : 1;
+    for (std::size_t i = na; i-- > 0;) {
+        if (a[i] != b[i]) return a[i] < b[i] ? -1 : 1;
+    }
+    return 0;
+}
+
+// ============================================================================
+// MULTIPLICATION: three algorithms, picked by operand size
+// ============================================================================
+//
+//   schoolbook   O(n^2)        every limb times every limb; unbeatable when small
+//   Karatsuba    O(n^1.585)    3 half-size products instead of 4:
+//                                (a1 B + a0)(b1 B + b0) =
+//                                  z2 B^2 + ((a0+a1)(b0+b1) - z2 - z0) B + z0
+//   NTT          O(n log n)    number-theoretic transform = FFT over integers
+//                              mod a prime: exact, no floating-point rounding
+//
+// Thresholds come from the benchmark below (crossover points on x86-64). The
+// NTT works on 16-bit pieces, so its transforms are 8x longer than the limb
+// count: it only pays off for operands of hundreds of thousands of digits.
+
+constexpr std::size_t kKaratsubaThreshold = 32;    // limbs
+constexpr std::size_t kNttThreshold = 16384;       // limbs, smaller operand
+
+// r[0..na+nb) = a * b
+void mul_schoolbook(Limb* r, const Limb* a, std::size_t na, const Limb* b, std::size_t nb) {
+    std::fill(r, r + na + nb, Limb(0));
+    for (std::size_t j = 0; j < nb; ++j) {
+        r[na + j] = addmul_1(r + j, a, na, b[j]);
+    }
+}
+
+// r[0..2n) = a[0..n) * b[0..n)
+void mul_karatsuba(Limb* r, const Limb* a, const Limb* b, std::size_t n) {
+    if (n < kKaratsubaThreshold) {
+        mul_schoolbook(r, a, n, b, n);
+        return;
+    }
+    const std::size_t h = n / 2;   // low half:  a0 = a[0..h)
+    const std::size_t hi = n - h;  // high half: a1 = a[h..n), hi >= h
+
+    mul_karatsuba(r, a, b, h);                  // z0 -> r[0..2h)
+    mul_karatsuba(r + 2 * h, a + h, b + h, hi); // z2 -> r[2h..2n)
+
+    std::vector<Limb> sa(hi + 1), sb(hi + 1), z1(2 * (hi + 1));
+    sa[hi] = add(sa.data(), a + h, hi, a, h);   // a0 + a1 (one extra limb for the carry)
+    sb[hi] = add(sb.data(), b + h, hi, b, h);
+    mul_karatsuba(z1.data(), sa.data(), sb.data(), hi + 1);
+    sub_from(z1.data(), z1.size(), r, 2 * h);           // - z0
+    sub_from(z1.data(), z1.size(), r + 2 * h, 2 * hi);  // - z2
+
+    // z1 = a0*b1 + a1*b0 < 2 B^n, so it fits in the 2n - h limbs above r[h]
+    std::size_t len = normalized(z1.data(), std::min(z1.size(), 2 * n - h));
+    add_into(r + h, 2 * n - h, z1.data(), len);
+}
+
+// ----------------------------------------------------------------------------
+// NTT over the "Goldilocks" prime p = 2^64 - 2^32 + 1
+// ----------------------------------------------------------------------------
+// p - 1 = 2^32 * (2^32 - 1): transforms of any power-of-two length up to 2^32
+// exist, and x mod p needs no division (2^64 = 2^32 - 1 and 2^96 = -1 mod p).
+//
+// Each limb is split into four 16-bit digits. A coefficient of the product is
+// a sum of at most 4*n products of two 16-bit digits, < 4n * 2^32 - far below
+// p for any size we can allocate, so the result mod p IS the exact value.
+
+namespace ntt {
+
+constexpr std::uint64_t P = 0xFFFFFFFF00000001ull;
+constexpr std::uint64_t EPS = 0xFFFFFFFFull;  // 2^64 - P
+constexpr std::uint64_t G = 7;                // generator of the multiplicative group
+
+inline std::uint64_t reduce(DoubleLimb x) {
+    std::uint64_t lo = std::uint64_t(x);
+    std::uint64_t hi = std::uint64_t(x >> 64);
+    std::uint64_t hi_hi = hi >> 32;
+    std::uint64_t hi_lo = hi & EPS;
+
+    std::uint64_t t0;
+    if (__builtin_sub_overflow(lo, hi_hi, &t0)) t0 -= EPS;  // lo - hi_hi * 2^96
+    std::uint64_t t1 = hi_lo * EPS;                          //    + hi_lo * 2^64
+    std::uint64_t r;
+    if (__builtin_add_overflow(t0, t1, &r)) r += EPS;
+    return r >= P ? r - P : r;
+}
+
+inline std::uint64_t mul(std::uint64_t a, std::uint64_t b) { return reduce(DoubleLimb(a) * b); }
+
+inline std::uint64_t add(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t s;
+    if (__builtin_add_overflow(a, b, &s)) return s + EPS;
+    return s >= P ? s - P : s;
+}
+
+inline std::uint64_t sub(std::uint64_t a, std::uint64_t b) {
+    std::uint64_t d;
+    if (__builtin_sub_overflow(a, b, &d)) return d - EPS;
+    return d;
+}
+
+std::uint64_t power(std::uint64_t base, std::uint64_t e) {
+    std::uint64_t result = 1;
+    while (e) {
+        if (e & 1) result = mul(result, base);
+        base = mul(base, base);
+        e >>= 1;
+    }
+    return result;
+}
+
+// In-place iterative radix-2 transform (Cooley-Tukey), a.size() a power of two
+void transform(std::vector<std::uint64_t>& a, bool invert) {
+    const std::size_t n = a.size();
+    for (std::size_t i = 1, j = 0; i < n; ++i) {  // bit-reversal permutation
+        std::size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) j ^= bit;
+        j ^= bit;
+        if (i < j) std::swap(a[i], a[j]);
+    }
+
+    std::vector<std::uint64_t> twiddle(n / 2);
+    for (std::size_t len = 2; len <= n; len <<= 1) {
+        std::uint64_t w = power(G, (P - 1) / len);  // primitive len-th root of unity
+        if (invert) w = power(w, P - 2);
+        const std::size_t half = len / 2;
+        twiddle[0] = 1;
+        for (std::size_t k = 1; k < half; ++k) twiddle[k] = mul(twiddle[k - 1], w);
+
+        for (std::size_t i = 0; i < n; i += len) {
+            for (std::size_t k = 0; k < half; ++k) {
+                std::uint64_t u = a[i + k];
+                std::uint64_t v = mul(a[i + k + half], twiddle[k]);
+                a[i + k] = add(u, v);
+                a[i + k + half] = sub(u, v);
+            }
+        }
+    }
+
+    if (invert) {
+        std::uint64_t n_inv = power(n % P, P - 2);
+        for (auto& x : a) x = mul(x, n_inv);
+    }
+}
+
+}  // namespace ntt
+
+// r[0..na+nb) = a * b
+void mul_ntt(Limb* r, const Limb* a, std::size_t na, const Limb* b, std::size_t nb) {
+    const std::size_t digits = 4 * (na + nb);
+    std::size_t n = 1;
+    while (n < digits) n <<= 1;
+
+    std::vector<std::uint64_t> fa(n, 0), fb(n, 0);
+    for (std::size_t i = 0; i < na; ++i)
+        for (int k = 0; k < 4; ++k) fa[4 * i + k] = (a[i] >> (16 * k)) & 0xFFFF;
+    for (std::size_t i = 0; i < nb; ++i)
+        for (int k = 0; k < 4; ++k) fb[4 * i + k] = (b[i] >> (16 * k)) & 0xFFFF;
+
+    ntt::transform(fa, false);
+    ntt::transform(fb, false);
+    for (std::size_t i = 0; i < n; ++i) fa[i] = ntt::mul(fa[i], fb[i]);
+    ntt::transform(fa, true);
+
+    // Carry the 16-bit digits and pack them back into limbs
+    std::fill(r, r + na + nb, Limb(0));
+    std::uint64_t carry = 0;
+    for (std::size_t i = 0; i < digits; ++i) {
+        std::uint64_t v = fa[i] + carry;
+        r[i / 4] |= (v & 0xFFFF) << (16 * (i % 4));
+        carry = v >> 16;
+    }
+}
+
+enum class MulAlgorithm { Auto, Schoolbook, Karatsuba, Ntt };
+
+// r[0..na+nb) = a * b, picking the algorithm by the smaller operand's size
+void mul_mag(Limb* r, const Limb* a, std::size_t na, const Limb* b, std::size_t nb,
+             MulAlgorithm alg = MulAlgorithm::Auto) {
+    if (na < nb) {
+        std::swap(a, b);
+        std::swap(na, nb);
+    }
+    if (alg == MulAlgorithm::Auto) {
+        alg = nb < kKaratsubaThreshold ? MulAlgorithm::Schoolbook
+            : nb >= kNttThreshold      ? MulAlgorithm::Ntt
+                                       : MulAlgorithm::Karatsuba;
+    }
+    if (nb == 0) {
+        std::fill(r, r + na, Limb(0));
+        return;
+    }
+    switch (alg) {
+        case MulAlgorithm::Schoolbook:
+            mul_schoolbook(r, a, na, b, nb);
+            return;
+        case MulAlgorithm::Ntt:
+            mul_ntt(r, a, na, b, nb);
+            return;
+        default:
+            break;
+    }
+
+    // Karatsuba wants equal sizes: cut the longer operand into nb-limb chunks
+    if (na == nb) {
+        mul_karatsuba(r, a, b, nb);
+        return;
+    }
+    std::fill(r, r + na + nb, Limb(0));
+    std::vector<Limb> part(2 * nb);
+    for (std::size_t off = 0; off < na; off += nb) {
+        std::size_t chunk = std::min(nb, na - off);
+        if (chunk == nb) {
+            mul_karatsuba(part.data(), a + off, b, nb);
+        } else {
+            mul_mag(part.data(), b, nb, a + off, chunk, MulAlgorithm::Karatsuba);
+        }
+        add_into(r + off, na + nb - off, part.data(), chunk + nb);
+    }
+}
+
+// ============================================================================
+// DIVISION BY 10^19 for printing
+// ============================================================================
+// 10^19 is the largest power of ten below 2^64, so each division peels off 19
+// decimal digits. Its top bit is set, which lets us replace the slow 128/64
+// hardware division with a multiplication by a precomputed reciprocal
+// (Moller & Granlund, "Improved division by invariant integers", 2011).
+
+constexpr Limb kChunk = 10000000000000000000ull;  // 10^19
+constexpr int kChunkDigits = 19;
+const Limb kChunkInv = Limb(~DoubleLimb(0) / kChunk);  // floor((2^128 - 1) / d) - 2^64
+
+// (u1:u0) / 10^19 with u1 < 10^19: quotient returned, remainder in r
+inline Limb div_chunk(Limb u1, Limb u0, Limb& r) {
+    DoubleLimb q = DoubleLimb(kChunkInv) * u1 + ((DoubleLimb(u1) << 64) | u0);
+    Limb q1 = Limb(q >> 64) + 1;
+    Limb q0 = Limb(q);
+    r = u0 - q1 * kChunk;
+    if (r > q0) {
+        --q1;
+        r += kChunk;
+    }
+    if (r >= kChunk) {
+        ++q1;
+        r -= kChunk;
+    }
+    return q1;
+}
+
+const char kDigitPairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+    "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+
+// Write exactly `width` digits of v ending at `end` (leading zeros included)
+void write_digits(char* end, Limb v, int width) {
+    while (width >= 2) {
+        std::memcpy(end - 2, kDigitPairs + 2 * (v % 100), 2);
+        v /= 100;
+        end -= 2;
+        width -= 2;
+    }
+    if (width) *--end = char('0' + v % 10);
+}
+
+int digit_count(Limb v) {
+    int n = 1;
+    while (v >= 10) {
+        v /= 10;
+        ++n;
+    }
+    return n;
+}
+
+// ============================================================================
+// BigNumber
+// ============================================================================
+
+class BigNumber {
+private:
+    static constexpr std::uint32_t kInline = 2;
+
+    union {
+        Limb inline_[kInline];  // cap_ == kInline: limbs stored in the object
+        Limb* heap_;            // cap_ >  kInline: limbs on the heap
+    };
+    std::uint32_t size_ = 0;  // significant limbs; 0 means the value 0
+    std::uint32_t cap_ = kInline;
+    bool neg_ = false;        // never true for 0
+
+    static inline std::size_t heap_allocations_ = 0;
+
+    bool on_heap() const { return cap_ > kInline; }
+    Limb* data() { return on_heap() ? heap_ : inline_; }
+    const Limb* data() const { return on_heap() ? heap_ : inline_; }
+
+    void reserve(std::uint32_t n) {
+        if (n <= cap_) return;
+        std::uint32_t cap = std::max(n, cap_ * 2);
+        Limb* fresh = new Limb[cap];
+        ++heap_allocations_;
+        std::copy(data(), data() + size_, fresh);
+        if (on_heap()) delete[] heap_;
+        heap_ = fresh;
+        cap_ = cap;
+    }
+
+    // Drop leading zero limbs; zero has no sign
+    void trim() {
+        size_ = std::uint32_t(normalized(data(), size_));
+        if (size_ == 0) neg_ = false;
+    }
+
+    // Fits in an int64: the fast path for + - * ++. One limb isn't always
+    // inline: a heap result that trim() shrank keeps its heap buffer.
+    bool is_small() const { return size_ == 0 || (size_ == 1 && data()[0] <= Limb(LLONG_MAX)); }
+    long long small_value() const {
+        long long v = size_ ? static_cast<long long>(data()[0]) : 0;
+        return neg_ ? -v : v;
+    }
+
+    static BigNumber from_two_limbs(bool negative, Limb lo, Limb hi) {
+        BigNumber r;
+        r.inline_[0] = lo;
+        r.inline_[1] = hi;
+        r.size_ = 2;
+        r.neg_ = negative;
+        r.trim();
+        return r;
+    }
+
+    // |a| + |b| or |a| - |b| with the right sign (b_neg may be flipped for -)
+    static BigNumber add_signed(const BigNumber& a, const BigNumber& b, bool b_neg) {
+        const BigNumber* x = &a;
+        const BigNumber* y = &b;
+        bool x_neg = a.neg_, y_neg = b_neg;
+        BigNumber r;
+        if (x_neg == y_neg) {
+            if (x->size_ < y->size_) std::swap(x, y);
+            r.reserve(x->size_ + 1);
+            Limb carry = add(r.data(), x->data(), x->size_, y->data(), y->size_);
+            r.data()[x->size_] = carry;
+            r.size_ = x->size_ + 1;
+            r.neg_ = x_neg;
+        } else {
+            int c = compare_mag(x->data(), x->size_, y->data(), y->size_);
+            if (c == 0) return BigNumber();
+            if (c < 0) {
+                std::swap(x, y);
+                std::swap(x_neg, y_neg);
+            }
+            r.reserve(x->size_);
+            sub(r.data(), x->data(), x->size_, y->data(), y->size_);
+            r.size_ = x->size_;
+            r.neg_ = x_neg;
+        }
+        r.trim();
+        return r;
+    }
+
+public:
+    BigNumber() : inline_{0, 0} {}
+
+    // Implicit, like Number(int): BigNumber b = 42; b + 1 ...
+    BigNumber(long long v) : inline_{0, 0} {
+        if (v == 0) return;
+        neg_ = v < 0;
+        inline_[0] = neg_ ? Limb(0) - Limb(v) : Limb(v);  // also correct for LLONG_MIN
+        size_ = 1;
+    }
+
+    // Decimal string, optional leading '-'
+    explicit BigNumber(const std::string& text) : inline_{0, 0} {
+        std::size_t pos = 0;
+        bool negative = false;
+        if (pos < text.size() && (text[pos] == '-' || text[pos] == '+')) negative = text[pos++] == '-';
+        if (pos == text.size()) throw std::invalid_argument("BigNumber: no digits");
+
+        // Groups of 19 digits: value = value * 10^19 + group
+        std::size_t first = (text.size() - pos) % kChunkDigits;
+        if (first == 0) first = kChunkDigits;
+        while (pos < text.size()) {
+            Limb group = 0;
+            Limb scale = 1;
+            for (std::size_t end = pos + first; pos < end; ++pos) {
+                char c = text[pos];
+                if (c < '0' || c > '9') throw std::invalid_argument("BigNumber: not a digit: " + text);
+                group = group * 10 + Limb(c - '0');
+                scale *= 10;
+            }
+            first = kChunkDigits;
+            reserve(size_ + 1);
+            Limb* d = data();
+            Limb carry = group;
+            for (std::uint32_t i = 0; i < size_; ++i) {
+                DoubleLimb t = DoubleLimb(d[i]) * scale + carry;
+                d[i] = Limb(t);
+                carry = Limb(t >> 64);
+            }
+            if (carry) d[size_++] = carry;
+        }
+        neg_ = negative;
+        trim();
+    }
+
+    static BigNumber from_limbs(const Limb* limbs, std::size_t n, bool negative = false) {
+        BigNumber r;
+        r.reserve(std::uint32_t(n));
+        std::copy(limbs, limbs + n, r.data());
+        r.size_ = std::uint32_t(n);
+        r.neg_ = negative;
+        r.trim();
+        return r;
+    }
+
+    BigNumber(const BigNumber& other) : inline_{0, 0}, neg_{other.neg_} {
+        reserve(other.size_);
+        std::copy(other.data(), other.data() + other.size_, data());
+        size_ = other.size_;
+    }
+
+    BigNumber(BigNumber&& other) noexcept : size_{other.size_}, cap_{other.cap_}, neg_{other.neg_} {
+        if (other.on_heap()) {
+            heap_ = other.heap_;
+            other.cap_ = kInline;
+        } else {
+            inline_[0] = other.inline_[0];
+            inline_[1] = other.inline_[1];
+        }
+        other.size_ = 0;
+        other.neg_ = false;
+    }
+
+    BigNumber& operator=(const BigNumber& other) {
+        if (this != &other) {
+            reserve(other.size_);  // reuses our buffer when it is big enough
+            std::copy(other.data(), other.data() + other.size_, data());
+            size_ = other.size_;
+            neg_ = other.neg_;
+        }
+        return *this;
+    }
+
+    BigNumber& operator=(BigNumber&& other) noexcept {
+        if (this != &other) {
+            this->~BigNumber();
+            new (this) BigNumber(std::move(other));
+        }
+        return *this;
+    }
+
+    ~BigNumber() {
+        if (on_heap()) delete[] heap_;
+    }
+
+    // ----- The Number operator surface -----
+
+    BigNumber operator+(const BigNumber& other) const {
+        long long r;
+        if (is_small() && other.is_small() && !__builtin_add_overflow(small_value(), other.small_value(), &r))
+            return BigNumber(r);
+        return add_signed(*this, other, other.neg_);
+    }
+
+    BigNumber operator-(const BigNumber& other) const {
+        long long r;
+        if (is_small() && other.is_small() && !__builtin_sub_overflow(small_value(), other.small_value(), &r))
+            return BigNumber(r);
+        return add_signed(*this, other, !other.neg_);
+    }
+
+    BigNumber operator-() const {
+        BigNumber r = *this;
+        if (r.size_) r.neg_ = !r.neg_;
+        return r;
+    }
+
+    BigNumber operator*(const BigNumber& other) const {
+        if (size_ <= 1 && other.size_ <= 1) {  // one 64x64 -> 128-bit multiply, stays inline
+            DoubleLimb p = DoubleLimb(size_ ? data()[0] : 0) * (other.size_ ? other.data()[0] : 0);
+            return from_two_limbs(neg_ != other.neg_, Limb(p), Limb(p >> 64));
+        }
+        return multiply(*this, other, MulAlgorithm::Auto);
+    }
+
+    BigNumber& operator+=(const BigNumber& other) { return *this = *this + other; }
+    BigNumber& operator-=(const BigNumber& other) { return *this = *this - other; }
+    BigNumber& operator*=(const BigNumber& other) { return *this = *this * other; }
+
+    // Prefix ++: in place; only a carry out of the top limb needs more room
+    BigNumber& operator++() {
+        if (neg_) return *this = *this + 1;
+        Limb* d = data();
+        for (std::uint32_t i = 0; i < size_; ++i) {
+            if (++d[i] != 0) return *this;
+        }
+        reserve(size_ + 1);
+        data()[size_++] = 1;
+        return *this;
+    }
+
+    // Postfix ++ (dummy int parameter distinguishes it)
+    BigNumber operator++(int) {
+        BigNumber temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    // operator[] - the i-th 64-bit limb of the magnitude (0 past the top)
+    Limb operator[](std::size_t index) const { return index < size_ ? data()[index] : 0; }
+
+    // operator() - same meaning as Number: value + x + y
+    BigNumber operator()(const BigNumber& x, const BigNumber& y) const { return *this + x + y; }
+
+    friend std::ostream& operator<<(std::ostream& os, const BigNumber& num) {
+        return os << num.to_string();
+    }
+
+    bool operator==(const BigNumber& o) const {
+        return neg_ == o.neg_ && compare_mag(data(), size_, o.data(), o.size_) == 0;
+    }
+    bool operator!=(const BigNumber& o) const { return !(*this == o); }
+    bool operator<(const BigNumber& o) const {
+        if (neg_ != o.neg_) return neg_;
+        int c = compare_mag(data(), size_, o.data(), o.size_);
+        return neg_ ? c > 0 : c < 0;
+    }
+
+    std::size_t limb_count() const { return size_; }
+    bool negative() const { return neg_; }
+    static std::size_t heap_allocations() { return heap_allocations_; }
+
+    static BigNumber multiply(const BigNumber& a, const BigNumber& b, MulAlgorithm alg) {
+        if (a.size_ == 0 || b.size_ == 0) return BigNumber();
+        BigNumber r;
+        r.reserve(a.size_ + b.size_);
+        mul_mag(r.data(), a.data(), a.size_, b.data(), b.size_, alg);
+        r.size_ = a.size_ + b.size_;
+        r.neg_ = a.neg_ != b.neg_;
+        r.trim();
+        return r;
+    }
+
+    // Decimal text. Repeated division by 10^19: O(n^2) in the number of limbs.
+    std::string to_string() const {
+        if (size_ == 0) return "0";
+        if (size_ == 1) {  // fast path: one limb, no scratch buffers
+            char buf[24];
+            int n = digit_count(data()[0]);
+            buf[0] = '-';
+            write_digits(buf + 1 + n, data()[0], n);  // digits at buf + 1, the sign before them
+            return std::string(buf + !neg_, std::size_t(neg_ + n));
+        }
+
+        std::vector<Limb> tmp(data(), data() + size_);
+        std::vector<Limb> chunks;  // base-10^19 digits, least significant first
+        chunks.reserve(size_ * 20 / 19 + 1);
+        std::size_t n = size_;
+        while (n > 0) {
+            Limb rem = 0;
+            for (std::size_t i = n; i-- > 0;) tmp[i] = div_chunk(rem, tmp[i], rem);
+            chunks.push_back(rem);
+            n = normalized(tmp.data(), n);
+        }
+
+        int top_digits = digit_count(chunks.back());
+        std::string s(std::size_t(neg_) + top_digits + (chunks.size() - 1) * kChunkDigits, '0');
+        char* p = &s[0];
+        if (neg_) *p++ = '-';
+        write_digits(p + top_digits, chunks.back(), top_digits);
+        p += top_digits;
+        for (std::size_t i = chunks.size() - 1; i-- > 0;) {
+            write_digits(p + kChunkDigits, chunks[i], kChunkDigits);
+            p += kChunkDigits;
+        }
+        return s;
+    }
+};
+
+// ============================================================================
+// DEMO + BENCHMARKS
+// ============================================================================
+
+// Two draws: each Lcg::next() is 32 bits
+Limb random_limb(Lcg& rng) {
+    Limb high = rng.next();
+    return high << 32 | rng.next();
+}
+
+BigNumber random_big(std::size_t limbs, Lcg& rng) {
+    std::vector<Limb> v(limbs);
+    for (auto& l : v) l = random_limb(rng);
+    if (limbs) v.back() |= Limb(1) << 63;  // exactly `limbs` significant limbs
+    return BigNumber::from_limbs(v.data(), v.size());
+}
+
+void show_operators() {
+    std::cout << "=== Same operators as Number, no overflow ===" << std::endl;
+
+    int i = INT_MAX;
+    std::cout << "int:       2147483647 + 1 = " << static_cast<int>(static_cast<unsigned>(i) + 1u)
+              << "  (Number wraps around)" << std::endl;
+    BigNumber a = 2147483647;
+    std::cout << "BigNumber: 2147483647 + 1 = " << a + 1 << std::endl;
+
+    BigNumber big = LLONG_MAX;
+    std::cout << "LLONG_MAX + 1 = " << big + 1 << "  (leaves the int64 fast path)" << std::endl;
+
+    BigNumber d = BigNumber("18446744073709551615");  // 2^64 - 1: one full limb
+    std::cout << "++(2^64 - 1) = " << ++d << "  (carry into a second limb)" << std::endl;
+    std::cout << "d[0] = " << d[0] << ", d[1] = " << d[1] << "  (operator[]: 64-bit limbs)" << std::endl;
+    std::cout << "d++ = " << d++ << ", d now = " << d << std::endl;
+    std::cout << "a(5, 3) = " << a(5, 3) << "  (operator(): a + 5 + 3)" << std::endl;
+
+    BigNumber f = 1;
+    for (int k = 2; k <= 100; ++k) f *= k;
+    std::cout << "100! = " << f << std::endl;
+    std::cout << std::endl;
+}
+
+void test_correctness() {
+    std::cout << "=== Correctness ===" << std::endl;
+
+    BigNumber f = 1;
+    for (int k = 2; k <= 100; ++k) f *= k;
+    check(f.to_string() ==
+              "93326215443944152681699238856266700490715968264381621468592963895217599993229915608941463976156518286253697920827223758251185210916864000000000000000000000000",
+          "100! matches the known value");
+
+    BigNumber two64 = BigNumber(4294967296LL) * BigNumber(4294967296LL);
+    check(two64.to_string() == "18446744073709551616" && two64[1] == 1 && two64[0] == 0, "2^32 * 2^32 = 2^64");
+    check((BigNumber(LLONG_MIN) - 1).to_string() == "-9223372036854775809", "LLONG_MIN - 1");
+    check(BigNumber(-5) * BigNumber(7) == BigNumber(-35) && BigNumber(-5) + 5 == BigNumber(0), "signs");
+    check(BigNumber("-000123") == BigNumber(-123) && BigNumber("0").to_string() == "0", "parsing");
+    // a - (a - 5) is computed on the heap and trimmed to one limb: the
+    // one-limb fast paths must read the heap buffer, not the inline slot
+    BigNumber a("123456789012345678901234567890123456789012345678901234567890");
+    BigNumber c = a - (a - 5);
+    check(c == 5 && c.to_string() == "5" && (c + 1).to_string() == "6" && (c * 2).to_string() == "10" &&
+              (-c).to_string() == "-5",
+          "one limb left on the heap after trim: 5, 5 + 1, 5 * 2, -5");
+
+    Lcg rng{12345};
+    bool agree = true, roundtrip = true, identity = true;
+    const std::size_t sizes[][2] = {{1, 1}, {3, 2}, {31, 31}, {32, 32}, {33, 33}, {100, 100}, {257, 257},
+                                    {1000, 37}, {1000, 1000}, {1600, 1600}, {3000, 1700}, {4000, 4000}};
+    for (const auto& sz : sizes) {
+        BigNumber x = random_big(sz[0], rng), y = random_big(sz[1], rng);
+        BigNumber s = BigNumber::multiply(x, y, MulAlgorithm::Schoolbook);
+        BigNumber k = BigNumber::multiply(x, y, MulAlgorithm::Karatsuba);
+        BigNumber n = BigNumber::multiply(x, y, MulAlgorithm::Ntt);
+        agree &= s == k && s == n && s == x * y;
+        roundtrip &= BigNumber(s.to_string()) == s;
+        BigNumber neg_y = -y;
+        identity &= (x + neg_y) * (x + y) == x * x - y * y;
+    }
+    check(agree, "schoolbook == Karatsuba == NTT on 12 size pairs (up to 4000 x 4000 limbs)");
+    BigNumber h1 = random_big(24000, rng), h2 = random_big(17000, rng);
+    check(h1 * h2 == BigNumber::multiply(h1, h2, MulAlgorithm::Karatsuba), "auto (NTT) == Karatsuba at 24000 x 17000 limbs");
+    check(roundtrip, "parse(to_string(x)) == x");
+    check(identity, "(x - y)(x + y) == x^2 - y^2");
+    std::cout << std::endl;
+}
+
+void bench_multiply() {
+    std::cout << "=== Multiply: time per product (us) ===" << std::endl;
+    std::cout << "   limbs   schoolbook    Karatsuba          NTT   auto picks" << std::endl;
+    Lcg rng{99};
+    for (std::size_t limbs : {8, 32, 128, 512, 2048, 8192, 32768}) {
+        BigNumber x = random_big(limbs, rng), y = random_big(limbs, rng);
+        auto per_product = [&](MulAlgorithm alg) -> double {
+            if (alg == MulAlgorithm::Schoolbook && limbs > 4096) return -1;  // too slow to bother
+            int reps = 1;
+            double ms = 0;
+            while (true) {  // grow reps until the sample is long enough to trust
+                ms = time_ms([&] {
+                    for (int r = 0; r < reps; ++r) do_not_optimize(BigNumber::multiply(x, y, alg));
+                });
+                if (ms > 50 || reps > (1 << 20)) break;
+                reps *= 4;
+            }
+            return ms * 1e3 / reps;
+        };
+        double s = per_product(MulAlgorithm::Schoolbook);
+        double k = per_product(MulAlgorithm::Karatsuba);
+        double n = per_product(MulAlgorithm::Ntt);
+        const char* pick = limbs < kKaratsubaThreshold ? "schoolbook" : limbs >= kNttThreshold ? "NTT" : "Karatsuba";
+
+        char line[128];
+        std::snprintf(line, sizeof(line), "  %6zu %12.2f %12.2f %12.2f   %s", limbs, s, k, n, pick);
+        std::string row = line;
+        if (s < 0) row.replace(row.find("-1.00"), 5, "  n/a");
+        std::cout << row << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void bench_printing() {
+    std::cout << "=== Printing throughput ===" << std::endl;
+    Lcg rng{7};
+    for (std::size_t limbs : {1, 4, 32, 256, 2048}) {
+        std::vector<BigNumber> values;
+        for (int i = 0; i < 16; ++i) values.push_back(random_big(limbs, rng));
+        std::size_t digits = 0;
+        int reps = std::max(1, int(200000 / (limbs * limbs)));
+        double ms = time_ms([&] {
+            for (int r = 0; r < reps; ++r)
+                for (const BigNumber& v : values) digits += v.to_string().size();
+        });
+        std::cout << "  " << limbs << " limbs (" << values[0].to_string().size() << " digits): "
+                  << digits / (ms * 1e3) << " M digits/s" << std::endl;
+    }
+
+    // Small values: BigNumber's one-limb path vs std::to_string
+    const int n = 2000000;
+    std::size_t total = 0;
+    double big_ms = time_ms([&] {
+        for (int i = 0; i < n; ++i) total += BigNumber(i * 7919LL).to_string().size();
+    });
+    double std_ms = time_ms([&] {
+        for (int i = 0; i < n; ++i) total += std::to_string(i * 7919LL).size();
+    });
+    do_not_optimize(total);
+    std::cout << "  small values: BigNumber " << big_ms * 1e6 / n << " ns, std::to_string "
+              << std_ms * 1e6 / n << " ns" << std::endl;
+    std::cout << std::endl;
+}
+
+void bench_small_path() {
+    std::cout << "=== Small-value fast path ===" << std::endl;
+    const int n = 10000000;
+    std::size_t allocs_before = BigNumber::heap_allocations();
+
+    BigNumber big_sum = 0;
+    double big_ms = time_ms([&] {
+        for (int i = 0; i < n; ++i) big_sum = big_sum + BigNumber(i % 1000) * 3;
+    });
+    long long int_sum = 0;
+    double int_ms = time_ms([&] {
+        for (int i = 0; i < n; ++i) {
+            int_sum = int_sum + (i % 1000) * 3;
+            do_not_optimize(int_sum);
+        }
+    });
+
+    std::cout << "  " << n << " x (sum + v * 3):  BigNumber " << big_ms << " ms, long long " << int_ms << " ms" << std::endl;
+    std::cout << "  heap allocations during the BigNumber loop: " << BigNumber::heap_allocations() - allocs_before
+              << std::endl;
+    check(big_sum == BigNumber(int_sum), "same result as long long");
+    std::cout << std::endl;
+}
+
+int main() {
+    std::cout << "=== BigNumber: Arbitrary-Precision Integers ===" << std::endl << std::endl;
+
+    show_operators();
+    test_correctness();
+    bench_small_path();
+    bench_multiply();
+    bench_printing();
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Same operator surface as Number, but + and ++ carry into a new limb" << std::endl;
+    std::cout << "• Values up to 2 limbs live inside the object: no heap allocation" << std::endl;
+    std::cout << "• int64-sized operands use the overflow flag, not limb loops" << std::endl;
+    std::cout << "• Karatsuba: 3 half-size products instead of 4 -> O(n^1.585)" << std::endl;
+    std::cout << "• NTT: exact FFT modulo 2^64 - 2^32 + 1 -> O(n log n) for huge operands" << std::endl;
+    std::cout << "• Printing divides by 10^19 using a precomputed reciprocal, not div" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,350 @@
+// The brace_init_compiler.cpp pipeline for real: lexing, parsing and narrowing
+// checks on brace-initialized config files (link with brace_init_engine.cpp)
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "brace_init_engine.h"
+
+// ============================================================================
+// WHAT THE ENGINE ANSWERS
+// ============================================================================
+// Generated config files use C++'s own brace syntax, so a typo like
+//
+//   Sensor probe{'a', 80800, 0.5f, {1.0, 2.0, 3.0}};    port is unsigned short
+//
+// should be caught the way a compiler catches it ("narrowing conversion of
+// '80800' from 'int' to 'unsigned short'") - without running a compiler over
+// megabytes of input. Two questions for this demo:
+//   1. Does it give the same verdict as g++? (a table of corner cases)
+//   2. How many MB/s does each stage manage, and what does SSE2 buy the lexer?
+
+// ============================================================================
+// THE VERDICTS, CASE BY CASE
+// ============================================================================
+
+const char* const kPrelude =
+    "struct Point { int x; int y; };\n"
+    "struct Line { Point start; Point end; };\n"
+    "struct Sensor { char id; unsigned short port; float gain; double offsets[3]; std::string name; };\n"
+    "const long big = 3000000000;\n"
+    "const long small = 1000;\n"
+    "constexpr double half = 0.5;\n"
+    "constexpr double huge = 1e300;\n"
+    "const double quarter = 0.25;\n"
+    "long runtime_long = 5;\n"
+    "int runtime_int = 5;\n"
+    "Point origin{0, 0};\n";
+
+struct Case {
+    const char* source;
+    bool error;
+    const char* why;
+};
+
+const Case kCases[] = {
+    {"int a{5};", false, "int literal into int"},
+    {"char c{65};", false, "constant that fits: not narrowing"},
+    {"unsigned char uc{255};", false, "255 fits unsigned char"},
+    {"short s{small};", false, "const long 1000 fits short"},
+    {"float f{half};", false, "constexpr double 0.5 is in float's range"},
+    {"double d{1.5f};", false, "float -> double widens"},
+    {"long long ll{runtime_int};", false, "long long holds every int"},
+    {"float f2{16777216};", false, "2^24 is exact in float"},
+    {"int copy_init = 2.5;", false, "T x = v: copy-initialization may narrow"},
+    {"bool b{1};", false, "constant 1 fits bool"},
+    {"int most_negative{-2147483648};", false, "long 2147483648, negated, fits int"},
+    {"unsigned u{0x80000000};", false, "hex literal: unsigned int"},
+    {"Line l{{0, 0}, {3, 4}};", false, "nested lists"},
+    {"Line elided{1, 2, 3, 4};", false, "brace elision"},
+    {"Point ps[]{1, 2, 3, 4, 5};", false, "deduced extent with elision: 3 Points"},
+    {"std::vector<Point> path{{1, 2}, {3, 4}};", false, "initializer_list of aggregates"},
+    {"Sensor s1{'a', 8080, 0.5f, {1.0, 2.0, 3.0}, \"probe\"};", false, "every member"},
+    {"Sensor s2{'b', 80, 1, 1.0, 2.0, 3.0};", false, "elided array, name value-initialized"},
+    {"Point copied{origin};", false, "single element of the same type: a copy"},
+    {"int m[2][3]{{1, 2, 3}, {4, 5, 6}};", false, "two-dimensional"},
+    {"int flat[2][3]{1, 2, 3, 4, 5};", false, "two-dimensional, elided"},
+    {"std::string name{\"config\"};", false, "string literal"},
+    {"std::string letters{65, 66};", false, "initializer_list<char>: \"AB\""},
+    {"int zero{};", false, "empty braces: value-initialized"},
+    {"char newline{'\\n'};", false, "escape sequence"},
+    {"unsigned long long all_ones{18446744073709551615u};", false, "largest literal"},
+    {"long double ld{1e300};", false, "double -> long double"},
+    {"int separated{1'000'000};", false, "digit separators"},
+    {"const int n = 7; char from_const{n};", false, "const int 7 fits char"},
+    {"int r{2.5};", true, "floating -> integer"},
+    {"int r2{2.0};", true, "floating -> integer even when exact"},
+    {"char c2{200};", true, "200 doesn't fit char"},
+    {"unsigned u2{-1};", true, "negative into unsigned"},
+    {"short s4{big};", true, "const long 3000000000 doesn't fit short"},
+    {"int r3{runtime_long};", true, "non-constant long -> int"},
+    {"unsigned long ul{runtime_int};", true, "non-constant int may be negative"},
+    {"float f3{huge};", true, "1e300 is out of float's range"},
+    {"float f5{quarter};", true, "a const double isn't a constant expression"},
+    {"float f4{16777217};", true, "2^24 + 1 isn't exact in float"},
+    {"double d2{runtime_int};", true, "non-constant integer -> floating"},
+    {"bool b2{2};", true, "2 doesn't fit bool"},
+    {"int r4 = {2.5};", true, "T x = {v} checks narrowing too"},
+    {"Point p{1.5, 2};", true, "narrowing inside an aggregate"},
+    {"Line l2{1, 2, 3, 4, 5};", true, "too many initializers"},
+    {"int a2[2]{1, 2, 3};", true, "more elements than the extent"},
+    {"std::vector<int> v{1, 2.5};", true, "narrowing in an initializer_list"},
+    {"int x2{1, 2};", true, "two values for a scalar"},
+    {"std::string s3{300};", true, "initializer_list<char>: 300 doesn't fit char"},
+    {"Widget w{1};", true, "unknown type"},
+    {"int y{undeclared};", true, "unknown name"},
+    {"unsigned char uc2{-1};", true, "-1 doesn't fit unsigned char"},
+    {"int e{1e3};", true, "1e3 is a double"},
+    {"long huge_literal{100000000000000000000};", true, "literal too large for any type"},
+    {"int n2 = 7; char from_var{n2};", true, "n2 isn't const: only its type counts"},
+};
+
+std::string case_source() {
+    std::string text = kPrelude;
+    for (const Case& c : kCases) text += std::string(c.source) + "\n";
+    return text;
+}
+
+std::uint32_t prelude_lines() {
+    std::uint32_t n = 0;
+    for (const char* p = kPrelude; *p; ++p) n += *p == '\n';
+    return n;
+}
+
+std::string run(const std::string& command) {
+    std::string text;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return text;
+    char buf[4096];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof buf, pipe)) > 0) text.append(buf, n);
+    pclose(pipe);
+    return text;
+}
+
+// Lines g++ rejects, numbered like the case source (two #include lines dropped).
+// g++ only warns about some ill-formed code (narrowing from a non-constant,
+// a literal too large for long long): -pedantic-errors makes those errors.
+bool gxx_error_lines(const std::string& source, std::set<std::uint32_t>& lines) {
+    if (run("command -v g++").empty()) return false;
+    char path[] = "/tmp/brace_init_cases_XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) return false;
+    std::string text = "#include <string>\n#include <vector>\n" + source;
+    bool written = write(fd, text.data(), text.size()) == ssize_t(text.size());
+    close(fd);
+    std::string cpp = std::string(path) + ".cpp";
+    std::rename(path, cpp.c_str());
+    std::string output = written ? run("g++ -std=c++17 -fsyntax-only -pedantic-errors -x c++ " + cpp + " 2>&1") : "";
+    unlink(cpp.c_str());
+    // "/tmp/brace_init_cases_XXXXXX.cpp:41:7: error: narrowing conversion ..."
+    for (std::size_t at = output.find(cpp + ":"); at != std::string::npos; at = output.find(cpp + ":", at + 1)) {
+        std::size_t number = at + cpp.size() + 1;
+        std::size_t colon = output.find(':', number);
+        std::size_t kind = output.find(": ", colon + 1);
+        if (colon == std::string::npos || kind == std::string::npos) break;
+        if (output.compare(kind + 2, 5, "error") == 0)
+            lines.insert(std::uint32_t(std::stoul(output.substr(number, colon - number))) - 2);
+    }
+    return true;
+}
+
+void check_cases() {
+    std::cout << "=== Verdicts on " << sizeof kCases / sizeof kCases[0] << " Corner Cases ===" << std::endl;
+    std::string source = case_source();
+    BraceInitEngine engine;
+    engine.run(source);
+    std::set<std::uint32_t> ours;
+    for (const Diagnostic& d : engine.diagnostics()) ours.insert(d.line);
+
+    std::uint32_t first = prelude_lines() + 1;
+    int wrong = 0;
+    for (std::size_t i = 0; i < sizeof kCases / sizeof kCases[0]; ++i) {
+        const Case& c = kCases[i];
+        bool flagged = ours.count(first + std::uint32_t(i)) > 0;
+        if (flagged != c.error) {
+            ++wrong;
+            std::cout << "  expected " << (c.error ? "an error" : "no error") << ": " << c.source << std::endl;
+        }
+    }
+    check(wrong == 0 && ours.size() > 0 && *ours.begin() >= first, "every case gets the expected verdict");
+
+    std::cout << "  some of the diagnostics:" << std::endl;
+    int shown = 0;
+    for (const Diagnostic& d : engine.diagnostics())
+        if (shown++ < 6) std::cout << "    " << d.line << ":" << d.column << ": " << d.message << std::endl;
+
+    std::set<std::uint32_t> theirs;
+    if (!gxx_error_lines(source, theirs)) {
+        std::cout << "  (g++ not found - comparison skipped)" << std::endl << std::endl;
+        return;
+    }
+    std::size_t disagree = 0;
+    for (std::uint32_t line = 1; line <= first + sizeof kCases / sizeof kCases[0]; ++line)
+        if (ours.count(line) != theirs.count(line)) {
+            ++disagree;
+            std::cout << "  g++ " << (theirs.count(line) ? "rejects" : "accepts") << " line " << line << std::endl;
+        }
+    check(disagree == 0, "g++ -pedantic-errors rejects exactly the same lines (" + std::to_string(theirs.size()) + ")");
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// A MULTI-MEGABYTE CONFIG
+// ============================================================================
+
+struct Generated {
+    std::string text;
+    std::set<std::uint32_t> bad_lines;  // where a narrowing conversion was planted
+};
+
+Generated generate(std::size_t bytes) {
+    Generated g;
+    g.text = kPrelude;
+    std::uint32_t line = prelude_lines();
+    std::mt19937 rng(7);
+    auto num = [&](int range) { return std::to_string(int(rng() % unsigned(range)) - range / 4); };
+    for (std::size_t i = 0; g.text.size() < bytes; ++i) {
+        std::string id = std::to_string(i);
+        std::string decl;
+        switch (rng() % 8) {
+        case 0: decl = "Point p" + id + "{" + num(1000) + ", " + num(1000) + "};"; break;
+        case 1: decl = "Line l" + id + "{{" + num(100) + ", " + num(100) + "}, {" + num(100) + ", " + num(100) + "}};"; break;
+        case 2: decl = "Line e" + id + "{" + num(100) + ", " + num(100) + ", " + num(100) + ", " + num(100) + "};"; break;
+        case 3:
+            decl = "Sensor s" + id + "{'s', " + std::to_string(rng() % 65536) + ", 0.5f, {1.0, 2.5, " + num(100) +
+                   ".25}, \"sensor-" + id + "\"};";
+            break;
+        case 4: {
+            decl = "int samples" + id + "[]{";
+            for (int k = 0; k < 16; ++k) decl += (k ? ", " : "") + num(100000);
+            decl += "};";
+            break;
+        }
+        case 5: decl = "std::vector<double> weights" + id + "{0.5, 0.25, " + num(10) + ", 2e-3, 1.5e+2};"; break;
+        case 6: decl = "std::vector<Point> path" + id + "{{1, 2}, {3, 4}, {" + num(50) + ", " + num(50) + "}};"; break;
+        default: decl = "    const long limit" + id + " = " + std::to_string(rng() % 30000) + "; short port" + id +
+                        "{limit" + id + "};  // fits"; break;
+        }
+        if (rng() % 500 == 0) {  // plant a narrowing conversion
+            decl = rng() % 2 ? "int bad" + id + "{2.5};" : "unsigned char bad" + id + "{" + std::to_string(256 + rng() % 1000) + "};";
+            g.bad_lines.insert(line + 1);
+        }
+        g.text += decl;
+        g.text += "\n";
+        ++line;
+        if (i % 64 == 0) {
+            g.text += "/* section " + id + " */\n";
+            ++line;
+        }
+    }
+    return g;
+}
+
+void report(const char* what, double ms, std::size_t bytes) {
+    std::cout << "  " << what << ms << " ms  (" << double(bytes) / 1e3 / ms << " MB/s)" << std::endl;
+}
+
+void benchmark(std::size_t megabytes) {
+    Generated g = generate(megabytes << 20);
+    std::size_t bytes = g.text.size();
+    std::cout << "=== Throughput on a " << bytes / (1 << 20) << " MB Config ===" << std::endl;
+
+    // Lexer alone: byte loop vs SSE2, same tokens?
+    std::vector<Token> scalar_tokens, simd_tokens;
+    scalar_tokens.reserve(bytes / 3);
+    simd_tokens.reserve(bytes / 3);
+    tokenize(g.text, scalar_tokens, false);  // warm up
+    tokenize(g.text, simd_tokens, true);
+    double scalar_ms = 1e30, simd_ms = 1e30;
+    for (int round = 0; round < 3; ++round) {
+        scalar_ms = std::min(scalar_ms, time_ms([&] {
+                                 scalar_tokens.clear();
+                                 tokenize(g.text, scalar_tokens, false);
+                             }));
+        simd_ms = std::min(simd_ms, time_ms([&] {
+                               simd_tokens.clear();
+                               tokenize(g.text, simd_tokens, true);
+                           }));
+    }
+    // The floor: only storing that many 16-byte tokens, no scanning at all
+    std::vector<Token> stored;
+    stored.reserve(bytes / 3);
+    double store_ms = 1e30;
+    for (int round = 0; round < 3; ++round)
+        store_ms = std::min(store_ms, time_ms([&] {
+                                stored.clear();
+                                for (const Token& t : scalar_tokens) stored.push_back(t);
+                                do_not_optimize(stored.data());
+                            }));
+    report("lex, byte at a time     ", scalar_ms, bytes);
+    report("lex, SSE2               ", simd_ms, bytes);
+    report("store the tokens only   ", store_ms, bytes);
+    std::cout << "  scanning beyond the stores: byte loop " << scalar_ms - store_ms << " ms, SSE2 "
+              << simd_ms - store_ms << " ms" << std::endl;
+    bool same = scalar_tokens.size() == simd_tokens.size();
+    for (std::size_t i = 0; same && i < simd_tokens.size(); ++i)
+        same = scalar_tokens[i].kind == simd_tokens[i].kind && scalar_tokens[i].offset == simd_tokens[i].offset &&
+               scalar_tokens[i].length == simd_tokens[i].length && scalar_tokens[i].line == simd_tokens[i].line;
+    check(same, "identical token streams (" + std::to_string(simd_tokens.size()) + " tokens)");
+
+    BraceInitEngine engine;
+    engine.run(g.text);  // warm up: arena chunks, tables
+    std::size_t reserved = engine.arena_bytes();
+    double lex_ms = 1e30, parse_ms = 1e30, check_ms = 1e30;
+    for (int round = 0; round < 3; ++round) {
+        lex_ms = std::min(lex_ms, time_ms([&] { engine.lex(g.text); }));
+        parse_ms = std::min(parse_ms, time_ms([&] { engine.parse(); }));
+        check_ms = std::min(check_ms, time_ms([&] { engine.check(); }));
+    }
+    report("lex                     ", lex_ms, bytes);
+    report("parse (AST in the arena)", parse_ms, bytes);
+    report("check                   ", check_ms, bytes);
+    report("all three               ", lex_ms + parse_ms + check_ms, bytes);
+    std::cout << "  " << engine.variables().size() << " variables, " << engine.list_count() << " braced-init-lists, "
+              << engine.arena_bytes() / 1024 << " KiB of arena" << std::endl;
+    check(engine.arena_bytes() == reserved, "second run reuses the arena's chunks");
+
+    std::set<std::uint32_t> flagged;
+    for (const Diagnostic& d : engine.diagnostics()) flagged.insert(d.line);
+    check(flagged == g.bad_lines && engine.diagnostics().size() == g.bad_lines.size(),
+          "exactly the " + std::to_string(g.bad_lines.size()) + " planted narrowing conversions reported");
+    if (!engine.diagnostics().empty()) {
+        const Diagnostic& d = engine.diagnostics().front();
+        std::cout << "  first: " << d.line << ":" << d.column << ": " << d.message << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Brace-Initialization Engine: Lexer, Parser, Narrowing Checker ===" << std::endl;
+    std::cout << std::endl;
+    std::size_t megabytes = argc > 1 ? std::size_t(std::atol(argv[1])) : 16;
+
+    check_cases();
+    benchmark(megabytes);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Narrowing depends on the value only for constants: char c{65} is fine, char c{i} is not" << std::endl;
+    std::cout << "• Integer -> floating narrows too, unless the constant survives the round trip" << std::endl;
+    std::cout << "• Brace elision: an aggregate member takes a nested list or as many plain values as it needs"
+              << std::endl;
+    std::cout << "• SSE2 turns 64 bytes into bitmasks: ctz(starts) is the next token, whitespace is never visited"
+              << std::endl;
+    std::cout << "• Short tokens: storing 16 bytes per token is ~40% of lexing, and SIMD only speeds up the rest"
+              << std::endl;
+    std::cout << "• Nodes in a bump arena, lists collected on a scratch stack: parsing allocates in chunks"
+              << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
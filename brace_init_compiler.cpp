@@ -114,6 +114,10 @@ void show_overload_resolution() {
 //     }
 //     return false;
 // }
+//
+// A sketch: it calls char c{65} narrowing (a constant that fits isn't) and
+// misses int -> float. brace_init_engine.cpp has the complete rule, checked
+// against g++ by brace_init_bench.cpp.
 
 void show_narrowing_detection() {
     std::cout << "=== Narrowing Detection ===" << std::endl << std::endl;
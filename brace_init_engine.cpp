@@ -0,0 +1,1336 @@
+// Brace-initialization engine (see brace_init_engine.h): lexer, parser, checker
+#include "brace_init_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+constexpr int kMaxDepth = 256;      // nested braces / template arguments
+constexpr int kMaxExtents = 8;      // int x[2][3]...
+constexpr std::size_t kMaxLiteral = 128;
+
+// ============================================================================
+// LEXER
+// ============================================================================
+//
+// A config file is mostly short tokens: a name, one space, a two-digit
+// number, a comma. The byte loop pays for every byte (load, table lookup,
+// branch) and dispatches every token on its first character. The SSE2 lexer
+// classifies 64 bytes at a time into bitmasks instead, one bit per byte
+// (bit 0 = first byte, shown left), and derives where tokens START:
+//
+//   bytes   "Point p{12, -7};"
+//   ident    1111101011000100
+//   space    0000010000100000
+//   starts   1000001110010111    ident runs begin + every other non-space byte
+//
+// ctz(starts) is the next token; ctz(~ident >> i) is where a name or number
+// beginning at bit i ends. Whitespace is never looked at. Line numbers come
+// from a newline mask: a token's line is 1 + the newlines before it.
+// Strings, comments and the rare cases (1'000, 1e+5, ::) go through the same
+// one-token scalar code the byte loop uses; the start bits they cover are
+// dropped.
+
+enum : std::uint8_t {
+    kSpace = 1,    // ' ' \t \n \r \v \f
+    kIdent = 2,    // [A-Za-z0-9_]
+    kNumber = 4,   // pp-number body: identifier characters, '.' and '\''
+};
+
+struct CharClasses {
+    std::uint8_t of[256] = {};
+    constexpr CharClasses() {
+        for (char c : {' ', '\t', '\n', '\r', '\v', '\f'}) of[static_cast<unsigned char>(c)] = kSpace;
+        for (int c = 0; c < 256; ++c) {
+            bool alpha = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+            if (alpha || (c >= '0' && c <= '9') || c == '_') of[c] = kIdent | kNumber;
+        }
+        of[static_cast<unsigned char>('.')] = kNumber;
+        of[static_cast<unsigned char>('\'')] = kNumber;
+    }
+};
+
+constexpr CharClasses kClasses;
+
+inline std::uint8_t char_class(char c) { return kClasses.of[static_cast<unsigned char>(c)]; }
+
+inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+// Single-character tokens; everything else maps to Invalid
+struct Punctuation {
+    TokenKind of[256] = {};
+    constexpr Punctuation() {
+        for (TokenKind& k : of) k = TokenKind::Invalid;
+        of[static_cast<unsigned char>('{')] = TokenKind::LBrace;
+        of[static_cast<unsigned char>('}')] = TokenKind::RBrace;
+        of[static_cast<unsigned char>('[')] = TokenKind::LBracket;
+        of[static_cast<unsigned char>(']')] = TokenKind::RBracket;
+        of[static_cast<unsigned char>('<')] = TokenKind::Less;
+        of[static_cast<unsigned char>('>')] = TokenKind::Greater;
+        of[static_cast<unsigned char>(',')] = TokenKind::Comma;
+        of[static_cast<unsigned char>(';')] = TokenKind::Semicolon;
+        of[static_cast<unsigned char>('=')] = TokenKind::Equals;
+        of[static_cast<unsigned char>('+')] = TokenKind::Plus;
+        of[static_cast<unsigned char>('-')] = TokenKind::Minus;
+    }
+};
+
+constexpr Punctuation kPunctuation;
+
+inline TokenKind punctuation(char c) { return kPunctuation.of[static_cast<unsigned char>(c)]; }
+
+const char* skip_class(const char* p, const char* end, std::uint8_t cls) {
+    while (p < end && (char_class(*p) & cls)) ++p;
+    return p;
+}
+
+// A pp-number continues as C++ lexes it: 1.5e+3, 0x1F, 1'000'000, 2.5f -
+// and 0x1e+5, which is one (invalid) token in C++ too. p is past the part
+// already scanned; returns the end.
+const char* finish_number(const char* p, const char* end) {
+    for (;;) {
+        p = skip_class(p, end, kNumber);
+        bool exponent = p < end && (*p == '+' || *p == '-') &&
+                        (p[-1] == 'e' || p[-1] == 'E' || p[-1] == 'p' || p[-1] == 'P');
+        if (!exponent) return p;
+        ++p;
+    }
+}
+
+TokenKind number_kind(const char* start, const char* stop) {
+    bool hex = stop - start > 1 && start[0] == '0' && (start[1] == 'x' || start[1] == 'X');
+    for (const char* q = start; q < stop; ++q)
+        if (*q == '.' || (hex ? (*q == 'p' || *q == 'P') : (*q == 'e' || *q == 'E'))) return TokenKind::Float;
+    return TokenKind::Integer;
+}
+
+// The closing quote of a char or string literal, or nullptr when the line
+// or input ends first
+const char* skip_quoted(const char* p, const char* end, char quote) {
+    while (p < end) {
+        char c = *p;
+        if (c == quote) return p + 1;
+        if (c == '\n') return nullptr;
+        p += c == '\\' ? 2 : 1;
+    }
+    return nullptr;
+}
+
+struct Emitter {
+    const char* begin;
+    std::vector<Token>& out;
+
+    void operator()(TokenKind kind, const char* from, const char* to, std::uint32_t line) const {
+        out.push_back(Token{kind, std::uint32_t(from - begin), std::uint32_t(to - from), line});
+    }
+};
+
+// One token starting at p (not whitespace); returns its end. Comments emit
+// nothing. Newlines inside the token are the caller's to count.
+const char* lex_token(const char* p, const char* end, std::uint32_t line, const Emitter& emit) {
+    const char* start = p;
+    char c = *p;
+
+    if (char_class(c) & kIdent) {
+        if (is_digit(c)) {
+            p = finish_number(p + 1, end);
+            emit(number_kind(start, p), start, p, line);
+        } else {
+            p = skip_class(p + 1, end, kIdent);
+            emit(TokenKind::Identifier, start, p, line);
+        }
+        return p;
+    }
+
+    switch (c) {
+    case '.':
+        if (p + 1 < end && is_digit(p[1])) {  // .5
+            p = finish_number(p + 1, end);
+            emit(TokenKind::Float, start, p, line);
+            return p;
+        }
+        break;
+    case '"':
+    case '\'': {
+        const char* close = skip_quoted(p + 1, end, c);
+        if (!close) {
+            p = std::find(p, end, '\n');
+            emit(TokenKind::Invalid, start, p, line);
+        } else {
+            p = close;
+            emit(c == '"' ? TokenKind::String : TokenKind::Char, start, p, line);
+        }
+        return p;
+    }
+    case '/':
+        if (p + 1 < end && p[1] == '/') {
+            const void* nl = std::memchr(p, '\n', std::size_t(end - p));  // glibc's memchr is SIMD too
+            return nl ? static_cast<const char*>(nl) : end;
+        }
+        if (p + 1 < end && p[1] == '*') {
+            std::string_view rest(p + 2, std::size_t(end - p - 2));
+            std::size_t close = rest.find("*/");
+            if (close == std::string_view::npos) {
+                emit(TokenKind::Invalid, start, end, line);
+                return end;
+            }
+            return p + 2 + close + 2;
+        }
+        break;
+    case ':':
+        if (p + 1 < end && p[1] == ':') {
+            emit(TokenKind::Scope, start, p + 2, line);
+            return p + 2;
+        }
+        break;
+    default:
+        break;
+    }
+
+    emit(punctuation(c), start, p + 1, line);
+    return p + 1;
+}
+
+// ----- byte at a time -----
+
+void lex_bytes(std::string_view source, std::vector<Token>& out) {
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    const Emitter emit{begin, out};
+    std::uint32_t line = 1;
+
+    for (const char* p = begin;;) {
+        for (; p < end && (char_class(*p) & kSpace); ++p) line += *p == '\n';
+        if (p == end) break;
+        const char* next = lex_token(p, end, line, emit);
+        if (*p == '/' || *p == '"' || *p == '\'')  // /* */ comments, and "a\<newline>b" splices
+            line += std::uint32_t(std::count(p, next, '\n'));
+        p = next;
+    }
+    emit(TokenKind::End, end, end, line);
+}
+
+// ----- 64 bytes at a time -----
+
+#if defined(__SSE2__)
+
+inline std::uint64_t movemask(__m128i v) { return static_cast<std::uint32_t>(_mm_movemask_epi8(v)); }
+
+inline __m128i in_range(__m128i v, char lo, char hi) {
+    // Signed compares: bytes >= 0x80 are negative and never in an ASCII range
+    return _mm_and_si128(_mm_cmpgt_epi8(v, _mm_set1_epi8(char(lo - 1))), _mm_cmplt_epi8(v, _mm_set1_epi8(char(hi + 1))));
+}
+
+struct BlockMasks {
+    std::uint64_t space, newline, ident, number;  // number: ident plus '.'
+};
+
+BlockMasks classify(const char* block) {
+    BlockMasks m{0, 0, 0, 0};
+    for (int k = 0; k < 4; ++k) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * k));
+        __m128i space = _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), in_range(v, '\t', '\r'));
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));  // 'A'..'Z' -> 'a'..'z'
+        __m128i ident = _mm_or_si128(_mm_or_si128(in_range(lower, 'a', 'z'), in_range(v, '0', '9')),
+                                     _mm_cmpeq_epi8(v, _mm_set1_epi8('_')));
+        m.space |= movemask(space) << (16 * k);
+        m.newline |= movemask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))) << (16 * k);
+        m.ident |= movemask(ident) << (16 * k);
+        m.number |= movemask(_mm_or_si128(ident, _mm_cmpeq_epi8(v, _mm_set1_epi8('.')))) << (16 * k);
+    }
+    return m;
+}
+
+// Bits at and above n (n may be 64)
+inline std::uint64_t from_bit(std::size_t n) { return n >= 64 ? 0 : ~std::uint64_t(0) << n; }
+
+// Without -mpopcnt, __builtin_popcountll is a library call. Most tokens
+// have no newline before them in their block, and the rest one or two.
+inline std::uint32_t count_bits(std::uint64_t m) {
+    std::uint32_t n = 0;
+    for (; m; m &= m - 1) ++n;
+    return n;
+}
+
+void lex_blocks(std::string_view source, std::vector<Token>& out) {
+    const char* begin = source.data();
+    const char* end = begin + source.size();
+    const Emitter emit{begin, out};
+    std::uint32_t line = 1;
+    const char* resume = begin;       // everything before this belongs to a token
+    std::uint64_t ident_carry = 0;    // did the previous block end inside a name?
+
+    for (const char* base = begin; base < end; base += 64) {
+        std::size_t size = std::size_t(end - base);
+        BlockMasks m;
+        if (size >= 64) {
+            m = classify(base);
+        } else {
+            alignas(16) char tail[64] = {};  // zeros: not space, not ident - and masked off below
+            std::memcpy(tail, base, size);
+            m = classify(tail);
+        }
+        std::uint64_t valid = size >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << size) - 1;
+        std::uint64_t name_starts = m.ident & ~((m.ident << 1) | ident_carry);
+        std::uint64_t starts = (name_starts | (~m.space & ~m.ident)) & valid;
+        ident_carry = m.ident >> 63;
+        std::uint64_t newlines = m.newline & valid;
+        if (resume > base) starts &= from_bit(std::size_t(resume - base));
+
+        while (starts) {
+            unsigned i = unsigned(__builtin_ctzll(starts));
+            std::uint64_t before = newlines & ((std::uint64_t(1) << i) - 1);
+            if (before) {
+                line += count_bits(before);
+                newlines &= ~before;
+            }
+            const char* p = base + i;
+            const char* next;
+            if (m.ident >> i & 1) {
+                bool number = is_digit(*p);
+                std::uint64_t rest = ~(number ? m.number : m.ident) >> i;
+                // A run to the end of the block continues in the next one
+                next = rest ? p + __builtin_ctzll(rest) : skip_class(base + 64, end, number ? kNumber : kIdent);
+                if (number) {
+                    next = finish_number(next, end);  // 1'000, 1e+5
+                    emit(number_kind(p, next), p, next, line);
+                } else {
+                    emit(TokenKind::Identifier, p, next, line);
+                }
+            } else if (TokenKind kind = punctuation(*p); kind != TokenKind::Invalid) {
+                next = p + 1;
+                emit(kind, p, next, line);
+            } else {
+                next = lex_token(p, end, line, emit);  // literals, comments, '::', '.5', strays
+            }
+            resume = next;
+            starts &= from_bit(std::size_t(next - base));
+        }
+        line += count_bits(newlines);
+    }
+    emit(TokenKind::End, end, end, line);
+}
+
+#endif
+
+// ============================================================================
+// ARITHMETIC TYPES
+// ============================================================================
+
+struct ScalarInfo {
+    const char* name;
+    bool floating;
+    __int128 min;  // integers
+    __int128 max;
+    int rank;      // floating: float < double < long double
+};
+
+template <typename T>
+constexpr ScalarInfo integer_info(const char* name) {
+    return ScalarInfo{name, false, std::numeric_limits<T>::min(), std::numeric_limits<T>::max(), 0};
+}
+
+const ScalarInfo kScalars[] = {
+    integer_info<bool>("bool"),
+    integer_info<char>("char"),
+    integer_info<signed char>("signed char"),
+    integer_info<unsigned char>("unsigned char"),
+    integer_info<short>("short"),
+    integer_info<unsigned short>("unsigned short"),
+    integer_info<int>("int"),
+    integer_info<unsigned int>("unsigned int"),
+    integer_info<long>("long"),
+    integer_info<unsigned long>("unsigned long"),
+    integer_info<long long>("long long"),
+    integer_info<unsigned long long>("unsigned long long"),
+    {"float", true, 0, 0, 1},
+    {"double", true, 0, 0, 2},
+    {"long double", true, 0, 0, 3},
+};
+
+inline const ScalarInfo& info(Scalar s) { return kScalars[static_cast<int>(s)]; }
+
+long double floating_max(Scalar s) {
+    if (s == Scalar::Float) return std::numeric_limits<float>::max();
+    if (s == Scalar::Double) return std::numeric_limits<double>::max();
+    return std::numeric_limits<long double>::max();
+}
+
+// The value as the target type stores it (rounded to float, ...)
+long double round_to(Scalar s, long double v) {
+    if (s == Scalar::Float) return static_cast<float>(v);
+    if (s == Scalar::Double) return static_cast<double>(v);
+    return v;
+}
+
+// brace_init_compiler.cpp's is_narrowing(), completed: a constant that fits
+// is fine even into a smaller type (char c{65}), and integer -> floating
+// narrows too unless the constant survives the round trip
+bool is_narrowing(Scalar source, Scalar target, const Value& value) {
+    const ScalarInfo& from = info(source);
+    const ScalarInfo& to = info(target);
+    if (!to.floating && from.floating) return true;  // even 2.0 -> int
+    if (!to.floating && !from.floating) {
+        if (from.min >= to.min && from.max <= to.max) return false;  // every value fits
+        if (value.known) return value.integer < to.min || value.integer > to.max;
+        return true;
+    }
+    if (to.floating && !from.floating) {
+        if (!value.known) return true;  // even int -> double: not every long fits exactly
+        long double converted = round_to(target, static_cast<long double>(value.integer));
+        return static_cast<__int128>(converted) != value.integer;
+    }
+    if (to.rank >= from.rank) return false;
+    if (value.known) return std::isfinite(value.real) && std::fabs(value.real) > floating_max(target);
+    return true;
+}
+
+// What a constant becomes once stored in `target` (for const variables)
+Value convert(const Value& v, bool source_floating, Scalar target) {
+    Value out;
+    if (!v.known) return out;
+    const ScalarInfo& to = info(target);
+    out.known = true;
+    out.floating = to.floating;
+    if (to.floating) {
+        out.real = round_to(target, source_floating ? v.real : static_cast<long double>(v.integer));
+        return out;
+    }
+    __int128 i;
+    if (source_floating) {
+        if (!std::isfinite(v.real) || std::fabs(v.real) > 1.8e19L) return Value{};  // undefined behavior
+        i = static_cast<__int128>(v.real);
+    } else {
+        i = v.integer;
+    }
+    if (target == Scalar::Bool) {
+        out.integer = i != 0;
+    } else if (i < to.min || i > to.max) {
+        // Modular, like the conversion the compiler would emit
+        __int128 span = to.max - to.min + 1;
+        i = ((i - to.min) % span + span) % span + to.min;
+        out.integer = i;
+    } else {
+        out.integer = i;
+    }
+    return out;
+}
+
+const Type kArithmetic[] = {
+    Type(Type::Arithmetic, Scalar::Bool),          Type(Type::Arithmetic, Scalar::Char),
+    Type(Type::Arithmetic, Scalar::SignedChar),    Type(Type::Arithmetic, Scalar::UnsignedChar),
+    Type(Type::Arithmetic, Scalar::Short),         Type(Type::Arithmetic, Scalar::UnsignedShort),
+    Type(Type::Arithmetic, Scalar::Int),           Type(Type::Arithmetic, Scalar::UnsignedInt),
+    Type(Type::Arithmetic, Scalar::Long),          Type(Type::Arithmetic, Scalar::UnsignedLong),
+    Type(Type::Arithmetic, Scalar::LongLong),      Type(Type::Arithmetic, Scalar::UnsignedLongLong),
+    Type(Type::Arithmetic, Scalar::Float),         Type(Type::Arithmetic, Scalar::Double),
+    Type(Type::Arithmetic, Scalar::LongDouble),
+};
+const Type kString(Type::String);
+
+inline const Type* arithmetic(Scalar s) { return &kArithmetic[static_cast<int>(s)]; }
+
+bool same_type(const Type* a, const Type* b) {
+    if (a == b) return true;
+    if (a->kind != b->kind) return false;
+    switch (a->kind) {
+    case Type::Arithmetic: return a->scalar == b->scalar;
+    case Type::String: return true;
+    case Type::Struct: return false;  // one Type per struct declaration
+    case Type::Array: return a->extent == b->extent && same_type(a->element, b->element);
+    case Type::Vector: return same_type(a->element, b->element);
+    }
+    return false;
+}
+
+std::string type_name(const Type* t) {
+    switch (t->kind) {
+    case Type::Arithmetic: return info(t->scalar).name;
+    case Type::String: return "std::string";
+    case Type::Struct: return std::string(t->name);
+    case Type::Vector: return "std::vector<" + type_name(t->element) + ">";
+    case Type::Array: {
+        std::string dims;
+        for (; t->kind == Type::Array; t = t->element)
+            dims += t->extent < 0 ? std::string("[]") : "[" + std::to_string(t->extent) + "]";
+        return type_name(t) + " " + dims;
+    }
+    }
+    return "?";
+}
+
+bool is_keyword(std::string_view s) {
+    static const char* const kKeywords[] = {"bool",  "char",  "short",  "int",       "long", "float",
+                                            "double", "signed", "unsigned", "struct", "const", "constexpr",
+                                            "true",  "false"};
+    for (const char* k : kKeywords)
+        if (s == k) return true;
+    return false;
+}
+
+// ============================================================================
+// NAME TABLE
+// ============================================================================
+//
+// Every name in an initializer is looked up, and every declaration checks
+// for a redefinition. std::unordered_map chains a heap node per name, so a
+// lookup among 100k+ names is a walk through cold memory. Open addressing
+// keeps names in one flat array instead:
+//
+//   slots [ p12 | --- | l7 | e3 | --- | ... ]   hash & mask, then step right
+//
+// Never more than half full, so a miss stops at an empty slot in a step or
+// two. clear() empties the slots but keeps them for the next file.
+
+template <typename T>
+class NameTable {
+public:
+    const T* find(std::string_view name) const {
+        if (slots_.empty()) return nullptr;
+        std::size_t mask = slots_.size() - 1;
+        for (std::size_t i = hash(name) & mask;; i = (i + 1) & mask) {
+            const Slot& s = slots_[i];
+            if (!s.value) return nullptr;
+            if (s.name == name) return s.value;
+        }
+    }
+
+    // name must not be present yet
+    void insert(std::string_view name, const T* value) {
+        if (2 * (size_ + 1) > slots_.size()) grow();
+        place(name, value);
+        ++size_;
+    }
+
+    void clear() {
+        std::fill(slots_.begin(), slots_.end(), Slot{});
+        size_ = 0;
+    }
+
+private:
+    struct Slot {
+        std::string_view name;
+        const T* value = nullptr;  // nullptr: empty
+    };
+
+    static std::size_t hash(std::string_view name) {
+        std::uint64_t h = 14695981039346656037ull;  // FNV-1a
+        for (char c : name) h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        return std::size_t(h ^ (h >> 29));  // mix the high bits into the ones the mask keeps
+    }
+
+    void place(std::string_view name, const T* value) {
+        std::size_t mask = slots_.size() - 1;
+        std::size_t i = hash(name) & mask;
+        while (slots_[i].value) i = (i + 1) & mask;
+        slots_[i] = Slot{name, value};
+    }
+
+    void grow() {
+        std::vector<Slot> old(std::max<std::size_t>(64, 2 * slots_.size()));
+        old.swap(slots_);
+        for (const Slot& s : old)
+            if (s.value) place(s.name, s.value);
+    }
+
+    std::vector<Slot> slots_;  // a power of two
+    std::size_t size_ = 0;
+};
+
+}  // namespace
+
+const char* scalar_name(Scalar s) { return info(s).name; }
+
+void tokenize(std::string_view source, std::vector<Token>& out, bool simd) {
+#if defined(__SSE2__)
+    if (simd) return lex_blocks(source, out);
+#endif
+    (void)simd;
+    lex_bytes(source, out);
+}
+
+// ============================================================================
+// PARSER
+// ============================================================================
+//
+//   config      := { struct-decl | variable }
+//   struct-decl := 'struct' name '{' { type name extents { ',' name extents } ';' } '}' ';'
+//   variable    := [ 'const' | 'constexpr' ] type name extents [ initializer ] ';'
+//   initializer := braced-init-list | '=' braced-init-list | '=' clause
+//   braced-init-list := '{' [ clause { ',' clause } [ ',' ] ] '}'
+//   clause      := braced-init-list | [ '+' | '-' ] literal | name | 'true' | 'false'
+//   type        := arithmetic keywords | 'std' '::' 'string'
+//                | 'std' '::' 'vector' '<' type '>' | struct-name
+//   extents     := { '[' [ integer ] ']' }
+//
+// One function per rule. Nodes go into the Arena; the elements of a list are
+// collected on a scratch stack (nested lists push above their parent's) and
+// copied into the arena once the '}' shows how many there are.
+
+struct BraceInitEngine::State {
+    std::string_view source;
+    std::vector<Token> tokens;
+    bool simd = true;
+
+    Arena arena;
+    std::vector<VarDecl*> decls;
+    std::vector<const VarDecl*> variables;
+    std::vector<const Type*> structs;
+    std::vector<Diagnostic> diagnostics;
+    NameTable<Type> struct_names;
+    NameTable<VarDecl> var_names;
+    std::vector<const Init*> scratch;
+    std::vector<Member> member_scratch;
+    std::size_t lists = 0;
+
+    std::size_t pos = 0;
+    int depth = 0;
+    bool failed = false;  // the current declaration already has a syntax error
+
+    // ----- tokens -----
+
+    const Token& peek(std::size_t ahead = 0) const { return tokens[std::min(pos + ahead, tokens.size() - 1)]; }
+    std::string_view text(const Token& t) const { return source.substr(t.offset, t.length); }
+    std::string_view text(std::uint32_t first, std::uint32_t last) const {
+        return source.substr(tokens[first].offset, tokens[last].offset + tokens[last].length - tokens[first].offset);
+    }
+    bool at(TokenKind kind) const { return peek().kind == kind; }
+    bool at_word(const char* word) const { return at(TokenKind::Identifier) && text(peek()) == word; }
+
+    // ----- diagnostics -----
+
+    void report(const Token& t, std::string message) {
+        std::size_t line_start = t.offset == 0 ? std::string_view::npos : source.rfind('\n', t.offset - 1);
+        std::uint32_t column = std::uint32_t(t.offset - (line_start == std::string_view::npos ? 0 : line_start + 1) + 1);
+        diagnostics.push_back(Diagnostic{t.line, column, std::move(message)});
+    }
+
+    std::nullptr_t syntax_error(std::string message) {
+        if (!failed) {
+            const Token& t = peek();
+            if (t.kind == TokenKind::Invalid)
+                message = t.length > 0 && (source[t.offset] == '"' || source[t.offset] == '\'')
+                              ? "missing terminating quote"
+                              : t.length > 1 ? "unterminated comment" : "stray '" + std::string(text(t)) + "' in input";
+            else if (t.kind == TokenKind::End)
+                message += " at end of input";
+            else
+                message += " before '" + std::string(text(t)) + "'";
+            report(t, std::move(message));
+        }
+        failed = true;
+        return nullptr;
+    }
+
+    bool expect(TokenKind kind, const char* what) {
+        if (at(kind)) {
+            ++pos;
+            return true;
+        }
+        syntax_error(std::string("expected ") + what);
+        return false;
+    }
+
+    // Skips the rest of a broken declaration. A struct body is skipped as a
+    // whole; in a variable a ';' always ends it, even inside unclosed braces.
+    void recover(std::size_t start, bool is_struct) {
+        std::size_t stop = pos;
+        int braces = 0;
+        for (pos = start; !at(TokenKind::End); ++pos) {
+            if (at(TokenKind::LBrace)) ++braces;
+            if (at(TokenKind::RBrace)) --braces;
+            if (at(TokenKind::Semicolon) && (!is_struct || braces <= 0)) {
+                ++pos;
+                break;
+            }
+        }
+        if (pos <= stop && !at(TokenKind::End)) pos = stop + 1;  // always make progress
+    }
+
+    // ----- declarations -----
+
+    void parse_all() {
+        arena.reset();
+        decls.clear();
+        variables.clear();
+        structs.clear();
+        diagnostics.clear();
+        struct_names.clear();
+        var_names.clear();
+        lists = 0;
+        pos = 0;
+        while (!at(TokenKind::End)) {
+            failed = false;
+            depth = 0;
+            std::size_t start = pos;
+            bool is_struct = at_word("struct");
+            if (is_struct)
+                parse_struct();
+            else
+                parse_variable();
+            if (failed) recover(start, is_struct);
+        }
+    }
+
+    void parse_struct() {
+        ++pos;
+        if (!at(TokenKind::Identifier) || is_keyword(text(peek()))) return (void)syntax_error("expected a struct name");
+        std::uint32_t name_token = std::uint32_t(pos++);
+        std::string_view name = text(tokens[name_token]);
+        if (struct_names.find(name)) {
+            report(tokens[name_token], "redefinition of 'struct " + std::string(name) + "'");
+            failed = true;
+            return;
+        }
+        if (!expect(TokenKind::LBrace, "'{'")) return;
+        std::size_t mark = member_scratch.size();
+        while (!at(TokenKind::RBrace) && !failed) {
+            const Type* type = parse_type();
+            if (!type) break;
+            for (;;) {
+                if (!at(TokenKind::Identifier) || is_keyword(text(peek()))) {
+                    syntax_error("expected a member name");
+                    break;
+                }
+                const Token& member = tokens[pos++];
+                for (std::size_t i = mark; i < member_scratch.size(); ++i)
+                    if (member_scratch[i].name == text(member)) {
+                        report(member, "duplicate member '" + std::string(text(member)) + "'");
+                        failed = true;
+                    }
+                const Type* t = parse_extents(type, false);
+                if (!t) break;
+                member_scratch.push_back(Member{text(member), t});
+                if (!at(TokenKind::Comma)) break;
+                ++pos;
+            }
+            if (!failed) expect(TokenKind::Semicolon, "';' after member");
+        }
+        if (failed || !expect(TokenKind::RBrace, "'}'") || !expect(TokenKind::Semicolon, "';' after struct")) {
+            member_scratch.resize(mark);
+            return;
+        }
+        Type* t = arena.make<Type>(Type::Struct);
+        t->name = name;
+        t->member_count = std::uint32_t(member_scratch.size() - mark);
+        Member* members = static_cast<Member*>(arena.allocate(sizeof(Member) * t->member_count, alignof(Member)));
+        std::copy(member_scratch.begin() + std::ptrdiff_t(mark), member_scratch.end(), members);
+        t->members = members;
+        member_scratch.resize(mark);
+        struct_names.insert(name, t);
+        structs.push_back(t);
+    }
+
+    void parse_variable() {
+        bool constant = false;
+        bool is_constexpr = false;
+        while (at_word("const") || at_word("constexpr")) {
+            constant = true;
+            is_constexpr |= at_word("constexpr");
+            ++pos;
+        }
+        const Type* type = parse_type();
+        if (!type) return;
+        if (!at(TokenKind::Identifier) || is_keyword(text(peek()))) return (void)syntax_error("expected a variable name");
+        std::uint32_t name_token = std::uint32_t(pos++);
+        std::string_view name = text(tokens[name_token]);
+        if (var_names.find(name) || struct_names.find(name)) {
+            report(tokens[name_token], "redefinition of '" + std::string(name) + "'");
+            failed = true;
+            return;
+        }
+        type = parse_extents(type, true);
+        if (!type) return;
+
+        VarDecl* v = arena.make<VarDecl>();
+        v->name = name;
+        v->type = type;
+        v->init = nullptr;
+        v->style = VarDecl::Default;
+        v->constant = constant;
+        v->is_constexpr = is_constexpr;
+        v->token = name_token;
+        if (at(TokenKind::LBrace)) {
+            v->style = VarDecl::Braced;
+            v->init = parse_braced_list();
+        } else if (at(TokenKind::Equals)) {
+            ++pos;
+            v->style = at(TokenKind::LBrace) ? VarDecl::CopyList : VarDecl::Copy;
+            v->init = at(TokenKind::LBrace) ? parse_braced_list() : parse_clause();
+        }
+        if (failed || (v->style != VarDecl::Default && !v->init)) return;
+        if (!expect(TokenKind::Semicolon, "';' after declaration")) return;
+        var_names.insert(name, v);
+        decls.push_back(v);
+        variables.push_back(v);
+    }
+
+    // ----- types -----
+
+    const Type* parse_type() {
+        if (!at(TokenKind::Identifier)) return syntax_error("expected a type");
+        std::string_view word = text(peek());
+        if (word == "std") {
+            ++pos;
+            if (!expect(TokenKind::Scope, "'::'")) return nullptr;
+            if (at_word("string")) {
+                ++pos;
+                return &kString;
+            }
+            if (at_word("vector")) {
+                ++pos;
+                if (!expect(TokenKind::Less, "'<'")) return nullptr;
+                if (++depth > kMaxDepth) return syntax_error("types nested too deeply");
+                const Type* element = parse_type();
+                --depth;
+                if (!element || !expect(TokenKind::Greater, "'>'")) return nullptr;
+                Type* t = arena.make<Type>(Type::Vector);
+                t->element = element;
+                return t;
+            }
+            return syntax_error("expected 'string' or 'vector' after 'std::'");
+        }
+        if (const Type* found = struct_names.find(word)) {
+            ++pos;
+            return found;
+        }
+        return parse_arithmetic();
+    }
+
+    // "unsigned long long", "long double", "signed char": count the words,
+    // then decide
+    const Type* parse_arithmetic() {
+        int is_unsigned = 0, is_signed = 0, shorts = 0, longs = 0, ints = 0, chars = 0, bools = 0, floats = 0,
+            doubles = 0;
+        std::size_t start = pos;
+        for (; at(TokenKind::Identifier); ++pos) {
+            std::string_view w = text(peek());
+            if (w == "unsigned") ++is_unsigned;
+            else if (w == "signed") ++is_signed;
+            else if (w == "short") ++shorts;
+            else if (w == "long") ++longs;
+            else if (w == "int") ++ints;
+            else if (w == "char") ++chars;
+            else if (w == "bool") ++bools;
+            else if (w == "float") ++floats;
+            else if (w == "double") ++doubles;
+            else break;
+        }
+        if (pos == start) {
+            report(peek(), "'" + std::string(text(peek())) + "' does not name a type");
+            failed = true;
+            return nullptr;
+        }
+        int words = int(pos - start);
+        auto invalid = [&]() -> const Type* {
+            report(tokens[start], "invalid type '" + std::string(text(std::uint32_t(start), std::uint32_t(pos - 1))) + "'");
+            failed = true;
+            return nullptr;
+        };
+        if (is_unsigned + is_signed > 1 || shorts > 1 || longs > 2 || ints > 1 || chars > 1 ||
+            bools + floats + doubles > 1)
+            return invalid();
+        if (bools || floats) return words == 1 ? arithmetic(bools ? Scalar::Bool : Scalar::Float) : invalid();
+        if (doubles) {
+            if (words == 1) return arithmetic(Scalar::Double);
+            return words == 2 && longs == 1 ? arithmetic(Scalar::LongDouble) : invalid();
+        }
+        if (chars) {
+            if (shorts || longs || ints) return invalid();
+            return arithmetic(is_unsigned ? Scalar::UnsignedChar : is_signed ? Scalar::SignedChar : Scalar::Char);
+        }
+        if (shorts && longs) return invalid();
+        if (shorts) return arithmetic(is_unsigned ? Scalar::UnsignedShort : Scalar::Short);
+        if (longs == 1) return arithmetic(is_unsigned ? Scalar::UnsignedLong : Scalar::Long);
+        if (longs == 2) return arithmetic(is_unsigned ? Scalar::UnsignedLongLong : Scalar::LongLong);
+        return arithmetic(is_unsigned ? Scalar::UnsignedInt : Scalar::Int);
+    }
+
+    // int x[2][3]: Array(2, Array(3, int)). Only the first extent may be
+    // left to the initializer.
+    const Type* parse_extents(const Type* element, bool may_deduce) {
+        std::int64_t extents[kMaxExtents];
+        int n = 0;
+        while (at(TokenKind::LBracket)) {
+            ++pos;
+            if (n == kMaxExtents) return syntax_error("too many array dimensions");
+            if (at(TokenKind::RBracket) && n == 0 && may_deduce) {
+                extents[n++] = -1;
+            } else {
+                if (!at(TokenKind::Integer)) return syntax_error("expected an array size");
+                const Literal* size = parse_literal(false, false);
+                if (!size) return nullptr;
+                if (size->value.integer <= 0) {
+                    report(tokens[size->first_token], "array size must be positive");
+                    failed = true;
+                    return nullptr;
+                }
+                extents[n++] = std::int64_t(size->value.integer);
+            }
+            if (!expect(TokenKind::RBracket, "']'")) return nullptr;
+        }
+        for (int i = n - 1; i >= 0; --i) {
+            Type* array = arena.make<Type>(Type::Array);
+            array->element = element;
+            array->extent = extents[i];
+            element = array;
+        }
+        return element;
+    }
+
+    // ----- initializers -----
+
+    const BracedInitList* parse_braced_list() {
+        if (++depth > kMaxDepth) return syntax_error("braces nested too deeply");
+        std::uint32_t first = std::uint32_t(pos++);
+        std::size_t mark = scratch.size();
+        while (!at(TokenKind::RBrace)) {
+            const Init* element = parse_clause();
+            if (!element) {
+                scratch.resize(mark);
+                return nullptr;
+            }
+            scratch.push_back(element);
+            if (!at(TokenKind::Comma)) break;
+            ++pos;  // a trailing comma before '}' is allowed
+        }
+        if (!expect(TokenKind::RBrace, "',' or '}'")) {
+            scratch.resize(mark);
+            return nullptr;
+        }
+        --depth;
+        std::uint32_t count = std::uint32_t(scratch.size() - mark);
+        const Init** elements = static_cast<const Init**>(arena.allocate(sizeof(Init*) * count, alignof(Init*)));
+        std::copy(scratch.begin() + std::ptrdiff_t(mark), scratch.end(), elements);
+        scratch.resize(mark);
+        ++lists;
+        return arena.make<BracedInitList>(first, std::uint32_t(pos - 1), elements, count);
+    }
+
+    const Init* parse_clause() {
+        const Token& t = peek();
+        switch (t.kind) {
+        case TokenKind::LBrace:
+            return parse_braced_list();
+        case TokenKind::Plus:
+        case TokenKind::Minus: {
+            TokenKind next = peek(1).kind;
+            if (next != TokenKind::Integer && next != TokenKind::Float && next != TokenKind::Char)
+                return syntax_error("expected a number after the sign");
+            return parse_literal(true, t.kind == TokenKind::Minus);
+        }
+        case TokenKind::Integer:
+        case TokenKind::Float:
+        case TokenKind::Char:
+        case TokenKind::String:
+            return parse_literal(false, false);
+        case TokenKind::Identifier: {
+            std::string_view name = text(t);
+            if (name == "true" || name == "false") {
+                Value v;
+                v.known = true;
+                v.integer = name == "true";
+                std::uint32_t at_token = std::uint32_t(pos++);
+                return arena.make<Literal>(at_token, at_token, arithmetic(Scalar::Bool), v);
+            }
+            const VarDecl* found = var_names.find(name);
+            if (!found) {
+                report(t, "'" + std::string(name) + "' was not declared");
+                failed = true;
+                return nullptr;
+            }
+            return arena.make<NameRef>(std::uint32_t(pos++), found);
+        }
+        default:
+            return syntax_error("expected an initializer");
+        }
+    }
+
+    // ----- literals -----
+
+    const Literal* parse_literal(bool has_sign, bool negate) {
+        std::uint32_t first = std::uint32_t(pos);
+        if (has_sign) ++pos;
+        const Token& t = tokens[pos];
+        std::uint32_t last = std::uint32_t(pos++);
+        const Type* type = nullptr;
+        Value v;
+        bool ok = false;
+        switch (t.kind) {
+        case TokenKind::Integer: ok = integer_literal(t, type, v); break;
+        case TokenKind::Float: ok = floating_literal(t, type, v); break;
+        case TokenKind::Char: ok = char_literal(t, type, v); break;
+        default:  // String
+            type = &kString;
+            ok = true;
+            break;
+        }
+        if (!ok) {
+            failed = true;
+            return nullptr;
+        }
+        if (has_sign) {
+            // Unary + and - promote: -'a' is an int, -1u is 4294967295u
+            Scalar s = type->scalar;
+            if (static_cast<int>(s) < static_cast<int>(Scalar::Int)) type = arithmetic(s = Scalar::Int);
+            if (negate) {
+                if (v.floating) {
+                    v.real = -v.real;
+                } else if (info(s).min == 0) {
+                    v.integer = v.integer == 0 ? 0 : info(s).max + 1 - v.integer;
+                } else {
+                    v.integer = -v.integer;
+                }
+            }
+        }
+        return arena.make<Literal>(first, last, type, v);
+    }
+
+    bool integer_literal(const Token& t, const Type*& type, Value& v) {
+        std::string_view s = text(t);
+        int base = 10;
+        std::size_t i = 0;
+        if (s.size() > 1 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) base = 16, i = 2;
+        else if (s.size() > 1 && s[0] == '0' && (s[1] == 'b' || s[1] == 'B')) base = 2, i = 2;
+        else if (s.size() > 1 && s[0] == '0') base = 8, i = 1;
+
+        // Suffix: u, l, ul, ll, ull in any case and order (but not lL)
+        std::size_t end = s.size();
+        while (end > i && (s[end - 1] == 'u' || s[end - 1] == 'U' || s[end - 1] == 'l' || s[end - 1] == 'L')) --end;
+        std::string_view suffix = s.substr(end);
+        int u = 0, l = 0;
+        for (char c : suffix) (c == 'u' || c == 'U') ? ++u : ++l;
+        bool suffix_ok = u <= 1 && l <= 2 && (l < 2 || suffix.find("ll") != std::string_view::npos ||
+                                               suffix.find("LL") != std::string_view::npos);
+
+        unsigned __int128 value = 0;
+        bool digits = false, too_large = false;
+        for (std::size_t k = i; k < end; ++k) {
+            char c = s[k];
+            if (c == '\'' && digits && k + 1 < end) continue;  // 1'000'000
+            int d = c >= '0' && c <= '9' ? c - '0' : c >= 'a' && c <= 'f' ? c - 'a' + 10 : c >= 'A' && c <= 'F' ? c - 'A' + 10 : 99;
+            if (d >= base) {
+                suffix_ok = false;
+                break;
+            }
+            digits = true;
+            value = value * unsigned(base) + unsigned(d);
+            too_large |= value > std::numeric_limits<unsigned long long>::max();
+        }
+        if (!suffix_ok || (!digits && base != 8)) {
+            report(t, "invalid integer literal '" + std::string(s) + "'");
+            return false;
+        }
+
+        // The first type that holds the value ([lex.icon] table 7)
+        static const Scalar kDecimal[] = {Scalar::Int, Scalar::Long, Scalar::LongLong};
+        static const Scalar kOther[] = {Scalar::Int,  Scalar::UnsignedInt,  Scalar::Long,
+                                        Scalar::UnsignedLong, Scalar::LongLong, Scalar::UnsignedLongLong};
+        const Scalar* candidates = base == 10 && !u ? kDecimal : kOther;
+        std::size_t count = base == 10 && !u ? 3 : 6;
+        for (std::size_t k = 0; k < count && !too_large; ++k) {
+            Scalar c = candidates[k];
+            bool is_unsigned = info(c).min == 0;
+            int rank = c == Scalar::Int || c == Scalar::UnsignedInt ? 0 : c == Scalar::Long || c == Scalar::UnsignedLong ? 1 : 2;
+            if ((u && !is_unsigned) || rank < l) continue;
+            if (__int128(value) <= info(c).max) {
+                type = arithmetic(c);
+                v.known = true;
+                v.integer = __int128(value);
+                return true;
+            }
+        }
+        report(t, "integer literal '" + std::string(s) + "' is too large for its type");
+        return false;
+    }
+
+    bool floating_literal(const Token& t, const Type*& type, Value& v) {
+        std::string_view s = text(t);
+        char buf[kMaxLiteral];
+        std::size_t n = 0;
+        for (char c : s)
+            if (c != '\'' && n < sizeof buf - 1) buf[n++] = c;
+        // In 0x1.8p3f the f is a suffix; in 0x1f it would be a digit
+        bool hex = s.size() > 1 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+        bool f_is_suffix = !hex || std::memchr(buf, 'p', n) || std::memchr(buf, 'P', n);
+        Scalar scalar = Scalar::Double;
+        if (n > 0 && (buf[n - 1] == 'f' || buf[n - 1] == 'F') && f_is_suffix) {
+            scalar = Scalar::Float;
+            --n;
+        } else if (n > 0 && (buf[n - 1] == 'l' || buf[n - 1] == 'L')) {
+            scalar = Scalar::LongDouble;
+            --n;
+        }
+        buf[n] = '\0';
+        char* parsed = nullptr;
+        long double value = std::strtold(buf, &parsed);
+        if (s.size() >= kMaxLiteral || n == 0 || parsed != buf + n || !std::isfinite(value)) {
+            report(t, "invalid floating literal '" + std::string(s) + "'");
+            return false;
+        }
+        type = arithmetic(scalar);
+        v.known = true;
+        v.floating = true;
+        v.real = round_to(scalar, value);
+        return true;
+    }
+
+    bool char_literal(const Token& t, const Type*& type, Value& v) {
+        std::string_view s = text(t).substr(1, t.length - 2);  // without the quotes
+        int code = -1;
+        if (s.size() == 1 && s[0] != '\\') {
+            code = static_cast<unsigned char>(s[0]);
+        } else if (s.size() >= 2 && s[0] == '\\') {
+            static const char kSimple[] = "n\nt\tr\r0\0\\\\''\"\"a\ab\bf\fv\v";
+            for (std::size_t k = 0; k + 1 < sizeof kSimple && s.size() == 2; k += 2)
+                if (kSimple[k] == s[1]) code = static_cast<unsigned char>(kSimple[k + 1]);
+            if (s[1] == 'x' && s.size() > 2 && s.size() <= 4)
+                code = int(std::strtol(std::string(s.substr(2)).c_str(), nullptr, 16));
+        }
+        if (code < 0) {
+            report(t, "unsupported character literal " + std::string(text(t)));
+            return false;
+        }
+        type = arithmetic(Scalar::Char);
+        v.known = true;
+        v.integer = static_cast<char>(code);  // char is signed on x86-64
+        return true;
+    }
+
+    // ========================================================================
+    // CHECKER
+    // ========================================================================
+    //
+    // Walks each initializer against its declared type, the way [dcl.init.list]
+    // and [dcl.init.aggr] do:
+    //
+    //   Line l{0, 0, 3, 4}          Line: members start, end
+    //     start <- elided braces    Point: x <- 0, y <- 0
+    //     end   <- elided braces    Point: x <- 3, y <- 4
+    //
+    // A member that is an aggregate takes a nested list if there is one,
+    // otherwise as many plain elements as it needs ("brace elision").
+
+    struct Operand {
+        const Type* type;
+        Value value;
+    };
+
+    Operand operand(const Init* e) const {
+        if (e->kind == Init::Literal) {
+            const Literal* l = static_cast<const Literal*>(e);
+            return Operand{l->type, l->value};
+        }
+        const VarDecl* var = static_cast<const NameRef*>(e)->var;
+        return Operand{var->type, var->constant ? var->value : Value{}};
+    }
+
+    void error_at(const Init* e, std::string message) { report(tokens[e->first_token], std::move(message)); }
+
+    std::string quoted(const Init* e) const { return "'" + std::string(text(e->first_token, e->last_token)) + "'"; }
+
+    // One clause (not a list) initializing `target`; narrowing is an error
+    // unless this is plain copy-initialization (T x = v)
+    void check_clause(const Type* target, const Init* e, bool list_init) {
+        Operand op = operand(e);
+        switch (target->kind) {
+        case Type::Arithmetic:
+            if (op.type->kind != Type::Arithmetic) {
+                error_at(e, "cannot convert " + quoted(e) + " from '" + type_name(op.type) + "' to '" +
+                                type_name(target) + "'");
+            } else if (list_init && is_narrowing(op.type->scalar, target->scalar, op.value)) {
+                error_at(e, "narrowing conversion of " + quoted(e) + " from '" + type_name(op.type) + "' to '" +
+                                type_name(target) + "'");
+            }
+            return;
+        case Type::Array:
+            error_at(e, "array '" + type_name(target) + "' must be initialized with a brace-enclosed initializer");
+            return;
+        default:
+            if (!same_type(op.type, target))
+                error_at(e, "cannot convert " + quoted(e) + " from '" + type_name(op.type) + "' to '" +
+                                type_name(target) + "'");
+            return;
+        }
+    }
+
+    void check_list(const Type* target, const BracedInitList* list) {
+        switch (target->kind) {
+        case Type::String: {
+            // std::string has an initializer_list<char> constructor, and list
+            // initialization tries it first: std::string s{65, 66} is "AB" and
+            // s{300} narrows. Only when some element isn't a number does the
+            // list mean a constructor call: s{"text"}, s{other}.
+            bool chars = list->count > 0;
+            for (std::uint32_t i = 0; chars && i < list->count; ++i)
+                chars = list->elements[i]->kind != Init::List &&
+                        operand(list->elements[i]).type->kind == Type::Arithmetic;
+            if (chars) {
+                for (std::uint32_t i = 0; i < list->count; ++i)
+                    check_clause(arithmetic(Scalar::Char), list->elements[i], true);
+                return;
+            }
+        }
+            // fall through
+        case Type::Arithmetic:
+            if (list->count == 0) return;  // value-initialized: 0, ""
+            if (list->count > 1) {
+                error_at(list->elements[1], "too many initializers for '" + type_name(target) + "'");
+            } else if (list->elements[0]->kind == Init::List) {
+                error_at(list->elements[0], "braces around scalar initializer for type '" + type_name(target) + "'");
+            } else {
+                check_clause(target, list->elements[0], true);
+            }
+            return;
+        case Type::Vector:
+            // std::initializer_list<T>: every element initializes one T
+            for (std::uint32_t i = 0; i < list->count; ++i) {
+                const Init* e = list->elements[i];
+                if (e->kind == Init::List)
+                    check_list(target->element, static_cast<const BracedInitList*>(e));
+                else
+                    check_clause(target->element, e, true);
+            }
+            return;
+        case Type::Struct: {
+            if (list->count == 1 && list->elements[0]->kind != Init::List &&
+                same_type(operand(list->elements[0]).type, target))
+                return;  // Point p{origin}: a copy
+            std::uint32_t next = 0;
+            for (std::uint32_t m = 0; m < target->member_count && next < list->count; ++m)
+                init_element(target->members[m].type, list, next);
+            if (next < list->count) error_at(list->elements[next], "too many initializers for '" + type_name(target) + "'");
+            return;
+        }
+        case Type::Array: {
+            std::uint32_t next = 0;
+            std::int64_t n = 0;
+            for (; next < list->count && (target->extent < 0 || n < target->extent); ++n)
+                init_element(target->element, list, next);
+            if (next < list->count) {
+                error_at(list->elements[next], "too many initializers for '" + type_name(target) + "'");
+            } else if (target->extent < 0) {
+                // The parser made this Array type for this declaration alone
+                const_cast<Type*>(target)->extent = n;
+                if (n == 0) error_at(list, "zero-size array");
+            }
+            return;
+        }
+        }
+    }
+
+    // Initializes one element of an aggregate from list->elements[next...],
+    // taking the braces or eliding them
+    void init_element(const Type* target, const BracedInitList* list, std::uint32_t& next) {
+        const Init* e = list->elements[next];
+        if (e->kind == Init::List) {
+            ++next;
+            check_list(target, static_cast<const BracedInitList*>(e));
+            return;
+        }
+        bool aggregate = target->kind == Type::Struct || target->kind == Type::Array;
+        if (!aggregate || same_type(operand(e).type, target)) {
+            ++next;
+            check_clause(target, e, true);
+            return;
+        }
+        std::uint32_t before = next;
+        if (target->kind == Type::Struct) {
+            for (std::uint32_t m = 0; m < target->member_count && next < list->count; ++m)
+                init_element(target->members[m].type, list, next);
+        } else {
+            for (std::int64_t i = 0; i < target->extent && next < list->count; ++i)
+                init_element(target->element, list, next);
+        }
+        if (next == before) {  // struct {} or no extent: nothing takes this element
+            error_at(e, "cannot convert " + quoted(e) + " to '" + type_name(target) + "'");
+            ++next;
+        }
+    }
+
+    void check_variable(VarDecl* v) {
+        const Token& at_name = tokens[v->token];
+        switch (v->style) {
+        case VarDecl::Default:
+            if (v->type->kind == Type::Array && v->type->extent < 0)
+                report(at_name, "storage size of '" + std::string(v->name) + "' isn't known");
+            else if (v->constant)
+                report(at_name, "uninitialized 'const " + std::string(v->name) + "'");
+            break;
+        case VarDecl::Braced:
+        case VarDecl::CopyList:
+            check_list(v->type, static_cast<const BracedInitList*>(v->init));
+            break;
+        case VarDecl::Copy:
+            check_clause(v->type, v->init, false);
+            break;
+        }
+        if (!v->constant || v->type->kind != Type::Arithmetic) return;
+        // [expr.const]: a const variable is usable in constant expressions
+        // only if it's integral; floating ones need constexpr
+        if (info(v->type->scalar).floating && !v->is_constexpr) return;
+
+        // A const variable's value is known when its initializer's is
+        const Init* source = v->init;
+        if (source && source->kind == Init::List) {
+            const BracedInitList* list = static_cast<const BracedInitList*>(source);
+            if (list->count == 0) {
+                v->value.known = true;
+                v->value.floating = info(v->type->scalar).floating;
+                return;
+            }
+            source = list->count == 1 ? list->elements[0] : nullptr;
+        }
+        if (!source || source->kind == Init::List) return;
+        Operand op = operand(source);
+        if (op.type->kind == Type::Arithmetic) v->value = convert(op.value, op.value.floating, v->type->scalar);
+    }
+
+    void check_all() {
+        for (VarDecl* v : decls) check_variable(v);
+        std::stable_sort(diagnostics.begin(), diagnostics.end(), [](const Diagnostic& a, const Diagnostic& b) {
+            return a.line != b.line ? a.line < b.line : a.column < b.column;
+        });
+    }
+};
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+BraceInitEngine::BraceInitEngine() : state_(new State) {}
+BraceInitEngine::~BraceInitEngine() = default;
+
+void BraceInitEngine::lex(std::string_view source) {
+    state_->source = source;
+    state_->tokens.clear();
+    tokenize(source, state_->tokens, state_->simd);
+}
+
+void BraceInitEngine::parse() { state_->parse_all(); }
+
+void BraceInitEngine::check() { state_->check_all(); }
+
+std::size_t BraceInitEngine::run(std::string_view source) {
+    lex(source);
+    parse();
+    check();
+    return state_->diagnostics.size();
+}
+
+void BraceInitEngine::set_simd(bool on) { state_->simd = on; }
+
+const std::vector<Token>& BraceInitEngine::tokens() const { return state_->tokens; }
+const std::vector<const VarDecl*>& BraceInitEngine::variables() const { return state_->variables; }
+const std::vector<const Type*>& BraceInitEngine::structs() const { return state_->structs; }
+const std::vector<Diagnostic>& BraceInitEngine::diagnostics() const { return state_->diagnostics; }
+std::size_t BraceInitEngine::list_count() const { return state_->lists; }
+std::size_t BraceInitEngine::arena_bytes() const { return state_->arena.reserved(); }
@@ -0,0 +1,229 @@
+// brace_init_engine.h - lexer, parser and narrowing checker for brace-initialized config files
+//
+// brace_init_compiler.cpp describes LEXER -> PARSER -> SEMANTIC as comments.
+// This runs that pipeline on config files written in the same syntax:
+//
+//   struct Point { int x; int y; };
+//   struct Line { Point start; Point end; };
+//   const long limit = 3000000000;
+//   Line diagonal{{0, 0}, {3, 4}};
+//   Line flat{0, 0, 3, 4};             brace elision, as in C++
+//   std::vector<double> weights{0.5, 0.25, 1};
+//   int ratio{2.5};                    error: narrowing conversion of '2.5' from 'double' to 'int'
+//   short port{limit};                 error: '3000000000' doesn't fit (limit is a constant)
+//
+//   source ──LEXER──▶ Token[] ──PARSER──▶ VarDecl + BracedInitList ──CHECKER──▶ Diagnostic[]
+//          SSE2: token starts     recursive descent,         aggregates, arrays,
+//          and ends from          nodes bump-allocated        brace elision and
+//          64-byte bitmasks       in an Arena                 is_narrowing()
+//
+// Accepted: struct declarations (members of any accepted type), variables
+// with T x{...}, T x = {...} or T x = value, optional const/constexpr,
+// the arithmetic types (unsigned long long, long double, ...), std::string,
+// std::vector<T>, arrays T x[N] / T x[] (also multi-dimensional), integer,
+// floating, character, string and bool literals, names of earlier variables,
+// and // and /* */ comments. Whatever a C++ compiler would reject, this
+// reports - with the same verdict on narrowing (brace_init_bench.cpp checks
+// that against g++).
+
+#ifndef BRACE_INIT_ENGINE_H
+#define BRACE_INIT_ENGINE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"
+
+// ============================================================================
+// TOKENS
+// ============================================================================
+
+enum class TokenKind : std::uint8_t {
+    Identifier,  // also keywords: the parser knows them by their text
+    Integer,
+    Float,
+    Char,
+    String,
+    LBrace,
+    RBrace,
+    LBracket,
+    RBracket,
+    Less,
+    Greater,
+    Comma,
+    Semicolon,
+    Equals,
+    Plus,
+    Minus,
+    Scope,    // ::
+    Invalid,  // stray character, unterminated literal or comment
+    End,
+};
+
+struct Token {
+    TokenKind kind;
+    std::uint32_t offset;  // into the source
+    std::uint32_t length;
+    std::uint32_t line;    // 1-based
+};
+
+// Appends the tokens of `source` to out, ending with one End token.
+// simd = false runs the byte-at-a-time loop the SSE2 paths replace.
+void tokenize(std::string_view source, std::vector<Token>& out, bool simd = true);
+
+// ============================================================================
+// TYPES AND VALUES
+// ============================================================================
+
+enum class Scalar : std::uint8_t {
+    Bool,
+    Char,
+    SignedChar,
+    UnsignedChar,
+    Short,
+    UnsignedShort,
+    Int,
+    UnsignedInt,
+    Long,
+    UnsignedLong,
+    LongLong,
+    UnsignedLongLong,
+    Float,
+    Double,
+    LongDouble,
+};
+
+const char* scalar_name(Scalar s);  // "unsigned long", as written in C++
+
+struct Member;
+
+struct Type {
+    enum Kind : std::uint8_t { Arithmetic, String, Struct, Array, Vector };
+    Kind kind;
+    Scalar scalar = Scalar::Int;     // Arithmetic
+    std::string_view name;           // Struct
+    const Member* members = nullptr; // Struct
+    std::uint32_t member_count = 0;
+    const Type* element = nullptr;   // Array, Vector
+    std::int64_t extent = 0;         // Array: -1 = deduced from the initializer
+
+    explicit Type(Kind k, Scalar s = Scalar::Int) : kind(k), scalar(s) {}
+};
+
+struct Member {
+    std::string_view name;
+    const Type* type;
+};
+
+// A number as the checker sees it. Constants (literals, const variables)
+// are known; everything else only has a type.
+struct Value {
+    bool known = false;
+    bool floating = false;  // which of the two is meant
+    union {
+        __int128 integer = 0;  // covers long long and unsigned long long
+        long double real;      // all-zero bits are 0.0L too
+    };
+};
+
+// ============================================================================
+// AST
+// ============================================================================
+
+struct VarDecl;
+
+struct Init {
+    enum Kind : std::uint8_t { Literal, Name, List };
+    Kind kind;
+    std::uint32_t first_token;  // [first_token, last_token]: the source text
+    std::uint32_t last_token;
+
+    Init(Kind k, std::uint32_t first, std::uint32_t last) : kind(k), first_token(first), last_token(last) {}
+};
+
+struct Literal : Init {
+    const Type* type;  // an Arithmetic type, or std::string for "text"
+    Value value;
+
+    Literal(std::uint32_t first, std::uint32_t last, const Type* t, const Value& v)
+        : Init(Init::Literal, first, last), type(t), value(v) {}
+};
+
+struct NameRef : Init {
+    const VarDecl* var;
+
+    NameRef(std::uint32_t token, const VarDecl* v) : Init(Init::Name, token, token), var(v) {}
+};
+
+// '{' initializer-clause, ... '}'
+struct BracedInitList : Init {
+    const Init* const* elements;
+    std::uint32_t count;
+
+    BracedInitList(std::uint32_t first, std::uint32_t last, const Init* const* e, std::uint32_t n)
+        : Init(Init::List, first, last), elements(e), count(n) {}
+};
+
+struct VarDecl {
+    enum Style : std::uint8_t {
+        Default,    // T x;
+        Braced,     // T x{...};     direct-list-initialization
+        CopyList,   // T x = {...};  copy-list-initialization
+        Copy,       // T x = v;      copy-initialization: narrowing allowed
+    };
+    std::string_view name;
+    const Type* type;
+    const Init* init;
+    Style style;
+    bool constant;      // const or constexpr
+    bool is_constexpr;  // const double isn't a constant expression; constexpr double is
+    std::uint32_t token;
+    Value value;    // filled in by the checker when constant and arithmetic
+};
+
+struct Diagnostic {
+    std::uint32_t line;
+    std::uint32_t column;
+    std::string message;
+};
+
+// ============================================================================
+// THE ENGINE
+// ============================================================================
+
+class BraceInitEngine {
+public:
+    BraceInitEngine();
+    ~BraceInitEngine();
+
+    BraceInitEngine(const BraceInitEngine&) = delete;
+    BraceInitEngine& operator=(const BraceInitEngine&) = delete;
+
+    // All three stages; returns the number of errors. `source` must outlive
+    // the results, which stay valid until the next call.
+    std::size_t run(std::string_view source);
+
+    // The stages one at a time (each needs the one before)
+    void lex(std::string_view source);
+    void parse();
+    void check();
+
+    void set_simd(bool on);
+
+    const std::vector<Token>& tokens() const;
+    const std::vector<const VarDecl*>& variables() const;
+    const std::vector<const Type*>& structs() const;
+    const std::vector<Diagnostic>& diagnostics() const;
+    std::size_t list_count() const;  // BracedInitList nodes built
+    std::size_t arena_bytes() const;
+
+private:
+    struct State;
+    std::unique_ptr<State> state_;
+};
+
+#endif  // BRACE_INIT_ENGINE_H
@@ -1,10 +1,10 @@
 // C functions that will be called from C++
 // No special syntax needed - C doesn't do name mangling
+#include "c_functions.h"
 
-struct Point {
-    int x;
-    int y;
-};
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 int add_numbers(int a, int b) {
     return a + b;
@@ -23,3 +23,73 @@ void modify_struct(struct Point* p) {
     p->x *= 2;
     p->y *= 2;
 }
+
+// ============================================================================
+// Batch versions - the loop runs here, on the C side
+// ============================================================================
+
+void add_numbers_n(const int* a, const int* b, int* out, size_t n) {
+    // Simple indexed loop over plain arrays: GCC/Clang vectorize this at -O2/-O3
+    // (4 ints per SSE2 add, 8 with AVX2)
+    for (size_t i = 0; i < n; i++) {
+        out[i] = a[i] + b[i];
+    }
+}
+
+void modify_structs(struct Point* points, size_t n) {
+    // x and y are interleaved, but both get the same operation, so the
+    // compiler can treat the array as 2*n ints
+    for (size_t i = 0; i < n; i++) {
+        points[i].x *= 2;
+        points[i].y *= 2;
+    }
+}
+
+// Kahan summation: `c` carries the low-order bits that were lost when adding
+// a small number to a big sum, and feeds them back into the next addition.
+//
+//   y = value - c        // correct the value by the previous error
+//   t = sum + y          // big + small: low bits of y get lost
+//   c = (t - sum) - y    // recover exactly what was lost
+//   sum = t
+double calculate_average_n(const double* array, size_t n) {
+    if (n == 0) return 0.0;
+
+    double sum = 0.0;
+    double c = 0.0;
+    size_t i = 0;
+
+#if defined(__SSE2__)
+    // Two independent Kahan sums, one per lane (even / odd elements)
+    __m128d vsum = _mm_setzero_pd();
+    __m128d vc = _mm_setzero_pd();
+    for (; i + 2 <= n; i += 2) {
+        __m128d y = _mm_sub_pd(_mm_loadu_pd(array + i), vc);
+        __m128d t = _mm_add_pd(vsum, y);
+        vc = _mm_sub_pd(_mm_sub_pd(t, vsum), y);
+        vsum = t;
+    }
+    double lane_sum[2], lane_c[2];
+    _mm_storeu_pd(lane_sum, vsum);
+    _mm_storeu_pd(lane_c, vc);
+
+    // Fold both lanes (and their pending corrections) into the scalar sum
+    for (int l = 0; l < 2; l++) {
+        double values[2] = {lane_sum[l], -lane_c[l]};
+        for (int k = 0; k < 2; k++) {
+            double y = values[k] - c;
+            double t = sum + y;
+            c = (t - sum) - y;
+            sum = t;
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        double y = array[i] - c;
+        double t = sum + y;
+        c = (t - sum) - y;
+        sum = t;
+    }
+    return sum / (double)n;
+}
@@ -0,0 +1,54 @@
+/* C functions that can be called from both C and C++
+ *
+ * The extern "C" block is only seen by a C++ compiler: it turns off name
+ * mangling so the C++ side links against the plain C symbol names.
+ * A C compiler skips it (__cplusplus is not defined in C).
+ */
+#ifndef C_FUNCTIONS_H
+#define C_FUNCTIONS_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Same binary layout in C and C++ */
+struct Point {
+    int x;
+    int y;
+};
+
+/* ---- One value / one struct per call ---- */
+
+int add_numbers(int a, int b);
+double calculate_average(double* array, int size);
+void modify_struct(struct Point* p);
+
+/* ---- Batch versions: one call for n elements ----
+ *
+ * Crossing the C/C++ boundary once per element costs a call, a return and
+ * lost optimization (the compiler can't vectorize across an opaque call).
+ * These take whole arrays so the loop runs inside C, where it can be
+ * vectorized. Signatures are stable: only add new functions, never change
+ * these.
+ */
+
+/* out[i] = a[i] + b[i] for i in [0, n). out may alias a or b. */
+void add_numbers_n(const int* a, const int* b, int* out, size_t n);
+
+/* modify_struct() on points[0] .. points[n-1] */
+void modify_structs(struct Point* points, size_t n);
+
+/* Average of n doubles with size_t length (no 2^31 element limit).
+ * Uses compensated (Kahan) summation per SIMD lane, so large arrays lose far
+ * less precision than a plain running sum. Returns 0.0 for n == 0.
+ * Don't compile c_functions.c with -ffast-math: it would optimize the
+ * compensation away. */
+double calculate_average_n(const double* array, size_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* C_FUNCTIONS_H */
@@ -1,40 +1,76 @@
 // C++ calling C functions - Example of binary compatibility
 #include <iostream>
+#include <chrono>
+#include <vector>
 
-// Declare C functions using extern "C" to prevent name mangling
-extern "C" {
-    // These functions are defined in c_functions.c
-    int add_numbers(int a, int b);
-    double calculate_average(double* array, int size);
-    void modify_struct(struct Point* p);
-    
-    // C struct definition (same layout in both languages)
-    struct Point {
-        int x;
-        int y;
-    };
-}
+// The header declares the C functions inside extern "C" (prevents name
+// mangling) and defines struct Point with the same layout in both languages.
+// These functions are defined in c_functions.c
+#include "c_functions.h"
 
 int main() {
     std::cout << "=== C++ and C Interoperability Example ===" << std::endl;
     std::cout << std::endl;
-    
+
     // Call C function directly - no conversion needed
     int sum = add_numbers(10, 20);
     std::cout << "C function add_numbers(10, 20) = " << sum << std::endl;
-    
+
     // Pass array to C function - same memory layout
     double numbers[] = {1.5, 2.5, 3.5, 4.5, 5.5};
     double avg = calculate_average(numbers, 5);
     std::cout << "C function calculate_average() = " << avg << std::endl;
-    
+
     // Pass struct to C function - binary compatible
     struct Point p = {10, 20};
     std::cout << std::endl << "Before C function: Point(" << p.x << ", " << p.y << ")" << std::endl;
     modify_struct(&p);
     std::cout << "After C function: Point(" << p.x << ", " << p.y << ")" << std::endl;
-    
+
     std::cout << std::endl << "No overhead: same calling convention, same data layout!" << std::endl;
-    
+
+    // BATCH CALLS: one boundary crossing for a whole array
+    std::cout << std::endl << "=== Batch C API ===" << std::endl << std::endl;
+
+    int a[] = {1, 2, 3, 4};
+    int b[] = {10, 20, 30, 40};
+    int out[4];
+    add_numbers_n(a, b, out, 4);
+    std::cout << "add_numbers_n({1,2,3,4}, {10,20,30,40}) = {"
+              << out[0] << "," << out[1] << "," << out[2] << "," << out[3] << "}" << std::endl;
+
+    struct Point pts[] = {{1, 2}, {3, 4}, {5, 6}};
+    modify_structs(pts, 3);
+    std::cout << "modify_structs({1,2},{3,4},{5,6}) = {" << pts[0].x << "," << pts[0].y << "},{"
+              << pts[1].x << "," << pts[1].y << "},{" << pts[2].x << "," << pts[2].y << "}" << std::endl;
+
+    // Compensated summation: 1.0 followed by many tiny values.
+    // A plain running sum drops every 1e-16 (below half an ulp of 1.0).
+    std::vector<double> tiny(10000001, 1e-16);
+    tiny[0] = 1.0;
+    std::cout.precision(17);
+    std::cout << "Average of {1.0, 1e-16 x 10M}:" << std::endl;
+    std::cout << "  calculate_average   (plain sum):  " << calculate_average(tiny.data(), static_cast<int>(tiny.size())) << std::endl;
+    std::cout << "  calculate_average_n (Kahan, SIMD): " << calculate_average_n(tiny.data(), tiny.size()) << std::endl;
+    std::cout << "  exact:                             " << (1.0 + 1e-16 * 1e7) / 10000001.0 << std::endl;
+    std::cout.precision(6);
+
+    // Per-element calls vs one batch call
+    const std::size_t n = 10000000;
+    std::vector<struct Point> many(n, Point{1, 1});
+    auto t0 = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < n; ++i) modify_struct(&many[i]);
+    auto t1 = std::chrono::steady_clock::now();
+    modify_structs(many.data(), n);
+    auto t2 = std::chrono::steady_clock::now();
+
+    std::cout << std::endl << n << " Points:" << std::endl;
+    std::cout << "  modify_struct() per element: "
+              << std::chrono::duration<double, std::milli>(t1 - t0).count() << " ms" << std::endl;
+    std::cout << "  modify_structs() once:       "
+              << std::chrono::duration<double, std::milli>(t2 - t1).count() << " ms" << std::endl;
+
+    std::cout << std::endl << "Batch API: the loop runs in C, the call overhead is paid once!" << std::endl;
+
     return 0;
 }
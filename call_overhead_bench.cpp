@@ -0,0 +1,393 @@
+// How much does a call across C++ / C / assembly really cost?
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#if defined(__linux__)
+#include <dlfcn.h>
+#include <link.h>  // ElfW(Sym)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#include "c_functions.h"  // add_numbers (c_functions.c)
+
+extern "C" int asm_add(int a, int b);  // asm_functions_x86_64.s / asm_functions.s
+
+// ============================================================================
+// WHAT IS MEASURED
+// ============================================================================
+// The README says calls between C++, C and assembly have "zero overhead".
+// That's true for the DATA (same layout, same registers - nothing is
+// converted), but a call is still a call: it costs a few instructions and,
+// more importantly, it hides the callee from the optimizer.
+//
+//   inline C++        add_inline() in this file - the compiler sees the body
+//   C++ noinline      same, but forced out of line (cost of a plain call)
+//   extern "C"        add_numbers from c_functions.c - another translation unit
+//   function pointer  add_numbers through a pointer - indirect call
+//   assembly          asm_add - can never be inlined, not even with LTO
+//
+// LTO (link-time optimization): with -flto on BOTH the .c and the .cpp, the
+// linker sees GCC's intermediate code for c_functions.c and can inline
+// add_numbers into the C++ loop. The language boundary disappears - the
+// binary boundary (the .o file) was the real cost.
+//
+//   g++ -O2            call_overhead_bench.cpp  c_functions.o      -> calls add_numbers
+//   g++ -O2 -flto      call_overhead_bench.cpp  c_functions.o(lto) -> may inline it
+//
+// Each loop feeds the result into the next call (a dependency chain) and hides
+// the value from the optimizer after every iteration, so no loop can be
+// collapsed into a formula.
+
+template <typename T>
+inline void do_not_optimize(T& value) {
+    asm volatile("" : "+r"(value));
+}
+
+inline int add_inline(int a, int b) { return a + b; }
+
+__attribute__((noinline)) int add_noinline(int a, int b) { return a + b; }
+
+// Read through a volatile so the compiler can't see which function it is
+int (*volatile add_pointer)(int, int) = add_numbers;
+
+// ============================================================================
+// THE LOOPS - one out-of-line function per variant (their code is inspected below)
+// ============================================================================
+
+__attribute__((noinline)) int loop_empty(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc ^= i;  // minimal work, so only loop overhead + the barrier remain
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) int loop_inline(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = add_inline(acc, i);
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) int loop_noinline(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = add_noinline(acc, i);
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) int loop_extern_c(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = add_numbers(acc, i);
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) int loop_pointer(int n) {
+    int (*fn)(int, int) = add_pointer;
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = fn(acc, i);
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+__attribute__((noinline)) int loop_asm(int n) {
+    int acc = 0;
+    for (int i = 0; i < n; ++i) {
+        acc = asm_add(acc, i);
+        do_not_optimize(acc);
+    }
+    return acc;
+}
+
+// ============================================================================
+// COUNTERS: hardware instructions/cycles via perf_event_open (Linux), plus the
+// CPU's timestamp counter. Hardware counters are often unavailable (VMs,
+// containers, perf_event_paranoid) - then those columns say n/a.
+// ============================================================================
+
+std::uint64_t timestamp_ticks() {
+#if defined(__x86_64__)
+    return __rdtsc();  // constant-rate TSC: "reference cycles", not core cycles
+#elif defined(__aarch64__)
+    std::uint64_t v;
+    asm volatile("mrs %0, cntvct_el0" : "=r"(v));  // generic timer: usually 24 MHz or 1 GHz
+    return v;
+#else
+    return 0;
+#endif
+}
+
+class HwCounters {
+private:
+    int fd_instructions = -1;
+    int fd_cycles = -1;
+
+#if defined(__linux__)
+    static int open_counter(std::uint64_t config) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;  // count only our own user-space code
+        attr.exclude_hv = 1;
+        return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+#endif
+
+public:
+    std::string error;
+
+    HwCounters() {
+#if defined(__linux__)
+        fd_instructions = open_counter(PERF_COUNT_HW_INSTRUCTIONS);
+        if (fd_instructions < 0) error = std::strerror(errno);
+        fd_cycles = open_counter(PERF_COUNT_HW_CPU_CYCLES);
+#else
+        error = "perf_event_open is Linux-only";
+#endif
+    }
+
+    ~HwCounters() {
+#if defined(__linux__)
+        if (fd_instructions >= 0) close(fd_instructions);
+        if (fd_cycles >= 0) close(fd_cycles);
+#endif
+    }
+
+    HwCounters(const HwCounters&) = delete;
+    HwCounters& operator=(const HwCounters&) = delete;
+
+    bool available() const { return fd_instructions >= 0; }
+
+    void start() {
+#if defined(__linux__)
+        for (int fd : {fd_instructions, fd_cycles}) {
+            if (fd < 0) continue;
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+#endif
+    }
+
+    // -1 for a counter that couldn't be opened
+    void stop(long long& instructions, long long& cycles) {
+        instructions = cycles = -1;
+#if defined(__linux__)
+        auto read_fd = [](int fd, long long& out) {
+            if (fd < 0) return;
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long v = 0;
+            if (read(fd, &v, sizeof(v)) == sizeof(v)) out = v;
+        };
+        read_fd(fd_instructions, instructions);
+        read_fd(fd_cycles, cycles);
+#endif
+    }
+};
+
+struct Result {
+    std::string name;
+    double ns = 0;
+    double ticks = 0;
+    double instructions = -1;
+    double cycles = -1;
+};
+
+// Best of `reps` runs (least disturbed by other processes), per call
+Result measure(const std::string& name, int (*loop)(int), int n, int reps, HwCounters& hw) {
+    Result best;
+    best.name = name;
+    best.ns = 1e300;
+    for (int r = 0; r < reps; ++r) {
+        long long instr = -1, cyc = -1;
+        hw.start();
+        std::uint64_t t0 = timestamp_ticks();
+        auto start = std::chrono::steady_clock::now();
+        int acc = loop(n);
+        auto stop = std::chrono::steady_clock::now();
+        std::uint64_t t1 = timestamp_ticks();
+        hw.stop(instr, cyc);
+        do_not_optimize(acc);
+
+        double ns = std::chrono::duration<double, std::nano>(stop - start).count() / n;
+        if (ns < best.ns) {
+            best.ns = ns;
+            best.ticks = double(t1 - t0) / n;
+            best.instructions = instr >= 0 ? double(instr) / n : -1;
+            best.cycles = cyc >= 0 ? double(cyc) / n : -1;
+        }
+    }
+    return best;
+}
+
+// ============================================================================
+// DID THE CALL SURVIVE? Scan the loop's machine code for a direct call to the
+// callee. Crude (a linear byte scan, not a disassembler), but a match needs
+// the exact target address, so false positives are practically impossible.
+// The scan covers exactly the loop function's bytes, as recorded in its ELF
+// symbol (st_size): reading past the end would run into whatever function
+// the linker placed next, possibly one that calls the callee itself.
+// ============================================================================
+
+// Size in bytes of the function at `fn`, or 0 if the dynamic symbol table
+// doesn't list it (the binary was linked without -rdynamic)
+std::size_t function_size(const void* fn) {
+#if defined(__linux__)
+    Dl_info info;
+    void* extra = nullptr;  // receives a const ElfW(Sym)*
+    if (dladdr1(fn, &info, &extra, RTLD_DL_SYMENT) == 0 || extra == nullptr) return 0;
+    if (info.dli_saddr != fn) return 0;  // inside some other symbol
+    return static_cast<const ElfW(Sym)*>(extra)->st_size;
+#else
+    (void)fn;
+    return 0;
+#endif
+}
+
+// 1 = the loop calls target, 0 = it doesn't, -1 = can't tell (size unknown)
+int calls_function(int (*loop)(int), const void* target) {
+    const unsigned char* code = reinterpret_cast<const unsigned char*>(loop);
+    const std::uintptr_t want = reinterpret_cast<std::uintptr_t>(target);
+    const std::size_t size = function_size(reinterpret_cast<const void*>(loop));
+    if (size == 0) return -1;
+    for (std::size_t i = 0; i < size; ++i) {
+#if defined(__x86_64__)
+        // E8 rel32 = call, E9 rel32 = jmp (tail call); target = next instruction + rel32
+        if ((code[i] == 0xE8 || code[i] == 0xE9) && i + 5 <= size) {
+            std::int32_t rel;
+            std::memcpy(&rel, code + i + 1, 4);
+            if (reinterpret_cast<std::uintptr_t>(code + i + 5) + std::intptr_t(rel) == want) return 1;
+        }
+#elif defined(__aarch64__)
+        // BL imm26 (0x94000000) / B imm26 (0x14000000), 4-byte aligned instructions
+        if (i % 4 == 0 && i + 4 <= size) {
+            std::uint32_t insn;
+            std::memcpy(&insn, code + i, 4);
+            std::uint32_t op = insn & 0xFC000000u;
+            if (op == 0x94000000u || op == 0x14000000u) {
+                std::int32_t imm = std::int32_t(insn << 6) >> 6;  // sign-extend 26 bits
+                if (reinterpret_cast<std::uintptr_t>(code + i) + std::intptr_t(imm) * 4 == want) return 1;
+            }
+        }
+#endif
+    }
+    return 0;
+}
+
+std::string fmt(double v) {
+    if (v < 0) return "n/a";
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.2f", v);
+    return buf;
+}
+
+void print_row(const Result& r, double baseline_ns) {
+    std::string name = r.name;
+    name.resize(20, ' ');
+    std::string cols[] = {fmt(r.ns), fmt(std::max(0.0, r.ns - baseline_ns)), fmt(r.ticks), fmt(r.instructions), fmt(r.cycles)};
+    std::cout << "  " << name;
+    for (auto& c : cols) {
+        c.insert(0, std::max(0, 11 - int(c.size())), ' ');
+        std::cout << c;
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Call Overhead: C++ vs extern \"C\" vs Assembly vs Inline ===" << std::endl;
+    std::cout << std::endl;
+
+    int n = argc > 1 ? std::atoi(argv[1]) : 50000000;
+    const int reps = 5;
+
+    HwCounters hw;
+    std::cout << "Calls per measurement: " << n << " (best of " << reps << ")" << std::endl;
+    std::cout << "Hardware counters: "
+              << (hw.available() ? "perf_event_open" : "n/a (" + hw.error + ")") << std::endl;
+    std::cout << std::endl;
+
+    Result rows[] = {
+        measure("empty loop", loop_empty, n, reps, hw),
+        measure("inline C++", loop_inline, n, reps, hw),
+        measure("C++ noinline", loop_noinline, n, reps, hw),
+        measure("extern \"C\"", loop_extern_c, n, reps, hw),
+        measure("function pointer", loop_pointer, n, reps, hw),
+        measure("assembly", loop_asm, n, reps, hw),
+    };
+    double baseline = rows[0].ns;
+
+    std::cout << "  variant                  ns   -empty ns   ticks/call  instr/call  cycles/call" << std::endl;
+    for (const Result& r : rows) print_row(r, baseline);
+    std::cout << "  (ticks = timestamp counter, constant rate; cycles = real core cycles)" << std::endl;
+
+    // ----- Was the cross-language call inlined? -----
+    std::cout << std::endl << "=== Inlining across the boundary ===" << std::endl;
+    struct Probe {
+        const char* what;
+        int (*loop)(int);
+        const void* callee;
+    } probes[] = {
+        {"add_numbers (C)", loop_extern_c, reinterpret_cast<const void*>(&add_numbers)},
+        {"asm_add (assembly)", loop_asm, reinterpret_cast<const void*>(&asm_add)},
+        {"add_noinline (C++)", loop_noinline, reinterpret_cast<const void*>(&add_noinline)},
+    };
+    bool c_inlined = false, unknown = false;
+    for (const Probe& p : probes) {
+        int called = calls_function(p.loop, p.callee);
+        std::cout << "  " << p.what << ": "
+                  << (called < 0 ? "unknown (loop size not in the symbol table)"
+                      : called ? "called" : "INLINED (no call in the loop)") << std::endl;
+        if (p.loop == loop_extern_c) c_inlined = called == 0;
+        unknown |= called < 0;
+    }
+
+#if defined(__x86_64__) || defined(__aarch64__)
+    if (unknown) {
+        std::cout << "Link with -rdynamic so dladdr1() can report each loop's size." << std::endl;
+    } else if (c_inlined) {
+        std::cout << "LTO inlined the C function into C++: the language boundary cost nothing." << std::endl;
+    } else {
+        std::cout << "add_numbers is a real call. Build c_functions.c AND this file with -flto" << std::endl;
+        std::cout << "to let the linker inline it." << std::endl;
+    }
+#else
+    (void)c_inlined;
+    std::cout << "(machine-code scan only implemented for x86-64 and ARM64)" << std::endl;
+#endif
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• Same ABI = no conversion, but a call still costs ~1-2 ns and a few instructions" << std::endl;
+    std::cout << "• C++ noinline and extern \"C\" cost the same: the language adds nothing" << std::endl;
+    std::cout << "• The real cost is the lost optimization: no inlining, no vectorization" << std::endl;
+    std::cout << "• LTO removes the .o boundary: C functions inline into C++ code" << std::endl;
+    std::cout << "• Assembly stays a black box even with LTO - keep it for whole loops, not one add" << std::endl;
+    std::cout << "• Hot path with tiny functions? Batch APIs (add_numbers_n) or LTO" << std::endl;
+
+    return 0;
+}
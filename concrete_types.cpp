@@ -2,6 +2,8 @@
 #include <string>
 #include <memory>
 
+#include "trace.h"  // TRACE_SCOPE: compiled out unless -DENABLE_TRACING
+
 // ============================================================================
 // CONCRETE TYPE vs ABSTRACT TYPE
 // ============================================================================
@@ -64,6 +66,7 @@ public:
 // ============================================================================
 
 void demonstrate_placement() {
+    TRACE_SCOPE("demonstrate_placement");
     std::cout << "=== 1. Object Placement ===" << std::endl << std::endl;
     
     // ON THE STACK (automatic storage)
@@ -109,6 +112,7 @@ void demonstrate_placement() {
 // ============================================================================
 
 void demonstrate_direct_reference() {
+    TRACE_SCOPE("demonstrate_direct_reference");
     std::cout << "=== 2. Direct Object Reference ===" << std::endl << std::endl;
     
     // CONCRETE TYPE: Direct object
@@ -141,6 +145,7 @@ void demonstrate_direct_reference() {
 // ============================================================================
 
 void demonstrate_initialization() {
+    TRACE_SCOPE("demonstrate_initialization");
     std::cout << "=== 3. Immediate and Complete Initialization ===" << std::endl << std::endl;
     
     // CONCRETE TYPE: Constructed completely in one step
@@ -178,6 +183,7 @@ void demonstrate_initialization() {
 // ============================================================================
 
 void demonstrate_copying() {
+    TRACE_SCOPE("demonstrate_copying");
     std::cout << "=== 4. Copy Objects ===" << std::endl << std::endl;
     
     // CONCRETE TYPE: Can copy directly
@@ -217,6 +223,7 @@ void demonstrate_copying() {
 // ============================================================================
 
 void demonstrate_efficiency() {
+    TRACE_SCOPE("demonstrate_efficiency");
     std::cout << "=== Why Concrete Types Are Efficient ===" << std::endl << std::endl;
     
     // MEMORY LAYOUT
@@ -273,5 +280,6 @@ int main() {
     std::cout << "  4. Value semantics (copying works naturally)" << std::endl;
     std::cout << "  5. Optimal efficiency (minimal overhead)" << std::endl;
     
+    TRACE_EXPORT("concrete_types.trace.json");  // with -DENABLE_TRACING: open in ui.perfetto.dev
     return 0;
 }
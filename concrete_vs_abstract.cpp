@@ -1,5 +1,7 @@
 #include <iostream>
 
+#include "trace.h"  // TRACE_SCOPE: compiled out unless -DENABLE_TRACING
+
 // ============================================================================
 // VISUAL EXPLANATION: What "representation is part of definition" means
 // ============================================================================
@@ -42,6 +44,7 @@ public:
 // ============================================================================
 
 void show_memory_layout() {
+    TRACE_SCOPE("show_memory_layout");
     std::cout << "=== Memory Layout Demonstration ===" << std::endl << std::endl;
     
     // CONCRETE TYPE: Full size known at compile time
@@ -95,6 +98,7 @@ public:
 };
 
 void show_abstract_type() {
+    TRACE_SCOPE("show_abstract_type");
     std::cout << "=== Abstract Type (No Fixed Representation) ===" << std::endl << std::endl;
     
     std::cout << "Abstract Shape:" << std::endl;
@@ -124,6 +128,7 @@ void show_abstract_type() {
 // ============================================================================
 
 void show_four_benefits() {
+    TRACE_SCOPE("show_four_benefits");
     std::cout << "=== The 4 Benefits of Concrete Types ===" << std::endl << std::endl;
     
     // BENEFIT 1: Stack allocation
@@ -159,6 +164,7 @@ void show_four_benefits() {
 // ============================================================================
 
 void show_efficiency() {
+    TRACE_SCOPE("show_efficiency");
     std::cout << "=== Efficiency: Concrete vs Abstract ===" << std::endl << std::endl;
     
     std::cout << "Array of 1000 Points (concrete type):" << std::endl;
@@ -174,7 +180,8 @@ void show_efficiency() {
     std::cout << "  Not cache-friendly: objects scattered in memory" << std::endl;
     std::cout << std::endl;
     
-    std::cout << "Performance difference: 10-100x faster for concrete types!" << std::endl;
+    std::cout << "Performance difference: depends on N and cache level - measure it!" << std::endl;
+    std::cout << "  (concrete_vs_abstract_bench.cpp sweeps N across L1/L2/L3/DRAM)" << std::endl;
     std::cout << "  - One allocation vs thousands" << std::endl;
     std::cout << "  - Contiguous vs scattered memory" << std::endl;
     std::cout << "  - Direct access vs pointer indirection" << std::endl;
@@ -195,5 +202,6 @@ int main() {
     std::cout << "  - Enables stack allocation, direct access, copying" << std::endl;
     std::cout << "  - Results in optimal efficiency (time & space)" << std::endl;
     
+    TRACE_EXPORT("concrete_vs_abstract.trace.json");  // with -DENABLE_TRACING: open in ui.perfetto.dev
     return 0;
 }
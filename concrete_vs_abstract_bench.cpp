@@ -0,0 +1,532 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#include "bench_util.h"
+#include "perf_scope.h"
+
+// ============================================================================
+// MEASURING "CONCRETE vs ABSTRACT" INSTEAD OF CLAIMING IT
+// ============================================================================
+//
+// concrete_vs_abstract.cpp says "10-100x faster for concrete types!".
+// This file measures it. Four experiments:
+//
+//   1. TRAVERSAL:     Point[N] (contiguous) vs Shape*[N] (heap, virtual)
+//   2. CONSTRUCTION:  object on the stack vs new/delete on the heap
+//   3. CALLS:         virtual call through Shape* vs direct call on Circle
+//   4. CONSTRUCTORS:  member initializer list vs assignment in the body
+//                     (the two Vector constructors from initializer_list.cpp)
+//
+// Each experiment is repeated for N chosen so the data fits in L1, L2, L3,
+// and finally only in DRAM - that's where the differences show up.
+//
+// HOW TO GET NUMBERS YOU CAN TRUST:
+//   - Warm up first (page faults, branch predictors, frequency scaling)
+//   - Calibrate the inner loop so one sample takes ~5 ms (timer noise << sample)
+//   - Take many samples, report MEDIAN (robust to outliers) + spread
+//   - Keep the optimizer from deleting the work: do_not_optimize()
+//   - Count what the CPU did, not just how long it took: the hardware
+//     counters (perf_scope.h) show WHY - L1/LLC misses per element confirm
+//     or refute "the prefetcher wins"
+
+// ============================================================================
+// OPTIMIZER BARRIERS
+// ============================================================================
+//
+// Without these, the compiler sees "result is never used" and removes the loop.
+// do_not_optimize(v) (bench_util.h) says "this value is read by something you
+// can't see"; clobber_memory() says the same about all of memory.
+
+inline void clobber_memory() {
+    asm volatile("" : : : "memory");
+}
+
+// ============================================================================
+// TYPES UNDER TEST (same shapes as concrete_vs_abstract.cpp)
+// ============================================================================
+
+struct Point {  // Concrete
+    int x;
+    int y;
+};
+
+class Shape {   // Abstract
+public:
+    virtual double area() const = 0;
+    virtual ~Shape() {}
+};
+
+class Circle final : public Shape {
+    double radius;
+public:
+    Circle(double r) : radius{r} {}
+    double area() const override { return 3.14159 * radius * radius; }
+};
+
+class Rectangle final : public Shape {
+    double width;
+    double height;
+public:
+    Rectangle(double w, double h) : width{w}, height{h} {}
+    double area() const override { return width * height; }
+};
+
+// The two Vector constructors from initializer_list.cpp, side by side.
+// noinline keeps each constructor a real call we can compare fairly.
+class VectorInit {
+    double* elem;
+    int sz;
+public:
+    __attribute__((noinline)) VectorInit(int s) : elem{new double[s]}, sz{s} {}
+    ~VectorInit() { delete[] elem; }
+    int size() const { return sz; }
+};
+
+class VectorAssign {
+    double* elem;
+    int sz;
+public:
+    __attribute__((noinline)) VectorAssign(int s) {
+        elem = new double[s];
+        sz = s;
+    }
+    ~VectorAssign() { delete[] elem; }
+    int size() const { return sz; }
+};
+
+// With a member that has a non-trivial default constructor the difference is
+// real: assignment = default-construct THEN assign
+struct NamedInit {
+    std::string name;
+    __attribute__((noinline)) NamedInit(const char* n) : name{n} {}
+};
+
+struct NamedAssign {
+    std::string name;
+    __attribute__((noinline)) NamedAssign(const char* n) { name = n; }
+};
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+
+struct Stats {
+    double median;
+    double mean;
+    double stddev;
+    double min;
+    double max;
+    double ci_lo;  // 95% confidence interval of the MEDIAN, from order
+    double ci_hi;  //   statistics (no assumption about the distribution)
+    PerfReading counters;  // per element, over all samples (invalid where unavailable)
+};
+
+Stats summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    std::size_t n = samples.size();
+    Stats s{};
+    s.median = (n % 2) ? samples[n / 2] : 0.5 * (samples[n / 2 - 1] + samples[n / 2]);
+    s.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+    double var = 0.0;
+    for (double x : samples) var += (x - s.mean) * (x - s.mean);
+    s.stddev = n > 1 ? std::sqrt(var / (n - 1)) : 0.0;
+    s.min = samples.front();
+    s.max = samples.back();
+    // Each sample lands below the true median with probability 1/2, so the
+    // number below it is Binomial(n, 1/2). [x_(j), x_(n-1-j)] (sorted, 0-based)
+    // covers the median unless j or fewer samples fall on one side:
+    // coverage 1 - 2 P(B <= j). Take the largest j that keeps it >= 95%.
+    // (1.96 * stddev / sqrt(n) would be the mean's interval, and only for
+    // normal samples and large n - neither holds for 7-21 timings.)
+    std::size_t j = 0;
+    double tail = 0.0;  // P(B <= k)
+    for (std::size_t k = 0; k < n / 2; ++k) {
+        double log_pmf = std::lgamma(n + 1.0) - std::lgamma(k + 1.0) - std::lgamma(double(n - k) + 1.0) -
+                         double(n) * std::log(2.0);
+        tail += std::exp(log_pmf);
+        if (tail > 0.025) break;
+        j = k;
+    }
+    s.ci_lo = samples[j];
+    s.ci_hi = samples[n - 1 - j];
+    return s;
+}
+
+struct Result {
+    std::string group;
+    std::string name;
+    std::string level;       // L1 / L2 / L3 / DRAM / -
+    std::size_t n;           // elements per operation batch
+    std::size_t bytes;       // working-set size
+    Stats ns_per_element;
+};
+
+struct Config {
+    int samples = 21;
+    double target_sample_ms = 5.0;
+};
+
+// One set of counters for the whole run: opening them costs syscalls
+const PerfCounters& bench_counters() {
+    static PerfCounters counters;
+    return counters;
+}
+
+// Runs body() (which processes `elements` items) enough times to fill one
+// sample, then records ns per element for each sample
+template <typename F>
+Stats measure(const Config& cfg, std::size_t elements, F&& body) {
+    using clock = std::chrono::steady_clock;
+
+    // Warm-up + calibration: double reps until one sample is long enough
+    std::size_t reps = 1;
+    for (;;) {
+        auto t0 = clock::now();
+        for (std::size_t r = 0; r < reps; ++r) body();
+        double ms = std::chrono::duration<double, std::milli>(clock::now() - t0).count();
+        if (ms >= cfg.target_sample_ms || reps >= (std::size_t(1) << 30)) break;
+        reps *= 2;
+    }
+
+    std::vector<double> samples;
+    samples.reserve(cfg.samples);
+    PerfReading counters;
+    {
+        PerfScope scope(bench_counters(), counters);
+        for (int i = 0; i < cfg.samples; ++i) {
+            auto t0 = clock::now();
+            for (std::size_t r = 0; r < reps; ++r) body();
+            clobber_memory();
+            double ns = std::chrono::duration<double, std::nano>(clock::now() - t0).count();
+            samples.push_back(ns / (double(reps) * elements));
+        }
+    }
+    Stats s = summarize(samples);
+    s.counters = counters.per(double(reps) * double(elements) * cfg.samples);
+    return s;
+}
+
+// ============================================================================
+// CACHE SIZES: ask the OS, fall back to typical desktop values
+// ============================================================================
+
+struct CacheLevel {
+    const char* name;
+    std::size_t bytes;
+};
+
+std::vector<CacheLevel> cache_levels() {
+    std::size_t l1 = 32 * 1024, l2 = 1024 * 1024, l3 = 32 * 1024 * 1024;
+#if defined(__linux__) && defined(_SC_LEVEL1_DCACHE_SIZE)
+    long v;
+    if ((v = sysconf(_SC_LEVEL1_DCACHE_SIZE)) > 0) l1 = v;
+    if ((v = sysconf(_SC_LEVEL2_CACHE_SIZE)) > 0) l2 = v;
+    if ((v = sysconf(_SC_LEVEL3_CACHE_SIZE)) > 0) l3 = v;
+#endif
+    // Half of each level so the working set really fits; 4x L3 for DRAM
+    return {{"L1", l1 / 2}, {"L2", l2 / 2}, {"L3", l3 / 2}, {"DRAM", l3 * 4}};
+}
+
+// ============================================================================
+// EXPERIMENT 1: TRAVERSAL
+// ============================================================================
+//
+//   Point[N]:   [x y][x y][x y][x y]...           <- one stream, prefetcher wins
+//   Shape*[N]:  [p][p][p]...  each p -> somewhere on the heap
+//               load pointer, load vptr, load vtable slot, indirect call
+
+void bench_traversal(const Config& cfg, const CacheLevel& level, std::vector<Result>& out) {
+    // Size N by the bytes the ABSTRACT layout touches (pointer + object),
+    // so both sides are compared at the same N
+    std::size_t per_shape = sizeof(Shape*) + sizeof(Rectangle);
+    std::size_t n = std::max<std::size_t>(level.bytes / per_shape, 64);
+
+    std::vector<Point> points(n);
+    for (std::size_t i = 0; i < n; ++i) points[i] = {int(i), int(i * 3)};
+
+    out.push_back({"traversal", "Point[N] contiguous sum", level.name, n, n * sizeof(Point),
+                   measure(cfg, n, [&] {
+                       long long sum = 0;
+                       for (const Point& p : points) sum += p.x + p.y;
+                       do_not_optimize(sum);
+                   })});
+
+    std::vector<Shape*> shapes(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 2 == 0) shapes[i] = new Circle(1.0 + i % 7);
+        else            shapes[i] = new Rectangle(1.0, 1.0 + i % 5);
+    }
+
+    auto virtual_sum = [&] {
+        double sum = 0.0;
+        for (const Shape* s : shapes) sum += s->area();
+        do_not_optimize(sum);
+    };
+
+    out.push_back({"traversal", "Shape*[N] virtual, allocation order", level.name, n,
+                   n * per_shape, measure(cfg, n, virtual_sum)});
+
+    // A long-running program's heap isn't in allocation order: shuffle the
+    // pointers so consecutive elements live far apart
+    std::mt19937 rng(12345);
+    std::shuffle(shapes.begin(), shapes.end(), rng);
+    out.push_back({"traversal", "Shape*[N] virtual, shuffled heap", level.name, n,
+                   n * per_shape, measure(cfg, n, virtual_sum)});
+
+    for (Shape* s : shapes) delete s;
+}
+
+// ============================================================================
+// EXPERIMENT 2: STACK vs HEAP CONSTRUCTION
+// ============================================================================
+
+void bench_construction(const Config& cfg, std::vector<Result>& out) {
+    const std::size_t n = 1024;
+
+    out.push_back({"construction", "Point on stack", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            Point p{int(i), int(i)};
+            do_not_optimize(p);
+        }
+    })});
+
+    out.push_back({"construction", "Circle on stack", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            Circle c{double(i)};
+            do_not_optimize(c);
+        }
+    })});
+
+    out.push_back({"construction", "new/delete Circle", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            Shape* s = new Circle(double(i));
+            do_not_optimize(s);
+            delete s;
+        }
+    })});
+
+    // Batch: allocate all, then free all (heap has to track n live objects)
+    std::vector<Shape*> batch(n);
+    out.push_back({"construction", "new N Circles, then delete N", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) batch[i] = new Circle(double(i));
+        do_not_optimize(batch.data());
+        for (std::size_t i = 0; i < n; ++i) delete batch[i];
+    })});
+}
+
+// ============================================================================
+// EXPERIMENT 3: VIRTUAL vs DIRECT CALLS (data is hot in L1 for both)
+// ============================================================================
+
+void bench_calls(const Config& cfg, std::vector<Result>& out) {
+    const std::size_t n = 1024;
+    std::vector<Circle> circles;
+    circles.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) circles.emplace_back(1.0 + i % 7);
+
+    std::vector<const Shape*> same_type(n);
+    for (std::size_t i = 0; i < n; ++i) same_type[i] = &circles[i];
+
+    // Circle is final -> c.area() is a direct (and inlinable) call
+    out.push_back({"calls", "direct Circle::area()", "-", n, 0, measure(cfg, n, [&] {
+        double sum = 0.0;
+        for (const Circle& c : circles) sum += c.area();
+        do_not_optimize(sum);
+    })});
+
+    // Same objects, through the base pointer: indirect call, not inlinable
+    out.push_back({"calls", "virtual Shape::area(), one type", "-", n, 0, measure(cfg, n, [&] {
+        double sum = 0.0;
+        for (const Shape* s : same_type) sum += s->area();
+        do_not_optimize(sum);
+    })});
+
+    // Mixed types in random order: the branch predictor can't guess the target
+    std::vector<Rectangle> rects;
+    rects.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) rects.emplace_back(1.0, 1.0 + i % 5);
+    std::vector<const Shape*> mixed(n);
+    std::mt19937 rng(777);
+    for (std::size_t i = 0; i < n; ++i) {
+        mixed[i] = (rng() & 1) ? static_cast<const Shape*>(&circles[i]) : &rects[i];
+    }
+    out.push_back({"calls", "virtual Shape::area(), random types", "-", n, 0, measure(cfg, n, [&] {
+        double sum = 0.0;
+        for (const Shape* s : mixed) sum += s->area();
+        do_not_optimize(sum);
+    })});
+}
+
+// ============================================================================
+// EXPERIMENT 4: INITIALIZER LIST vs ASSIGNMENT IN THE BODY
+// ============================================================================
+
+void bench_constructors(const Config& cfg, std::vector<Result>& out) {
+    const std::size_t n = 256;
+
+    out.push_back({"constructors", "Vector(int) : elem{..}, sz{..}", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            VectorInit v(8);
+            do_not_optimize(v);
+        }
+    })});
+
+    out.push_back({"constructors", "Vector(int) { elem = ..; sz = ..; }", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            VectorAssign v(8);
+            do_not_optimize(v);
+        }
+    })});
+
+    // 40 chars: longer than the small-string buffer -> a real allocation
+    const char* long_name = "a name long enough to need the heap.....";
+    out.push_back({"constructors", "std::string member : name{n}", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            NamedInit x(long_name);
+            do_not_optimize(x);
+        }
+    })});
+
+    out.push_back({"constructors", "std::string member { name = n; }", "-", n, 0, measure(cfg, n, [&] {
+        for (std::size_t i = 0; i < n; ++i) {
+            NamedAssign x(long_name);
+            do_not_optimize(x);
+        }
+    })});
+}
+
+// ============================================================================
+// OUTPUT
+// ============================================================================
+
+std::string json_escape(const std::string& s) {
+    std::string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        r += c;
+    }
+    return r;
+}
+
+std::string to_json(const std::vector<Result>& results, const Config& cfg) {
+    std::ostringstream os;
+    os.precision(6);
+    os << "{\n  \"samples_per_benchmark\": " << cfg.samples << ",\n";
+    os << "  \"unit\": \"ns_per_element\",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        const Stats& s = r.ns_per_element;
+        os << "    {\"group\": \"" << json_escape(r.group) << "\", \"name\": \"" << json_escape(r.name)
+           << "\", \"level\": \"" << r.level << "\", \"n\": " << r.n << ", \"bytes\": " << r.bytes
+           << ", \"median\": " << s.median << ", \"mean\": " << s.mean << ", \"stddev\": " << s.stddev
+           << ", \"min\": " << s.min << ", \"max\": " << s.max << ", \"median_ci95\": [" << s.ci_lo << ", "
+           << s.ci_hi << "]";
+        // Only the counters this machine has; a missing key means "not measured", not 0
+        os << ", \"counters_per_element\": {";
+        const char* sep = "";
+        for (int e = 0; e < kPerfEventCount; ++e) {
+            if (!s.counters.valid[e]) continue;
+            os << sep << "\"" << perf_event_name(PerfEvent(e)) << "\": " << s.counters.value[e];
+            sep = ", ";
+        }
+        os << "}}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+    return os.str();
+}
+
+void print_table(const std::vector<Result>& results) {
+    std::string group;
+    for (const Result& r : results) {
+        if (r.group != group) {
+            group = r.group;
+            std::cout << std::endl << "--- " << group << " ---" << std::endl;
+        }
+        std::cout << "  ";
+        std::cout.width(40);
+        std::cout << std::left << r.name;
+        std::cout.width(6);
+        std::cout << r.level;
+        std::cout << " N=";
+        std::cout.width(10);
+        std::cout << r.n << std::right;
+        std::cout << " median " << r.ns_per_element.median << " ns  (CI " << r.ns_per_element.ci_lo << ".."
+                  << r.ns_per_element.ci_hi << ", min " << r.ns_per_element.min << ")";
+        const PerfReading& c = r.ns_per_element.counters;
+        if (c.has(PerfEvent::L1dMisses)) std::cout << "  L1d-miss/elem " << c.get(PerfEvent::L1dMisses);
+        if (c.has(PerfEvent::LlcMisses)) std::cout << "  LLC-miss/elem " << c.get(PerfEvent::LlcMisses);
+        if (c.has(PerfEvent::BranchMisses)) std::cout << "  br-miss/elem " << c.get(PerfEvent::BranchMisses);
+        if (c.ipc() > 0) std::cout << "  IPC " << c.ipc();
+        std::cout << std::endl;
+    }
+    if (!bench_counters().any_hardware()) {
+        std::cout << std::endl << "(hardware counters unavailable: " << bench_counters().unavailable_reason() << ")"
+                  << std::endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    Config cfg;
+    std::string json_path;
+    bool quick = false;
+    int samples = 0;  // 0: not given
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) json_path = argv[++i];
+        else if (std::strcmp(argv[i], "--quick") == 0) quick = true;
+        else if (std::strcmp(argv[i], "--samples") == 0 && i + 1 < argc) samples = std::atoi(argv[++i]);
+    }
+    if (quick) {
+        cfg.samples = 7;
+        cfg.target_sample_ms = 1.0;
+    }
+    if (samples != 0) cfg.samples = samples;  // an explicit --samples wins over --quick
+    // With fewer than 6 samples even [min, max] covers the median less than 95% of the time
+    if (cfg.samples < 6) cfg.samples = 6;
+
+    std::cout << "=== Concrete vs Abstract: Measured ===" << std::endl;
+    std::cout << "Samples per benchmark: " << cfg.samples << " (median and its 95% CI, ns per element)" << std::endl;
+
+    std::vector<CacheLevel> levels = cache_levels();
+    if (quick) levels.pop_back();  // skip the DRAM-sized run
+    std::cout << "Working-set sizes:";
+    for (const CacheLevel& l : levels) std::cout << " " << l.name << "=" << l.bytes / 1024 << "KB";
+    std::cout << std::endl;
+
+    std::vector<Result> results;
+    for (const CacheLevel& l : levels) bench_traversal(cfg, l, results);
+    bench_construction(cfg, results);
+    bench_calls(cfg, results);
+    bench_constructors(cfg, results);
+
+    print_table(results);
+
+    if (!json_path.empty()) {
+        std::ofstream out(json_path);
+        out << to_json(results, cfg);
+        std::cout << std::endl << "JSON written to " << json_path << std::endl;
+    }
+
+    std::cout << std::endl << "=== Reading the Numbers ===" << std::endl;
+    std::cout << "• Traversal: the gap grows with N - small in L1, largest once data is in DRAM" << std::endl;
+    std::cout << "• Shuffled heap is the realistic case for long-running programs" << std::endl;
+    std::cout << "• Virtual calls cost most when the target type is unpredictable" << std::endl;
+    std::cout << "• Initializer list vs assignment: same for pointers/ints, differs for std::string" << std::endl;
+    std::cout << "• Misses per element (where the CPU exposes counters) name the cause: Point[N] takes" << std::endl;
+    std::cout << "  ~1/8 L1d miss per element (8 Points per 64-byte line), a shuffled heap ~1 or more" << std::endl;
+
+    return 0;
+}
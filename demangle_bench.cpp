@@ -0,0 +1,358 @@
+// In-process demangling: Demangler vs abi::__cxa_demangle vs c++filt
+// (link with demangler.cpp and alloc_tracker.cpp)
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <cxxabi.h>
+#include <unistd.h>
+
+#include "alloc_tracker.h"
+#include "bench_util.h"
+#include "demangler.h"
+
+// ============================================================================
+// THE PROBLEM
+// ============================================================================
+// A symbolizer turns millions of addresses into names. The names in the
+// binary are mangled (operator_grammar.cpp: _ZN4DemoplEi), so every one has
+// to be demangled. Three ways to do it:
+//
+//   nm | c++filt              one process, pipes, text in and out
+//   abi::__cxa_demangle       in-process, but malloc's a fresh buffer
+//                             (and internal state) for every symbol
+//   Demangler::demangle_batch in-process, parse nodes in a reused arena,
+//                             all results appended to one buffer
+//
+// The first two are the reference: the Demangler's output must be the same
+// text, symbol for symbol.
+
+// ============================================================================
+// THE CORPUS: every _Z symbol in this binary and in libstdc++
+// ============================================================================
+
+std::string run(const std::string& command) {
+    std::string text;
+    FILE* pipe = popen(command.c_str(), "r");
+    if (!pipe) return text;
+    char buf[1 << 16];
+    std::size_t n;
+    while ((n = std::fread(buf, 1, sizeof buf, pipe)) > 0) text.append(buf, n);
+    pclose(pipe);
+    return text;
+}
+
+// The libstdc++ this process actually loaded, from /proc/self/maps
+std::string loaded_libstdcxx() {
+    std::ifstream maps("/proc/self/maps");
+    std::string line;
+    while (std::getline(maps, line)) {
+        std::size_t at = line.find('/');
+        if (at != std::string::npos && line.find("libstdc++.so", at) != std::string::npos) return line.substr(at);
+    }
+    return "";
+}
+
+// "nm -P" prints "name type [value size]"; symbol versions (@GLIBCXX_3.4)
+// aren't part of the mangled name
+void collect_symbols(const std::string& path, std::vector<std::string>& out) {
+    std::istringstream in(run("nm -P --defined-only " + path + " 2>/dev/null; nm -P -D --defined-only " + path +
+                              " 2>/dev/null"));
+    std::string line;
+    while (std::getline(in, line)) {
+        std::string name = line.substr(0, line.find(' '));
+        name = name.substr(0, name.find('@'));
+        if (name.size() > 2 && name[0] == '_' && name[1] == 'Z') out.push_back(name);
+    }
+}
+
+std::vector<std::string> build_corpus(const std::string& library) {
+    std::vector<std::string> symbols;
+    char self[4096];
+    ssize_t len = readlink("/proc/self/exe", self, sizeof self - 1);  // nm's own /proc/self is nm
+    if (len > 0) collect_symbols(std::string(self, std::size_t(len)), symbols);
+    std::size_t own = symbols.size();
+    if (!library.empty()) collect_symbols(library, symbols);
+    std::cout << "  " << own << " from this binary, " << symbols.size() - own << " from "
+              << (library.empty() ? "(no library found)" : library) << std::endl;
+    return symbols;
+}
+
+// ============================================================================
+// CORRECTNESS
+// ============================================================================
+
+struct Tricky {
+    const char* mangled;
+    const char* expected;
+};
+
+// One line per corner of the grammar - each of these broke a naive printer
+const Tricky kTricky[] = {
+    {"_ZN4DemoplEi", "Demo::operator+(int)"},
+    {"_ZN4DemomiERKS_", "Demo::operator-(Demo const&)"},
+    {"_ZN4DemoixEm", "Demo::operator[](unsigned long)"},
+    {"_ZN4DemoclEv", "Demo::operator()()"},
+    {"_ZN4DemocviEv", "Demo::operator int()"},
+    {"_Zli3_kmPKcm", "operator\"\" _km(char const*, unsigned long)"},
+    {"_ZN6VectorC2Ei", "Vector::Vector(int)"},
+    {"_ZN6VectorD1Ev", "Vector::~Vector()"},
+    {"_ZNSt6vectorIiSaIiEE9push_backEOi", "std::vector<int, std::allocator<int> >::push_back(int&&)"},
+    {"_ZNKSt8functionIFviEEclEi", "std::function<void (int)>::operator()(int) const"},
+    {"_Z5applyPFviEi", "apply(void (*)(int), int)"},
+    {"_Z3sumRA3_Ki", "sum(int const (&) [3])"},
+    {"_Z1fM5ShapeKFdvE", "f(double (Shape::*)() const)"},
+    {"_Z3maxIiET_S0_S0_", "int max<int>(int, int)"},
+    {"_Z5printIJidEEvDpT_", "void print<int, double>(int, double)"},
+    {"_ZZ4mainENKUlvE_clEv", "main::{lambda()#1}::operator()() const"},
+    {"_ZZ4mainE5count", "main::count"},
+    {"_ZN12_GLOBAL__N_14implEv", "(anonymous namespace)::impl()"},
+    {"_ZNK6Circle4areaB5cxx11Ev", "Circle::area[abi:cxx11]() const"},
+    {"_ZTV6Circle", "vtable for Circle"},
+    {"_ZTI5Shape", "typeinfo for Shape"},
+    {"_ZThn8_N6Circle4areaEv", "non-virtual thunk to Circle::area()"},
+    {"_ZGVZ4mainE1x", "guard variable for main::x"},
+    {"_Z1fIiEDTplfp_Li1EET_", "decltype ({parm#1}+(1)) f<int>(int)"},
+    {"_Z3foov.cold", "foo() [clone .cold]"},
+    {"_Z3barv.constprop.0", "bar() [clone .constprop.0]"},
+    {"_ZN1BCI11AEi", "B::A(int)"},
+};
+
+void check_tricky() {
+    std::cout << "=== Corners of the Grammar ===" << std::endl;
+    Demangler demangler;
+    int wrong = 0;
+    for (const Tricky& t : kTricky) {
+        std::string_view mine = demangler.demangle(t.mangled);
+        int status = 0;
+        char* ref = abi::__cxa_demangle(t.mangled, nullptr, nullptr, &status);
+        bool ok = mine == t.expected && ref && mine == ref;
+        if (!ok) {
+            ++wrong;
+            std::cout << "  " << t.mangled << "\n    got      " << mine << "\n    expected " << t.expected
+                      << "\n    libstdc++ " << (ref ? ref : "(failed)") << std::endl;
+        }
+        std::free(ref);
+    }
+    std::cout << "  _ZN4DemoplEi -> " << demangler.demangle("_ZN4DemoplEi") << std::endl;
+    check(wrong == 0, std::to_string(sizeof kTricky / sizeof kTricky[0]) +
+                          " hand-picked symbols, same as expected and as __cxa_demangle");
+    check(demangler.demangle("_ZN4Demo").empty() && demangler.demangle("main").empty() &&
+              demangler.demangle("_Z1fIiEvT0_").empty(),
+          "truncated names, C names and dangling template parameters are rejected");
+    // __cxa_demangle fails on these too: no C8/D3 kind, a function type needs a parameter (v for none)
+    check(demangler.demangle("_ZN1AC8Ev").empty() && demangler.demangle("_ZN1AD3Ev").empty() &&
+              demangler.demangle("_Z1fPFvE").empty(),
+          "unknown constructor/destructor kinds and parameterless F...E are rejected");
+    std::cout << std::endl;
+}
+
+void check_corpus(const std::vector<std::string>& symbols) {
+    std::cout << "=== Same Text as __cxa_demangle ===" << std::endl;
+    Demangler demangler;
+    std::size_t same = 0, compared = 0, ref_failed = 0, shown = 0;
+    for (const std::string& symbol : symbols) {
+        int status = 0;
+        char* ref = abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status);
+        if (!ref) {
+            ++ref_failed;  // __cxa_demangle gives up on some valid names
+            continue;
+        }
+        ++compared;
+        std::string_view mine = demangler.demangle(symbol);
+        if (mine == ref) {
+            ++same;
+        } else if (shown++ < 3) {
+            std::cout << "  " << symbol << "\n    mine " << mine << "\n    ref  " << ref << std::endl;
+        }
+        std::free(ref);
+    }
+    double rate = compared ? 100.0 * double(same) / double(compared) : 0;
+    std::cout << "  " << same << " / " << compared << " identical (" << rate << "%), " << ref_failed
+              << " not demangled by __cxa_demangle" << std::endl;
+    check(compared > 0 && same == compared, "every name __cxa_demangle handles comes out identical");
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// THROUGHPUT
+// ============================================================================
+
+void report(const char* what, double ms, std::size_t n) {
+    std::cout << "  " << what << ms << " ms  (" << ms * 1e6 / double(n) << " ns/symbol)" << std::endl;
+}
+
+void benchmark(const std::vector<std::string>& symbols) {
+    std::cout << "=== Throughput: " << symbols.size() << " Symbols ===" << std::endl;
+    std::vector<std::string_view> views(symbols.begin(), symbols.end());
+    std::size_t n = symbols.size();
+
+    double cxa_ms = time_ms([&] {
+        for (const std::string& symbol : symbols) {
+            int status = 0;
+            char* out = abi::__cxa_demangle(symbol.c_str(), nullptr, nullptr, &status);
+            do_not_optimize(out);
+            std::free(out);
+        }
+    });
+    report("__cxa_demangle (malloc per call)      ", cxa_ms, n);
+
+    // Its own buffer-reuse mode: pass the last buffer back, it realloc's
+    std::size_t length = 0;
+    char* buffer = nullptr;
+    double cxa_reuse_ms = time_ms([&] {
+        for (const std::string& symbol : symbols) {
+            int status = 0;
+            char* out = abi::__cxa_demangle(symbol.c_str(), buffer, &length, &status);
+            if (out) buffer = out;
+            do_not_optimize(buffer);
+        }
+    });
+    std::free(buffer);
+    report("__cxa_demangle (reused output buffer) ", cxa_reuse_ms, n);
+
+    Demangler demangler;
+    std::size_t chars = 0;
+    double single_ms = time_ms([&] {
+        for (std::string_view symbol : views) chars += demangler.demangle(symbol).size();
+    });
+    do_not_optimize(chars);
+    report("Demangler::demangle                   ", single_ms, n);
+
+    DemangledBatch batch;
+    demangler.demangle_batch(views, batch);  // sizes the buffers once
+    double batch_ms = time_ms([&] {
+        batch.clear();
+        demangler.demangle_batch(views, batch);
+    });
+    report("Demangler::demangle_batch             ", batch_ms, n);
+    // One pass each: the ratio moves from run to run, so it's reported, not checked
+    std::cout << "  speedup over __cxa_demangle: " << cxa_ms / batch_ms << "x" << std::endl;
+
+    // Steady state: nothing allocated per symbol
+    std::uint64_t before = thread_allocations();
+    batch.clear();
+    demangler.demangle_batch(views, batch);
+    std::uint64_t batch_allocs = thread_allocations() - before;
+    before = thread_allocations();
+    for (std::string_view symbol : views) do_not_optimize(demangler.demangle(symbol));
+    std::uint64_t single_allocs = thread_allocations() - before;
+    std::cout << "  allocations in a warm pass: batch " << batch_allocs << ", demangle() " << single_allocs
+              << " (arena " << demangler.arena_bytes() / 1024 << " KiB)" << std::endl;
+    check(batch_allocs == 0 && single_allocs == 0, "zero heap allocations per symbol once warm");
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// AS A FILTER: c++filt's job, in-process
+// ============================================================================
+
+void shorten_std_names(std::string& text) {
+    static const char* const kLong[][2] = {
+        {"std::basic_string<char, std::char_traits<char>, std::allocator<char> >", "std::string"},
+        {"std::basic_iostream<char, std::char_traits<char> >", "std::iostream"},
+        {"std::basic_istream<char, std::char_traits<char> >", "std::istream"},
+        {"std::basic_ostream<char, std::char_traits<char> >", "std::ostream"},
+    };
+    for (const auto& names : kLong) {
+        std::size_t from_len = std::strlen(names[0]);
+        std::size_t to_len = std::strlen(names[1]);
+        for (std::size_t at = text.find(names[0]); at != std::string::npos; at = text.find(names[0], at + 1)) {
+            text.replace(at, from_len, names[1]);
+            // The long name ended in '>', so a closing '>' after it got a
+            // space: "hash<std::string >". The short one doesn't: "hash<std::string>"
+            if (text.compare(at + to_len, 2, " >") == 0) text.erase(at + to_len, 1);
+        }
+    }
+}
+
+void compare_filter(const std::vector<std::string>& symbols) {
+    std::cout << "=== Filtering nm-style Text vs c++filt ===" << std::endl;
+    std::string text;
+    for (std::size_t i = 0; i < symbols.size(); ++i)
+        text += "0000000000" + std::to_string(i) + " T " + symbols[i] + "\n";
+
+    Demangler demangler;
+    std::string mine;
+    double filter_ms = time_ms([&] { demangler.filter(text, mine); });
+    std::cout << "  Demangler::filter  " << filter_ms << " ms for " << text.size() / 1024 << " KiB" << std::endl;
+
+    if (run("command -v c++filt").empty()) {
+        std::cout << "  (c++filt not found - comparison skipped)" << std::endl << std::endl;
+        return;
+    }
+    char in_path[] = "/tmp/demangle_bench_XXXXXX";
+    int fd = mkstemp(in_path);
+    if (fd < 0) return;
+    if (write(fd, text.data(), text.size()) != ssize_t(text.size())) std::cout << "  (short write)" << std::endl;
+    close(fd);
+    std::string theirs;
+    double cxxfilt_ms = time_ms([&] { theirs = run(std::string("c++filt < ") + in_path); });
+    unlink(in_path);
+    std::cout << "  c++filt (process)  " << cxxfilt_ms << " ms" << std::endl;
+
+    // c++filt asks for verbose output: Ss is std::basic_string<char, ...>
+    // there, std::string in __cxa_demangle. Spell both sides the short way.
+    shorten_std_names(mine);
+    shorten_std_names(theirs);
+    std::istringstream a(mine), b(theirs);
+    std::string la, lb;
+    std::size_t lines = 0, same = 0, skew = 0;
+    while (std::getline(a, la) && std::getline(b, lb)) {
+        ++lines;
+        if (la == lb) {
+            ++same;
+            continue;
+        }
+        // c++filt is binutils' copy of the demangler and can be a different
+        // version from libstdc++'s: (std::declval<T>)() there, std::declval<T>()
+        // here. Such a line must still be exactly __cxa_demangle's text.
+        std::size_t i = lines - 1;
+        int status = 0;
+        char* ref = i < symbols.size() ? abi::__cxa_demangle(symbols[i].c_str(), nullptr, nullptr, &status) : nullptr;
+        if (ref) {
+            std::string expected = "0000000000" + std::to_string(i) + " T " + ref;
+            shorten_std_names(expected);
+            skew += la == expected;
+            std::free(ref);
+        }
+    }
+    std::cout << "  " << same << " / " << lines << " lines identical, " << cxxfilt_ms / filter_ms
+              << "x faster in-process" << std::endl;
+    if (skew) std::cout << "  " << skew << " lines where this c++filt disagrees with __cxa_demangle" << std::endl;
+    check(lines == symbols.size() && same + skew == lines,
+          "filter output is identical to c++filt's (or to __cxa_demangle's where they differ)");
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== In-process Itanium Demangler ===" << std::endl;
+    std::cout << std::endl;
+    std::string library = argc > 1 ? argv[1] : loaded_libstdcxx();
+
+    check_tricky();
+
+    std::cout << "=== Corpus ===" << std::endl;
+    std::vector<std::string> symbols = build_corpus(library);
+    std::cout << std::endl;
+    check_corpus(symbols);
+    benchmark(symbols);
+    compare_filter(symbols);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Parse into arena-allocated nodes, print from the tree: declarators (void (*)(int)) need both" << std::endl;
+    std::cout << "• Substitutions and template parameters point at nodes - S0_ and T_ cost one table lookup" << std::endl;
+    std::cout << "• Reset the arena, keep the buffers: after warm-up a symbol costs no malloc at all" << std::endl;
+    std::cout << "• One output buffer plus end offsets replaces a string per symbol" << std::endl;
+    std::cout << "• A process per batch (c++filt) pays for pipes and text; in-process skips both" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,2104 @@
+// Itanium C++ ABI demangler (see demangler.h): parse nodes, parser, printer
+#include "demangler.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace {
+
+constexpr int kMaxParseDepth = 256;
+constexpr int kMaxPrintDepth = 512;
+constexpr std::size_t kMaxOutput = 1 << 20;  // substitutions can expand exponentially
+
+// ============================================================================
+// PRINTER STATE
+// ============================================================================
+
+struct TemplateNode;
+
+struct Printer {
+    std::string& s;
+    std::size_t start;    // demangle_to() appends: don't look before this
+    int pack_index = -1;  // which element of a pack a pack expansion is printing
+    const TemplateNode* scope = nullptr;             // whose arguments T_ means right now
+    const TemplateNode* current_template = nullptr;  // innermost template being printed
+    int depth = 0;
+    bool failed = false;
+    std::size_t trimmed_at = std::string::npos;  // where an empty pack's ", " was taken back
+
+    explicit Printer(std::string& out) : s(out), start(out.size()) {}
+    void add(std::string_view v) { s.append(v.data(), v.size()); }
+    void add(char c) { s.push_back(c); }
+    // After a trimmed ", " this still reports the ' ' (as libiberty does):
+    // A<B<int>, (empty pack)> prints A<B<int>> - the spacing is part of the output format
+    char last() const {
+        if (s.size() == trimmed_at) return ' ';
+        return s.size() > start ? s.back() : '\0';
+    }
+    void number(long n) {
+        char buf[24];
+        int len = 0;
+        if (n < 0) {
+            add('-');
+            n = -n;
+        }
+        do buf[len++] = char('0' + n % 10);
+        while ((n /= 10) != 0);
+        while (len) add(buf[--len]);
+    }
+};
+
+// ============================================================================
+// NODES
+// ============================================================================
+// Each node prints in two halves so declarators come out right:
+//
+//   pointer to function returning int:   int (*)(char)
+//                                        └left─┘└right─┘
+//   the pointer's left prints its pointee's left, then "(*"; its right
+//   prints ")" and the pointee's right. Names and most types have only a left.
+
+enum class K : unsigned char {
+    Name, Builtin, StdSub, Nested, Template, AbiTag, Special, CtorVtable, RefTemp, CtorDtor,
+    Operator, Conversion, Qual, VendorQual, Pointer, Reference, PtrMem, Function, Array,
+    Vector, Postfix, Encoding, Local, Lambda, Unnamed, Binding, TemplateParam, Auto, ArgPack,
+    PackExpansion, Decltype, FunctionParam, Literal, Unary, Binary, Trinary, New, ExprList,
+    InitList, SizeofPack, Clone, ExceptionSpec
+};
+
+struct Node {
+    K kind;
+    explicit Node(K k) : kind(k) {}
+    virtual void left(Printer& p) const = 0;
+    virtual void right(Printer&) const {}
+    // The argument pack a pack expansion iterates over (through template parameters)
+    virtual const Node* find_pack(Printer&) const { return nullptr; }
+};
+
+struct NodeArray {
+    Node** data = nullptr;
+    std::size_t size = 0;
+    Node* const* begin() const { return data; }
+    Node* const* end() const { return data + size; }
+};
+
+void print_left(const Node* n, Printer& p) {
+    if (p.failed) return;
+    if (!n || ++p.depth > kMaxPrintDepth || p.s.size() - p.start > kMaxOutput) {
+        p.failed = true;
+        return;
+    }
+    n->left(p);
+    --p.depth;
+}
+
+void print_right(const Node* n, Printer& p) {
+    if (p.failed) return;
+    if (!n || ++p.depth > kMaxPrintDepth) {
+        p.failed = true;
+        return;
+    }
+    n->right(p);
+    --p.depth;
+}
+
+void print(const Node* n, Printer& p) {
+    print_left(n, p);
+    print_right(n, p);
+}
+
+// "a, b, c". An element that prints nothing (an empty pack) loses its comma
+// only when everything after it is empty too: libiberty prints f<>(A, , B)
+// for f<>(A, Ts const&..., B) with an empty Ts, and so do we.
+void print_list(const NodeArray& list, Printer& p) {
+    std::size_t keep = p.s.size();  // end of the last element that printed something
+    for (std::size_t i = 0; i < list.size; ++i) {
+        if (i > 0) p.add(", ");
+        std::size_t before = p.s.size();
+        print(list.data[i], p);
+        if (p.s.size() != before) keep = p.s.size();
+    }
+    if (p.s.size() != keep) {
+        p.s.resize(keep);
+        p.trimmed_at = keep;
+    }
+}
+
+const Node* find_pack_in(const NodeArray& list, Printer& p) {
+    for (const Node* n : list)
+        if (const Node* pack = n->find_pack(p)) return pack;
+    return nullptr;
+}
+
+const Node* find_pack_of(const Node* n, Printer& p) { return n ? n->find_pack(p) : nullptr; }
+
+void print_quals(unsigned char cv, Printer& p) {
+    if (cv & 1) p.add(" const");
+    if (cv & 2) p.add(" volatile");
+    if (cv & 4) p.add(" restrict");
+}
+
+struct NameNode : Node {
+    std::string_view text;
+    std::string_view base;  // constructor name for std:: substitutions ("basic_string")
+    char literal;           // builtins: how a literal of this type prints (i, j, l, m, x, y, b, f)
+    NameNode(K k, std::string_view t, std::string_view b = {}, char lit = 0) : Node(k), text(t), base(b), literal(lit) {}
+    void left(Printer& p) const override { p.add(text); }
+};
+
+struct NestedNode : Node {
+    const Node* prefix;
+    const Node* name;
+    NestedNode(const Node* a, const Node* b) : Node(K::Nested), prefix(a), name(b) {}
+    void left(Printer& p) const override {
+        print(prefix, p);
+        p.add("::");
+        print(name, p);
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(prefix, p);
+        return pack ? pack : find_pack_of(name, p);
+    }
+};
+
+// A template's arguments are in scope while its name and everything below it
+// prints (conversion operators need them: A::operator T<int>())
+struct CurrentTemplate {
+    Printer& p;
+    const TemplateNode* saved;
+    CurrentTemplate(Printer& pr, const TemplateNode* t) : p(pr), saved(pr.current_template) { p.current_template = t; }
+    ~CurrentTemplate() { p.current_template = saved; }
+};
+
+// T_ means the arguments of the function being printed
+struct TemplateScope {
+    Printer& p;
+    const TemplateNode* saved;
+    TemplateScope(Printer& pr, const TemplateNode* t) : p(pr), saved(pr.scope) { p.scope = t; }
+    ~TemplateScope() { p.scope = saved; }
+};
+
+struct TemplateNode : Node {
+    const Node* name;
+    NodeArray args;
+    TemplateNode(const Node* n, NodeArray a) : Node(K::Template), name(n), args(a) {}
+    void left(Printer& p) const override {
+        CurrentTemplate current(p, this);
+        print(name, p);
+        if (p.last() == '<') p.add(' ');  // operator< <int>
+        p.add('<');
+        print_list(args, p);
+        if (p.last() == '>') p.add(' ');  // vector<vector<int> >
+        p.add('>');
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(name, p);
+        return pack ? pack : find_pack_in(args, p);
+    }
+};
+
+struct AbiTagNode : Node {
+    const Node* inner;
+    std::string_view tag;
+    AbiTagNode(const Node* n, std::string_view t) : Node(K::AbiTag), inner(n), tag(t) {}
+    void left(Printer& p) const override {
+        print(inner, p);
+        p.add("[abi:");
+        p.add(tag);
+        p.add(']');
+    }
+};
+
+// "vtable for X", "non-virtual thunk to X", ...
+struct SpecialNode : Node {
+    std::string_view prefix;
+    const Node* child;
+    SpecialNode(std::string_view t, const Node* c) : Node(K::Special), prefix(t), child(c) {}
+    void left(Printer& p) const override {
+        p.add(prefix);
+        print(child, p);
+    }
+};
+
+struct CtorVtableNode : Node {
+    const Node* complete;
+    const Node* base;
+    CtorVtableNode(const Node* a, const Node* b) : Node(K::CtorVtable), complete(a), base(b) {}
+    void left(Printer& p) const override {
+        p.add("construction vtable for ");
+        print(base, p);
+        p.add("-in-");
+        print(complete, p);
+    }
+};
+
+struct RefTempNode : Node {
+    const Node* name;
+    long number;
+    RefTempNode(const Node* n, long num) : Node(K::RefTemp), name(n), number(num) {}
+    void left(Printer& p) const override {
+        p.add("reference temporary #");
+        p.number(number);
+        p.add(" for ");
+        print(name, p);
+    }
+};
+
+struct CtorDtorNode : Node {
+    std::string_view base;
+    bool dtor;
+    CtorDtorNode(std::string_view b, bool d) : Node(K::CtorDtor), base(b), dtor(d) {}
+    void left(Printer& p) const override {
+        if (dtor) p.add('~');
+        p.add(base);
+    }
+};
+
+// The operator table: mangled code, spelling, operand count
+struct OperatorInfo {
+    char code[3];
+    const char* symbol;
+    unsigned char arity;
+};
+
+const OperatorInfo kOperators[] = {
+    {"aN", "&=", 2},         {"aS", "=", 2},           {"aa", "&&", 2},          {"ad", "&", 1},
+    {"an", "&", 2},          {"at", "alignof ", 1},    {"aw", "co_await ", 1},   {"az", "alignof ", 1},
+    {"cc", "const_cast", 2}, {"cl", "()", 2},          {"cm", ",", 2},           {"co", "~", 1},
+    {"dV", "/=", 2},         {"da", "delete[] ", 1},   {"dc", "dynamic_cast", 2}, {"de", "*", 1},
+    {"dl", "delete ", 1},    {"ds", ".*", 2},          {"dt", ".", 2},           {"dv", "/", 2},
+    {"eO", "^=", 2},         {"eo", "^", 2},           {"eq", "==", 2},          {"ge", ">=", 2},
+    {"gs", "::", 1},         {"gt", ">", 2},           {"ix", "[]", 2},          {"lS", "<<=", 2},
+    {"le", "<=", 2},         {"ls", "<<", 2},          {"lt", "<", 2},           {"mI", "-=", 2},
+    {"mL", "*=", 2},         {"mi", "-", 2},           {"ml", "*", 2},           {"mm", "--", 1},
+    {"na", "new[]", 3},      {"ne", "!=", 2},          {"ng", "-", 1},           {"nt", "!", 1},
+    {"nw", "new", 3},        {"nx", "noexcept", 1},    {"oR", "|=", 2},          {"oo", "||", 2},
+    {"or", "|", 2},          {"pL", "+=", 2},          {"pl", "+", 2},           {"pm", "->*", 2},
+    {"pp", "++", 1},         {"ps", "+", 1},           {"pt", "->", 2},          {"qu", "?", 3},
+    {"rM", "%=", 2},         {"rS", ">>=", 2},         {"rc", "reinterpret_cast", 2}, {"rm", "%", 2},
+    {"rs", ">>", 2},         {"sP", "sizeof...", 1},   {"sZ", "sizeof...", 1},   {"sc", "static_cast", 2},
+    {"ss", "<=>", 2},        {"st", "sizeof ", 1},     {"sz", "sizeof ", 1},     {"te", "typeid ", 1},
+    {"ti", "typeid ", 1},    {"tr", "throw", 0},       {"tw", "throw ", 1},
+};
+
+const OperatorInfo* find_operator(char a, char b) {
+    // Codes are two letters: a 26 x 52 table, built once
+    static const OperatorInfo* table[26][52] = {};
+    static const bool built = [] {
+        for (const OperatorInfo& op : kOperators) {
+            int second = op.code[1] >= 'a' ? op.code[1] - 'a' : 26 + op.code[1] - 'A';
+            table[op.code[0] - 'a'][second] = &op;
+        }
+        return true;
+    }();
+    (void)built;
+    if (a < 'a' || a > 'z') return nullptr;
+    int second = (b >= 'a' && b <= 'z') ? b - 'a' : (b >= 'A' && b <= 'Z') ? 26 + b - 'A' : -1;
+    return second < 0 ? nullptr : table[a - 'a'][second];
+}
+
+bool is_code(const OperatorInfo* op, const char* code) { return op && op->code[0] == code[0] && op->code[1] == code[1]; }
+
+// operator+, operator new, operator delete[], operator"" _x, operator vendor
+struct OperatorNode : Node {
+    const OperatorInfo* info;  // null: literal or vendor operator, spelled by `name`
+    std::string_view name;
+    OperatorNode(const OperatorInfo* i, std::string_view n = {}) : Node(K::Operator), info(i), name(n) {}
+    void left(Printer& p) const override {
+        p.add("operator");
+        if (!info) {
+            p.add(name);
+            return;
+        }
+        std::string_view symbol = info->symbol;
+        if (symbol[0] >= 'a' && symbol[0] <= 'z') p.add(' ');
+        if (symbol.back() == ' ') symbol.remove_suffix(1);
+        p.add(symbol);
+    }
+};
+
+struct ConversionNode : Node {
+    const Node* type;
+    explicit ConversionNode(const Node* t) : Node(K::Conversion), type(t) {}
+    void left(Printer& p) const override {
+        p.add("operator ");
+        TemplateScope scope(p, p.current_template ? p.current_template : p.scope);
+        print(type, p);
+    }
+};
+
+// T_, T0_, ...: looked up while printing, not while parsing. The same node
+// can be reached from a nested encoding (a lambda's enclosing function) and
+// from the outer one through a substitution, and means each one's own T_.
+struct TemplateParamNode : Node {
+    std::size_t index;
+    explicit TemplateParamNode(std::size_t i) : Node(K::TemplateParam), index(i) {}
+    const Node* lookup(const Printer& p) const {
+        return p.scope && index < p.scope->args.size ? p.scope->args.data[index] : nullptr;
+    }
+    const Node* argument(const Printer& p) const;
+    void left(Printer& p) const override { print_left(argument(p), p); }
+    void right(Printer& p) const override { print_right(argument(p), p); }
+    const Node* find_pack(Printer& p) const override {
+        const Node* arg = lookup(p);
+        return arg && arg->kind == K::ArgPack ? arg : nullptr;
+    }
+};
+
+struct ArgPackNode : Node {
+    NodeArray elements;
+    explicit ArgPackNode(NodeArray e) : Node(K::ArgPack), elements(e) {}
+    void left(Printer& p) const override { print_list(elements, p); }
+    const Node* find_pack(Printer& p) const override { return find_pack_in(elements, p); }
+};
+
+// The argument, or inside a pack expansion the current element of the pack
+const Node* TemplateParamNode::argument(const Printer& p) const {
+    const Node* arg = lookup(p);
+    if (!arg || arg->kind != K::ArgPack || p.pack_index < 0) return arg;
+    const NodeArray& e = static_cast<const ArgPackNode*>(arg)->elements;
+    return std::size_t(p.pack_index) < e.size ? e.data[p.pack_index] : nullptr;
+}
+
+// Through template parameters to the real type
+const Node* underlying(const Node* n, const Printer& p) {
+    for (int hops = 0; n && hops < 64 && n->kind == K::TemplateParam; ++hops)
+        n = static_cast<const TemplateParamNode*>(n)->argument(p);
+    return n && n->kind == K::TemplateParam ? nullptr : n;
+}
+
+bool has_right(const Node* n, const Printer& p);
+
+bool wraps_declarator(const Node* u) { return u && (u->kind == K::Function || u->kind == K::Array); }
+
+const Node* declarator_of(const Node* n, const Printer& p);
+
+struct QualNode : Node {
+    const Node* child;
+    unsigned char cv;  // 1 const, 2 volatile, 4 restrict
+    QualNode(const Node* c, unsigned char q) : Node(K::Qual), child(c), cv(q) {}
+    static unsigned char outermost(unsigned char q) { return q & 4 ? 4 : q & 2 ? 2 : 1; }
+    // const T with T = X const: the argument already says const
+    bool repeats(const Printer& p) const {
+        if (child->kind != K::TemplateParam) return false;
+        const Node* u = underlying(child, p);
+        return u && u->kind == K::Qual && outermost(static_cast<const QualNode*>(u)->cv) == outermost(cv);
+    }
+    void left(Printer& p) const override {
+        print_left(child, p);
+        if (!repeats(p)) print_quals(cv, p);
+    }
+    void right(Printer& p) const override { print_right(child, p); }
+    const Node* find_pack(Printer& p) const override { return find_pack_of(child, p); }
+};
+
+// U <source-name> <type>: "float __vector", "int foo"
+struct VendorQualNode : Node {
+    const Node* child;
+    std::string_view name;
+    VendorQualNode(const Node* c, std::string_view n) : Node(K::VendorQual), child(c), name(n) {}
+    void left(Printer& p) const override {
+        print_left(child, p);
+        p.add(' ');
+        p.add(name);
+    }
+    void right(Printer& p) const override { print_right(child, p); }
+    const Node* find_pack(Printer& p) const override { return find_pack_of(child, p); }
+};
+
+// " _Complex", " _Imaginary"
+struct PostfixNode : Node {
+    const Node* child;
+    std::string_view suffix;
+    PostfixNode(const Node* c, std::string_view s) : Node(K::Postfix), child(c), suffix(s) {}
+    void left(Printer& p) const override {
+        print_left(child, p);
+        p.add(suffix);
+    }
+    void right(Printer& p) const override { print_right(child, p); }
+};
+
+struct PointerNode : Node {
+    const Node* pointee;
+    bool rvalue;
+
+    PointerNode(K k, const Node* t, bool rv) : Node(k), pointee(t), rvalue(rv) {}
+
+    // Reference collapsing through template parameters: T& with T = int&&
+    // prints int&. Returns the reference to print instead, or sets inner.
+    const Node* collapse(const Printer& p, const Node*& inner) const {
+        inner = pointee;
+        if (kind != K::Reference) return nullptr;
+        const Node* u = underlying(pointee, p);
+        if (!u || u->kind != K::Reference) return nullptr;
+        auto* r = static_cast<const PointerNode*>(u);
+        if (!r->rvalue || r->rvalue == rvalue) return r;
+        inner = r->pointee;
+        return nullptr;
+    }
+
+    const char* symbol() const { return kind == K::Pointer ? "*" : rvalue ? "&&" : "&"; }
+
+    void left(Printer& p) const override {
+        const Node* inner;
+        if (const Node* r = collapse(p, inner)) return print_left(r, p);
+        const Node* u = declarator_of(inner, p);
+        print_left(inner, p);
+        if (u && u->kind == K::Function) {  // void (*)(int)
+            char c = p.last();
+            if (c != '(' && c != '*' && c != ' ') p.add(' ');
+            p.add('(');
+        } else if (u && u->kind == K::Array) {  // int (*) [3]
+            p.add(" (");
+        }
+        p.add(symbol());
+    }
+
+    void right(Printer& p) const override {
+        const Node* inner;
+        if (const Node* r = collapse(p, inner)) return print_right(r, p);
+        if (wraps_declarator(declarator_of(inner, p))) p.add(')');
+        print_right(inner, p);
+    }
+
+    const Node* find_pack(Printer& p) const override { return find_pack_of(pointee, p); }
+};
+
+struct PtrMemNode : Node {
+    const Node* cls;
+    const Node* member;
+    PtrMemNode(const Node* c, const Node* m) : Node(K::PtrMem), cls(c), member(m) {}
+    void left(Printer& p) const override {
+        const Node* u = declarator_of(member, p);
+        print_left(member, p);
+        if (u && u->kind == K::Function) {  // void (A::*)(int)
+            if (p.last() != ' ') p.add(' ');
+            p.add('(');
+        } else if (u && u->kind == K::Array) {
+            p.add(" (");
+        } else {  // int A::*
+            p.add(' ');
+        }
+        print(cls, p);
+        p.add("::*");
+    }
+    void right(Printer& p) const override {
+        if (wraps_declarator(declarator_of(member, p))) p.add(')');
+        print_right(member, p);
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(cls, p);
+        return pack ? pack : find_pack_of(member, p);
+    }
+};
+
+// " noexcept", " noexcept(expr)", " throw(types)"
+struct ExceptionSpecNode : Node {
+    const Node* expr;  // noexcept(expr)
+    NodeArray types;   // throw(types)
+    bool dynamic;
+    ExceptionSpecNode(const Node* e, NodeArray t, bool d) : Node(K::ExceptionSpec), expr(e), types(t), dynamic(d) {}
+    void left(Printer& p) const override {
+        if (dynamic) {
+            p.add(" throw(");
+            print_list(types, p);
+            p.add(')');
+            return;
+        }
+        p.add(" noexcept");
+        if (expr) {
+            p.add('(');
+            print(expr, p);
+            p.add(')');
+        }
+    }
+};
+
+struct FunctionNode : Node {
+    const Node* ret;  // null: constructors, destructors, conversions, non-template functions
+    NodeArray params;
+    unsigned char cv;
+    unsigned char ref;  // 1 &, 2 &&
+    const Node* exception;
+
+    FunctionNode(const Node* r, NodeArray ps, unsigned char q, unsigned char rq, const Node* e)
+        : Node(K::Function), ret(r), params(ps), cv(q), ref(rq), exception(e) {}
+
+    // "(int, char) const &"
+    void signature(Printer& p) const {
+        p.add('(');
+        print_list(params, p);
+        p.add(')');
+        print_quals(cv, p);
+        if (ref == 1) p.add(" &");
+        if (ref == 2) p.add(" &&");
+        if (exception) print(exception, p);
+    }
+
+    void left(Printer& p) const override {
+        if (!ret) return;
+        print_left(ret, p);
+        if (!has_right(ret, p)) p.add(' ');
+    }
+    void right(Printer& p) const override {
+        signature(p);
+        if (ret) print_right(ret, p);
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(ret, p);
+        return pack ? pack : find_pack_in(params, p);
+    }
+};
+
+struct ArrayNode : Node {
+    const Node* elem;
+    const Node* dim;  // null: int []
+    ArrayNode(const Node* e, const Node* d) : Node(K::Array), elem(e), dim(d) {}
+    void left(Printer& p) const override { print_left(elem, p); }
+    void right(Printer& p) const override {
+        const Node* u = underlying(elem, p);
+        // int [2][3]; but void (*[3])(int) puts the bounds inside the parens
+        if ((u && u->kind == K::Array) || !has_right(elem, p)) {
+            if (p.last() != ']') p.add(' ');
+        }
+        p.add('[');
+        if (dim) print(dim, p);
+        p.add(']');
+        print_right(elem, p);
+    }
+    const Node* find_pack(Printer& p) const override { return find_pack_of(elem, p); }
+};
+
+// What a pointer or reference points at, seen through cv-qualifiers:
+// char const (&) [3] is a reference to an array
+const Node* declarator_of(const Node* n, const Printer& p) {
+    const Node* u = underlying(n, p);
+    for (int hops = 0; u && u->kind == K::Qual && hops < 64; ++hops)
+        u = underlying(static_cast<const QualNode*>(u)->child, p);
+    return u;
+}
+
+bool has_right(const Node* n, const Printer& p) {
+    const Node* u = underlying(n, p);
+    if (!u) return false;
+    switch (u->kind) {
+    case K::Function:
+    case K::Array:
+        return true;
+    case K::Pointer:
+    case K::Reference: {
+        const Node* inner;
+        auto* ptr = static_cast<const PointerNode*>(u);
+        if (const Node* r = ptr->collapse(p, inner)) return has_right(static_cast<const PointerNode*>(r)->pointee, p);
+        return has_right(inner, p);
+    }
+    case K::Qual: return has_right(static_cast<const QualNode*>(u)->child, p);
+    case K::VendorQual: return has_right(static_cast<const VendorQualNode*>(u)->child, p);
+    case K::PtrMem: return has_right(static_cast<const PtrMemNode*>(u)->member, p);
+    default: return false;
+    }
+}
+
+// "float __vector(4)"
+struct VectorNode : Node {
+    const Node* elem;
+    const Node* dim;
+    VectorNode(const Node* e, const Node* d) : Node(K::Vector), elem(e), dim(d) {}
+    void left(Printer& p) const override {
+        print(elem, p);
+        p.add(" __vector(");
+        if (dim) print(dim, p);
+        p.add(')');
+    }
+};
+
+struct LocalNode : Node {
+    const Node* encoding;
+    const Node* entity;
+    LocalNode(const Node* e, const Node* n) : Node(K::Local), encoding(e), entity(n) {}
+    void left(Printer& p) const override {
+        print(encoding, p);
+        p.add("::");
+        print(entity, p);
+    }
+};
+
+// A function (or data object): [ret ]name(params)[ quals][ret right part]
+struct EncodingNode : Node {
+    const Node* name;
+    FunctionNode* fn;
+    EncodingNode(const Node* n, FunctionNode* f) : Node(K::Encoding), name(n), fn(f) {}
+    void left(Printer& p) const override {
+        // A function template's arguments are what T_ means in its signature
+        const Node* typed = name->kind == K::Local ? static_cast<const LocalNode*>(name)->entity : name;
+        TemplateScope scope(p, typed->kind == K::Template ? static_cast<const TemplateNode*>(typed) : p.scope);
+        if (fn->ret) {
+            print_left(fn->ret, p);
+            if (!has_right(fn->ret, p)) p.add(' ');
+        }
+        print(name, p);
+        fn->signature(p);
+        if (fn->ret) print_right(fn->ret, p);
+    }
+};
+
+struct LambdaNode : Node {
+    NodeArray params;
+    long number;
+    LambdaNode(NodeArray ps, long n) : Node(K::Lambda), params(ps), number(n) {}
+    void left(Printer& p) const override {
+        p.add("{lambda(");
+        print_list(params, p);
+        p.add(")#");
+        p.number(number);
+        p.add('}');
+    }
+};
+
+struct UnnamedNode : Node {
+    long number;
+    explicit UnnamedNode(long n) : Node(K::Unnamed), number(n) {}
+    void left(Printer& p) const override {
+        p.add("{unnamed type#");
+        p.number(number);
+        p.add('}');
+    }
+};
+
+// Structured binding: [a, b]
+struct BindingNode : Node {
+    NodeArray names;
+    explicit BindingNode(NodeArray n) : Node(K::Binding), names(n) {}
+    void left(Printer& p) const override {
+        p.add('[');
+        print_list(names, p);
+        p.add(']');
+    }
+};
+
+// Generic lambda parameter: auto:1
+struct AutoNode : Node {
+    long number;
+    explicit AutoNode(long n) : Node(K::Auto), number(n) {}
+    void left(Printer& p) const override {
+        p.add("auto:");
+        p.number(number);
+    }
+};
+
+void print_subexpr(const Node* n, Printer& p);
+
+struct PackExpansionNode : Node {
+    const Node* child;
+    explicit PackExpansionNode(const Node* c) : Node(K::PackExpansion), child(c) {}
+    void left(Printer& p) const override {
+        const Node* pack = child->find_pack(p);
+        if (!pack) {  // only function parameter packs involved: print the pattern
+            print_subexpr(child, p);
+            p.add("...");
+            return;
+        }
+        std::size_t n = static_cast<const ArgPackNode*>(pack)->elements.size;
+        int saved = p.pack_index;
+        for (std::size_t i = 0; i < n; ++i) {
+            p.pack_index = int(i);
+            print(child, p);
+            if (i + 1 < n) p.add(", ");
+        }
+        p.pack_index = saved;
+    }
+};
+
+struct DecltypeNode : Node {
+    const Node* expr;
+    explicit DecltypeNode(const Node* e) : Node(K::Decltype), expr(e) {}
+    void left(Printer& p) const override {
+        p.add("decltype (");
+        print(expr, p);
+        p.add(')');
+    }
+    const Node* find_pack(Printer& p) const override { return find_pack_of(expr, p); }
+};
+
+struct FunctionParamNode : Node {
+    long index;  // 0: this
+    explicit FunctionParamNode(long i) : Node(K::FunctionParam), index(i) {}
+    void left(Printer& p) const override {
+        if (index == 0) return p.add("this");
+        p.add("{parm#");
+        p.number(index);
+        p.add('}');
+    }
+};
+
+// Li5E -> 5, Lj5E -> 5u, Lb1E -> true, Lc65E -> (char)65, L1E2E -> (E)2
+struct LiteralNode : Node {
+    const Node* type;
+    std::string_view value;
+    bool negative;
+    LiteralNode(const Node* t, std::string_view v, bool neg) : Node(K::Literal), type(t), value(v), negative(neg) {}
+    void left(Printer& p) const override {
+        char lit = type->kind == K::Builtin ? static_cast<const NameNode*>(type)->literal : 0;
+        if (lit && std::strchr("ijlmxy", lit)) {
+            if (negative) p.add('-');
+            p.add(value);
+            switch (lit) {
+            case 'j': p.add('u'); break;
+            case 'l': p.add('l'); break;
+            case 'm': p.add("ul"); break;
+            case 'x': p.add("ll"); break;
+            case 'y': p.add("ull"); break;
+            }
+            return;
+        }
+        if (lit == 'b' && !negative && value.size() == 1 && (value[0] == '0' || value[0] == '1')) {
+            p.add(value[0] == '1' ? "true" : "false");
+            return;
+        }
+        p.add('(');
+        print(type, p);
+        p.add(')');
+        if (negative) p.add('-');
+        if (lit == 'f') p.add('[');
+        p.add(value);
+        if (lit == 'f') p.add(']');
+    }
+};
+
+struct ExprListNode : Node {
+    NodeArray items;
+    explicit ExprListNode(NodeArray i) : Node(K::ExprList), items(i) {}
+    void left(Printer& p) const override { print_list(items, p); }
+    const Node* find_pack(Printer& p) const override { return find_pack_in(items, p); }
+};
+
+struct InitListNode : Node {
+    const Node* type;  // null: untyped {a, b}
+    NodeArray items;
+    InitListNode(const Node* t, NodeArray i) : Node(K::InitList), type(t), items(i) {}
+    void left(Printer& p) const override {
+        if (type) print(type, p);
+        p.add('{');
+        print_list(items, p);
+        p.add('}');
+    }
+    const Node* find_pack(Printer& p) const override { return find_pack_in(items, p); }
+};
+
+// Names, qualified names, init lists and function parameters print bare in
+// an expression; everything else gets parentheses
+void print_subexpr(const Node* n, Printer& p) {
+    bool simple = n && (n->kind == K::Name || n->kind == K::Nested || n->kind == K::InitList ||
+                        n->kind == K::FunctionParam);
+    if (!simple) p.add('(');
+    print(n, p);
+    if (!simple) p.add(')');
+}
+
+struct UnaryNode : Node {
+    const OperatorInfo* op;  // null: a cast, (type)operand
+    const Node* cast_type;
+    const Node* operand;
+    bool suffix;  // x++ rather than ++x
+    UnaryNode(const OperatorInfo* o, const Node* t, const Node* e, bool s)
+        : Node(K::Unary), op(o), cast_type(t), operand(e), suffix(s) {}
+    void left(Printer& p) const override {
+        const Node* e = operand;
+        // &A::f, not &A::f(): the address of a function drops its parameter list
+        if (is_code(op, "ad") && e->kind == K::Encoding) {
+            auto* enc = static_cast<const EncodingNode*>(e);
+            if (enc->name->kind == K::Nested) e = enc->name;
+        }
+        if (suffix) {
+            print_subexpr(e, p);
+            p.add(op->symbol);
+            return;
+        }
+        if (!op) {
+            p.add('(');
+            print(cast_type, p);
+            p.add(')');
+        } else {
+            p.add(op->symbol);
+        }
+        if (is_code(op, "gs")) print(e, p);
+        else if (is_code(op, "st")) {
+            p.add('(');
+            print(e, p);
+            p.add(')');
+        } else {
+            print_subexpr(e, p);
+        }
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(cast_type, p);
+        return pack ? pack : find_pack_of(operand, p);
+    }
+};
+
+// sizeof...(T): the length of the pack
+struct SizeofPackNode : Node {
+    const Node* operand;
+    explicit SizeofPackNode(const Node* e) : Node(K::SizeofPack), operand(e) {}
+    void left(Printer& p) const override {
+        const Node* pack = operand->find_pack(p);
+        p.number(pack ? long(static_cast<const ArgPackNode*>(pack)->elements.size) : 0);
+    }
+};
+
+struct BinaryNode : Node {
+    const OperatorInfo* op;
+    const Node* lhs;
+    const Node* rhs;
+    BinaryNode(const OperatorInfo* o, const Node* l, const Node* r) : Node(K::Binary), op(o), lhs(l), rhs(r) {}
+    void left(Printer& p) const override {
+        if (is_code(op, "dc") || is_code(op, "sc") || is_code(op, "cc") || is_code(op, "rc")) {
+            p.add(op->symbol);  // static_cast<T>(e)
+            p.add('<');
+            print(lhs, p);
+            p.add(">(");
+            print(rhs, p);
+            p.add(')');
+            return;
+        }
+        // a > b inside template arguments would end the argument list
+        bool greater = std::strcmp(op->symbol, ">") == 0;
+        if (greater) p.add('(');
+        if (is_code(op, "cl") && lhs->kind == K::Encoding) print_subexpr(static_cast<const EncodingNode*>(lhs)->name, p);
+        else print_subexpr(lhs, p);
+        if (is_code(op, "ix")) {
+            p.add('[');
+            print(rhs, p);
+            p.add(']');
+        } else {
+            if (!is_code(op, "cl")) p.add(op->symbol);
+            print_subexpr(rhs, p);
+        }
+        if (greater) p.add(')');
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(lhs, p);
+        return pack ? pack : find_pack_of(rhs, p);
+    }
+};
+
+// a ? b : c
+struct TrinaryNode : Node {
+    const Node* a;
+    const Node* b;
+    const Node* c;
+    TrinaryNode(const Node* x, const Node* y, const Node* z) : Node(K::Trinary), a(x), b(y), c(z) {}
+    void left(Printer& p) const override {
+        print_subexpr(a, p);
+        p.add('?');
+        print_subexpr(b, p);
+        p.add(" : ");
+        print_subexpr(c, p);
+    }
+    const Node* find_pack(Printer& p) const override {
+        const Node* pack = find_pack_of(a, p);
+        if (!pack) pack = find_pack_of(b, p);
+        return pack ? pack : find_pack_of(c, p);
+    }
+};
+
+// new (placement) T(init)
+struct NewNode : Node {
+    const ExprListNode* placement;
+    const Node* type;
+    const Node* init;  // null, an ExprList (parenthesized) or an InitList
+    bool array;
+    NewNode(const ExprListNode* pl, const Node* t, const Node* i, bool arr)
+        : Node(K::New), placement(pl), type(t), init(i), array(arr) {}
+    void left(Printer& p) const override {
+        p.add(array ? "new[] " : "new ");
+        if (placement->items.size) {
+            print_subexpr(placement, p);
+            p.add(' ');
+        }
+        print(type, p);
+        if (init) print_subexpr(init, p);
+    }
+};
+
+struct CloneNode : Node {
+    const Node* encoding;
+    std::string_view suffix;
+    CloneNode(const Node* e, std::string_view s) : Node(K::Clone), encoding(e), suffix(s) {}
+    void left(Printer& p) const override {
+        print(encoding, p);
+        p.add(" [clone ");
+        p.add(suffix);
+        p.add(']');
+    }
+};
+
+// Constructor/destructor spelling: the class name without template arguments
+std::string_view basename_of(const Node* n) {
+    for (int hops = 0; n && hops < 64; ++hops) {
+        switch (n->kind) {
+        case K::Name:
+        case K::StdSub: {
+            auto* name = static_cast<const NameNode*>(n);
+            return name->base.empty() ? name->text : name->base;
+        }
+        case K::Nested: n = static_cast<const NestedNode*>(n)->name; break;
+        case K::Template: n = static_cast<const TemplateNode*>(n)->name; break;
+        case K::AbiTag: n = static_cast<const AbiTagNode*>(n)->inner; break;
+        default: return {};
+        }
+    }
+    return {};
+}
+
+}  // namespace
+
+// ============================================================================
+// PARSER
+// ============================================================================
+// Recursive descent over the grammar in the Itanium C++ ABI, section 5.1.
+// Every parse_* returns null on malformed input; nothing throws.
+
+struct Demangler::Parser {
+    Arena arena;
+    std::string output;  // demangle()'s result: keeps its capacity between calls
+    const char* first = nullptr;
+    const char* last = nullptr;
+
+    std::vector<Node*> subs;          // substitution candidates: S_, S0_, S1_, ...
+    std::vector<Node*> scratch;       // stack for building node arrays
+    std::size_t param_count = 0;      // template arguments T_ can refer to in this encoding
+    std::size_t forward_needed = 0;   // T_ seen before its arguments (conversion operators)
+    std::string_view last_name;       // latest source name: what C1/D1 spell (libiberty's rule)
+    int blocked = 0;                  // parsing an encoding's own template args: T_ can't refer yet
+    bool permit_forward = false;
+    bool in_conversion = false;       // cv T_ I...E: the I belongs to the operator, not T_ (one parse_type)
+    bool in_lambda = false;           // T_ in a lambda signature is an 'auto' parameter
+    int depth = 0;
+
+    struct NameState {
+        bool ends_with_template_args = false;
+        bool ctor_dtor_conversion = false;
+        unsigned char cv = 0;
+        unsigned char ref = 0;
+    };
+
+    // Shared nodes that don't depend on the input
+    NameNode builtins[26] = {
+        {K::Builtin, "signed char"},       {K::Builtin, "bool", {}, 'b'},
+        {K::Builtin, "char"},              {K::Builtin, "double", {}, 'f'},
+        {K::Builtin, "long double", {}, 'f'}, {K::Builtin, "float", {}, 'f'},
+        {K::Builtin, "__float128", {}, 'f'}, {K::Builtin, "unsigned char"},
+        {K::Builtin, "int", {}, 'i'},      {K::Builtin, "unsigned int", {}, 'j'},
+        {K::Builtin, "?"},                 {K::Builtin, "long", {}, 'l'},
+        {K::Builtin, "unsigned long", {}, 'm'}, {K::Builtin, "__int128"},
+        {K::Builtin, "unsigned __int128"}, {K::Builtin, "?"},
+        {K::Builtin, "?"},                 {K::Builtin, "?"},
+        {K::Builtin, "short"},             {K::Builtin, "unsigned short"},
+        {K::Builtin, "?"},                 {K::Builtin, "void", {}, 'v'},
+        {K::Builtin, "wchar_t"},           {K::Builtin, "long long", {}, 'x'},
+        {K::Builtin, "unsigned long long", {}, 'y'}, {K::Builtin, "..."},
+    };
+    NameNode std_name{K::Name, "std"};
+    NameNode anonymous_namespace{K::Name, "(anonymous namespace)"};
+    NameNode string_literal{K::Name, "string literal"};
+    NameNode std_allocator{K::StdSub, "std::allocator", "allocator"};
+    NameNode std_basic_string{K::StdSub, "std::basic_string", "basic_string"};
+    NameNode std_string{K::StdSub, "std::string", "basic_string"};
+    NameNode std_istream{K::StdSub, "std::istream", "basic_istream"};
+    NameNode std_ostream{K::StdSub, "std::ostream", "basic_ostream"};
+    NameNode std_iostream{K::StdSub, "std::iostream", "basic_iostream"};
+    NameNode std_string_full{K::StdSub, "std::basic_string<char, std::char_traits<char>, std::allocator<char> >",
+                             "basic_string"};
+    NameNode std_istream_full{K::StdSub, "std::basic_istream<char, std::char_traits<char> >", "basic_istream"};
+    NameNode std_ostream_full{K::StdSub, "std::basic_ostream<char, std::char_traits<char> >", "basic_ostream"};
+    NameNode std_iostream_full{K::StdSub, "std::basic_iostream<char, std::char_traits<char> >", "basic_iostream"};
+    NameNode d_builtins[10] = {
+        {K::Builtin, "decimal64"}, {K::Builtin, "decimal128"}, {K::Builtin, "decimal32"},
+        {K::Builtin, "half"},      {K::Builtin, "char32_t"},   {K::Builtin, "char16_t"},
+        {K::Builtin, "char8_t"},   {K::Builtin, "auto"},       {K::Builtin, "decltype(auto)"},
+        {K::Builtin, "decltype(nullptr)"},
+    };
+
+    // ----- Helpers -----
+
+    template <typename T, typename... Args>
+    T* make(Args&&... args) {
+        return new (arena.allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    // The scratch entries from `from` on, moved into the arena
+    NodeArray pop_array(std::size_t from) {
+        NodeArray out;
+        out.size = scratch.size() - from;
+        if (out.size) {
+            out.data = static_cast<Node**>(arena.allocate(out.size * sizeof(Node*), alignof(Node*)));
+            std::copy(scratch.begin() + std::ptrdiff_t(from), scratch.end(), out.data);
+        }
+        scratch.resize(from);
+        return out;
+    }
+
+    std::size_t left() const { return std::size_t(last - first); }
+    char look(std::size_t i = 0) const { return i < left() ? first[i] : '\0'; }
+    bool consume(char c) {
+        if (look() != c) return false;
+        ++first;
+        return true;
+    }
+    bool consume(const char* s) {
+        std::size_t n = std::strlen(s);
+        if (left() < n || std::memcmp(first, s, n) != 0) return false;
+        first += n;
+        return true;
+    }
+    static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+    struct DepthGuard {
+        int& depth;
+        bool ok;
+        explicit DepthGuard(int& d) : depth(d), ok(++d <= kMaxParseDepth) {}
+        ~DepthGuard() { --depth; }
+    };
+
+    // <number> ::= [n] <decimal>
+    bool parse_number(long& value) {
+        bool negative = consume('n');
+        if (!is_digit(look())) return false;
+        value = 0;
+        while (is_digit(look())) {
+            if (value > 100000000) return false;
+            value = value * 10 + (*first++ - '0');
+        }
+        if (negative) value = -value;
+        return true;
+    }
+
+    std::string_view parse_number_text() {
+        const char* start = first;
+        consume('n');
+        while (is_digit(look())) ++first;
+        return std::string_view(start, std::size_t(first - start));
+    }
+
+    // <seq-id> _ : base 36, S_ is 0, S0_ is 1
+    bool parse_seq_id(std::size_t& index) {
+        if (consume('_')) {
+            index = 0;
+            return true;
+        }
+        std::size_t value = 0;
+        while (is_digit(look()) || (look() >= 'A' && look() <= 'Z')) {
+            char c = *first++;
+            value = value * 36 + std::size_t(is_digit(c) ? c - '0' : c - 'A' + 10);
+            if (value > (1u << 24)) return false;
+        }
+        if (!consume('_')) return false;
+        index = value + 1;
+        return true;
+    }
+
+    // _ <digit> | __ <number> _
+    bool parse_discriminator() {
+        if (look() != '_') return true;
+        ++first;
+        if (consume('_')) {
+            long n;
+            if (!parse_number(n)) return false;
+            return n < 10 || consume('_');
+        }
+        long n;
+        return parse_number(n);
+    }
+
+    // <number> _ (compact form: _ is 0, <n>_ is n + 1)
+    bool parse_compact_number(long& value) {
+        if (consume('_')) {
+            value = 0;
+            return true;
+        }
+        if (!parse_number(value) || value < 0 || !consume('_')) return false;
+        ++value;
+        return true;
+    }
+
+    // ----- Names -----
+
+    // <source-name> ::= <length> <identifier>
+    Node* parse_source_name() {
+        long len;
+        if (!is_digit(look()) || !parse_number(len) || len <= 0 || std::size_t(len) > left()) return nullptr;
+        std::string_view text(first, std::size_t(len));
+        first += len;
+        last_name = text;
+        if (text.size() >= 10 && text.compare(0, 8, "_GLOBAL_") == 0 &&
+            (text[8] == '.' || text[8] == '_' || text[8] == '$') && text[9] == 'N')
+            return &anonymous_namespace;
+        return make<NameNode>(K::Name, text);
+    }
+
+    Node* parse_abi_tags(Node* n) {
+        while (n && consume('B')) {
+            long len;
+            if (!parse_number(len) || len <= 0 || std::size_t(len) > left()) return nullptr;
+            n = make<AbiTagNode>(n, std::string_view(first, std::size_t(len)));
+            first += len;
+        }
+        return n;
+    }
+
+    // <operator-name>, including cv <type> (conversion) and li <source-name>
+    Node* parse_operator_name(NameState* state) {
+        if (left() < 2) return nullptr;
+        if (consume("cv")) {
+            bool saved_forward = permit_forward;
+            permit_forward = permit_forward || state != nullptr;
+            in_conversion = true;
+            Node* type = parse_type();
+            permit_forward = saved_forward;
+            if (!type) return nullptr;
+            if (state) state->ctor_dtor_conversion = true;
+            return make<ConversionNode>(type);
+        }
+        if (consume("li")) {
+            Node* name = parse_source_name();
+            if (!name) return nullptr;
+            std::string_view text = static_cast<NameNode*>(name)->text;
+            // operator"" _x: spell it into the arena once
+            char* buf = static_cast<char*>(arena.allocate(text.size() + 4, 1));
+            std::memcpy(buf, "\"\" ", 3);
+            std::memcpy(buf + 3, text.data(), text.size());
+            return make<OperatorNode>(nullptr, std::string_view(buf, text.size() + 3));
+        }
+        if (look() == 'v' && is_digit(look(1))) {
+            first += 2;
+            Node* name = parse_source_name();
+            if (!name) return nullptr;
+            std::string_view text = static_cast<NameNode*>(name)->text;
+            char* buf = static_cast<char*>(arena.allocate(text.size() + 2, 1));
+            buf[0] = ' ';
+            std::memcpy(buf + 1, text.data(), text.size());
+            return make<OperatorNode>(nullptr, std::string_view(buf, text.size() + 1));
+        }
+        const OperatorInfo* op = find_operator(look(), look(1));
+        if (!op) return nullptr;
+        first += 2;
+        return make<OperatorNode>(op);
+    }
+
+    // <unqualified-name>
+    Node* parse_unqualified_name(NameState* state) {
+        Node* result = nullptr;
+        char c = look();
+        if (is_digit(c)) {
+            result = parse_source_name();
+        } else if (c >= 'a' && c <= 'z') {
+            result = parse_operator_name(state);
+        } else if (c == 'C' || (c == 'D' && look(1) >= '0' && look(1) <= '5')) {
+            result = parse_ctor_dtor_name(state);
+        } else if (c == 'U' && look(1) == 't') {
+            first += 2;
+            long n;
+            if (!parse_compact_number(n)) return nullptr;
+            result = make<UnnamedNode>(n + 1);
+        } else if (c == 'U' && look(1) == 'l') {
+            result = parse_lambda();
+        } else if (c == 'D' && look(1) == 'C') {
+            first += 2;
+            std::size_t from = scratch.size();
+            while (!consume('E')) {
+                Node* name = parse_source_name();
+                if (!name) return nullptr;
+                scratch.push_back(name);
+            }
+            result = make<BindingNode>(pop_array(from));
+        } else if (c == 'L') {  // internal linkage (GCC): L <source-name> [<discriminator>]
+            ++first;
+            result = parse_source_name();
+            if (!result || !parse_discriminator()) return nullptr;
+        }
+        return parse_abi_tags(result);
+    }
+
+    // C1-C5, CI1 <type> ... CI5 <type>, D0 D1 D2 D4 D5 (the kinds libstdc++
+    // knows; C8 or D3 is rejected like __cxa_demangle rejects it); spelled
+    // with the last source name seen, so Ut_D1Ev in MicroProps prints ~MicroProps()
+    Node* parse_ctor_dtor_name(NameState* state) {
+        std::string_view base = last_name;
+        if (base.empty()) return nullptr;
+        bool dtor = look() == 'D';
+        ++first;
+        bool inheriting = !dtor && consume('I');  // CI: the base's type follows the kind
+        char kind = look();
+        if (dtor ? (kind < '0' || kind > '5' || kind == '3') : (kind < '1' || kind > '5')) return nullptr;
+        ++first;
+        if (inheriting) {  // libstdc++ prints the base's name: B::A(int)
+            if (!parse_type()) return nullptr;
+            base = last_name;
+        }
+        if (state) state->ctor_dtor_conversion = true;
+        return make<CtorDtorNode>(base, dtor);
+    }
+
+    // Ul <lambda-sig> E [<number>] _
+    Node* parse_lambda() {
+        first += 2;
+        bool saved = in_lambda;
+        in_lambda = true;
+        std::size_t from = scratch.size();
+        while (!consume('E')) {
+            Node* t = parse_type();
+            if (!t) return nullptr;
+            scratch.push_back(t);
+        }
+        in_lambda = saved;
+        if (scratch.size() == from + 1 && scratch.back() == &builtins['v' - 'a']) scratch.pop_back();
+        NodeArray ps = pop_array(from);
+        long n;
+        if (!parse_compact_number(n)) return nullptr;
+        return make<LambdaNode>(ps, n + 1);
+    }
+
+    // <substitution>; in_prefix: Ss before a constructor spells the whole type
+    Node* parse_substitution(bool in_prefix) {
+        if (!consume('S')) return nullptr;
+        char c = look();
+        if (c >= 'a' && c <= 'z') {
+            ++first;
+            bool full = in_prefix && (look() == 'C' || look() == 'D');
+            NameNode* sub = nullptr;
+            switch (c) {
+            case 'a': sub = &std_allocator; break;
+            case 'b': sub = &std_basic_string; break;
+            case 's': sub = full ? &std_string_full : &std_string; break;
+            case 'i': sub = full ? &std_istream_full : &std_istream; break;
+            case 'o': sub = full ? &std_ostream_full : &std_ostream; break;
+            case 'd': sub = full ? &std_iostream_full : &std_iostream; break;
+            default: return nullptr;
+            }
+            last_name = sub->base;
+            return sub;
+        }
+        std::size_t index;
+        if (!parse_seq_id(index) || index >= subs.size()) return nullptr;
+        return subs[index];
+    }
+
+    // <template-param> ::= T_ | T <number> _
+    Node* parse_template_param() {
+        if (!consume('T')) return nullptr;
+        long n;
+        if (!parse_compact_number(n)) return nullptr;
+        if (in_lambda) return make<AutoNode>(n + 1);
+        std::size_t index = std::size_t(n);
+        if (!blocked && index < param_count) return make<TemplateParamNode>(index);
+        if (permit_forward) {  // cv T_ in a conversion operator: the arguments come later
+            forward_needed = std::max(forward_needed, index + 1);
+            return make<TemplateParamNode>(index);
+        }
+        return nullptr;
+    }
+
+    // I <template-arg>+ E; tag: these are the arguments T_ refers to from now on
+    Node* parse_template_args(bool tag, NodeArray& out) {
+        if (!consume('I')) return nullptr;
+        if (tag) ++blocked;
+        std::string_view saved_name = last_name;  // vector<pair<int, int> >::vector(), not ::pair()
+        std::size_t from = scratch.size();
+        while (!consume('E')) {
+            Node* arg = parse_template_arg();
+            if (!arg) {
+                if (tag) --blocked;
+                return nullptr;
+            }
+            scratch.push_back(arg);
+        }
+        if (tag) --blocked;
+        last_name = saved_name;
+        out = pop_array(from);
+        if (tag) {
+            param_count = out.size;
+            if (forward_needed > param_count) return nullptr;
+            forward_needed = 0;
+        }
+        return &std_name;  // non-null: success
+    }
+
+    Node* parse_template_arg() {
+        switch (look()) {
+        case 'X': {
+            ++first;
+            Node* e = parse_expression();
+            return e && consume('E') ? e : nullptr;
+        }
+        case 'J': {
+            ++first;
+            std::size_t from = scratch.size();
+            while (!consume('E')) {
+                Node* arg = parse_template_arg();
+                if (!arg) return nullptr;
+                scratch.push_back(arg);
+            }
+            return make<ArgPackNode>(pop_array(from));
+        }
+        case 'L': return parse_expr_primary();
+        default: return parse_type();
+        }
+    }
+
+    Node* with_template_args(Node* name, bool tag, NameState* state) {
+        NodeArray args;
+        if (!parse_template_args(tag, args)) return nullptr;
+        if (state) state->ends_with_template_args = true;
+        return make<TemplateNode>(name, args);
+    }
+
+    // N [<CV-qualifiers>] [<ref-qualifier>] <prefix> <unqualified-name> E
+    Node* parse_nested_name(NameState* state) {
+        if (!consume('N')) return nullptr;
+        unsigned char cv = parse_cv_qualifiers();
+        unsigned char ref = consume('R') ? 1 : consume('O') ? 2 : 0;
+        if (state) {
+            state->cv = cv;
+            state->ref = ref;
+        }
+        Node* so_far = nullptr;
+        auto push = [&](Node* component) {
+            if (!component) return false;
+            so_far = so_far ? make<NestedNode>(so_far, component) : component;
+            if (state) state->ends_with_template_args = false;
+            return true;
+        };
+        while (!consume('E')) {
+            consume('L');  // internal linkage marker (GCC)
+            char c = look();
+            if (c == 'S' && look(1) == 't') {
+                if (so_far) return nullptr;
+                first += 2;
+                so_far = &std_name;
+                continue;
+            }
+            if (c == 'T') {
+                if (!push(parse_template_param())) return nullptr;
+            } else if (c == 'I') {
+                if (!so_far || !(so_far = with_template_args(so_far, state != nullptr, state))) return nullptr;
+            } else if (c == 'D' && (look(1) == 't' || look(1) == 'T')) {
+                if (!push(parse_decltype())) return nullptr;
+            } else if (c == 'S') {
+                if (so_far) return nullptr;
+                if (!(so_far = parse_substitution(true))) return nullptr;
+                continue;  // already a candidate
+            } else if (c == 'M') {  // closure in a data member initializer
+                ++first;
+                if (!so_far) return nullptr;
+                continue;
+            } else {
+                if (!push(parse_unqualified_name(state))) return nullptr;
+            }
+            subs.push_back(so_far);
+        }
+        if (!so_far || subs.empty()) return nullptr;
+        subs.pop_back();  // the complete name is not a candidate here
+        return so_far;
+    }
+
+    // Z <function encoding> E <entity name> [<discriminator>] | Z ... E s | Z ... E d [<n>] _ <name>
+    Node* parse_local_name(NameState* state) {
+        if (!consume('Z')) return nullptr;
+        Node* encoding = parse_encoding();
+        if (!encoding || !consume('E')) return nullptr;
+        // f<int>()::x, not void const* f<int>()::x
+        if (encoding->kind == K::Encoding) static_cast<EncodingNode*>(encoding)->fn->ret = nullptr;
+        if (consume('s')) {
+            if (!parse_discriminator()) return nullptr;
+            return make<LocalNode>(encoding, &string_literal);
+        }
+        if (consume('d')) {
+            long n = -1;
+            if (look() != '_' && !parse_number(n)) return nullptr;
+            if (!consume('_')) return nullptr;
+            Node* entity = parse_name(state);
+            if (!entity) return nullptr;
+            // {default arg#N}::entity
+            char* buf = static_cast<char*>(arena.allocate(40, 1));
+            int len = std::snprintf(buf, 40, "{default arg#%ld}", n + 2);
+            Node* arg = make<NameNode>(K::Name, std::string_view(buf, std::size_t(len)));
+            return make<LocalNode>(encoding, make<NestedNode>(arg, entity));
+        }
+        Node* entity = parse_name(state);
+        if (!entity || !parse_discriminator()) return nullptr;
+        return make<LocalNode>(encoding, entity);
+    }
+
+    // <name>: nested, local, unscoped, or unscoped template
+    Node* parse_name(NameState* state) {
+        DepthGuard guard(depth);
+        if (!guard.ok) return nullptr;
+        if (look() == 'N') return parse_nested_name(state);
+        if (look() == 'Z') return parse_local_name(state);
+        if (look() == 'S' && look(1) != 't') {
+            Node* sub = parse_substitution(false);
+            if (!sub || look() != 'I') return nullptr;
+            return with_template_args(sub, state != nullptr, state);
+        }
+        bool in_std = consume("St");
+        Node* name = parse_unqualified_name(state);
+        if (!name) return nullptr;
+        if (in_std) name = make<NestedNode>(&std_name, name);
+        if (look() == 'I') {
+            subs.push_back(name);
+            return with_template_args(name, state != nullptr, state);
+        }
+        if (state) state->ends_with_template_args = false;
+        return name;
+    }
+
+    // ----- Types -----
+
+    unsigned char parse_cv_qualifiers() {
+        unsigned char cv = 0;
+        if (consume('r')) cv |= 4;
+        if (consume('V')) cv |= 2;
+        if (consume('K')) cv |= 1;
+        return cv;
+    }
+
+    // [<CV-qualifiers>] [<exception-spec>] [Dx] F [Y] <return type> <parameter types> [<ref-qualifier>] E
+    FunctionNode* parse_function_type() {
+        unsigned char cv = parse_cv_qualifiers();
+        Node* exception = nullptr;
+        if (consume("Do")) {
+            exception = make<ExceptionSpecNode>(nullptr, NodeArray{}, false);
+        } else if (consume("DO")) {
+            Node* e = parse_expression();
+            if (!e || !consume('E')) return nullptr;
+            exception = make<ExceptionSpecNode>(e, NodeArray{}, false);
+        } else if (consume("Dw")) {
+            std::size_t from = scratch.size();
+            while (!consume('E')) {
+                Node* t = parse_type();
+                if (!t) return nullptr;
+                scratch.push_back(t);
+            }
+            exception = make<ExceptionSpecNode>(nullptr, pop_array(from), true);
+        }
+        consume("Dx");  // transaction_safe
+        if (!consume('F')) return nullptr;
+        consume('Y');  // extern "C"
+        Node* ret = parse_type();
+        if (!ret) return nullptr;
+        unsigned char ref = 0;
+        std::size_t from = scratch.size();
+        for (;;) {
+            if (consume('E')) break;
+            if (look(1) == 'E' && (look() == 'R' || look() == 'O')) {
+                ref = look() == 'R' ? 1 : 2;
+                first += 2;
+                break;
+            }
+            Node* t = parse_type();
+            if (!t) return nullptr;
+            scratch.push_back(t);
+        }
+        if (scratch.size() == from) return nullptr;  // FvE: no parameter types, not even v
+        if (scratch.size() == from + 1 && scratch.back() == &builtins['v' - 'a']) scratch.pop_back();
+        return make<FunctionNode>(ret, pop_array(from), cv, ref, exception);
+    }
+
+    // A <number> _ <type> | A [<expression>] _ <type>
+    Node* parse_array_type() {
+        if (!consume('A')) return nullptr;
+        Node* dim = nullptr;
+        if (is_digit(look())) {
+            std::string_view n = parse_number_text();
+            dim = make<NameNode>(K::Name, n);
+        } else if (look() != '_') {
+            dim = parse_expression();
+            if (!dim) return nullptr;
+        }
+        if (!consume('_')) return nullptr;
+        Node* elem = parse_type();
+        return elem ? make<ArrayNode>(elem, dim) : nullptr;
+    }
+
+    Node* parse_decltype() {
+        if (!consume('D') || !(consume('t') || consume('T'))) return nullptr;
+        Node* e = parse_expression();
+        if (!e || !consume('E')) return nullptr;
+        return make<DecltypeNode>(e);
+    }
+
+    Node* parse_type() {
+        DepthGuard guard(depth);
+        if (!guard.ok) return nullptr;
+        bool conversion = in_conversion;  // only the conversion's own type, not types nested in it
+        in_conversion = false;
+        Node* result = nullptr;
+        char c = look();
+        switch (c) {
+        case 'r':
+        case 'V':
+        case 'K': {
+            // cv-qualified function type (member functions), or a qualified type
+            const char* save = first;
+            parse_cv_qualifiers();
+            bool function = look() == 'F' ||
+                            (look() == 'D' && (look(1) == 'o' || look(1) == 'O' || look(1) == 'w' || look(1) == 'x'));
+            first = save;
+            if (function) {
+                result = parse_function_type();
+                break;
+            }
+            unsigned char cv = parse_cv_qualifiers();
+            Node* child = parse_type();
+            if (!child) return nullptr;
+            result = make<QualNode>(child, cv);
+            break;
+        }
+        case 'U': {
+            ++first;
+            Node* name = parse_source_name();
+            if (!name) return nullptr;
+            Node* child = parse_type();
+            if (!child) return nullptr;
+            result = make<VendorQualNode>(child, static_cast<NameNode*>(name)->text);
+            break;
+        }
+        case 'a': case 'b': case 'c': case 'd': case 'e': case 'f': case 'g': case 'h': case 'i': case 'j':
+        case 'l': case 'm': case 'n': case 'o': case 's': case 't': case 'v': case 'w': case 'x': case 'y':
+        case 'z':
+            ++first;
+            return &builtins[c - 'a'];  // builtins are never substitution candidates
+        case 'u': {  // vendor extended type: a candidate, unlike other builtins
+            ++first;
+            result = parse_source_name();
+            if (!result) return nullptr;
+            break;
+        }
+        case 'D': {
+            char d = look(1);
+            const char* builtin_codes = "defhisuacn";
+            if (d && std::strchr(builtin_codes, d)) {
+                first += 2;
+                return &d_builtins[std::strchr(builtin_codes, d) - builtin_codes];
+            }
+            if (d == 'F') {  // _Float<N>, _Float<N>x
+                first += 2;
+                const char* start = first;
+                while (is_digit(look())) ++first;
+                if (first == start) return nullptr;
+                std::string_view bits(start, std::size_t(first - start));
+                bool extended = consume('x');
+                if (!extended && !consume('_')) return nullptr;
+                char* buf = static_cast<char*>(arena.allocate(bits.size() + 8, 1));
+                std::memcpy(buf, "_Float", 6);
+                std::memcpy(buf + 6, bits.data(), bits.size());
+                std::size_t len = bits.size() + 6;
+                if (extended) buf[len++] = 'x';
+                return make<NameNode>(K::Builtin, std::string_view(buf, len));
+            }
+            if (d == 'p') {
+                first += 2;
+                Node* child = parse_type();
+                if (!child) return nullptr;
+                result = make<PackExpansionNode>(child);
+                break;
+            }
+            if (d == 't' || d == 'T') {
+                result = parse_decltype();
+                if (!result) return nullptr;
+                break;
+            }
+            if (d == 'v') {  // Dv <number> _ <type> | Dv _ <expression> _ <type>
+                first += 2;
+                Node* dim = nullptr;
+                if (is_digit(look())) {
+                    dim = make<NameNode>(K::Name, parse_number_text());
+                } else {
+                    if (!consume('_')) return nullptr;
+                    dim = parse_expression();
+                    if (!dim) return nullptr;
+                }
+                if (!consume('_')) return nullptr;
+                Node* elem = parse_type();
+                if (!elem) return nullptr;
+                result = make<VectorNode>(elem, dim);
+                break;
+            }
+            if (d == 'o' || d == 'O' || d == 'w' || d == 'x') {
+                result = parse_function_type();
+                break;
+            }
+            return nullptr;
+        }
+        case 'F':
+            result = parse_function_type();
+            break;
+        case 'A':
+            result = parse_array_type();
+            break;
+        case 'M': {
+            ++first;
+            Node* cls = parse_type();
+            if (!cls) return nullptr;
+            Node* member = parse_type();
+            if (!member) return nullptr;
+            result = make<PtrMemNode>(cls, member);
+            break;
+        }
+        case 'T': {
+            result = parse_template_param();
+            if (!result) return nullptr;
+            // <template-template-param> <template-args>
+            if (look() == 'I' && !conversion) {
+                subs.push_back(result);
+                result = with_template_args(result, false, nullptr);
+            }
+            break;
+        }
+        case 'P':
+        case 'R':
+        case 'O': {
+            ++first;
+            Node* child = parse_type();
+            if (!child) return nullptr;
+            result = c == 'P' ? make<PointerNode>(K::Pointer, child, false)
+                              : make<PointerNode>(K::Reference, child, c == 'O');
+            break;
+        }
+        case 'C':
+        case 'G': {
+            ++first;
+            Node* child = parse_type();
+            if (!child) return nullptr;
+            result = make<PostfixNode>(child, c == 'C' ? " _Complex" : " _Imaginary");
+            break;
+        }
+        case 'S': {
+            if (look(1) == 't') {
+                result = parse_name(nullptr);
+                break;
+            }
+            Node* sub = parse_substitution(false);
+            if (!sub) return nullptr;
+            if (look() != 'I' || conversion) return sub;  // a substitution is not a new candidate
+            result = with_template_args(sub, false, nullptr);
+            break;
+        }
+        default:  // <class-enum-type>
+            result = parse_name(nullptr);
+            break;
+        }
+        if (!result) return nullptr;
+        subs.push_back(result);
+        return result;
+    }
+
+    // ----- Expressions -----
+
+    // L <type> <value> E | L _Z <encoding> E | L <nullptr type> E
+    Node* parse_expr_primary() {
+        if (!consume('L')) return nullptr;
+        if (look() == '_' || look() == 'Z') {
+            consume('_');
+            if (!consume('Z')) return nullptr;
+            Node* encoding = parse_encoding();
+            return encoding && consume('E') ? encoding : nullptr;
+        }
+        Node* type = parse_type();
+        if (!type) return nullptr;
+        if (type == &d_builtins[9] && consume('E')) return type;  // LDnE: nullptr
+        bool negative = consume('n');
+        const char* start = first;
+        while (look() != 'E') {
+            if (!look()) return nullptr;
+            ++first;
+        }
+        std::string_view value(start, std::size_t(first - start));
+        ++first;
+        return make<LiteralNode>(type, value, negative);
+    }
+
+    // <simple-id> ::= <source-name> [<template-args>]
+    Node* parse_simple_id() {
+        Node* name = parse_source_name();
+        if (!name) return nullptr;
+        return look() == 'I' ? with_template_args(name, false, nullptr) : name;
+    }
+
+    // <base-unresolved-name>: simple id, on <operator> [args], dn <destructor>
+    Node* parse_base_unresolved_name() {
+        if (is_digit(look())) return parse_simple_id();
+        if (consume("dn")) {
+            Node* type = is_digit(look()) ? parse_simple_id() : parse_unresolved_type();
+            if (!type) return nullptr;
+            std::string_view base = basename_of(type);
+            if (base.empty()) return nullptr;
+            return make<CtorDtorNode>(base, true);
+        }
+        consume("on");
+        Node* op = parse_operator_name(nullptr);
+        if (!op) return nullptr;
+        return look() == 'I' ? with_template_args(op, false, nullptr) : op;
+    }
+
+    Node* parse_unresolved_type() {
+        if (look() == 'T') {
+            Node* t = parse_template_param();
+            if (!t) return nullptr;
+            subs.push_back(t);
+            return t;
+        }
+        if (look() == 'D') {
+            Node* t = parse_decltype();
+            if (!t) return nullptr;
+            subs.push_back(t);
+            return t;
+        }
+        if (look() == 'S' && look(1) != 't') return parse_substitution(false);
+        return parse_type();  // GCC: sr St7is_sameIiiE 5value
+    }
+
+    // <unresolved-name>: [gs] [sr ...] names in dependent expressions
+    Node* parse_unresolved_name() {
+        bool global = consume("gs");
+        auto globalize = [&](Node* n) -> Node* {
+            return global && n ? make<UnaryNode>(find_operator('g', 's'), nullptr, n, false) : n;
+        };
+        if (!consume("sr")) return globalize(parse_base_unresolved_name());
+        Node* so_far = nullptr;
+        if (consume('N')) {  // srN <unresolved-type> [args] <qualifier-level>* E <base>
+            so_far = parse_unresolved_type();
+            if (!so_far) return nullptr;
+            if (look() == 'I' && !(so_far = with_template_args(so_far, false, nullptr))) return nullptr;
+            while (!consume('E')) {
+                Node* level = parse_simple_id();
+                if (!level) return nullptr;
+                so_far = make<NestedNode>(so_far, level);
+            }
+        } else if (is_digit(look())) {  // [gs] sr <qualifier-level>+ E <base>
+            do {
+                Node* level = parse_simple_id();
+                if (!level) return nullptr;
+                so_far = so_far ? make<NestedNode>(so_far, level) : globalize(level);
+            } while (!consume('E'));
+        } else {  // sr <unresolved-type> [args] <base>
+            so_far = parse_unresolved_type();
+            if (!so_far) return nullptr;
+            if (look() == 'I' && !(so_far = with_template_args(so_far, false, nullptr))) return nullptr;
+        }
+        Node* base = parse_base_unresolved_name();
+        return base ? make<NestedNode>(so_far, base) : nullptr;
+    }
+
+    // <expression>* up to the terminator
+    ExprListNode* parse_expression_list(char terminator) {
+        std::size_t from = scratch.size();
+        while (!consume(terminator)) {
+            Node* e = parse_expression();
+            if (!e) return nullptr;
+            scratch.push_back(e);
+        }
+        return make<ExprListNode>(pop_array(from));
+    }
+
+    Node* parse_expression() {
+        DepthGuard guard(depth);
+        if (!guard.ok) return nullptr;
+        char c = look(), d = look(1);
+        if (c == 'L') return parse_expr_primary();
+        if (c == 'T') return parse_template_param();
+        if ((c == 's' && d == 'r') || (c == 'g' && d == 's' && look(2) != 'n' && look(2) != 'd'))
+            return parse_unresolved_name();
+        if (c == 'g' && d == 's') {  // ::new, ::delete
+            first += 2;
+            Node* e = parse_expression();
+            return e ? make<UnaryNode>(find_operator('g', 's'), nullptr, e, false) : nullptr;
+        }
+        if (c == 's' && d == 'p') {
+            first += 2;
+            Node* e = parse_expression();
+            return e ? make<PackExpansionNode>(e) : nullptr;
+        }
+        if (c == 'f' && d == 'p') {  // function parameter
+            first += 2;
+            parse_cv_qualifiers();
+            if (consume('T')) return make<FunctionParamNode>(0);
+            long n;
+            if (!parse_compact_number(n)) return nullptr;
+            return make<FunctionParamNode>(n + 1);
+        }
+        if (is_digit(c)) return parse_simple_id();
+        if (c == 'o' && d == 'n') return parse_base_unresolved_name();
+        if (c == 'd' && d == 'n') return parse_base_unresolved_name();
+        if ((c == 'i' || c == 't') && d == 'l') {  // {a, b} | T{a, b}
+            first += 2;
+            Node* type = nullptr;
+            if (c == 't' && !(type = parse_type())) return nullptr;
+            ExprListNode* list = parse_expression_list('E');
+            return list ? make<InitListNode>(type, list->items) : nullptr;
+        }
+        if (c == 'c' && d == 'v') {  // cv <type> <expr> | cv <type> _ <expr>* E
+            first += 2;
+            Node* type = parse_type();
+            if (!type) return nullptr;
+            Node* operand = consume('_') ? parse_expression_list('E') : parse_expression();
+            return operand ? make<UnaryNode>(nullptr, type, operand, false) : nullptr;
+        }
+        const OperatorInfo* op = find_operator(c, d);
+        if (!op) return nullptr;
+        first += 2;
+        if (is_code(op, "st") || is_code(op, "at") || is_code(op, "ti")) {
+            Node* type = parse_type();
+            return type ? make<UnaryNode>(op, nullptr, type, false) : nullptr;
+        }
+        if (is_code(op, "sZ")) {
+            Node* e = look() == 'T' ? parse_template_param() : parse_expression();
+            return e ? make<SizeofPackNode>(e) : nullptr;
+        }
+        if (is_code(op, "nw") || is_code(op, "na")) {  // nw <expr>* _ <type> [pi <expr>* E | <init-list>] E
+            ExprListNode* placement = parse_expression_list('_');
+            if (!placement) return nullptr;
+            Node* type = parse_type();
+            if (!type) return nullptr;
+            Node* init = nullptr;
+            if (consume("pi")) {
+                if (!(init = parse_expression_list('E'))) return nullptr;
+            } else if (look() == 'i' && look(1) == 'l') {
+                if (!(init = parse_expression())) return nullptr;
+            }
+            if (!consume('E')) return nullptr;
+            return make<NewNode>(placement, type, init, is_code(op, "na"));
+        }
+        switch (op->arity) {
+        case 0:
+            return make<NameNode>(K::Name, op->symbol);
+        case 1: {
+            bool suffix = false;
+            if (is_code(op, "pp") || is_code(op, "mm")) suffix = !consume('_');  // pp_ is the prefix form
+            Node* e = parse_expression();
+            return e ? make<UnaryNode>(op, nullptr, e, suffix) : nullptr;
+        }
+        case 2: {
+            bool cast = is_code(op, "dc") || is_code(op, "sc") || is_code(op, "cc") || is_code(op, "rc");
+            Node* lhs = cast ? parse_type() : parse_expression();
+            if (!lhs) return nullptr;
+            Node* rhs = nullptr;
+            if (is_code(op, "cl")) {
+                rhs = parse_expression_list('E');
+            } else if ((is_code(op, "dt") || is_code(op, "pt")) && !(look() == 's' && look(1) == 'r') &&
+                       !(look() == 'g' && look(1) == 's')) {
+                rhs = parse_base_unresolved_name();
+            } else {
+                rhs = parse_expression();
+            }
+            return rhs ? make<BinaryNode>(op, lhs, rhs) : nullptr;
+        }
+        case 3: {
+            Node* a = parse_expression();
+            Node* b = a ? parse_expression() : nullptr;
+            Node* e = b ? parse_expression() : nullptr;
+            return e ? make<TrinaryNode>(a, b, e) : nullptr;
+        }
+        }
+        return nullptr;
+    }
+
+    // ----- Encodings -----
+
+    // h <offset> _ | v <offset> _ <virtual offset> _
+    bool parse_call_offset() {
+        long n;
+        if (consume('h')) return parse_number(n) && consume('_');
+        if (consume('v')) return parse_number(n) && consume('_') && parse_number(n) && consume('_');
+        return false;
+    }
+
+    Node* parse_special_name() {
+        if (consume('T')) {
+            char c = look();
+            ++first;
+            switch (c) {
+            case 'V': return special("vtable for ", parse_type());
+            case 'T': return special("VTT for ", parse_type());
+            case 'I': return special("typeinfo for ", parse_type());
+            case 'S': return special("typeinfo name for ", parse_type());
+            case 'F': return special("typeinfo fn for ", parse_type());
+            case 'h': {
+                long n;
+                if (!parse_number(n) || !consume('_')) return nullptr;
+                return special("non-virtual thunk to ", parse_encoding());
+            }
+            case 'v': {
+                long n;
+                if (!parse_number(n) || !consume('_') || !parse_number(n) || !consume('_')) return nullptr;
+                return special("virtual thunk to ", parse_encoding());
+            }
+            case 'c':
+                if (!parse_call_offset() || !parse_call_offset()) return nullptr;
+                return special("covariant return thunk to ", parse_encoding());
+            case 'C': {
+                Node* complete = parse_type();
+                long n;
+                if (!complete || !parse_number(n) || !consume('_')) return nullptr;
+                Node* base = parse_type();
+                return base ? make<CtorVtableNode>(complete, base) : nullptr;
+            }
+            case 'H': return special("TLS init function for ", parse_name(nullptr));
+            case 'W': return special("TLS wrapper function for ", parse_name(nullptr));
+            case 'A': return special("template parameter object for ", parse_template_arg());
+            default: return nullptr;
+            }
+        }
+        if (consume('G')) {
+            char c = look();
+            ++first;
+            switch (c) {
+            case 'V': return special("guard variable for ", parse_name(nullptr));
+            case 'R': {
+                Node* name = parse_name(nullptr);
+                long n = 0;
+                if (!name || (is_digit(look()) && !parse_number(n))) return nullptr;
+                return make<RefTempNode>(name, n);
+            }
+            case 'A': return special("hidden alias for ", parse_encoding());
+            case 'T':
+                if (consume('t')) return special("transaction clone for ", parse_encoding());
+                if (consume('n')) return special("non-transaction clone for ", parse_encoding());
+                return nullptr;
+            default: return nullptr;
+            }
+        }
+        return nullptr;
+    }
+
+    Node* special(const char* prefix, Node* child) { return child ? make<SpecialNode>(prefix, child) : nullptr; }
+
+    // <encoding> ::= <name> <bare-function-type> | <name> | <special-name>
+    Node* parse_encoding() {
+        DepthGuard guard(depth);
+        if (!guard.ok) return nullptr;
+        if (look() == 'G' || look() == 'T') return parse_special_name();
+
+        // An encoding's template parameters are its own, not the enclosing context's
+        std::size_t saved_count = param_count;
+        int saved_blocked = blocked;
+        param_count = 0;
+        blocked = 0;
+        Node* result = parse_function_or_data();
+        param_count = saved_count;
+        blocked = saved_blocked;
+        return result;
+    }
+
+    Node* parse_function_or_data() {
+        NameState state;
+        Node* name = parse_name(&state);
+        if (!name || forward_needed) return nullptr;
+        if (!look() || look() == 'E' || look() == '.') return name;  // a data object
+
+        Node* ret = nullptr;
+        if (state.ends_with_template_args && !state.ctor_dtor_conversion && !(ret = parse_type())) return nullptr;
+        std::size_t from = scratch.size();
+        while (look() && look() != 'E' && look() != '.') {
+            Node* t = parse_type();
+            if (!t) return nullptr;
+            scratch.push_back(t);
+        }
+        if (scratch.size() == from) return nullptr;
+        if (scratch.size() == from + 1 && scratch.back() == &builtins['v' - 'a']) scratch.pop_back();
+        auto* fn = make<FunctionNode>(ret, pop_array(from), state.cv, state.ref, nullptr);
+        return make<EncodingNode>(name, fn);
+    }
+
+    // _Z <encoding> [.<clone suffix>]*
+    Node* parse(std::string_view mangled) {
+        arena.reset();
+        subs.clear();
+        scratch.clear();
+        param_count = forward_needed = 0;
+        blocked = 0;
+        permit_forward = in_conversion = in_lambda = false;
+        depth = 0;
+        last_name = {};
+        first = mangled.data();
+        last = first + mangled.size();
+
+        if (!consume("_Z")) return nullptr;
+        Node* result = parse_encoding();
+        if (!result) return nullptr;
+        // .constprop.0, .isra.0, .cold, .part.3.lto_priv.0 ...
+        while (look() == '.' && ((look(1) >= 'a' && look(1) <= 'z') || look(1) == '_' || is_digit(look(1)))) {
+            const char* start = first;
+            first += 2;
+            while ((look() >= 'a' && look() <= 'z') || is_digit(look()) || look() == '_') ++first;
+            while (look() == '.' && is_digit(look(1))) {
+                first += 2;
+                while (is_digit(look())) ++first;
+            }
+            result = make<CloneNode>(result, std::string_view(start, std::size_t(first - start)));
+        }
+        return first == last ? result : nullptr;
+    }
+};
+
+// ============================================================================
+// PUBLIC API
+// ============================================================================
+
+Demangler::Demangler() : parser_(new Parser) {}
+Demangler::~Demangler() = default;
+
+bool Demangler::demangle_to(std::string_view mangled, std::string& out) {
+    Node* root = parser_->parse(mangled);
+    if (!root) return false;
+    Printer p(out);
+    print(root, p);
+    if (p.failed) out.resize(p.start);
+    return !p.failed;
+}
+
+std::string_view Demangler::demangle(std::string_view mangled) {
+    std::string& buffer = parser_->output;
+    buffer.clear();
+    if (!demangle_to(mangled, buffer)) return {};
+    return buffer;
+}
+
+void Demangler::demangle_batch(const std::vector<std::string_view>& symbols, DemangledBatch& out) {
+    for (std::string_view symbol : symbols) {
+        bool ok = demangle_to(symbol, out.text);
+        if (!ok) out.text.append(symbol.data(), symbol.size());
+        out.ends.push_back(std::uint32_t(out.text.size()));
+        out.demangled.push_back(ok);
+    }
+}
+
+void Demangler::filter(std::string_view text, std::string& out) {
+    auto symbol_char = [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == '$' ||
+               c == '.';
+    };
+    std::size_t i = 0;
+    while (i < text.size()) {
+        if (!symbol_char(text[i])) {
+            std::size_t j = i;
+            while (j < text.size() && !symbol_char(text[j])) ++j;
+            out.append(text.data() + i, j - i);
+            i = j;
+            continue;
+        }
+        std::size_t j = i;
+        while (j < text.size() && symbol_char(text[j])) ++j;
+        std::string_view token = text.substr(i, j - i);
+        if (token.size() < 3 || token[0] != '_' || token[1] != 'Z' || !demangle_to(token, out))
+            out.append(token.data(), token.size());
+        i = j;
+    }
+}
+
+std::size_t Demangler::arena_bytes() const { return parser_->arena.reserved(); }
@@ -0,0 +1,97 @@
+// demangler.h - in-process Itanium C++ ABI demangler with a batch API
+//
+// operator_grammar.cpp walks through one mangled name by hand:
+//
+//   _ZN4DemoplEi  ->  Demo::operator+(int)
+//     N...E nested name, 4Demo source name, pl = operator+, i = int parameter
+//
+// This turns any such symbol back into C++, the way c++filt and
+// abi::__cxa_demangle do (same output text as libstdc++'s __cxa_demangle),
+// without a process per call and without heap traffic per symbol:
+//
+//   "_ZNSt6vectorIiSaIiEE9push_backEOi"
+//        │ parse: recursive descent over the grammar, nodes bump-allocated
+//        ▼        in an Arena; substitutions (S_, S0_) and template
+//   Nested(Template(std::vector, [int, Template(std::allocator, [int])]),
+//          push_back) + Function([int&&])
+//        │ print: declarator-aware (void (*)(int), int (&) [3], ...)
+//        ▼
+//   "std::vector<int, std::allocator<int> >::push_back(int&&)"
+//
+// After the first few symbols nothing is allocated: the arena keeps its
+// chunks, the substitution and template-parameter tables keep their
+// capacity, and the output goes into a reused buffer.
+//
+// Covered: the full <encoding> grammar - nested/local/unscoped names, every
+// operator code (pl mi ml ... cv li v), constructors/destructors, ABI tags,
+// lambdas and unnamed types, templates and packs, function/array/member
+// pointer types, decltype and template-argument expressions, literals,
+// special names (vtable, typeinfo, thunks, guard variables, TLS wrappers)
+// and clone suffixes (.constprop.0, .cold). Names that aren't valid
+// mangled names come back as "not demangled" rather than half-printed,
+// with the same strictness as __cxa_demangle: a constructor kind outside
+// C1-C5, a destructor kind outside D0-D2/D4/D5 or a function type with no
+// parameter types (FvE rather than FvvE) is invalid.
+
+#ifndef DEMANGLER_H
+#define DEMANGLER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "arena.h"  // parse nodes; reset() keeps the chunks
+
+// Results of demangle_batch(): one text buffer, one end offset per symbol
+struct DemangledBatch {
+    std::string text;
+    std::vector<std::uint32_t> ends;
+    std::vector<bool> demangled;  // false: the entry is the input, unchanged
+
+    std::size_t size() const { return ends.size(); }
+    std::string_view operator[](std::size_t i) const {
+        std::uint32_t begin = i == 0 ? 0 : ends[i - 1];
+        return std::string_view(text).substr(begin, ends[i] - begin);
+    }
+    void clear() {
+        text.clear();
+        ends.clear();
+        demangled.clear();
+    }
+};
+
+class Demangler {
+public:
+    Demangler();
+    ~Demangler();
+
+    Demangler(const Demangler&) = delete;
+    Demangler& operator=(const Demangler&) = delete;
+
+    // The demangled name, or an empty view if `mangled` isn't a valid
+    // mangled name. Valid until the next call on this Demangler.
+    std::string_view demangle(std::string_view mangled);
+
+    // Appends the demangled name to out; on failure appends nothing and
+    // returns false
+    bool demangle_to(std::string_view mangled, std::string& out);
+
+    // Many symbols in one call; failures are copied through unchanged.
+    // Reuse `out` across batches and nothing is allocated per symbol.
+    void demangle_batch(const std::vector<std::string_view>& symbols, DemangledBatch& out);
+
+    // What c++filt does to its input: copies text to out, replacing every
+    // mangled name in it (tokens of [A-Za-z0-9_$.] starting with _Z)
+    void filter(std::string_view text, std::string& out);
+
+    std::size_t arena_bytes() const;
+
+private:
+    struct Parser;
+    std::unique_ptr<Parser> parser_;
+};
+
+#endif  // DEMANGLER_H
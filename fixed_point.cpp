@@ -0,0 +1,621 @@
+// Fixed<IntBits, FracBits>: deterministic fixed-point Number + SIMD NumberBatch
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#include "bench_util.h"
+
+// ============================================================================
+// WHY FIXED POINT
+// ============================================================================
+//
+// double results can differ between machines running the SAME source:
+//   - the compiler may fuse a*b + c into one FMA (one rounding instead of two)
+//   - -ffast-math / vectorization reorders sums: (a + b) + c != a + (b + c)
+//   - libm functions (exp, pow) are not correctly rounded and differ by vendor
+//
+// Fixed point stores value * 2^FracBits as an INTEGER. Every operation is
+// integer arithmetic with an explicitly chosen rounding and overflow rule, so
+// the result is the same bit pattern on every platform and at every -O level.
+//
+//   Fixed<16, 16>  (Q15.16, "16.16"):  32 bits = sign + 15 integer + 16 fraction
+//   ┌─┬───────────────┬────────────────┐
+//   │s│ integer part  │ fraction       │   raw = round(value * 65536)
+//   └─┴───────────────┴────────────────┘
+//   range [-32768, 32767.99998], step 1/65536 = 0.0000153
+//
+// IntBits includes the sign bit. IntBits + FracBits <= 32; the raw value is
+// stored in int16_t or int32_t, and every intermediate in int64_t.
+//
+// Two policies, chosen per type:
+//   Overflow::Saturate  clamp to the largest/smallest value (prices don't wrap)
+//   Overflow::Wrap      keep the low bits, like unsigned/int arithmetic
+//   Rounding::Floor        drop the extra fraction bits (toward -infinity)
+//   Rounding::Nearest      round half up (toward +infinity)
+//   Rounding::NearestEven  round half to even ("banker's rounding": no bias)
+//
+// The one platform assumption: >> on a negative integer is an arithmetic
+// shift. Every mainstream compiler does this, and C++20 guarantees it.
+
+enum class Overflow { Saturate, Wrap };
+enum class Rounding { Floor, Nearest, NearestEven };
+
+template <int IntBits, int FracBits, Overflow O = Overflow::Saturate, Rounding R = Rounding::Nearest>
+class Fixed {
+    static_assert(IntBits >= 1, "IntBits includes the sign bit");
+    static_assert(FracBits >= 0 && IntBits + FracBits <= 32, "at most 32 bits");
+
+public:
+    static constexpr int kIntBits = IntBits;
+    static constexpr int kFracBits = FracBits;
+    static constexpr int kTotalBits = IntBits + FracBits;
+    static constexpr Overflow kOverflow = O;
+    static constexpr Rounding kRounding = R;
+
+    using Raw = std::conditional_t<(kTotalBits <= 16), std::int16_t, std::int32_t>;
+    using Wide = std::int64_t;
+
+    static constexpr Wide kMaxRaw = (Wide(1) << (kTotalBits - 1)) - 1;
+    static constexpr Wide kMinRaw = -(Wide(1) << (kTotalBits - 1));
+    static constexpr Wide kOne = Wide(1) << FracBits;
+
+private:
+    Raw raw_ = 0;
+
+    // Bring an exact intermediate back into kTotalBits
+    static Raw fit(Wide v) {
+        if constexpr (O == Overflow::Saturate) {
+            return Raw(std::clamp(v, kMinRaw, kMaxRaw));
+        } else {
+            // keep the low kTotalBits bits, then sign-extend them
+            constexpr int shift = 64 - kTotalBits;
+            return Raw(Wide(std::uint64_t(v) << shift) >> shift);
+        }
+    }
+
+    // n / d rounded by the policy, d > 0
+    static Wide round_div(Wide n, Wide d) {
+        Wide q = n / d, r = n % d;
+        if (r < 0) {  // C++ division truncates toward zero; make it floor
+            --q;
+            r += d;
+        }
+        if constexpr (R == Rounding::Nearest) {
+            if (2 * r >= d) ++q;
+        } else if constexpr (R == Rounding::NearestEven) {
+            if (2 * r > d || (2 * r == d && (q & 1))) ++q;
+        }
+        return q;
+    }
+
+    // n / 2^FracBits rounded by the policy: the same rule as round_div, with shifts
+    static Wide round_shift(Wide n) {
+        if constexpr (FracBits == 0) {
+            return n;
+        } else {
+            constexpr Wide half = Wide(1) << (FracBits - 1);
+            if constexpr (R == Rounding::Floor) {
+                return n >> FracBits;
+            } else if constexpr (R == Rounding::Nearest) {
+                return (n + half) >> FracBits;
+            } else {
+                Wide q = n >> FracBits;
+                Wide r = n & (kOne - 1);
+                if (r > half || (r == half && (q & 1))) ++q;
+                return q;
+            }
+        }
+    }
+
+public:
+    Fixed() = default;
+
+    // Implicit from int, like Number(int): Fixed x = 3; x + 1 ...
+    Fixed(int v) : raw_(fit(Wide(v) * kOne)) {}
+
+    // From double: scaling by 2^FracBits is exact, only the final rounding is not.
+    // NaN has no nearest representable value: it becomes 0. ±infinity
+    // saturates like any other out-of-range value.
+    explicit Fixed(double v) {
+        if (std::isnan(v)) v = 0.0;  // std::clamp passes NaN through, and NaN -> int64 is undefined
+        double scaled = v * double(kOne);
+        double r;
+        if constexpr (R == Rounding::Floor) r = std::floor(scaled);
+        else if constexpr (R == Rounding::Nearest) r = std::floor(scaled + 0.5);
+        else r = std::nearbyint(scaled);  // default FP environment: ties to even
+        r = std::clamp(r, -9.0e18, 9.0e18);  // keep the cast to int64 defined
+        raw_ = fit(Wide(r));
+    }
+
+    static Fixed from_raw(Raw raw) {
+        Fixed f;
+        f.raw_ = raw;
+        return f;
+    }
+
+    static Fixed max() { return from_raw(Raw(kMaxRaw)); }
+    static Fixed min() { return from_raw(Raw(kMinRaw)); }
+    static Fixed epsilon() { return from_raw(1); }
+
+    Raw raw() const { return raw_; }
+    double to_double() const { return double(raw_) / double(kOne); }  // exact
+
+    // ----- The Number operator surface -----
+
+    Fixed operator+(Fixed other) const { return from_raw(fit(Wide(raw_) + other.raw_)); }
+    Fixed operator-(Fixed other) const { return from_raw(fit(Wide(raw_) - other.raw_)); }
+    Fixed operator-() const { return from_raw(fit(-Wide(raw_))); }
+
+    // Product has 2*FracBits fraction bits: round away FracBits of them
+    Fixed operator*(Fixed other) const { return from_raw(fit(round_shift(Wide(raw_) * other.raw_))); }
+
+    // Division by zero has no trap in fixed point: return the saturated value
+    // in the direction of the dividend (0 / 0 gives 0)
+    Fixed operator/(Fixed other) const {
+        if (other.raw_ == 0) return raw_ > 0 ? max() : raw_ < 0 ? min() : Fixed();
+        Wide n = Wide(raw_) * kOne;
+        Wide d = other.raw_;
+        if (d < 0) {
+            n = -n;
+            d = -d;
+        }
+        return from_raw(fit(round_div(n, d)));
+    }
+
+    Fixed& operator+=(Fixed other) { return *this = *this + other; }
+    Fixed& operator-=(Fixed other) { return *this = *this - other; }
+    Fixed& operator*=(Fixed other) { return *this = *this * other; }
+    Fixed& operator/=(Fixed other) { return *this = *this / other; }
+
+    // ++ adds 1.0 (not one raw step)
+    Fixed& operator++() { return *this += Fixed(1); }
+    Fixed operator++(int) {
+        Fixed temp = *this;
+        ++*this;
+        return temp;
+    }
+
+    // operator[] - bit `index` of the raw two's complement pattern
+    int operator[](int index) const { return int((std::uint32_t(std::int32_t(raw_)) >> index) & 1u); }
+
+    // operator() - same meaning as Number: value + x + y
+    Fixed operator()(Fixed x, Fixed y) const { return *this + x + y; }
+
+    bool operator==(Fixed o) const { return raw_ == o.raw_; }
+    bool operator!=(Fixed o) const { return raw_ != o.raw_; }
+    bool operator<(Fixed o) const { return raw_ < o.raw_; }
+
+    // Exact decimal: FracBits binary fraction digits need exactly FracBits
+    // decimal digits; trailing zeros are trimmed
+    friend std::ostream& operator<<(std::ostream& os, Fixed f) {
+        Wide v = f.raw_;
+        std::string s = v < 0 ? "-" : "";
+        std::uint64_t mag = v < 0 ? std::uint64_t(-v) : std::uint64_t(v);
+        s += std::to_string(mag >> FracBits);
+        std::uint64_t frac = mag & std::uint64_t(kOne - 1);
+        if (frac) {
+            s += '.';
+            while (frac) {  // frac * 10 < 2^36: no overflow
+                frac *= 10;
+                s += char('0' + (frac >> FracBits));
+                frac &= std::uint64_t(kOne - 1);
+            }
+        }
+        return os << s;
+    }
+};
+
+using Q16 = Fixed<16, 16>;  // the usual "16.16" format
+
+// ============================================================================
+// NumberBatch: operator+ / operator* over whole arrays
+// ============================================================================
+//
+// Scalar definition first: the SIMD path must produce the same bits.
+//
+// AVX2 path for 32-bit raw values (IntBits + FracBits > 16), 8 lanes:
+//
+//   add, Saturate, 32 bits:  sum = a + b (wraps); overflow iff a and b have
+//                            the same sign and sum's sign differs; then pick
+//                            INT32_MAX or INT32_MIN by a's sign
+//   add, Saturate, <32 bits: a + b cannot overflow int32: clamp with min/max
+//   mul:                     _mm256_mul_epi32 gives 4 exact 64-bit products
+//                            (even lanes); shift the odd lanes down for the
+//                            other 4. Add the rounding bias, clamp in 64 bits,
+//                            then shift right by FracBits: after the clamp the
+//                            result fits in 32 bits, so a LOGICAL 64-bit shift
+//                            leaves the same low 32 bits as an arithmetic one
+//                            (AVX2 has no 64-bit arithmetic shift)
+//
+// NearestEven and 16-bit raw values use the scalar loop (GCC vectorizes the
+// 16-bit one by itself at -O3).
+
+template <typename Fx>
+void batch_add_scalar(const typename Fx::Raw* a, const typename Fx::Raw* b, typename Fx::Raw* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = (Fx::from_raw(a[i]) + Fx::from_raw(b[i])).raw();
+}
+
+template <typename Fx>
+void batch_mul_scalar(const typename Fx::Raw* a, const typename Fx::Raw* b, typename Fx::Raw* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) out[i] = (Fx::from_raw(a[i]) * Fx::from_raw(b[i])).raw();
+}
+
+#if defined(__AVX2__)
+
+template <typename Fx>
+constexpr bool kHasSimd = sizeof(typename Fx::Raw) == 4 && Fx::kRounding != Rounding::NearestEven;
+
+// Sign-extend the low `bits` bits of every 32-bit lane
+template <int Bits>
+inline __m256i sign_extend32(__m256i v) {
+    if constexpr (Bits == 32) return v;
+    else return _mm256_srai_epi32(_mm256_slli_epi32(v, 32 - Bits), 32 - Bits);
+}
+
+template <typename Fx>
+void batch_add_simd(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::size_t n) {
+    constexpr int bits = Fx::kTotalBits;
+    const __m256i vmax = _mm256_set1_epi32(std::int32_t(Fx::kMaxRaw));
+    const __m256i vmin = _mm256_set1_epi32(std::int32_t(Fx::kMinRaw));
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i sum = _mm256_add_epi32(va, vb);
+        if constexpr (Fx::kOverflow == Overflow::Wrap) {
+            sum = sign_extend32<bits>(sum);
+        } else if constexpr (bits == 32) {
+            // sign bit of (sum ^ a) & (sum ^ b) is set exactly on overflow
+            __m256i overflow = _mm256_and_si256(_mm256_xor_si256(sum, va), _mm256_xor_si256(sum, vb));
+            // blendv_ps picks by the sign bit of each 32-bit lane (blendv_epi8 would use every byte's)
+            auto pick = [](__m256i if_clear, __m256i if_set, __m256i mask) {
+                return _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(if_clear), _mm256_castsi256_ps(if_set),
+                                                            _mm256_castsi256_ps(mask)));
+            };
+            sum = pick(sum, pick(vmax, vmin, va), overflow);  // a < 0 -> MIN
+        } else {
+            sum = _mm256_min_epi32(_mm256_max_epi32(sum, vmin), vmax);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), sum);
+    }
+    batch_add_scalar<Fx>(a + i, b + i, out + i, n - i);
+}
+
+template <typename Fx>
+inline __m256i mul_round_clamp(__m256i product) {
+    constexpr int frac = Fx::kFracBits;
+    constexpr std::int64_t bias = Fx::kRounding == Rounding::Nearest && frac > 0 ? std::int64_t(1) << (frac - 1) : 0;
+    // q = floor(p / 2^frac) lies in [min, max]  <=>  p in [min * 2^frac, max * 2^frac + 2^frac - 1]
+    const __m256i lo = _mm256_set1_epi64x(Fx::kMinRaw * Fx::kOne);
+    const __m256i hi = _mm256_set1_epi64x(Fx::kMaxRaw * Fx::kOne + (Fx::kOne - 1));
+
+    __m256i p = _mm256_add_epi64(product, _mm256_set1_epi64x(bias));
+    if constexpr (Fx::kOverflow == Overflow::Saturate) {
+        p = _mm256_blendv_epi8(p, hi, _mm256_cmpgt_epi64(p, hi));
+        p = _mm256_blendv_epi8(p, lo, _mm256_cmpgt_epi64(lo, p));
+    }
+    return _mm256_srli_epi64(p, frac);
+}
+
+template <typename Fx>
+void batch_mul_simd(const std::int32_t* a, const std::int32_t* b, std::int32_t* out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i va = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+        __m256i vb = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i));
+        __m256i even = mul_round_clamp<Fx>(_mm256_mul_epi32(va, vb));
+        __m256i odd = mul_round_clamp<Fx>(_mm256_mul_epi32(_mm256_srli_epi64(va, 32), _mm256_srli_epi64(vb, 32)));
+        __m256i r = _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xAA);
+        if constexpr (Fx::kOverflow == Overflow::Wrap) r = sign_extend32<Fx::kTotalBits>(r);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), r);
+    }
+    batch_mul_scalar<Fx>(a + i, b + i, out + i, n - i);
+}
+
+#else
+
+template <typename Fx>
+constexpr bool kHasSimd = false;
+
+#endif
+
+template <typename Fx>
+class NumberBatch {
+public:
+    using Raw = typename Fx::Raw;
+
+    explicit NumberBatch(std::size_t n = 0) : raw_(n) {}
+
+    std::size_t size() const { return raw_.size(); }
+    Fx operator[](std::size_t i) const { return Fx::from_raw(raw_[i]); }
+    void set(std::size_t i, Fx v) { raw_[i] = v.raw(); }
+    const Raw* data() const { return raw_.data(); }
+    Raw* data() { return raw_.data(); }
+
+    // Elementwise; sizes must match. `out` may alias a or b.
+    static void add(const NumberBatch& a, const NumberBatch& b, NumberBatch& out) {
+#if defined(__AVX2__)
+        if constexpr (kHasSimd<Fx>) {
+            batch_add_simd<Fx>(a.data(), b.data(), out.data(), a.size());
+            return;
+        }
+#endif
+        batch_add_scalar<Fx>(a.data(), b.data(), out.data(), a.size());
+    }
+
+    static void mul(const NumberBatch& a, const NumberBatch& b, NumberBatch& out) {
+#if defined(__AVX2__)
+        if constexpr (kHasSimd<Fx>) {
+            batch_mul_simd<Fx>(a.data(), b.data(), out.data(), a.size());
+            return;
+        }
+#endif
+        batch_mul_scalar<Fx>(a.data(), b.data(), out.data(), a.size());
+    }
+
+    NumberBatch operator+(const NumberBatch& other) const {
+        NumberBatch out(size());
+        add(*this, other, out);
+        return out;
+    }
+
+    NumberBatch operator*(const NumberBatch& other) const {
+        NumberBatch out(size());
+        mul(*this, other, out);
+        return out;
+    }
+
+private:
+    std::vector<Raw> raw_;
+};
+
+// ============================================================================
+// DEMO + BENCHMARKS
+// ============================================================================
+
+// FNV-1a over raw bit patterns: equal hashes <=> equal bits
+struct Fnv {
+    std::uint64_t h = 0xcbf29ce484222325ull;
+    void add(std::uint32_t v) {
+        for (int k = 0; k < 4; ++k) {
+            h ^= (v >> (8 * k)) & 0xFF;
+            h *= 0x100000001b3ull;
+        }
+    }
+};
+
+void show_operators() {
+    std::cout << "=== Same operators as Number ===" << std::endl;
+    Q16 a(3.25), b = 2;
+    std::cout << "a = " << a << " (raw 0x" << std::hex << a.raw() << std::dec << "), b = " << b << std::endl;
+    std::cout << "a + b = " << a + b << ", a * b = " << a * b << ", a / b = " << a / b << std::endl;
+    std::cout << "a(1, 2) = " << a(1, 2) << "  (operator(): a + 1 + 2)" << std::endl;
+    std::cout << "a[16] = " << a[16] << ", a[15] = " << a[15] << ", a[14] = " << a[14]
+              << "  (operator[]: raw bits, 3.25 = 11.01b)" << std::endl;
+    std::cout << "a++ = " << a++ << ", then ++a = " << ++a << std::endl;
+    std::cout << "Q16(0.1) = " << Q16(0.1) << "  (exact value stored; 0.1 has no finite binary form)" << std::endl;
+    std::cout << std::endl;
+}
+
+void show_policies() {
+    std::cout << "=== Overflow policies (Fixed<16, 16>) ===" << std::endl;
+    Fixed<16, 16, Overflow::Saturate> sat = Fixed<16, 16, Overflow::Saturate>::max();
+    Fixed<16, 16, Overflow::Wrap> wrap = Fixed<16, 16, Overflow::Wrap>::max();
+    std::cout << "  max + 1:  Saturate -> " << sat + 1 << ",  Wrap -> " << wrap + 1 << std::endl;
+    std::cout << "  200 * 200: Saturate -> " << Fixed<16, 16, Overflow::Saturate>(200) * 200
+              << ",  Wrap -> " << Fixed<16, 16, Overflow::Wrap>(200) * 200 << std::endl;
+
+    std::cout << "=== Rounding policies (Fixed<8, 8>: step 1/256) ===" << std::endl;
+    std::cout << "  product          exact      Floor    Nearest  NearestEven" << std::endl;
+    using F = Fixed<8, 8, Overflow::Saturate, Rounding::Floor>;
+    using N = Fixed<8, 8, Overflow::Saturate, Rounding::Nearest>;
+    using E = Fixed<8, 8, Overflow::Saturate, Rounding::NearestEven>;
+    for (int raw : {1, 3, -3, 5}) {
+        char line[128];
+        std::snprintf(line, sizeof(line), "  %3d/256 * 0.5  %5.1f/256  %5d/256  %5d/256  %5d/256", raw, raw * 0.5,
+                      (F::from_raw(std::int16_t(raw)) * F(0.5)).raw(), (N::from_raw(std::int16_t(raw)) * N(0.5)).raw(),
+                      (E::from_raw(std::int16_t(raw)) * E(0.5)).raw());
+        std::cout << line << std::endl;
+    }
+    std::cout << std::endl;
+}
+
+void show_associativity() {
+    std::cout << "=== Addition order ===" << std::endl;
+    double x = 0.1, y = 0.2, z = 0.3;
+    std::cout.precision(17);
+    std::cout << "  double: (0.1 + 0.2) + 0.3 = " << (x + y) + z << std::endl;
+    std::cout << "          0.1 + (0.2 + 0.3) = " << x + (y + z) << std::endl;
+    std::cout.precision(6);
+    Q16 fx(0.1), fy(0.2), fz(0.3);
+    std::cout << "  Q16:    (0.1 + 0.2) + 0.3 = " << (fx + fy) + fz << std::endl;
+    std::cout << "          0.1 + (0.2 + 0.3) = " << fx + (fy + fz) << std::endl;
+    std::cout << "  Integer addition is associative: any summation order, any SIMD width," << std::endl;
+    std::cout << "  same bits (as long as no intermediate saturates)." << std::endl;
+    std::cout << std::endl;
+}
+
+// Random raw values, with the extremes mixed in so saturation paths run
+template <typename Fx>
+std::vector<typename Fx::Raw> random_raw(std::size_t n, Lcg& rng) {
+    std::vector<typename Fx::Raw> v(n);
+    for (auto& x : v) {
+        std::uint32_t r = rng.next();
+        switch (r % 16) {
+            case 0: x = typename Fx::Raw(Fx::kMaxRaw); break;
+            case 1: x = typename Fx::Raw(Fx::kMinRaw); break;
+            case 2: x = typename Fx::Raw(Fx::kOne); break;
+            case 3: x = typename Fx::Raw(r % 7); break;
+            default: x = Fx::from_raw(typename Fx::Raw(std::int32_t(rng.next()) >> (32 - Fx::kTotalBits))).raw();
+        }
+    }
+    return v;
+}
+
+template <typename Fx>
+void check_format(const char* name) {
+    Lcg rng{2026};
+    const std::size_t n = 100003;  // not a multiple of 8: the scalar tail runs too
+    NumberBatch<Fx> a(n), b(n);
+    auto ra = random_raw<Fx>(n, rng), rb = random_raw<Fx>(n, rng);
+    std::copy(ra.begin(), ra.end(), a.data());
+    std::copy(rb.begin(), rb.end(), b.data());
+
+    NumberBatch<Fx> sum = a + b, prod = a * b;
+    bool same = true, close = true;
+    for (std::size_t i = 0; i < n; ++i) {
+        same &= sum[i] == a[i] + b[i] && prod[i] == a[i] * b[i];
+        // Compared with exact real arithmetic: at most one step off, unless saturated or wrapped
+        double exact = a[i].to_double() * b[i].to_double();
+        double lim = Fx::max().to_double();
+        if (std::abs(exact) < lim && Fx::kOverflow == Overflow::Saturate)
+            close &= std::abs(prod[i].to_double() - exact) <= Fx::epsilon().to_double();
+    }
+    std::string simd = kHasSimd<Fx> ? "AVX2" : "scalar";
+    check(same, std::string(name) + ": NumberBatch (" + simd + ") == scalar operators, bit for bit");
+    check(close, std::string(name) + ": products within one step of the exact value");
+}
+
+// A toy pricing kernel: compounding with fees, one step after another.
+// Every intermediate is a Q16 bit pattern, so the final hash is the same on
+// every compiler, flag set and CPU.
+std::uint64_t pricing_hash() {
+    Fnv fnv;
+    Q16 rate(1.0003), fee(0.0125);
+    NumberBatch<Q16> px(4096), qty(4096), notional(4096);
+    for (std::size_t i = 0; i < px.size(); ++i) {
+        px.set(i, Q16(double(i % 997) / 7.0));
+        qty.set(i, Q16(int(i % 13) + 1));
+    }
+    for (int step = 0; step < 200; ++step) {
+        NumberBatch<Q16>::mul(px, qty, notional);
+        for (std::size_t i = 0; i < px.size(); ++i) px.set(i, px[i] * rate - fee);
+        for (std::size_t i = 0; i < notional.size(); i += 97) fnv.add(std::uint32_t(notional[i].raw()));
+    }
+    return fnv.h;
+}
+
+// Recorded once on x86-64; any platform that disagrees is not bit-exact
+constexpr std::uint64_t kPricingGolden = 0xdf93f708ed717e25ull;
+
+template <typename Fx>
+void bench_format(const char* name, std::size_t n, int reps) {
+    Lcg rng{1};
+    NumberBatch<Fx> a(n), b(n), out(n);
+    std::vector<double> da(n), db(n), dout(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Fx x = Fx::from_raw(typename Fx::Raw(std::int32_t(rng.next()) >> (33 - Fx::kTotalBits)));
+        Fx y(double(rng.next() % 2000) / 1000.0);
+        a.set(i, x);
+        b.set(i, y);
+        da[i] = x.to_double();
+        db[i] = y.to_double();
+    }
+
+    auto rate = [&](double ms) { return double(n) * reps / (ms * 1e3); };  // M elements/s
+    double d_add = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            for (std::size_t i = 0; i < n; ++i) dout[i] = da[i] + db[i];
+            do_not_optimize(dout[0]);
+        }
+    });
+    double d_mul = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            for (std::size_t i = 0; i < n; ++i) dout[i] = da[i] * db[i];
+            do_not_optimize(dout[0]);
+        }
+    });
+    double s_add = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            batch_add_scalar<Fx>(a.data(), b.data(), out.data(), n);
+            do_not_optimize(out.data()[0]);
+        }
+    });
+    double s_mul = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            batch_mul_scalar<Fx>(a.data(), b.data(), out.data(), n);
+            do_not_optimize(out.data()[0]);
+        }
+    });
+    double b_add = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            NumberBatch<Fx>::add(a, b, out);
+            do_not_optimize(out.data()[0]);
+        }
+    });
+    double b_mul = time_ms([&] {
+        for (int r = 0; r < reps; ++r) {
+            NumberBatch<Fx>::mul(a, b, out);
+            do_not_optimize(out.data()[0]);
+        }
+    });
+
+    std::cout << "--- " << name << " (" << n << " elements, M elements/s) ---" << std::endl;
+    char line[160];
+    std::snprintf(line, sizeof(line), "  %-26s %10s %10s", "", "add", "mul");
+    std::cout << line << std::endl;
+    std::snprintf(line, sizeof(line), "  %-26s %10.0f %10.0f", "double loop", rate(d_add), rate(d_mul));
+    std::cout << line << std::endl;
+    std::snprintf(line, sizeof(line), "  %-26s %10.0f %10.0f", "Fixed scalar loop", rate(s_add), rate(s_mul));
+    std::cout << line << std::endl;
+    std::snprintf(line, sizeof(line), "  %-26s %10.0f %10.0f", kHasSimd<Fx> ? "NumberBatch (AVX2)" : "NumberBatch (scalar)",
+                  rate(b_add), rate(b_mul));
+    std::cout << line << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Fixed-Point Numbers: Deterministic Fast Math ===" << std::endl << std::endl;
+
+    show_operators();
+    show_policies();
+    show_associativity();
+
+    std::cout << "=== Correctness ===" << std::endl;
+    check_format<Fixed<16, 16, Overflow::Saturate, Rounding::Nearest>>("Q16 saturate/nearest");
+    check_format<Fixed<16, 16, Overflow::Wrap, Rounding::Floor>>("Q16 wrap/floor");
+    check_format<Fixed<16, 16, Overflow::Saturate, Rounding::NearestEven>>("Q16 saturate/even");
+    check_format<Fixed<1, 31>>("Q0.31 (-1 * -1 saturates)");
+    check_format<Fixed<12, 12>>("Q11.12 (24 bits)");
+    check_format<Fixed<20, 8, Overflow::Wrap>>("Q19.8 wrap (28 bits)");
+    check_format<Fixed<1, 15>>("Q0.15 (int16 raw)");
+    check(Fixed<1, 31>(-1) * Fixed<1, 31>(-1) == Fixed<1, 31>::max(), "Q0.31: -1 * -1 = max, not -1");
+    check(Q16(7) / Q16(0) == Q16::max() && Q16(-7) / Q16(0) == Q16::min(), "division by zero saturates");
+    check(Q16(std::nan("")) == Q16(0) && Q16(HUGE_VAL) == Q16::max() && Q16(-HUGE_VAL) == Q16::min(),
+          "from double: NaN -> 0, +-infinity saturates");
+    check(Q16(1) / Q16(3) * 3 != Q16(1) && Q16(10) / Q16(4) == Q16(2.5), "division rounds to the nearest step");
+
+    std::uint64_t h = pricing_hash();
+    std::cout << "  pricing kernel hash: 0x" << std::hex << h << std::dec << std::endl;
+    check(h == kPricingGolden, "hash matches the value recorded on x86-64");
+    std::cout << std::endl;
+
+    std::size_t n = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1 << 14;
+    int reps = std::max(1, int((std::size_t(400) << 20) / (n * 8)));
+    std::cout << "=== Throughput vs double ===" << std::endl;
+    bench_format<Q16>("Q16 saturate/nearest", n, reps);
+    bench_format<Fixed<16, 16, Overflow::Wrap, Rounding::Floor>>("Q16 wrap/floor", n, reps);
+    bench_format<Fixed<1, 15>>("Q0.15 (int16 raw)", n, reps);
+    std::cout << std::endl;
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Fixed point = integers + an agreed scale: same bits on every machine" << std::endl;
+    std::cout << "• Rounding and overflow are part of the type, not an accident of the FPU" << std::endl;
+    std::cout << "• Saturation is what prices want: wrap-around turns +big into -big" << std::endl;
+    std::cout << "• SIMD is safe here: integer ops give identical results in any lane order" << std::endl;
+    std::cout << "• A fixed multiply needs a 64-bit product + shift: more work than a double mul" << std::endl;
+    std::cout << "• Range is the price: Q16 ends at 32768, pick IntBits for your data" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,348 @@
+// layout_inspector.h - memory layout and cache-locality report for registered types
+//
+// memory_visualization.cpp prints the addresses of one Vector by hand. This
+// does it for any type whose members are listed once:
+//
+//   struct Line { Point start; Point end; };
+//   INSPECT_LAYOUT(Line, start, end);            // at namespace scope
+//
+//   print_layout(layout_of<Line>(), std::cout);  // sizeof, alignof, offsets, holes
+//   print_array_footprint(layout_of<Line>(), 1000, std::cout);
+//
+//   Line  size 16  align 4  trivially copyable
+//     offset  size  member
+//          0     8  start
+//          8     8  end
+//     padding: 0 bytes in 0 holes
+//
+// Private members: put LAYOUT_FRIEND; inside the class (a friend declaration,
+// no data, no layout change).
+//
+// Polymorphic types get a "<vptr>" pseudo-member at offset 0 (single,
+// non-virtual inheritance: the Itanium ABI puts the vtable pointer first).
+// A hole is any byte not covered by a registered member - so forgetting to
+// register a member shows up as "padding" too. Bit-fields can't be listed.
+//
+// For containers, heap_placement() reports where the elements live relative
+// to the object (stack vs heap) and which NUMA node backs each page, asked of
+// the kernel with move_pages(2) in query mode (no libnuma needed). Where the
+// syscall is refused (seccomp, no NUMA support) the page report says why.
+
+#ifndef LAYOUT_INSPECTOR_H
+#define LAYOUT_INSPECTOR_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <iterator>
+#include <map>
+#include <numeric>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <sys/syscall.h>
+#include <unistd.h>
+
+constexpr std::size_t kCacheLine = 64;
+
+struct MemberLayout {
+    std::string name;
+    std::size_t offset;
+    std::size_t size;
+    std::size_t align;
+};
+
+struct LayoutHole {
+    std::size_t offset;
+    std::size_t size;
+};
+
+struct ArrayFootprint {
+    std::size_t count;
+    std::size_t bytes;
+    std::size_t lines_aligned;  // array starts on a cache-line boundary
+    std::size_t lines_worst;    // worst start offset the type's alignment allows
+    std::size_t straddling;     // objects split across two lines (aligned start)
+};
+
+struct TypeLayout {
+    std::string name;
+    std::size_t size = 0;
+    std::size_t align = 0;
+    bool has_vptr = false;
+    bool trivially_copyable = false;
+    std::vector<MemberLayout> members;  // in offset order, "<vptr>" first if present
+
+    // Bytes not covered by any member, including tail padding
+    std::vector<LayoutHole> holes() const {
+        std::vector<LayoutHole> out;
+        std::size_t at = 0;
+        for (const MemberLayout& m : members) {
+            if (m.offset > at) out.push_back(LayoutHole{at, m.offset - at});
+            at = std::max(at, m.offset + m.size);
+        }
+        if (size > at) out.push_back(LayoutHole{at, size - at});
+        return out;
+    }
+
+    std::size_t padding_bytes() const {
+        std::size_t n = 0;
+        for (const LayoutHole& h : holes()) n += h.size;
+        return n;
+    }
+
+    // sizeof if the members were declared largest-alignment first: what
+    // reordering alone could reach (the vptr stays in front)
+    std::size_t packed_size() const {
+        std::vector<MemberLayout> sorted = members;
+        std::stable_sort(sorted.begin(), sorted.end(), [](const MemberLayout& a, const MemberLayout& b) {
+            if ((a.name == "<vptr>") != (b.name == "<vptr>")) return a.name == "<vptr>";
+            return a.align > b.align;
+        });
+        std::size_t at = 0;
+        for (const MemberLayout& m : sorted) at = (at + m.align - 1) / m.align * m.align + m.size;
+        return align ? (at + align - 1) / align * align : at;
+    }
+
+    const MemberLayout* member(const std::string& member_name) const {
+        for (const MemberLayout& m : members)
+            if (m.name == member_name) return &m;
+        return nullptr;
+    }
+
+    // Lines touched by a cache-line-aligned array of n objects and the worst
+    // misaligned start. Objects repeat their position every
+    // line/gcd(size, line) elements, so one period is enough to count straddlers.
+    ArrayFootprint array_footprint(std::size_t n, std::size_t line = kCacheLine) const {
+        ArrayFootprint f{n, n * size, 0, 0, 0};
+        if (n == 0 || size == 0) return f;
+        f.lines_aligned = (f.bytes + line - 1) / line;
+        for (std::size_t start = 0; start < line; start += std::max<std::size_t>(align, 1))
+            f.lines_worst = std::max(f.lines_worst, (start + f.bytes + line - 1) / line);
+        std::size_t period = line / std::gcd(size, line);
+        auto straddles = [&](std::size_t i) { return (i * size) / line != (i * size + size - 1) / line; };
+        std::size_t per_period = 0;
+        for (std::size_t i = 0; i < period; ++i) per_period += straddles(i);
+        f.straddling = n / period * per_period;
+        for (std::size_t i = n / period * period; i < n; ++i) f.straddling += straddles(i);
+        return f;
+    }
+};
+
+// Specialized by INSPECT_LAYOUT; get() returns the filled-in TypeLayout
+template <typename T>
+struct LayoutOf;
+
+template <typename T>
+TypeLayout layout_of() {
+    return LayoutOf<T>::get();
+}
+
+template <typename T>
+class LayoutBuilder {
+public:
+    explicit LayoutBuilder(const char* name) {
+        layout_.name = name;
+        layout_.size = sizeof(T);
+        layout_.align = alignof(T);
+        layout_.has_vptr = std::is_polymorphic<T>::value;
+        layout_.trivially_copyable = std::is_trivially_copyable<T>::value;
+        if (layout_.has_vptr) layout_.members.push_back(MemberLayout{"<vptr>", 0, sizeof(void*), alignof(void*)});
+    }
+
+    // offsetof is only defined for standard-layout types; a pointer-to-member
+    // applied to raw storage also works with a vptr or private members. No
+    // object is constructed and nothing is read.
+    template <typename M>
+    LayoutBuilder& member(const char* name, M T::*pointer) {
+        alignas(T) static unsigned char storage[sizeof(T)];
+        const T* object = reinterpret_cast<const T*>(storage);
+        std::size_t offset = std::size_t(reinterpret_cast<const unsigned char*>(&(object->*pointer)) - storage);
+        layout_.members.push_back(MemberLayout{name, offset, sizeof(M), alignof(M)});
+        return *this;
+    }
+
+    operator TypeLayout() const {
+        TypeLayout out = layout_;
+        std::stable_sort(out.members.begin(), out.members.end(),
+                         [](const MemberLayout& a, const MemberLayout& b) { return a.offset < b.offset; });
+        return out;
+    }
+
+private:
+    TypeLayout layout_;
+};
+
+// Lines actually touched by n objects at p - the real address decides
+template <typename T>
+std::size_t cache_lines_touched(const T* p, std::size_t n, std::size_t line = kCacheLine) {
+    if (n == 0) return 0;
+    auto first = reinterpret_cast<std::uintptr_t>(p);
+    auto last = first + n * sizeof(T) - 1;
+    return std::size_t(last / line - first / line + 1);
+}
+
+// ============================================================================
+// HEAP AND PAGE PLACEMENT
+// ============================================================================
+
+struct PagePlacement {
+    bool available = false;  // move_pages answered
+    std::string reason;      // why not, if it didn't
+    std::size_t pages = 0;
+    std::size_t not_present = 0;         // never touched (or swapped out): no node yet
+    std::map<int, std::size_t> on_node;  // node -> pages
+};
+
+struct HeapPlacement {
+    const void* object;
+    const void* data;
+    std::ptrdiff_t distance;  // data - object, bytes
+    std::size_t bytes;        // element storage
+    PagePlacement pages;
+};
+
+inline std::size_t page_size() {
+    static const std::size_t size = std::size_t(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+// move_pages(pid 0, count, pages, nodes = NULL, status, 0): with no target
+// nodes nothing moves; status[i] = node of page i, or -errno
+inline PagePlacement page_placement(const void* data, std::size_t bytes) {
+    PagePlacement out;
+    if (!data || bytes == 0) {
+        out.reason = "empty";
+        return out;
+    }
+#ifdef SYS_move_pages
+    const std::size_t page = page_size();
+    auto first = reinterpret_cast<std::uintptr_t>(data) / page * page;
+    auto end = reinterpret_cast<std::uintptr_t>(data) + bytes;
+    out.pages = (end - first + page - 1) / page;
+
+    const std::size_t batch = 1024;
+    std::vector<void*> addresses;
+    std::vector<int> status;
+    for (std::size_t done = 0; done < out.pages; done += batch) {
+        std::size_t count = std::min(batch, out.pages - done);
+        addresses.resize(count);
+        status.assign(count, 0);
+        for (std::size_t i = 0; i < count; ++i) addresses[i] = reinterpret_cast<void*>(first + (done + i) * page);
+        long rc = syscall(SYS_move_pages, 0, static_cast<unsigned long>(count), addresses.data(), nullptr,
+                          status.data(), 0);
+        if (rc < 0) {
+            out.reason = std::string("move_pages: ") + std::strerror(errno);
+            out.not_present = 0;
+            out.on_node.clear();
+            return out;
+        }
+        for (int s : status) {
+            if (s >= 0) ++out.on_node[s];
+            else ++out.not_present;  // -ENOENT: not faulted in; -EFAULT: not mapped
+        }
+    }
+    out.available = true;
+#else
+    out.reason = "move_pages not available on this platform";
+#endif
+    return out;
+}
+
+inline HeapPlacement heap_placement(const void* object, const void* data, std::size_t bytes) {
+    std::ptrdiff_t distance = reinterpret_cast<const char*>(data) - reinterpret_cast<const char*>(object);
+    return HeapPlacement{object, data, distance, bytes, page_placement(data, bytes)};
+}
+
+// Contiguous containers: anything with std::data and std::size
+template <typename Container>
+HeapPlacement heap_placement(const Container& c) {
+    return heap_placement(&c, std::data(c), std::size(c) * sizeof(*std::data(c)));
+}
+
+// ============================================================================
+// REPORTS
+// ============================================================================
+
+inline void print_layout(const TypeLayout& layout, std::ostream& os) {
+    os << "  " << layout.name << "  size " << layout.size << "  align " << layout.align
+       << (layout.has_vptr ? "  has vptr" : "") << (layout.trivially_copyable ? "  trivially copyable" : "")
+       << std::endl;
+    os << "    offset  size  member" << std::endl;
+    std::vector<LayoutHole> holes = layout.holes();
+    std::size_t h = 0;
+    auto print_holes_before = [&](std::size_t offset) {
+        for (; h < holes.size() && holes[h].offset < offset; ++h)
+            os << "    " << std::setw(6) << holes[h].offset << std::setw(6) << holes[h].size << "  (padding)"
+               << std::endl;
+    };
+    for (const MemberLayout& m : layout.members) {
+        print_holes_before(m.offset);
+        os << "    " << std::setw(6) << m.offset << std::setw(6) << m.size << "  " << m.name << std::endl;
+    }
+    print_holes_before(layout.size);
+    os << "    padding: " << layout.padding_bytes() << " bytes in " << holes.size() << " holes";
+    std::size_t packed = layout.packed_size();
+    if (packed < layout.size) os << "  (reordered: " << packed << " bytes)";
+    os << std::endl;
+}
+
+inline void print_array_footprint(const TypeLayout& layout, std::size_t n, std::ostream& os) {
+    ArrayFootprint f = layout.array_footprint(n);
+    os << "    " << layout.name << "[" << n << "]: " << f.bytes << " bytes, " << f.lines_aligned
+       << " cache lines aligned (" << f.lines_worst << " worst start), " << f.straddling
+       << " objects straddle two lines" << std::endl;
+}
+
+inline void print_heap_placement(const HeapPlacement& p, std::ostream& os) {
+    os << "    object " << p.object << "  data " << p.data << "  distance " << p.distance << " bytes"
+       << std::endl;
+    os << "    " << p.bytes << " bytes of elements";
+    if (!p.pages.available) {
+        os << ", pages: unavailable (" << p.pages.reason << ")" << std::endl;
+        return;
+    }
+    os << " on " << p.pages.pages << " pages:";
+    for (const auto& node : p.pages.on_node) os << " node " << node.first << " x" << node.second;
+    if (p.pages.not_present) os << " not present x" << p.pages.not_present;
+    os << std::endl;
+}
+
+// ============================================================================
+// REGISTRATION
+// ============================================================================
+// INSPECT_LAYOUT(Type, m1, m2, ...) - up to 8 members, at namespace scope.
+
+#define LAYOUT_FRIEND \
+    template <typename> \
+    friend struct LayoutOf
+
+#define LAYOUT_CONCAT_INNER(a, b) a##b
+#define LAYOUT_CONCAT(a, b) LAYOUT_CONCAT_INNER(a, b)
+#define LAYOUT_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, n, ...) n
+#define LAYOUT_COUNT(...) LAYOUT_COUNT_(__VA_ARGS__, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+
+#define LAYOUT_MEMBER(T, m) .member(#m, &T::m)
+#define LAYOUT_EACH_1(T, m) LAYOUT_MEMBER(T, m)
+#define LAYOUT_EACH_2(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_1(T, __VA_ARGS__)
+#define LAYOUT_EACH_3(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_2(T, __VA_ARGS__)
+#define LAYOUT_EACH_4(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_3(T, __VA_ARGS__)
+#define LAYOUT_EACH_5(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_4(T, __VA_ARGS__)
+#define LAYOUT_EACH_6(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_5(T, __VA_ARGS__)
+#define LAYOUT_EACH_7(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_6(T, __VA_ARGS__)
+#define LAYOUT_EACH_8(T, m, ...) LAYOUT_MEMBER(T, m) LAYOUT_EACH_7(T, __VA_ARGS__)
+
+#define INSPECT_LAYOUT(Type, ...) \
+    template <> \
+    struct LayoutOf<Type> { \
+        static TypeLayout get() { \
+            return LayoutBuilder<Type>(#Type) LAYOUT_CONCAT(LAYOUT_EACH_, LAYOUT_COUNT(__VA_ARGS__))(Type, __VA_ARGS__); \
+        } \
+    }
+
+#endif  // LAYOUT_INSPECTOR_H
@@ -0,0 +1,266 @@
+// Layout inspector: sizeof, offsets, padding holes and cache lines for the repo's types
+#include <chrono>
+#include <cstdlib>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bench_util.h"
+#include "c_functions.h"  // struct Point, shared with C
+#include "layout_inspector.h"
+
+// ============================================================================
+// WHY LAYOUT IS A PERFORMANCE PROPERTY
+// ============================================================================
+// memory_visualization.cpp: "Compiler knows Vector is always 16 bytes."
+// Knowing it is one thing; noticing when it changes is another. One extra
+// bool in the wrong place:
+//
+//   struct Sample { double value; int id; };          16 bytes, 4 per line
+//   struct Sample { bool valid; double value; int id; } 24 bytes:
+//        [v.......][value...][id..|pad]               2.67 per line, and
+//        2 of every 8 objects straddle two lines
+//
+// No test fails, nothing crashes - the loop over a million of them just
+// touches 50% more cache lines. The report below makes that visible, and the
+// checks at the end pin the layouts down so a regression fails loudly.
+
+// ============================================================================
+// THE TYPES
+// ============================================================================
+// Point is the real one from c_functions.h: c_functions.c, shm_channel and
+// spsc_ring all rely on its layout, so that is the definition to pin. The
+// others live inside their demos' .cpp files (concrete_types.cpp,
+// brace_initialization.cpp, concrete_vs_abstract.cpp,
+// brace_init_compiler.cpp) and are copied here; a change there is not seen.
+
+class Vector {
+    LAYOUT_FRIEND;  // elem and sz are private
+    double* elem;
+    int sz;
+
+public:
+    Vector(int s) : elem{new double[s]}, sz{s} {}
+    ~Vector() { delete[] elem; }
+    Vector(const Vector&) = delete;
+    Vector& operator=(const Vector&) = delete;
+
+    int size() const { return sz; }
+    double* data() const { return elem; }
+    double& operator[](int i) { return elem[i]; }
+};
+
+struct Line {
+    Point start;
+    Point end;
+};
+
+class Shape {
+public:
+    virtual double area() const = 0;
+    virtual ~Shape() {}
+};
+
+class Circle : public Shape {
+    LAYOUT_FRIEND;
+    double radius;
+
+public:
+    Circle(double r) : radius{r} {}
+    double area() const override { return 3.14159 * radius * radius; }
+};
+
+class Rectangle : public Shape {
+    LAYOUT_FRIEND;
+    double width;
+    double height;
+
+public:
+    Rectangle(double w, double h) : width{w}, height{h} {}
+    double area() const override { return width * height; }
+};
+
+class Example {
+public:
+    int a;
+    double b;
+
+    Example(int x, double y) : a{x}, b{y} {}
+    Example(std::initializer_list<int> list) : a{*list.begin()}, b{list.size() > 1 ? *(list.begin() + 1) : 0.0} {}
+};
+
+// The regression from the diagram, and its fix by reordering
+struct Sample {
+    bool valid;
+    double value;
+    int id;
+};
+
+struct SampleReordered {
+    double value;
+    int id;
+    bool valid;
+};
+
+INSPECT_LAYOUT(Vector, elem, sz);
+INSPECT_LAYOUT(Point, x, y);
+INSPECT_LAYOUT(Line, start, end);
+INSPECT_LAYOUT(Circle, radius);
+INSPECT_LAYOUT(Rectangle, width, height);
+INSPECT_LAYOUT(Example, a, b);
+INSPECT_LAYOUT(Sample, valid, value, id);
+INSPECT_LAYOUT(SampleReordered, value, id, valid);
+
+// Compile-time pins for the layouts other code depends on: a change here
+// breaks the build instead of quietly costing cache misses
+static_assert(sizeof(Point) == 8, "Point: 8 per cache line, same layout in C");
+static_assert(sizeof(Line) == 16, "Line: two Points, no padding");
+static_assert(sizeof(SampleReordered) == 16, "SampleReordered: 4 per cache line");
+
+// ============================================================================
+// THE REPORTS
+// ============================================================================
+
+void report_types(std::size_t n) {
+    std::cout << "=== Layout of the Registered Types ===" << std::endl;
+    for (const TypeLayout& layout : {layout_of<Vector>(), layout_of<Point>(), layout_of<Line>(), layout_of<Circle>(),
+                                     layout_of<Rectangle>(), layout_of<Example>(), layout_of<Sample>(),
+                                     layout_of<SampleReordered>()}) {
+        print_layout(layout, std::cout);
+        print_array_footprint(layout, n, std::cout);
+        std::cout << std::endl;
+    }
+}
+
+void check_types(std::size_t n) {
+    std::cout << "=== Checks ===" << std::endl;
+    TypeLayout vector = layout_of<Vector>();
+    check(vector.size == 16 && vector.member("sz")->offset == 8 && vector.holes().size() == 1 &&
+              vector.holes()[0].offset == 12 && vector.holes()[0].size == 4,
+          "Vector: 8-byte pointer + 4-byte int + 4 bytes tail padding = 16");
+    check(!vector.has_vptr && vector.packed_size() == 16, "Vector: no vptr, reordering can't help");
+
+    TypeLayout point = layout_of<Point>(), line = layout_of<Line>();
+    check(point.size == 8 && point.padding_bytes() == 0, "Point: two ints, no padding");
+    check(line.member("end")->offset == 8 && line.padding_bytes() == 0, "Line: end right after start");
+    check(point.array_footprint(n).lines_aligned == (n * 8 + 63) / 64 && point.array_footprint(n).straddling == 0,
+          "Point[n]: 8 per line, none straddles");
+
+    TypeLayout circle = layout_of<Circle>(), rectangle = layout_of<Rectangle>();
+    check(circle.has_vptr && circle.members[0].name == "<vptr>" && circle.member("radius")->offset == 8,
+          "Circle: vptr at 0, radius at 8");
+    check(circle.size == 16 && circle.padding_bytes() == 0, "Circle: the vptr is half the object");
+    check(rectangle.size == 24 && rectangle.member("height")->offset == 16, "Rectangle: vptr + 2 doubles = 24");
+
+    TypeLayout example = layout_of<Example>();
+    check(example.size == 16 && example.holes().size() == 1 && example.holes()[0].offset == 4,
+          "Example: 4-byte hole between int a and double b");
+
+    TypeLayout sample = layout_of<Sample>(), reordered = layout_of<SampleReordered>();
+    check(sample.size == 24 && sample.padding_bytes() == 11 && sample.packed_size() == 16,
+          "Sample: 11 bytes of padding, 16 if reordered");
+    check(reordered.size == 16 && reordered.packed_size() == 16, "SampleReordered: reaches the packed size");
+    // 24-byte Samples repeat their line offsets every 8 elements (0 24 48 8 32
+    // 56 16 40): elements 2 and 5 of each 8 cross a line. Checked at n and at
+    // a length with a remainder of 6, which ends past both of them.
+    ArrayFootprint bad = sample.array_footprint(n);
+    for (std::size_t count : {n, n / 8 * 8 + 14}) {
+        ArrayFootprint b = sample.array_footprint(count), g = reordered.array_footprint(count);
+        std::size_t r = count % 8;
+        std::string at = " (n=" + std::to_string(count) + ")";
+        check(b.lines_aligned == (count * 24 + 63) / 64 && g.lines_aligned == (count * 16 + 63) / 64,
+              "Sample[n] touches 1.5x the lines of SampleReordered[n], rounded up" + at);
+        check(b.straddling == count / 8 * 2 + (r > 2) + (r > 5) && g.straddling == 0,
+              "Sample: 2 of every 8 straddle, reordered none" + at);
+    }
+
+    // The arithmetic agrees with real arrays
+    std::vector<Sample> samples(n);
+    check(cache_lines_touched(samples.data(), n) >= bad.lines_aligned &&
+              cache_lines_touched(samples.data(), n) <= bad.lines_worst,
+          "real Sample array lies between aligned and worst case (" +
+              std::to_string(cache_lines_touched(samples.data(), n)) + " lines)");
+    std::cout << std::endl;
+}
+
+// A scan over every element: the bytes fetched follow sizeof, not the payload
+template <typename T>
+double scan_ms(const std::vector<T>& v, int rounds) {
+    double sum = 0;
+    double ms = time_ms([&] {
+        for (int r = 0; r < rounds; ++r)
+            for (const T& s : v) sum += s.value;
+    });
+    do_not_optimize(sum);
+    return ms / rounds;
+}
+
+void compare_scans(std::size_t n) {
+    std::cout << "=== Scan Cost: Sample vs SampleReordered (" << n << " objects) ===" << std::endl;
+    std::vector<Sample> bad(n, Sample{true, 1.0, 1});
+    std::vector<SampleReordered> good(n, SampleReordered{1.0, 1, true});
+    scan_ms(bad, 1);  // warm up
+    scan_ms(good, 1);
+    double bad_ms = scan_ms(bad, 5), good_ms = scan_ms(good, 5);
+    std::cout << "  Sample          " << bad_ms << " ms  (" << n * sizeof(Sample) / 1024 << " KiB)" << std::endl;
+    std::cout << "  SampleReordered " << good_ms << " ms  (" << n * sizeof(SampleReordered) / 1024 << " KiB)"
+              << std::endl;
+    std::cout << "  (only a difference once the array outgrows the caches)" << std::endl;
+    std::cout << std::endl;
+}
+
+void report_containers() {
+    std::cout << "=== Where the Elements Live ===" << std::endl;
+    const int n = 1 << 20;
+
+    Vector v(n);
+    for (int i = 0; i < v.size(); ++i) v[i] = i;
+    std::cout << "  Vector(" << n << "): object on the stack, elements on the heap" << std::endl;
+    HeapPlacement vp = heap_placement(&v, v.data(), std::size_t(v.size()) * sizeof(double));
+    print_heap_placement(vp, std::cout);
+    long long distance = vp.distance < 0 ? -vp.distance : vp.distance;
+    check(distance > 4096, "elements are far from the 16-byte object (memory_visualization.cpp)");
+
+    std::vector<double> reserved;
+    reserved.reserve(n);
+    std::cout << "  std::vector<double> after reserve(" << n << "): capacity, no pages yet" << std::endl;
+    HeapPlacement untouched = heap_placement(&reserved, reserved.data(), std::size_t(n) * sizeof(double));
+    print_heap_placement(untouched, std::cout);
+
+    reserved.resize(n);  // writes every element: now every page is faulted in
+    std::cout << "  ... after resize(" << n << ")" << std::endl;
+    HeapPlacement touched = heap_placement(reserved);
+    print_heap_placement(touched, std::cout);
+
+    if (!touched.pages.available) {
+        std::cout << "  (move_pages refused here: " << touched.pages.reason << " - page checks skipped)" << std::endl;
+    } else {
+        std::size_t on_nodes = 0;
+        for (const auto& node : touched.pages.on_node) on_nodes += node.second;
+        check(on_nodes == touched.pages.pages && touched.pages.not_present == 0, "every written page has a node");
+        check(untouched.pages.not_present > touched.pages.not_present, "reserve() alone leaves pages not present");
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Memory Layout and Cache-Locality Report ===" << std::endl;
+    std::cout << std::endl;
+    std::size_t n = argc > 1 ? std::size_t(std::atol(argv[1])) : 1000;
+
+    report_types(n);
+    check_types(n);
+    compare_scans(4000000);
+    report_containers();
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• sizeof is set by member order: largest alignment first removes the holes" << std::endl;
+    std::cout << "• A vptr costs 8 bytes per object - half of a Circle" << std::endl;
+    std::cout << "• Objects whose size doesn't divide 64 straddle lines: one access, two misses" << std::endl;
+    std::cout << "• A container object is small and fixed; its elements live elsewhere, page by page" << std::endl;
+    std::cout << "• Pin layouts with static_assert so a regression breaks the build, not the cache" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
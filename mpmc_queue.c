@@ -0,0 +1,108 @@
+// Bounded lock-free MPMC queue on top of the assembly atomics (see mpmc_queue.h)
+#include "mpmc_queue.h"
+#include "asm_atomics.h"
+
+#include <stdlib.h>
+
+#define CACHE_LINE 64
+
+struct Cell {
+    int64_t sequence;
+    int64_t value;
+};
+
+// Each counter gets its own cache line: producers hammer enqueue_pos and
+// consumers dequeue_pos, and they should not invalidate each other's line
+// (false sharing)
+struct MpmcQueue {
+    _Alignas(CACHE_LINE) int64_t enqueue_pos;
+    _Alignas(CACHE_LINE) int64_t dequeue_pos;
+    _Alignas(CACHE_LINE) struct Cell* cells;
+    int64_t mask;
+};
+
+// Largest power of two whose cell array, rounded up to a cache line, still
+// has a size_t byte count. Anything bigger would make the doubling loop
+// below wrap to 0 and spin forever, or the byte count overflow.
+static size_t max_capacity(void) {
+    size_t limit = (SIZE_MAX - CACHE_LINE) / sizeof(struct Cell);
+    size_t cap = 2;
+    while (cap <= limit / 2) cap *= 2;
+    return cap;
+}
+
+MpmcQueue* mpmc_create(size_t capacity) {
+    if (capacity > max_capacity()) return NULL;
+    size_t cap = 2;
+    while (cap < capacity) cap *= 2;
+
+    MpmcQueue* q = aligned_alloc(CACHE_LINE, sizeof(MpmcQueue));
+    if (!q) return NULL;
+    // aligned_alloc wants the size to be a multiple of the alignment
+    size_t bytes = (cap * sizeof(struct Cell) + CACHE_LINE - 1) & ~(size_t)(CACHE_LINE - 1);
+    q->cells = aligned_alloc(CACHE_LINE, bytes);
+    if (!q->cells) {
+        free(q);
+        return NULL;
+    }
+    for (size_t i = 0; i < cap; i++) {
+        q->cells[i].sequence = (int64_t)i;  // cell i is free for ticket i
+        q->cells[i].value = 0;
+    }
+    q->mask = (int64_t)cap - 1;
+    q->enqueue_pos = 0;
+    q->dequeue_pos = 0;
+    return q;
+}
+
+void mpmc_destroy(MpmcQueue* q) {
+    if (!q) return;
+    free(q->cells);
+    free(q);
+}
+
+size_t mpmc_capacity(const MpmcQueue* q) {
+    return (size_t)(q->mask + 1);
+}
+
+int mpmc_try_push(MpmcQueue* q, int64_t value) {
+    int64_t pos = asm_atomic_load(&q->enqueue_pos);
+    struct Cell* cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        int64_t diff = asm_atomic_load(&cell->sequence) - pos;
+        if (diff == 0) {
+            // Our turn: claim ticket pos. On failure the CAS reloads pos.
+            if (asm_atomic_cas(&q->enqueue_pos, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            return 0;  // the consumer of the previous lap hasn't freed it: full
+        } else {
+            pos = asm_atomic_load(&q->enqueue_pos);  // another producer got there first
+        }
+    }
+    // Only we own this cell now. The value is a plain store; the release
+    // store of the sequence publishes it to the consumer.
+    cell->value = value;
+    asm_atomic_store(&cell->sequence, pos + 1);
+    return 1;
+}
+
+int mpmc_try_pop(MpmcQueue* q, int64_t* out) {
+    int64_t pos = asm_atomic_load(&q->dequeue_pos);
+    struct Cell* cell;
+    for (;;) {
+        cell = &q->cells[pos & q->mask];
+        int64_t diff = asm_atomic_load(&cell->sequence) - (pos + 1);
+        if (diff == 0) {
+            if (asm_atomic_cas(&q->dequeue_pos, &pos, pos + 1)) break;
+        } else if (diff < 0) {
+            return 0;  // not written yet: empty
+        } else {
+            pos = asm_atomic_load(&q->dequeue_pos);
+        }
+    }
+    *out = cell->value;
+    // Free the cell for the producer one lap later
+    asm_atomic_store(&cell->sequence, pos + q->mask + 1);
+    return 1;
+}
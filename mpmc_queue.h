@@ -0,0 +1,66 @@
+/* Bounded lock-free multi-producer multi-consumer queue of int64_t values
+ *
+ * Built only on the assembly atomics in asm_atomics.h (Dmitry Vyukov's
+ * bounded MPMC design). Every cell carries a SEQUENCE number that says whose
+ * turn it is:
+ *
+ *   cell[i].sequence == pos       -> empty, the producer holding ticket pos may write
+ *   cell[i].sequence == pos + 1   -> full, the consumer holding ticket pos may read
+ *
+ *   enqueue_pos ──┐              dequeue_pos ──┐
+ *                 ▼                            ▼
+ *   [ seq=8 | seq=9 | seq=3 val | seq=4 val | seq=5 val | ... ]   (capacity 8)
+ *     empty   empty   full        full        full
+ *
+ * A producer claims a ticket with one CAS on enqueue_pos, writes the value,
+ * then publishes it with a release store of the sequence. Producers and
+ * consumers only contend on their own counter, never on a lock.
+ *
+ * Both calls are non-blocking: they return 0 when the queue is full/empty
+ * and the caller decides whether to spin, yield or do something else.
+ */
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MpmcQueue MpmcQueue;  /* opaque */
+
+/* Capacity is rounded up to a power of two (minimum 2). NULL if out of memory
+ * or if the rounded-up cell array's size would not fit in a size_t. */
+MpmcQueue* mpmc_create(size_t capacity);
+void mpmc_destroy(MpmcQueue* q);
+size_t mpmc_capacity(const MpmcQueue* q);
+
+/* 1 if pushed, 0 if the queue was full */
+int mpmc_try_push(MpmcQueue* q, int64_t value);
+
+/* 1 if a value was popped into *out, 0 if the queue was empty */
+int mpmc_try_pop(MpmcQueue* q, int64_t* out);
+
+#ifdef __cplusplus
+}
+
+/* C++ convenience: owns the queue (RAII) */
+class LockFreeQueue {
+private:
+    MpmcQueue* q;
+public:
+    explicit LockFreeQueue(size_t capacity) : q{mpmc_create(capacity)} {}
+    ~LockFreeQueue() { mpmc_destroy(q); }
+    LockFreeQueue(const LockFreeQueue&) = delete;
+    LockFreeQueue& operator=(const LockFreeQueue&) = delete;
+
+    bool valid() const { return q != nullptr; }
+    size_t capacity() const { return mpmc_capacity(q); }
+    bool try_push(int64_t value) { return mpmc_try_push(q, value) != 0; }
+    bool try_pop(int64_t& out) { return mpmc_try_pop(q, &out) != 0; }
+};
+#endif
+
+#endif /* MPMC_QUEUE_H */
@@ -0,0 +1,351 @@
+// Assembly atomics + lock-free MPMC queue: correctness, stress and benchmarks
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "asm_atomics.h"
+#include "bench_util.h"
+#include "mpmc_queue.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+//   Primitives:  asm_atomic_fetch_add  vs  std::atomic<int64_t>::fetch_add
+//   Queues:      LockFreeQueue (C, asm atomics)
+//                AtomicQueue   (same algorithm in C++ with std::atomic)
+//                MutexQueue    (ring buffer + std::mutex)
+//
+// The asm queue and the std::atomic queue should be close: the compiler emits
+// the same lock cmpxchg / casal. The difference is the function call per
+// atomic (asm is opaque, std::atomic is inlined).
+
+// ============================================================================
+// THE SAME QUEUE WITH std::atomic (for comparison)
+// ============================================================================
+
+class AtomicQueue {
+private:
+    struct Cell {
+        std::atomic<std::int64_t> sequence;
+        std::int64_t value;
+    };
+    alignas(64) std::atomic<std::int64_t> enqueue_pos{0};
+    alignas(64) std::atomic<std::int64_t> dequeue_pos{0};
+    alignas(64) std::vector<Cell> cells;
+    std::int64_t mask;
+
+public:
+    explicit AtomicQueue(std::size_t capacity) {
+        std::size_t cap = 2;
+        while (cap < capacity) cap *= 2;
+        cells = std::vector<Cell>(cap);
+        for (std::size_t i = 0; i < cap; ++i) cells[i].sequence.store(std::int64_t(i), std::memory_order_relaxed);
+        mask = std::int64_t(cap) - 1;
+    }
+
+    bool try_push(std::int64_t value) {
+        std::int64_t pos = enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            std::int64_t diff = cell->sequence.load(std::memory_order_acquire) - pos;
+            if (diff == 0) {
+                if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(std::int64_t& out) {
+        std::int64_t pos = dequeue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[pos & mask];
+            std::int64_t diff = cell->sequence.load(std::memory_order_acquire) - (pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        out = cell->value;
+        cell->sequence.store(pos + mask + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+class MutexQueue {
+private:
+    std::mutex m;
+    std::vector<std::int64_t> ring;
+    std::size_t head = 0, count = 0;
+
+public:
+    explicit MutexQueue(std::size_t capacity) : ring(capacity) {}
+
+    bool try_push(std::int64_t value) {
+        std::lock_guard<std::mutex> lock(m);
+        if (count == ring.size()) return false;
+        ring[(head + count) % ring.size()] = value;
+        ++count;
+        return true;
+    }
+
+    bool try_pop(std::int64_t& out) {
+        std::lock_guard<std::mutex> lock(m);
+        if (count == 0) return false;
+        out = ring[head];
+        head = (head + 1) % ring.size();
+        --count;
+        return true;
+    }
+};
+
+// ============================================================================
+// PRIMITIVES: single-threaded semantics
+// ============================================================================
+
+void test_primitives() {
+    std::cout << "=== Primitive semantics ===" << std::endl;
+
+    std::int64_t x = 5;
+    check(asm_atomic_exchange(&x, 9) == 5 && x == 9, "exchange returns old, stores new");
+
+    std::int64_t expected = 9;
+    check(asm_atomic_cas(&x, &expected, 11) == 1 && x == 11, "cas succeeds when *p == expected");
+    expected = 100;
+    check(asm_atomic_cas(&x, &expected, 12) == 0 && x == 11 && expected == 11,
+          "cas fails otherwise and reports the current value");
+
+    check(asm_atomic_fetch_add(&x, 4) == 11 && x == 15, "fetch_add returns old value");
+    check(asm_atomic_fetch_add(&x, -20) == 15 && x == -5, "fetch_add with negative delta");
+
+    asm_atomic_store(&x, 42);
+    check(asm_atomic_load(&x) == 42, "store then load");
+
+    AsmPair pair{1, 2};
+    AsmPair want{1, 2};
+    check(asm_atomic_cas128(&pair, &want, 3, 4) == 1 && pair.lo == 3 && pair.hi == 4, "cas128 succeeds on both words");
+    want = AsmPair{3, 99};  // lo matches, hi doesn't
+    check(asm_atomic_cas128(&pair, &want, 5, 6) == 0 && pair.lo == 3 && pair.hi == 4 && want.hi == 4,
+          "cas128 fails if either word differs");
+}
+
+// ============================================================================
+// PRIMITIVES: many threads on one location
+// ============================================================================
+
+void stress_primitives(int threads, int iterations) {
+    std::cout << std::endl << "=== Primitive stress (" << threads << " threads x "
+              << iterations << ") ===" << std::endl;
+
+    auto run = [&](auto body) {
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t) pool.emplace_back(body);
+        for (auto& th : pool) th.join();
+    };
+
+    std::int64_t counter = 0;
+    run([&] {
+        for (int i = 0; i < iterations; ++i) asm_atomic_fetch_add(&counter, 1);
+    });
+    check(counter == std::int64_t(threads) * iterations, "fetch_add: no lost increments");
+
+    std::int64_t cas_counter = 0;
+    run([&] {
+        for (int i = 0; i < iterations; ++i) {
+            std::int64_t seen = asm_atomic_load(&cas_counter);
+            while (!asm_atomic_cas(&cas_counter, &seen, seen + 1)) {
+            }
+        }
+    });
+    check(cas_counter == std::int64_t(threads) * iterations, "cas loop: no lost increments");
+
+    // exchange as a spin lock protecting a NON-atomic counter
+    std::int64_t lock = 0;
+    std::int64_t plain = 0;
+    run([&] {
+        for (int i = 0; i < iterations; ++i) {
+            while (asm_atomic_exchange(&lock, 1) != 0) std::this_thread::yield();
+            ++plain;
+            asm_atomic_store(&lock, 0);
+        }
+    });
+    check(plain == std::int64_t(threads) * iterations, "exchange spin lock: mutual exclusion");
+
+    // Double-width CAS: the pair {n, 3n} must never be seen torn
+    AsmPair pair{0, 0};
+    std::atomic<bool> torn{false};
+    run([&] {
+        for (int i = 0; i < iterations; ++i) {
+            AsmPair seen{0, 0};
+            while (!asm_atomic_cas128(&pair, &seen, seen.lo + 1, seen.hi + 3)) {
+                if (seen.hi != 3 * seen.lo) torn = true;
+            }
+        }
+    });
+    check(!torn && pair.lo == std::uint64_t(threads) * iterations && pair.hi == 3 * pair.lo,
+          "cas128: both words always move together");
+}
+
+// ============================================================================
+// QUEUE STRESS + THROUGHPUT
+// ============================================================================
+// Each producer pushes (producer_id << 40) | seq for seq = 0, 1, 2, ...
+// Each consumer checks that, per producer, the seqs it sees only increase
+// (FIFO), and the total count and checksum must match at the end.
+
+struct QueueResult {
+    double ms;
+    bool ok;
+};
+
+template <typename Queue>
+QueueResult run_queue(Queue& q, int producers, int consumers, std::int64_t per_producer) {
+    const std::int64_t total = per_producer * producers;
+    std::atomic<std::int64_t> consumed{0};
+    std::atomic<std::int64_t> checksum{0};
+    std::atomic<bool> order_ok{true};
+
+    double ms = time_ms([&] {
+        std::vector<std::thread> pool;
+        for (int p = 0; p < producers; ++p) {
+            pool.emplace_back([&, p] {
+                for (std::int64_t s = 0; s < per_producer; ++s) {
+                    std::int64_t v = (std::int64_t(p) << 40) | s;
+                    while (!q.try_push(v)) std::this_thread::yield();
+                }
+            });
+        }
+        for (int c = 0; c < consumers; ++c) {
+            pool.emplace_back([&] {
+                std::vector<std::int64_t> last(producers, -1);
+                std::int64_t local_sum = 0;
+                std::int64_t v;
+                while (consumed.load(std::memory_order_relaxed) < total) {
+                    if (!q.try_pop(v)) {
+                        std::this_thread::yield();
+                        continue;
+                    }
+                    int p = int(v >> 40);
+                    std::int64_t s = v & ((std::int64_t(1) << 40) - 1);
+                    if (p >= producers || s <= last[p]) order_ok = false;
+                    else last[p] = s;
+                    local_sum += v;
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                }
+                checksum.fetch_add(local_sum);
+            });
+        }
+        for (auto& th : pool) th.join();
+    });
+
+    std::int64_t expected = 0;
+    for (int p = 0; p < producers; ++p) {
+        expected += (std::int64_t(p) << 40) * per_producer + per_producer * (per_producer - 1) / 2;
+    }
+    return {ms, order_ok && consumed == total && checksum == expected};
+}
+
+void bench_queues(std::int64_t items) {
+    // Capacities whose rounded-up cell array can't be sized fail cleanly
+    // instead of looping forever in the rounding
+    std::cout << std::endl << "=== Queue capacity limits ===" << std::endl;
+    check(!LockFreeQueue(SIZE_MAX).valid(), "capacity SIZE_MAX: NULL");
+    check(!LockFreeQueue((SIZE_MAX >> 1) + 2).valid(), "capacity 2^63 + 1 (rounds past size_t): NULL");
+    {
+        LockFreeQueue small(3);
+        check(small.valid() && small.capacity() == 4, "capacity 3 rounds up to 4");
+    }
+
+    std::cout << std::endl << "=== Queue stress + throughput (" << items << " items, capacity 1024) ===" << std::endl;
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << std::endl;
+
+    const int configs[][2] = {{1, 1}, {2, 2}, {4, 4}, {1, 4}, {4, 1}};
+    for (const auto& cfg : configs) {
+        int producers = cfg[0], consumers = cfg[1];
+        std::int64_t per = items / producers;
+        std::cout << std::endl << producers << " producer(s), " << consumers << " consumer(s):" << std::endl;
+
+        auto report = [&](const char* name, QueueResult r) {
+            std::string padded = name;
+            padded.resize(26, ' ');
+            std::cout << "  " << padded << r.ms << " ms  (" << double(per * producers) / (r.ms * 1e3)
+                      << " M items/s)  " << (r.ok ? "verified" : "CORRUPTED") << std::endl;
+            if (!r.ok) ++failures;
+        };
+
+        LockFreeQueue asm_q(1024);
+        report("LockFreeQueue (asm)", run_queue(asm_q, producers, consumers, per));
+        AtomicQueue atomic_q(1024);
+        report("AtomicQueue (std::atomic)", run_queue(atomic_q, producers, consumers, per));
+        MutexQueue mutex_q(1024);
+        report("MutexQueue", run_queue(mutex_q, producers, consumers, per));
+    }
+}
+
+void bench_fetch_add(int iterations) {
+    std::cout << std::endl << "=== fetch_add throughput ===" << std::endl;
+
+    for (int threads : {1, 4}) {
+        std::int64_t asm_counter = 0;
+        std::atomic<std::int64_t> std_counter{0};
+
+        auto run = [&](auto body) {
+            return time_ms([&] {
+                std::vector<std::thread> pool;
+                for (int t = 0; t < threads; ++t) pool.emplace_back(body);
+                for (auto& th : pool) th.join();
+            });
+        };
+        double asm_ms = run([&] {
+            for (int i = 0; i < iterations; ++i) asm_atomic_fetch_add(&asm_counter, 1);
+        });
+        double std_ms = run([&] {
+            for (int i = 0; i < iterations; ++i) std_counter.fetch_add(1);
+        });
+
+        double ops = double(iterations) * threads;
+        std::cout << "  " << threads << " thread(s), same counter:" << std::endl;
+        std::cout << "    asm_atomic_fetch_add:  " << asm_ms * 1e6 / ops << " ns/op" << std::endl;
+        std::cout << "    std::atomic fetch_add: " << std_ms * 1e6 / ops << " ns/op" << std::endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Assembly Atomics and a Lock-Free MPMC Queue ===" << std::endl;
+    std::cout << std::endl;
+
+    std::int64_t items = argc > 1 ? std::atoll(argv[1]) : 1000000;
+
+    test_primitives();
+    stress_primitives(4, 200000);
+    bench_fetch_add(5000000);
+    bench_queues(items);
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• lock cmpxchg / casal make read-modify-write indivisible" << std::endl;
+    std::cout << "• ARM64 LSE does it in one instruction; LL/SC needs a retry loop" << std::endl;
+    std::cout << "• 128-bit CAS updates two words at once (pointer + ABA tag)" << std::endl;
+    std::cout << "• Per-cell sequence numbers let producers and consumers never share a lock" << std::endl;
+    std::cout << "• asm calls can't be inlined: std::atomic emits the same instruction inline" << std::endl;
+    std::cout << "• Contention, not the instruction, dominates: one hot cache line serializes everyone" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -62,7 +62,7 @@ public:
 //   (Z = C++ mangled, 3 = length of name, foo = name, i = int parameter)
 //
 // Operator function:
-//   Demo::operator+(int x) -> mangled name: _ZN4DemopiEi
+//   Demo::operator+(int x) -> mangled name: _ZN4DemoplEi
 //   (N...E = nested name, Demo = class, pl = "plus" operator, i = int)
 //
 // Each operator has a special encoding:
@@ -82,7 +82,7 @@ public:
 //     OperatorKind op_kind;     // PLUS
 //     Type return_type;         // int
 //     vector<Type> param_types; // [int]
-//     string mangled_name;      // "_ZN4DemopiEi"
+//     string mangled_name;      // "_ZN4DemoplEi"
 // };
 
 // Overload Resolution:
@@ -0,0 +1,298 @@
+// output_sink.h - buffered, allocation-free text output for hot paths
+//
+// Every demo in this repo prints with std::cout << ... << std::endl, and
+// std::endl FLUSHES: one write() system call per line. OutputSink collects
+// text in one big user-space buffer and calls write() only when the flush
+// policy says so:
+//
+//   FlushPolicy::WhenFull   when the buffer fills, on flush() and on destruction
+//   FlushPolicy::EveryLine  after any output that contains '\n' (what std::endl
+//                           does - useful for an interactive terminal)
+//   FlushPolicy::Immediate  after every operator<< (debugging a crash)
+//
+// The buffer is allocated once in the constructor; after that no operation
+// allocates. Numbers are formatted straight into the buffer with
+// std::to_chars (no locale, no virtual calls, no temporary strings) and
+// produce the SAME text as std::cout: integers in decimal, doubles like
+// "%g" with precision 6 (set_precision() changes it; kShortest gives the
+// shortest text that reads back to the same double), pointers like
+// show_memory() prints them: 0x7ffd5e8c3a40, null as 0.
+//
+// Compile-time-checked format strings (C++17):
+//
+//   out.print(SINK_FMT("elem[{}] at {}\n"), i, &elem[i]);
+//
+// The number of {} placeholders must equal the number of arguments, and
+// braces must balance ({{ and }} print literal braces). A mismatch is a
+// static_assert error, not a garbled line at runtime.
+//
+// Not thread-safe: give each thread its own sink (or see the async logger).
+// Don't mix with std::cout/printf on the same fd without flushing in between.
+
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <cerrno>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include <unistd.h>
+
+enum class FlushPolicy { WhenFull, EveryLine, Immediate };
+
+// ----------------------------------------------------------------------------
+// Format string checking
+// ----------------------------------------------------------------------------
+
+// Number of {} placeholders, or -1 if a brace is unmatched or a placeholder
+// holds anything but nothing ("{x}" is rejected)
+constexpr int count_placeholders(std::string_view fmt) {
+    int holes = 0;
+    for (std::size_t i = 0; i < fmt.size(); ++i) {
+        if (fmt[i] == '{') {
+            if (i + 1 < fmt.size() && fmt[i + 1] == '{') {
+                ++i;
+            } else if (i + 1 < fmt.size() && fmt[i + 1] == '}') {
+                ++holes;
+                ++i;
+            } else {
+                return -1;
+            }
+        } else if (fmt[i] == '}') {
+            if (i + 1 < fmt.size() && fmt[i + 1] == '}') ++i;
+            else return -1;
+        }
+    }
+    return holes;
+}
+
+template <std::size_t N>
+struct Placeholders {
+    std::size_t pos[N + 1];  // offset of each {} (one spare: arrays can't be empty)
+};
+
+template <std::size_t N>
+constexpr Placeholders<N> find_placeholders(std::string_view fmt) {
+    Placeholders<N> result{};
+    std::size_t k = 0;
+    for (std::size_t i = 0; i + 1 < fmt.size() && k < N; ++i) {
+        if (fmt[i] == '{' && fmt[i + 1] == '}') result.pos[k++] = i;
+        if (fmt[i] == fmt[i + 1] && (fmt[i] == '{' || fmt[i] == '}')) ++i;  // skip {{ and }}
+    }
+    return result;
+}
+
+// Wraps a string literal in a unique type, so that print() can inspect the
+// text at compile time (C++17 has no string literal template parameters)
+#define SINK_FMT(literal)                                                        \
+    ([] {                                                                        \
+        struct SinkFormat {                                                      \
+            static constexpr std::string_view text() { return literal; }         \
+        };                                                                       \
+        return SinkFormat{};                                                     \
+    }())
+
+class OutputSink {
+public:
+    static constexpr std::size_t kDefaultCapacity = 64 * 1024;
+    static constexpr int kShortest = -1;  // set_precision(kShortest): round-trip doubles
+
+    explicit OutputSink(int fd = STDOUT_FILENO, FlushPolicy policy = FlushPolicy::WhenFull,
+                        std::size_t capacity = kDefaultCapacity)
+        : buf_(new char[capacity < 64 ? 64 : capacity]),
+          cap_(capacity < 64 ? 64 : capacity),
+          fd_(fd),
+          policy_(policy) {}
+
+    ~OutputSink() { flush(); }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    // ----- Raw output -----
+
+    void write(const char* data, std::size_t n) {
+        if (n > cap_ - len_) {
+            flush();
+            if (n >= cap_) {  // bigger than the whole buffer: don't copy it in pieces
+                write_fd(data, n);
+                return;
+            }
+        }
+        std::memcpy(buf_.get() + len_, data, n);
+        len_ += n;
+        if (policy_ == FlushPolicy::EveryLine && std::memchr(data, '\n', n)) flush();
+    }
+
+    void put(char c) {
+        if (len_ == cap_) flush();
+        buf_[len_++] = c;
+        if (policy_ == FlushPolicy::EveryLine && c == '\n') flush();
+    }
+
+    // Hand the buffered bytes to the kernel. false if any write() failed.
+    bool flush() {
+        if (len_ > 0) {
+            write_fd(buf_.get(), len_);
+            len_ = 0;
+        }
+        return !failed_;
+    }
+
+    // ----- Formatting -----
+
+    OutputSink& operator<<(std::string_view s) {
+        write(s.data(), s.size());
+        return after_insert();
+    }
+    OutputSink& operator<<(const char* s) { return *this << std::string_view(s); }
+    OutputSink& operator<<(const std::string& s) { return *this << std::string_view(s); }
+    OutputSink& operator<<(char c) {
+        put(c);
+        return after_insert();
+    }
+    OutputSink& operator<<(signed char c) { return *this << char(c); }  // characters, as with std::cout
+    OutputSink& operator<<(unsigned char c) { return *this << char(c); }
+    OutputSink& operator<<(bool b) { return *this << (b ? '1' : '0'); }  // like std::cout without boolalpha
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+                                                      !std::is_same_v<T, char> && !std::is_same_v<T, signed char> &&
+                                                      !std::is_same_v<T, unsigned char>>>
+    OutputSink& operator<<(T value) {
+        char* p = reserve(24);  // 20 digits + sign fit
+        p = std::to_chars(p, p + 24, value).ptr;
+        len_ = std::size_t(p - buf_.get());
+        return after_insert();
+    }
+
+    OutputSink& operator<<(double value) {
+        char* p = reserve(64);  // enough for 40 significant digits and an exponent
+        auto r = precision_ == kShortest ? std::to_chars(p, p + 64, value)
+                                         : std::to_chars(p, p + 64, value, std::chars_format::general, precision_);
+        len_ = std::size_t(r.ptr - buf_.get());
+        return after_insert();
+    }
+    OutputSink& operator<<(float value) { return *this << double(value); }
+
+    // Same text as std::cout << (void*)p: 0x + lowercase hex, null prints 0
+    OutputSink& operator<<(const void* ptr) {
+        auto bits = reinterpret_cast<std::uintptr_t>(ptr);
+        if (bits == 0) return *this << '0';
+        char* p = reserve(2 + 2 * sizeof(bits));
+        p[0] = '0';
+        p[1] = 'x';
+        p = std::to_chars(p + 2, p + 2 + 2 * sizeof(bits), bits, 16).ptr;
+        len_ = std::size_t(p - buf_.get());
+        return after_insert();
+    }
+    OutputSink& operator<<(std::nullptr_t) { return *this << static_cast<const void*>(nullptr); }
+
+    // Any other object pointer prints as an address (char* is text, as with std::cout)
+    template <typename T, typename = std::enable_if_t<!std::is_same_v<std::remove_cv_t<T>, char>>>
+    OutputSink& operator<<(T* ptr) {
+        return *this << static_cast<const void*>(ptr);
+    }
+
+    // Manipulators: out << endl, out << flush
+    OutputSink& operator<<(OutputSink& (*manip)(OutputSink&)) { return manip(*this); }
+
+    // print(SINK_FMT("x = {}, y = {}\n"), x, y): the placeholder count is
+    // checked against the arguments at compile time
+    template <typename Format, typename... Args>
+    OutputSink& print(Format, const Args&... args) {
+        constexpr std::string_view text = Format::text();
+        constexpr int holes = count_placeholders(text);
+        static_assert(holes >= 0, "format string: unmatched '{' or '}'");
+        static_assert(holes == int(sizeof...(Args)), "format string: number of {} != number of arguments");
+
+        FlushPolicy saved = policy_;
+        if (policy_ == FlushPolicy::Immediate) policy_ = FlushPolicy::WhenFull;  // one flush per print
+        // Where the {} are is known at compile time: at runtime only the
+        // literal pieces are copied and the arguments formatted
+        constexpr auto at = find_placeholders<sizeof...(Args)>(text);
+        constexpr bool escapes = text.find("{{") != text.npos || text.find("}}") != text.npos;
+        std::size_t from = 0, k = 0;
+        ((print_literal(text, from, at.pos[k], escapes), *this << args, from = at.pos[k++] + 2), ...);
+        print_literal(text, from, text.size(), escapes);
+        static_cast<void>(at);  // unused when there are no arguments
+        policy_ = saved;
+        return after_insert();
+    }
+
+    // ----- Settings and statistics -----
+
+    void set_policy(FlushPolicy policy) { policy_ = policy; }
+    FlushPolicy policy() const { return policy_; }
+    void set_precision(int digits) { precision_ = digits < 0 ? kShortest : digits > 40 ? 40 : digits; }
+    std::size_t buffered() const { return len_; }
+    std::size_t capacity() const { return cap_; }
+    std::size_t syscalls() const { return syscalls_; }  // write() calls so far
+    bool ok() const { return !failed_; }
+
+private:
+    std::unique_ptr<char[]> buf_;
+    std::size_t cap_;
+    std::size_t len_ = 0;
+    int fd_;
+    FlushPolicy policy_;
+    int precision_ = 6;  // std::cout's default
+    std::size_t syscalls_ = 0;
+    bool failed_ = false;
+
+    // At least n free bytes at the end of the buffer (n <= 64 <= capacity)
+    char* reserve(std::size_t n) {
+        if (cap_ - len_ < n) flush();
+        return buf_.get() + len_;
+    }
+
+    OutputSink& after_insert() {
+        if (policy_ == FlushPolicy::Immediate) flush();
+        return *this;
+    }
+
+    void write_fd(const char* p, std::size_t n) {
+        while (n > 0 && !failed_) {
+            ssize_t w = ::write(fd_, p, n);
+            ++syscalls_;
+            if (w < 0) {
+                if (errno == EINTR) continue;
+                failed_ = true;  // like a stream's badbit: later output is dropped
+                return;
+            }
+            p += w;
+            n -= std::size_t(w);
+        }
+    }
+
+    // Literal text in [from, to); with `escapes`, {{ and }} become one brace
+    void print_literal(std::string_view text, std::size_t from, std::size_t to, bool escapes) {
+        if (!escapes) {
+            write(text.data() + from, to - from);
+            return;
+        }
+        for (std::size_t i = from; i < to; ++i) {
+            if (text[i] == '{' || text[i] == '}') {
+                write(text.data() + from, i + 1 - from);
+                from = i + 2;
+                ++i;
+            }
+        }
+        if (from < to) write(text.data() + from, to - from);
+    }
+};
+
+// Newline. Unlike std::endl it does NOT force a flush: the policy decides.
+inline OutputSink& endl(OutputSink& out) { return out << '\n'; }
+
+inline OutputSink& flush(OutputSink& out) {
+    out.flush();
+    return out;
+}
+
+#endif  // OUTPUT_SINK_H
@@ -0,0 +1,280 @@
+// OutputSink vs std::cout/std::endl vs printf
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "output_sink.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+// The same line, printed N times to stdout:
+//
+//   "  elem[17] at 0x55d0c8e2b2c4  value 4.25\n"
+//
+//   cout + endl        what every demo in this repo does: endl flushes, so
+//                      each line is its own write() system call
+//   cout + '\n'        same formatting, but stdio buffers the lines
+//   printf             C stdio: format string parsed at runtime, buffered
+//   sink EveryLine     OutputSink, one write() per line (same syscalls as endl)
+//   sink WhenFull <<   OutputSink, one write() per 64 KiB
+//   sink print(fmt)    OutputSink with a compile-time-checked format string
+//
+// stdout is redirected (dup2) to /dev/null, then to a real file, so that the
+// terminal's own speed doesn't hide the difference.
+
+// Run `body` with an OutputSink writing into a temporary file, return the
+// text it wrote (a pipe would block once the writer gets 64 KiB ahead)
+template <typename Body>
+std::string capture(FlushPolicy policy, Body&& body, std::size_t* syscalls = nullptr) {
+    std::FILE* tmp = std::tmpfile();
+    if (!tmp) return "<tmpfile failed>";
+    int fd = fileno(tmp);
+    {
+        OutputSink out(fd, policy);
+        body(out);
+        out.flush();
+        if (syscalls) *syscalls = out.syscalls();
+    }
+    std::string text;
+    char buf[4096];
+    ssize_t n;
+    lseek(fd, 0, SEEK_SET);
+    while ((n = read(fd, buf, sizeof(buf))) > 0) text.append(buf, std::size_t(n));
+    std::fclose(tmp);
+    return text;
+}
+
+// ============================================================================
+// CORRECTNESS: same text as std::cout
+// ============================================================================
+
+// Writes the same values to any stream-like target
+template <typename Out>
+void write_values(Out& out, const int* stack_ptr, const double* heap_ptr) {
+    out << "ints: " << 0 << ' ' << -1 << ' ' << LLONG_MIN << ' ' << ULLONG_MAX << ' ' << short(-7) << '\n';
+    out << "doubles: " << 0.1 + 0.2 << ' ' << 1e300 << ' ' << -0.0 << ' ' << 123456789.0 << ' ' << 5e-324 << ' '
+        << 3.0 << ' ' << std::numeric_limits<double>::infinity() << ' ' << 2.5f << '\n';
+    out << "pointers: " << stack_ptr << ' ' << heap_ptr << ' ' << static_cast<void*>(nullptr) << '\n';
+    out << "other: " << true << false << 'x' << std::string(" string") << '\n';
+}
+
+void test_correctness() {
+    std::cout << "=== Correctness: identical text to std::cout ===" << std::endl;
+    int on_stack = 42;
+    std::vector<double> on_heap(3);
+
+    std::ostringstream expected;
+    write_values(expected, &on_stack, on_heap.data());
+    std::string got = capture(FlushPolicy::WhenFull,
+                              [&](OutputSink& out) { write_values(out, &on_stack, on_heap.data()); });
+    check(got == expected.str(), "ints, doubles (%g, precision 6), pointers, bool, char, strings");
+    if (got != expected.str()) std::cout << "  expected:\n" << expected.str() << "  got:\n" << got;
+
+    std::ostringstream expected_prec;
+    expected_prec.precision(12);
+    expected_prec << 3.14159265358979 << ' ' << 1.0 / 3;
+    got = capture(FlushPolicy::WhenFull, [](OutputSink& out) {
+        out.set_precision(12);
+        out << 3.14159265358979 << ' ' << 1.0 / 3;
+    });
+    check(got == expected_prec.str(), "set_precision(12) matches std::cout.precision(12)");
+
+    got = capture(FlushPolicy::WhenFull, [](OutputSink& out) {
+        out.set_precision(OutputSink::kShortest);
+        out << 0.1 + 0.2;
+    });
+    check(got == "0.30000000000000004", "kShortest: the shortest text that reads back exactly (" + got + ")");
+
+    got = capture(FlushPolicy::WhenFull, [&](OutputSink& out) {
+        out.print(SINK_FMT("elem[{}] at {} = {} {{literal}}\n"), 2, &on_heap[2], 0.5);
+    });
+    std::ostringstream expected_fmt;
+    expected_fmt << "elem[" << 2 << "] at " << &on_heap[2] << " = " << 0.5 << " {literal}\n";
+    check(got == expected_fmt.str(), "print(SINK_FMT(...)) == the same << chain, {{ }} escapes");
+
+    // Uncomment either line for a compile error instead of a garbled log line:
+    //   OutputSink out; out.print(SINK_FMT("{} and {}\n"), 1);
+    //   OutputSink out; out.print(SINK_FMT("unclosed {\n"));
+    static_assert(count_placeholders("{} and {}") == 2, "");
+    static_assert(count_placeholders("{{}}") == 0, "");
+    static_assert(count_placeholders("oops {") == -1 && count_placeholders("{x}") == -1, "");
+
+    std::size_t every_line = 0, when_full = 0;
+    auto ten_lines = [](OutputSink& out) {
+        for (int i = 0; i < 10; ++i) out << "line " << i << endl;
+    };
+    capture(FlushPolicy::EveryLine, ten_lines, &every_line);
+    capture(FlushPolicy::WhenFull, ten_lines, &when_full);
+    check(every_line == 10 && when_full == 1, "10 lines: EveryLine -> " + std::to_string(every_line) +
+                                                  " write() calls, WhenFull -> " + std::to_string(when_full));
+
+    std::string big(200000, 'z');  // larger than the buffer: written directly, in one call
+    std::size_t calls = 0;
+    got = capture(FlushPolicy::WhenFull, [&](OutputSink& out) { out << "head " << big << " tail"; }, &calls);
+    check(got == "head " + big + " tail" && calls == 3, "200 KB string bypasses the 64 KiB buffer");
+    std::cout << std::endl;
+}
+
+// ============================================================================
+// show_memory() from memory_visualization.cpp, through the sink
+// ============================================================================
+
+class Vector {
+    double* elem;
+    int sz;
+
+public:
+    explicit Vector(int s) : elem(new double[s]), sz(s) {}
+    ~Vector() { delete[] elem; }
+
+    void show_memory(OutputSink& out) const {
+        out << "Vector object itself:" << endl;
+        out << "  Address of Vector object: " << this << endl;
+        out.print(SINK_FMT("  Size of Vector object:    {} bytes\n"), sizeof(*this));
+        out.print(SINK_FMT("  Value of elem (pointer):  {} <- points to heap\n"), elem);
+        for (int i = 0; i < 3 && i < sz; ++i) out.print(SINK_FMT("  elem[{}] at: {}\n"), i, &elem[i]);
+        out << flush;  // one write() for the whole block
+    }
+};
+
+// ============================================================================
+// THROUGHPUT
+// ============================================================================
+
+struct Result {
+    std::string name;
+    double ns_per_line;
+    long syscalls;  // -1: not counted (iostream/stdio)
+};
+
+std::vector<Result> run_all(long lines, const std::vector<double>& heap) {
+    std::vector<Result> results;
+    auto line_ptr = [&](long i) { return &heap[std::size_t(i) % heap.size()]; };
+
+    double ms = time_ms([&] {
+        for (long i = 0; i < lines; ++i)
+            std::cout << "  elem[" << i << "] at " << line_ptr(i) << "  value " << i * 0.25 << std::endl;
+    });
+    results.push_back({"cout + endl", ms * 1e6 / lines, lines});
+
+    ms = time_ms([&] {
+        for (long i = 0; i < lines; ++i)
+            std::cout << "  elem[" << i << "] at " << line_ptr(i) << "  value " << i * 0.25 << '\n';
+        std::cout.flush();
+    });
+    results.push_back({"cout + '\\n'", ms * 1e6 / lines, -1});
+
+    ms = time_ms([&] {
+        for (long i = 0; i < lines; ++i)
+            std::printf("  elem[%ld] at %p  value %g\n", i, static_cast<const void*>(line_ptr(i)), i * 0.25);
+        std::fflush(stdout);
+    });
+    results.push_back({"printf", ms * 1e6 / lines, -1});
+
+    for (FlushPolicy policy : {FlushPolicy::EveryLine, FlushPolicy::WhenFull}) {
+        OutputSink out(STDOUT_FILENO, policy);
+        ms = time_ms([&] {
+            for (long i = 0; i < lines; ++i)
+                out << "  elem[" << i << "] at " << line_ptr(i) << "  value " << i * 0.25 << endl;
+            out.flush();
+        });
+        results.push_back({policy == FlushPolicy::EveryLine ? "sink EveryLine" : "sink WhenFull <<",
+                           ms * 1e6 / lines, long(out.syscalls())});
+    }
+
+    OutputSink out(STDOUT_FILENO, FlushPolicy::WhenFull);
+    ms = time_ms([&] {
+        for (long i = 0; i < lines; ++i) out.print(SINK_FMT("  elem[{}] at {}  value {}\n"), i, line_ptr(i), i * 0.25);
+        out.flush();
+    });
+    results.push_back({"sink print(fmt)", ms * 1e6 / lines, long(out.syscalls())});
+    return results;
+}
+
+// Point fd 1 at `path` while the benchmark runs; the results print afterwards
+std::vector<Result> bench_into(const char* path, long lines, const std::vector<double>& heap) {
+    std::cout.flush();
+    std::fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0 || saved < 0) {
+        std::perror(path);
+        return {};
+    }
+    dup2(fd, STDOUT_FILENO);
+    close(fd);
+
+    std::vector<Result> results = run_all(lines, heap);
+
+    std::cout.flush();
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    return results;
+}
+
+void print_results(const char* target, const std::vector<Result>& results) {
+    OutputSink out;
+    out << "--- " << target << " ---" << endl;
+    char line[128];
+    for (const Result& r : results) {
+        std::snprintf(line, sizeof(line), "  %-18s %8.1f ns/line   ", r.name.c_str(), r.ns_per_line);
+        out << line;
+        if (r.syscalls >= 0) out << r.syscalls << " write() calls";
+        else out << "(stdio buffer)";
+        out << endl;
+    }
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Buffered Output Sink vs iostream vs printf ===" << std::endl;
+    std::cout << std::endl;
+
+    test_correctness();
+
+    std::cout << "=== show_memory() through OutputSink ===" << std::endl;
+    std::cout.flush();  // the sink below writes to the same fd
+    {
+        OutputSink out;
+        Vector v(5);
+        v.show_memory(out);
+        out << endl << "(" << out.syscalls() << " write() call for the block above)" << endl;
+    }
+    std::cout << std::endl;
+
+    long lines = argc > 1 ? std::atol(argv[1]) : 500000;
+    std::vector<double> heap(1024);
+    std::cout << "=== Throughput: " << lines << " lines ===" << std::endl;
+    std::cout.flush();
+    auto null_results = bench_into("/dev/null", lines, heap);
+    auto file_results = bench_into("/tmp/output_sink_bench.txt", lines, heap);
+    print_results("stdout -> /dev/null (formatting + syscall cost)", null_results);
+    print_results("stdout -> /tmp/output_sink_bench.txt (real file)", file_results);
+    unlink("/tmp/output_sink_bench.txt");
+
+    {
+        OutputSink out;
+        out << endl << "=== Key Insights ===" << endl;
+        out << "• std::endl = '\\n' + flush: one system call per line" << endl;
+        out << "• One 64 KiB buffer turns a million write() calls into a few hundred" << endl;
+        out << "• std::to_chars: no locale, no virtual calls, no temporary strings" << endl;
+        out << "• Same text as std::cout, so a demo can switch without changing output" << endl;
+        out << "• SINK_FMT checks the {} count at compile time; printf checks nothing" << endl;
+        out << "• Buffering means a crash can lose the tail: flush at the points that matter" << endl;
+        out << endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << endl;
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,334 @@
+// perf_scope.h - hardware performance counters for a code region, via perf_event_open
+//
+// "Cache-friendly: CPU prefetches next elements" (concrete_vs_abstract.cpp)
+// is a claim about cache misses; time alone can't confirm it. The kernel
+// exposes the CPU's counters through perf_event_open(2):
+//
+//   PerfCounters counters;                  // opens the events once (syscalls)
+//   PerfReading r;
+//   {
+//       PerfScope scope(counters, r);       // snapshot
+//       sum_points(points);
+//   }                                       // snapshot again: r = difference
+//   r.get(PerfEvent::L1dMisses) / n         // misses per element
+//
+//   { PerfScope scope("sum points"); ... }  // one line to std::cout at scope exit
+//
+// Counters stay enabled from construction; a scope costs two read()s (one
+// per group below), so scopes nest and can be reused any number of times.
+//
+//   hardware group (one read, scheduled together so ratios are consistent):
+//     cycles, instructions, L1d read misses, LLC misses, branch misses, dTLB read misses
+//   software group:
+//     task-clock (ns on CPU), page faults, context switches
+//
+// Counts only the calling thread. Hardware events count user space only
+// (what kernel.perf_event_paranoid = 2 allows without privileges).
+//
+// GRACEFUL DEGRADATION: every event that can't be opened - no PMU in a VM,
+// paranoid level, seccomp in a container, PERF_SCOPE=off in the environment -
+// is simply marked invalid, with the reason in unavailable_reason(). The
+// region still runs and everything else still reports; code never needs an
+// #ifdef.
+//
+// MULTIPLEXING is per group, never per member: a group goes onto the PMU
+// whole or not at all. When groups compete for the counters (ours, another
+// perf session, the NMI watchdog), the kernel rotates whole groups; values
+// are scaled by enabled/running time and the reading is flagged
+// `multiplexed`. A group that needs more counters than the PMU has can't be
+// rotated in: the member that doesn't fit fails to open with EINVAL, or the
+// group opens but is never scheduled (running == 0) and reads nothing. Both
+// end up in unavailable_reason(); pass fewer events to fit the PMU.
+
+#ifndef PERF_SCOPE_H
+#define PERF_SCOPE_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iostream>
+#include <string>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    L1dMisses,
+    LlcMisses,
+    BranchMisses,
+    DtlbMisses,
+    TaskClock,  // nanoseconds the thread was on a CPU
+    PageFaults,
+    ContextSwitches,
+};
+
+constexpr int kPerfEventCount = 9;
+
+inline const char* perf_event_name(PerfEvent e) {
+    static const char* const names[kPerfEventCount] = {
+        "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses",
+        "dTLB-misses", "task-clock-ns", "page-faults", "ctx-switches"};
+    return names[int(e)];
+}
+
+inline bool perf_event_is_hardware(PerfEvent e) { return int(e) <= int(PerfEvent::DtlbMisses); }
+
+struct PerfReading {
+    double value[kPerfEventCount] = {};
+    bool valid[kPerfEventCount] = {};
+    bool multiplexed = false;  // some values are scaled estimates
+
+    bool has(PerfEvent e) const { return valid[int(e)]; }
+    double get(PerfEvent e) const { return valid[int(e)] ? value[int(e)] : 0.0; }
+    bool any_hardware() const {
+        for (int i = 0; i < kPerfEventCount; ++i) {
+            if (valid[i] && perf_event_is_hardware(PerfEvent(i))) return true;
+        }
+        return false;
+    }
+    // Instructions per cycle, 0 if either counter is missing
+    double ipc() const {
+        return has(PerfEvent::Cycles) && has(PerfEvent::Instructions) && get(PerfEvent::Cycles) > 0
+                   ? get(PerfEvent::Instructions) / get(PerfEvent::Cycles)
+                   : 0.0;
+    }
+    // Every value divided by n (per element, per iteration)
+    PerfReading per(double n) const {
+        PerfReading r = *this;
+        for (double& v : r.value) v /= n;
+        return r;
+    }
+};
+
+// Raw counter values at one moment (see PerfCounters::snapshot)
+struct PerfSnapshot {
+    std::uint64_t raw[kPerfEventCount] = {};
+    std::uint64_t enabled[2] = {};  // per group: time enabled / running, for multiplexing
+    std::uint64_t running[2] = {};
+};
+
+class PerfCounters {
+public:
+    // All events by default; pass a shorter list to leave PMU counters free
+    PerfCounters(std::initializer_list<PerfEvent> events = {PerfEvent::Cycles, PerfEvent::Instructions,
+                                                            PerfEvent::L1dMisses, PerfEvent::LlcMisses,
+                                                            PerfEvent::BranchMisses, PerfEvent::DtlbMisses,
+                                                            PerfEvent::TaskClock, PerfEvent::PageFaults,
+                                                            PerfEvent::ContextSwitches}) {
+        const char* env = std::getenv("PERF_SCOPE");
+        if (env && std::strcmp(env, "off") == 0) {
+            reason_ = "disabled by PERF_SCOPE=off";
+            return;
+        }
+        for (PerfEvent e : events) open_event(e);
+    }
+
+    ~PerfCounters() {
+        for (int fd : fd_) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(PerfEvent e) const { return fd_[int(e)] >= 0; }
+    bool any_hardware() const { return leader_[0] >= 0; }
+
+    // Why the first unavailable event couldn't be opened, or why an open
+    // group read nothing ("" if all opened and counted)
+    const std::string& unavailable_reason() const { return reason_; }
+
+    // Current values: one read() per open group, nothing if none opened
+    PerfSnapshot snapshot() const {
+        PerfSnapshot s;
+        for (int g = 0; g < 2; ++g) {
+            if (leader_[g] < 0) continue;
+            // PERF_FORMAT_GROUP layout: nr, time_enabled, time_running, value[nr]
+            std::uint64_t buf[3 + kPerfEventCount];
+            if (read(leader_[g], buf, sizeof(buf)) <= 0) continue;
+            s.enabled[g] = buf[1];
+            s.running[g] = buf[2];
+            for (std::uint64_t i = 0; i < buf[0] && i < std::uint64_t(members_[g]); ++i) {
+                s.raw[int(order_[g][i])] = buf[3 + i];
+            }
+        }
+        return s;
+    }
+
+    // Counts since `start`, scaled if the kernel multiplexed a group
+    PerfReading since(const PerfSnapshot& start) const {
+        PerfSnapshot now = snapshot();
+        PerfReading r;
+        for (int g = 0; g < 2; ++g) {
+            if (leader_[g] < 0) continue;
+            std::uint64_t enabled = now.enabled[g] - start.enabled[g];
+            std::uint64_t running = now.running[g] - start.running[g];
+            if (running == 0) {  // the group never got onto the PMU: no data
+                if (enabled > 0 && reason_.empty()) {
+                    reason_ = std::string(g == 0 ? "hardware" : "software") +
+                              " group never scheduled (running == 0): more events than free PMU counters";
+                }
+                continue;
+            }
+            double scale = enabled > running ? double(enabled) / double(running) : 1.0;
+            if (scale > 1.0) r.multiplexed = true;
+            for (int i = 0; i < members_[g]; ++i) {
+                int e = int(order_[g][i]);
+                r.value[e] = double(now.raw[e] - start.raw[e]) * scale;
+                r.valid[e] = true;
+            }
+        }
+        return r;
+    }
+
+private:
+    int fd_[kPerfEventCount] = {-1, -1, -1, -1, -1, -1, -1, -1, -1};
+    int leader_[2] = {-1, -1};  // 0: hardware group, 1: software group
+    PerfEvent order_[2][kPerfEventCount] = {};
+    int members_[2] = {0, 0};
+    mutable std::string reason_;  // since() records a group that never ran
+
+    static void config_for(PerfEvent e, perf_event_attr& attr) {
+        auto cache = [](std::uint64_t which, std::uint64_t op, std::uint64_t result) {
+            return which | (op << 8) | (result << 16);
+        };
+        switch (e) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::L1dMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::LlcMisses:
+            attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE, attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        case PerfEvent::DtlbMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::TaskClock:
+            attr.type = PERF_TYPE_SOFTWARE, attr.config = PERF_COUNT_SW_TASK_CLOCK;
+            break;
+        case PerfEvent::PageFaults:
+            attr.type = PERF_TYPE_SOFTWARE, attr.config = PERF_COUNT_SW_PAGE_FAULTS;
+            break;
+        case PerfEvent::ContextSwitches:
+            attr.type = PERF_TYPE_SOFTWARE, attr.config = PERF_COUNT_SW_CONTEXT_SWITCHES;
+            break;
+        }
+    }
+
+    void open_event(PerfEvent e) {
+        if (fd_[int(e)] >= 0) return;  // listed twice
+        int g = perf_event_is_hardware(e) ? 0 : 1;
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        config_for(e, attr);
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Software events happen IN the kernel (a context switch has no user
+        // part): count them there if allowed, hardware events in user space only
+        attr.exclude_kernel = g == 0 ? 1 : 0;
+        attr.exclude_hv = 1;
+        // pid 0, cpu -1: this thread, on whatever CPU it runs
+        int fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader_[g], PERF_FLAG_FD_CLOEXEC));
+        if (fd < 0 && (errno == EACCES || errno == EPERM) && !attr.exclude_kernel) {
+            attr.exclude_kernel = 1;
+            fd = int(syscall(SYS_perf_event_open, &attr, 0, -1, leader_[g], PERF_FLAG_FD_CLOEXEC));
+        }
+        if (fd < 0) {
+            if (reason_.empty()) reason_ = std::string(perf_event_name(e)) + ": " + explain(errno);
+            return;
+        }
+        fd_[int(e)] = fd;
+        if (leader_[g] < 0) leader_[g] = fd;
+        order_[g][members_[g]++] = e;
+    }
+
+    static std::string explain(int err) {
+        std::string what = std::strerror(err);
+        switch (err) {
+        case ENOENT:
+        case EOPNOTSUPP:
+            return what + " (no PMU for this event: virtual machine or unsupported CPU)";
+        case EACCES:
+        case EPERM:
+            return what + " (see /proc/sys/kernel/perf_event_paranoid)";
+        case EINVAL:
+            return what + " (usually: the group needs more counters than the PMU has - pass fewer events)";
+        case ENOSYS:
+            return what + " (perf_event_open blocked: seccomp or container policy)";
+        default:
+            return what;
+        }
+    }
+};
+
+// Prints "name value" pairs for the valid counters, and derived ratios
+inline void print_reading(std::ostream& os, const PerfReading& r) {
+    bool any = false;
+    for (int i = 0; i < kPerfEventCount; ++i) {
+        if (!r.valid[i]) continue;
+        os << (any ? "  " : "") << perf_event_name(PerfEvent(i)) << " " << r.value[i];
+        any = true;
+    }
+    if (r.ipc() > 0) os << "  IPC " << r.ipc();
+    if (r.multiplexed) os << "  (multiplexed: scaled)";
+    if (!any) os << "no counters available";
+}
+
+// RAII region: snapshot on entry, difference on exit
+class PerfScope {
+public:
+    // Store the result in `out` when the scope ends
+    PerfScope(const PerfCounters& counters, PerfReading& out)
+        : counters_(counters), out_(&out), start_(counters.snapshot()) {}
+
+    // Print "[perf] label: ..." to `os` when the scope ends, using one set of
+    // counters per thread (opened on first use)
+    explicit PerfScope(const char* label, std::ostream& os = std::cout)
+        : counters_(thread_counters()), label_(label), os_(&os), start_(counters_.snapshot()) {}
+
+    ~PerfScope() {
+        PerfReading r = counters_.since(start_);
+        if (out_) *out_ = r;
+        if (os_) {
+            *os_ << "[perf] " << label_ << ": ";
+            print_reading(*os_, r);
+            if (!r.any_hardware() && !counters_.unavailable_reason().empty()) {
+                *os_ << "  [" << counters_.unavailable_reason() << "]";
+            }
+            *os_ << std::endl;
+        }
+    }
+
+    PerfScope(const PerfScope&) = delete;
+    PerfScope& operator=(const PerfScope&) = delete;
+
+    static const PerfCounters& thread_counters() {
+        thread_local PerfCounters counters;
+        return counters;
+    }
+
+private:
+    const PerfCounters& counters_;
+    PerfReading* out_ = nullptr;
+    const char* label_ = nullptr;
+    std::ostream* os_ = nullptr;
+    PerfSnapshot start_;
+};
+
+#endif  // PERF_SCOPE_H
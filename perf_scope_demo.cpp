@@ -0,0 +1,198 @@
+// PerfScope: hardware/software counters for a code region, with graceful degradation
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+#include "perf_scope.h"
+
+// ============================================================================
+// THE CLAIM UNDER TEST
+// ============================================================================
+// concrete_vs_abstract.cpp: "Cache-friendly: CPU can prefetch next elements"
+//
+//   contiguous:  [p0][p1][p2][p3][p4][p5][p6][p7] | [p8] ...   8 Points per 64-byte line:
+//                  one miss, then 7 hits - and the prefetcher hides most misses
+//   scattered:   node -> node -> node ...   each hop lands on a random line:
+//                  ~1 miss per element, nothing to prefetch (address unknown
+//                  until the previous load finishes)
+//
+// Time says "scattered is slower". L1d/LLC misses per element say WHY.
+
+struct Point {
+    int x;
+    int y;
+};
+
+struct Node {  // one Point per node, padded to a cache line like a heap object with a header
+    Node* next;
+    Point p;
+    char pad[48];
+};
+
+void availability(const PerfCounters& counters) {
+    std::cout << "=== Which counters does this machine give us? ===" << std::endl;
+    for (int i = 0; i < kPerfEventCount; ++i) {
+        PerfEvent e = PerfEvent(i);
+        std::cout << "  " << perf_event_name(e) << std::string(16 - std::string(perf_event_name(e)).size(), ' ')
+                  << (counters.available(e) ? "yes" : "no") << std::endl;
+    }
+    if (!counters.unavailable_reason().empty()) {
+        std::cout << "  first failure: " << counters.unavailable_reason() << std::endl;
+    }
+}
+
+void prefetch_claim(const PerfCounters& counters, std::size_t n) {
+    std::cout << std::endl << "=== Contiguous vs scattered: " << n << " Points ===" << std::endl;
+    std::vector<Point> points(n);
+    for (std::size_t i = 0; i < n; ++i) points[i] = Point{int(i), int(i * 3)};
+
+    std::vector<Node> pool(n);
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(42));
+    for (std::size_t i = 0; i < n; ++i) {
+        pool[order[i]].p = points[i];
+        pool[order[i]].next = i + 1 < n ? &pool[order[i + 1]] : nullptr;
+    }
+
+    PerfReading contiguous, scattered;
+    long long sum_a = 0, sum_b = 0;
+    double ms_a = time_ms([&] {
+        PerfScope scope(counters, contiguous);
+        for (const Point& p : points) sum_a += p.x + p.y;
+        do_not_optimize(sum_a);
+    });
+    double ms_b = time_ms([&] {
+        PerfScope scope(counters, scattered);
+        for (const Node* node = &pool[order[0]]; node; node = node->next) sum_b += node->p.x + node->p.y;
+        do_not_optimize(sum_b);
+    });
+    check(sum_a == sum_b, "both traversals see the same Points");
+
+    PerfReading a = contiguous.per(double(n)), b = scattered.per(double(n));
+    std::cout << "  contiguous: " << ms_a * 1e6 / double(n) << " ns/elem   ";
+    print_reading(std::cout, a);
+    std::cout << std::endl << "  scattered:  " << ms_b * 1e6 / double(n) << " ns/elem   ";
+    print_reading(std::cout, b);
+    std::cout << std::endl;
+
+    if (a.has(PerfEvent::L1dMisses) && b.has(PerfEvent::L1dMisses)) {
+        check(a.get(PerfEvent::L1dMisses) < 0.25, "contiguous: under 1/4 L1d miss per element");
+        check(b.get(PerfEvent::L1dMisses) > 0.5, "scattered: most elements miss L1d");
+    } else {
+        std::cout << "  (no cache counters here: the claim stays unverified on this machine," << std::endl;
+        std::cout << "   but nothing breaks - timing still runs)" << std::endl;
+        if (!counters.unavailable_reason().empty()) {
+            std::cout << "  reason: " << counters.unavailable_reason() << std::endl;
+        }
+    }
+}
+
+void software_counters(const PerfCounters& counters) {
+    std::cout << std::endl << "=== Software counters ===" << std::endl;
+
+    const std::size_t bytes = 64 << 20;
+    const long page = sysconf(_SC_PAGESIZE);
+    PerfReading faults;
+    {
+        PerfScope scope(counters, faults);
+        char* buf = new char[bytes];  // big enough for mmap: no pages yet
+        for (std::size_t i = 0; i < bytes; i += std::size_t(page)) buf[i] = 1;  // first touch -> fault
+        do_not_optimize(buf);
+        delete[] buf;
+    }
+    std::size_t pages = bytes / std::size_t(page);
+    std::cout << "  touch " << pages << " fresh pages: ";
+    print_reading(std::cout, faults);
+    std::cout << std::endl;
+    if (faults.has(PerfEvent::PageFaults)) {
+        check(faults.get(PerfEvent::PageFaults) >= 0.5 * double(pages) &&
+                  faults.get(PerfEvent::PageFaults) <= 1.1 * double(pages),
+              "about one page fault per 4 KiB page (fewer with transparent huge pages)");
+    }
+
+    PerfReading sleeping;
+    {
+        PerfScope scope(counters, sleeping);
+        for (int i = 0; i < 5; ++i) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    std::cout << "  5 x sleep 10 ms: ";
+    print_reading(std::cout, sleeping);
+    std::cout << std::endl;
+    if (sleeping.has(PerfEvent::ContextSwitches)) {
+        check(sleeping.get(PerfEvent::ContextSwitches) >= 5, "every sleep is a context switch");
+    }
+    if (sleeping.has(PerfEvent::TaskClock)) {
+        check(sleeping.get(PerfEvent::TaskClock) < 5e6, "task-clock: sleeping threads use almost no CPU time");
+    }
+}
+
+void degradation() {
+    std::cout << std::endl << "=== Graceful degradation (PERF_SCOPE=off) ===" << std::endl;
+    setenv("PERF_SCOPE", "off", 1);
+    PerfCounters off;
+    unsetenv("PERF_SCOPE");
+    PerfReading r;
+    long long sum = 0;
+    {
+        PerfScope scope(off, r);
+        for (int i = 0; i < 1000; ++i) sum += i;
+        do_not_optimize(sum);
+    }
+    bool none = true;
+    for (bool v : r.valid) none &= !v;
+    check(none && sum == 499500, "no counters, the region still runs, every value marked invalid");
+    check(off.unavailable_reason() == "disabled by PERF_SCOPE=off", "the reason is reported");
+    std::cout << "  reading: ";
+    print_reading(std::cout, r);
+    std::cout << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== PerfScope: Hardware Performance Counters ===" << std::endl;
+    std::cout << std::endl;
+    std::size_t n = argc > 1 ? std::size_t(std::atol(argv[1])) : 4000000;
+
+    PerfCounters counters;
+    availability(counters);
+    prefetch_claim(counters, n);
+    software_counters(counters);
+    degradation();
+
+    std::cout << std::endl << "=== Labelled scope (thread's own counters, prints on exit) ===" << std::endl;
+    {
+        PerfScope scope("sort 1M ints");
+        std::vector<int> v(1000000);
+        std::mt19937 rng(7);
+        for (int& x : v) x = int(rng());
+        std::sort(v.begin(), v.end());
+        do_not_optimize(v.data());
+    }
+
+    const int rounds = 100000;
+    PerfReading sink;
+    double ms = time_ms([&] {
+        for (int i = 0; i < rounds; ++i) PerfScope scope(counters, sink);
+    });
+    std::cout << std::endl << "Cost of an empty PerfScope: " << ms * 1e6 / rounds << " ns (one read() per open group)"
+              << std::endl;
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• Open the counters once; a scope is two snapshots and a subtraction" << std::endl;
+    std::cout << "• Misses per element turn \"cache-friendly\" from prose into a number" << std::endl;
+    std::cout << "• Every event may be missing (VM, paranoid level, seccomp): check has()," << std::endl;
+    std::cout << "  never assume 0 means \"no misses\"" << std::endl;
+    std::cout << "• Grouped events are scheduled together: ratios like IPC stay consistent;" << std::endl;
+    std::cout << "  whole groups are multiplexed and scaled, and one too big never runs" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,324 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "bench_util.h"
+
+// ============================================================================
+// FINDING ALL INTERSECTING PAIRS OF LINE SEGMENTS
+// ============================================================================
+//
+// The aggregates from brace_initialization.cpp:
+//   struct Point { int x; int y; };
+//   struct Line  { Point start; Point end; };
+//
+// DOUBLE LOOP: test every pair -> n*(n-1)/2 tests.
+//   100,000 lines = 5 BILLION tests, even if only a handful intersect.
+//
+// SORT AND SWEEP: sort segments by their left end, then move a vertical
+// "sweep line" from left to right. Only segments the sweep line currently
+// crosses (the ACTIVE set) can intersect the next one:
+//
+//        sweep line ──▶ │
+//     ───────           │
+//          ─────────────┼────          <- active (crosses the sweep line)
+//                 ──────┼─────         <- active
+//        ────           │              <- already finished: never tested again
+//                       │   ───────    <- not reached yet
+//
+// Cost: O(n log n) for the sort + one test per pair whose x-ranges overlap.
+
+struct Point {
+    int x;
+    int y;
+};
+
+struct Line {
+    Point start;
+    Point end;
+};
+
+// ============================================================================
+// EXACT PREDICATES
+// ============================================================================
+//
+// Point holds ints, so we never need floating point:
+//   orientation(a, b, c) = (b - a) x (c - a)   (cross product)
+//     > 0  -> c is left of a->b
+//     < 0  -> c is right of a->b
+//     = 0  -> collinear
+//
+// Differences of two ints need 33 bits; their product needs 66 bits -> more
+// than int64_t. __int128 (GCC/Clang) holds it exactly: no rounding, no epsilon.
+
+using wide = __int128;
+
+inline int orientation(const Point& a, const Point& b, const Point& c) {
+    wide cross = wide(std::int64_t(b.x) - a.x) * (std::int64_t(c.y) - a.y) -
+                 wide(std::int64_t(b.y) - a.y) * (std::int64_t(c.x) - a.x);
+    return (cross > 0) - (cross < 0);
+}
+
+// c is collinear with a-b: is it inside their bounding box?
+inline bool on_segment(const Point& a, const Point& b, const Point& c) {
+    return std::min(a.x, b.x) <= c.x && c.x <= std::max(a.x, b.x) &&
+           std::min(a.y, b.y) <= c.y && c.y <= std::max(a.y, b.y);
+}
+
+// Closed segments: touching endpoints and collinear overlaps count
+inline bool segments_intersect(const Line& s, const Line& t) {
+    int o1 = orientation(s.start, s.end, t.start);
+    int o2 = orientation(s.start, s.end, t.end);
+    int o3 = orientation(t.start, t.end, s.start);
+    int o4 = orientation(t.start, t.end, s.end);
+
+    if (o1 != o2 && o3 != o4) return true;  // proper crossing (or one touch)
+
+    if (o1 == 0 && on_segment(s.start, s.end, t.start)) return true;
+    if (o2 == 0 && on_segment(s.start, s.end, t.end)) return true;
+    if (o3 == 0 && on_segment(t.start, t.end, s.start)) return true;
+    if (o4 == 0 && on_segment(t.start, t.end, s.end)) return true;
+    return false;
+}
+
+using Pair = std::pair<std::uint32_t, std::uint32_t>;  // (i, j) with i < j
+
+// ============================================================================
+// BASELINE: O(n^2) double loop
+// ============================================================================
+
+std::vector<Pair> brute_force(const std::vector<Line>& lines) {
+    std::vector<Pair> out;
+    for (std::uint32_t i = 0; i < lines.size(); ++i) {
+        for (std::uint32_t j = i + 1; j < lines.size(); ++j) {
+            if (segments_intersect(lines[i], lines[j])) out.push_back({i, j});
+        }
+    }
+    return out;
+}
+
+// ============================================================================
+// SORT AND SWEEP
+// ============================================================================
+//
+// Each segment becomes a compact record: x-interval, y-interval, id.
+// Checking the y-interval first rejects most candidates before the exact
+// (and more expensive) orientation test.
+
+struct Extent {
+    int min_x, max_x;
+    int min_y, max_y;
+    std::uint32_t id;
+};
+
+inline Extent extent_of(const Line& l, std::uint32_t id) {
+    return {std::min(l.start.x, l.end.x), std::max(l.start.x, l.end.x),
+            std::min(l.start.y, l.end.y), std::max(l.start.y, l.end.y), id};
+}
+
+// Sweep over `sorted` (by min_x). `accept(a, b)` decides whether this sweep
+// should report a pair - the partitioned mode uses it to avoid duplicates.
+template <typename Accept>
+void sweep(const std::vector<Line>& lines, const std::vector<Extent>& sorted,
+           std::vector<Pair>& out, Accept&& accept) {
+    std::vector<Extent> active;
+    for (const Extent& e : sorted) {
+        // Drop segments that end before this one starts (swap-remove: order doesn't matter)
+        for (std::size_t k = 0; k < active.size();) {
+            if (active[k].max_x < e.min_x) {
+                active[k] = active.back();
+                active.pop_back();
+            } else {
+                ++k;
+            }
+        }
+        for (const Extent& a : active) {
+            if (a.max_y < e.min_y || e.max_y < a.min_y) continue;  // y-ranges don't overlap
+            if (!accept(a, e)) continue;
+            if (segments_intersect(lines[a.id], lines[e.id])) {
+                out.push_back(a.id < e.id ? Pair{a.id, e.id} : Pair{e.id, a.id});
+            }
+        }
+        active.push_back(e);
+    }
+}
+
+std::vector<Pair> sort_and_sweep(const std::vector<Line>& lines) {
+    std::vector<Extent> sorted(lines.size());
+    for (std::uint32_t i = 0; i < lines.size(); ++i) sorted[i] = extent_of(lines[i], i);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Extent& a, const Extent& b) { return a.min_x < b.min_x; });
+
+    std::vector<Pair> out;
+    sweep(lines, sorted, out, [](const Extent&, const Extent&) { return true; });
+    return out;
+}
+
+// ============================================================================
+// PARALLEL PARTITIONED SWEEP
+// ============================================================================
+//
+// Cut the x-axis into vertical slabs with about the same number of segments.
+// A segment is copied into every slab its x-range touches.
+//
+//     slab 0     │  slab 1     │  slab 2
+//   ───────      │             │
+//          ──────┼──────       │          <- lives in slabs 0 and 1
+//                │      ───────┼───       <- lives in slabs 1 and 2
+//
+// A pair whose x-overlap spans two slabs would be found twice. Rule: report
+// it only in the slab containing the LEFT edge of the x-overlap,
+// max(a.min_x, b.min_x). Every pair has exactly one such slab.
+
+std::vector<Pair> sort_and_sweep_parallel(const std::vector<Line>& lines, unsigned thread_count) {
+    if (thread_count <= 1 || lines.size() < 1024) return sort_and_sweep(lines);
+
+    std::vector<Extent> sorted(lines.size());
+    for (std::uint32_t i = 0; i < lines.size(); ++i) sorted[i] = extent_of(lines[i], i);
+    std::sort(sorted.begin(), sorted.end(),
+              [](const Extent& a, const Extent& b) { return a.min_x < b.min_x; });
+
+    // Slab boundaries at equal-count quantiles of min_x: slab s covers [lo[s], lo[s+1])
+    std::vector<std::int64_t> lo(thread_count + 1);
+    lo[0] = INT64_MIN;
+    for (unsigned s = 1; s < thread_count; ++s) lo[s] = sorted[sorted.size() * s / thread_count].min_x;
+    lo[thread_count] = INT64_MAX;
+
+    std::vector<std::vector<Pair>> partial(thread_count);
+    std::vector<std::thread> pool;
+    for (unsigned s = 0; s < thread_count; ++s) {
+        pool.emplace_back([&, s] {
+            // Segments overlapping [lo[s], lo[s+1]); `sorted` order is kept
+            std::vector<Extent> mine;
+            for (const Extent& e : sorted) {
+                if (e.min_x >= lo[s + 1]) break;
+                if (e.max_x >= lo[s]) mine.push_back(e);
+            }
+            sweep(lines, mine, partial[s], [&](const Extent& a, const Extent& b) {
+                std::int64_t left = std::max(a.min_x, b.min_x);
+                return left >= lo[s] && left < lo[s + 1];
+            });
+        });
+    }
+    for (auto& th : pool) th.join();
+
+    std::vector<Pair> out;
+    for (auto& p : partial) out.insert(out.end(), p.begin(), p.end());
+    return out;
+}
+
+// ============================================================================
+// INPUTS
+// ============================================================================
+
+// Typical map data: many short segments spread over a large area
+std::vector<Line> random_short(std::size_t n, Lcg& rng) {
+    const int world = 1 << 20;
+    std::vector<Line> v(n);
+    for (Line& l : v) {
+        int x = rng.range(0, world), y = rng.range(0, world);
+        l = {{x, y}, {x + rng.range(-3000, 3000), y + rng.range(-3000, 3000)}};
+    }
+    return v;
+}
+
+// Adversarial for an x-sweep: every segment spans the whole x-range, so all
+// of them are active at once. Stacked, they never intersect - lots of work,
+// no output.
+std::vector<Line> long_parallel(std::size_t n) {
+    std::vector<Line> v(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        int y = static_cast<int>(i) * 10;
+        v[i] = {{0, y}, {1000000, y + 5}};
+    }
+    return v;
+}
+
+// Adversarial for output size: a lattice of horizontal and vertical lines,
+// every horizontal crosses every vertical -> (n/2)^2 intersections
+std::vector<Line> lattice(std::size_t n) {
+    std::vector<Line> v;
+    std::size_t half = n / 2;
+    int span = static_cast<int>(half) * 10 + 10;
+    for (std::size_t i = 0; i < half; ++i) v.push_back({{0, int(i) * 10 + 5}, {span, int(i) * 10 + 5}});
+    for (std::size_t i = 0; i < n - half; ++i) v.push_back({{int(i) * 10 + 5, 0}, {int(i) * 10 + 5, span}});
+    return v;
+}
+
+// Degenerate cases the exact predicates must get right
+void show_exact_cases() {
+    std::cout << "=== Exact Integer Predicates ===" << std::endl << std::endl;
+    struct Case { const char* name; Line a; Line b; bool expected; };
+    const Case cases[] = {
+        {"proper crossing        ", {{0, 0}, {10, 10}}, {{0, 10}, {10, 0}}, true},
+        {"touching at endpoint   ", {{0, 0}, {5, 5}}, {{5, 5}, {10, 0}}, true},
+        {"T-junction             ", {{0, 0}, {10, 0}}, {{5, 0}, {5, 10}}, true},
+        {"collinear overlap      ", {{0, 0}, {10, 0}}, {{5, 0}, {15, 0}}, true},
+        {"collinear, disjoint    ", {{0, 0}, {4, 0}}, {{5, 0}, {15, 0}}, false},
+        {"parallel               ", {{0, 0}, {10, 0}}, {{0, 1}, {10, 1}}, false},
+        // Same slope, one unit apart; the cross products (~1.6e19) overflow int64
+        {"huge coords, near miss ", {{-2000000000, -2000000000}, {2000000000, 2000000001}},
+                                   {{-2000000000, -1999999999}, {2000000000, 2000000002}}, false},
+    };
+    for (const Case& c : cases) {
+        bool got = segments_intersect(c.a, c.b);
+        check(got == c.expected, std::string(c.name) + " -> " + (got ? "intersect" : "no intersection"));
+        // symmetric: the sweep may test the pair in either order
+        check(segments_intersect(c.b, c.a) == got, std::string(c.name) + " -> same with the segments swapped");
+    }
+    std::cout << std::endl;
+}
+
+std::vector<Pair> sorted_pairs(std::vector<Pair> v) {
+    std::sort(v.begin(), v.end());
+    return v;
+}
+
+void run(const char* name, const std::vector<Line>& lines, bool run_brute) {
+    unsigned hw = std::thread::hardware_concurrency();
+    unsigned threads = hw > 1 ? hw : 4;  // still exercise the partitioning on 1 core
+
+    std::vector<Pair> a, b, c;
+    double brute_ms = run_brute ? time_ms([&] { a = brute_force(lines); }) : 0.0;
+    double sweep_ms = time_ms([&] { b = sort_and_sweep(lines); });
+    double par_ms = time_ms([&] { c = sort_and_sweep_parallel(lines, threads); });
+
+    std::cout << name << " (" << lines.size() << " segments, " << b.size() << " intersecting pairs):" << std::endl;
+    if (run_brute) std::cout << "  double loop:          " << brute_ms << " ms" << std::endl;
+    std::cout << "  sort and sweep:       " << sweep_ms << " ms" << std::endl;
+    std::cout << "  partitioned, " << threads << " slabs: " << par_ms << " ms" << std::endl;
+    std::vector<Pair> swept = sorted_pairs(b);
+    if (run_brute) check(sorted_pairs(a) == swept, "sort and sweep finds exactly the double loop's pairs");
+    check(sorted_pairs(c) == swept, "partitioned sweep finds exactly the serial sweep's pairs");
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Sweep-Line Batch Intersection for Line Segments ===" << std::endl << std::endl;
+
+    show_exact_cases();
+
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    Lcg rng{2026};
+
+    std::cout << "=== Benchmark ===" << std::endl << std::endl;
+    run("Random short segments (small, with double loop)", random_short(5000, rng), true);
+    run("Random short segments", random_short(n, rng), false);
+    run("Adversarial: long stacked segments", long_parallel(5000), true);
+    run("Adversarial: lattice", lattice(2000), true);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Integer coordinates -> exact predicates with 128-bit cross products" << std::endl;
+    std::cout << "• Sweep only tests pairs whose x-ranges overlap (y-ranges checked first)" << std::endl;
+    std::cout << "• Slab partitioning parallelizes; each pair is reported by exactly one slab" << std::endl;
+    std::cout << "• Worst cases remain: all segments active at once, or n^2 real intersections" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,349 @@
+// Shared-memory SPSC channel over memfd / shm_open with futex wakeups (see shm_channel.h)
+#define _GNU_SOURCE
+#include "shm_channel.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "c_functions.h"  // struct Point
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__)
+#define CPU_RELAX() __asm__ __volatile__("yield")
+#else
+#define CPU_RELAX() ((void)0)
+#endif
+
+#define CACHE_LINE 64
+#define SHM_MAGIC 0x53484d43u  // "SHMC"
+#define SHM_VERSION 1u
+
+// ============================================================================
+// Shared layout - identical in every process that maps it
+// ============================================================================
+//
+//   [ header: 3 cache lines ][ slot 0 ][ slot 1 ] ... [ slot N-1 ]
+//   slot = { kind, count, payload[slot_bytes] } rounded up to a cache line
+//
+// head and tail are 32-bit because futex words are 32-bit. They count
+// batches forever and wrap around; head - tail is still the number of full
+// slots because slot_count is a power of two.
+
+struct ShmHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slot_count;
+    uint32_t slot_bytes;
+    size_t slot_stride;
+
+    _Alignas(CACHE_LINE) _Atomic uint32_t head;   // written by the producer only
+    _Atomic uint32_t consumer_waiting;            // consumer is (about to be) asleep on head
+
+    _Alignas(CACHE_LINE) _Atomic uint32_t tail;   // written by the consumer only
+    _Atomic uint32_t producer_waiting;            // producer is (about to be) asleep on tail
+};
+
+struct SlotHeader {
+    uint32_t kind;
+    uint32_t count;
+};
+
+// Per-process handle: the mapping plus private copies of the geometry. The
+// header is writable by the other process; the copies are checked once, on
+// create or attach, and every slot address is computed from them, so a peer
+// that rewrites the header later can't move our reads or writes out of the
+// mapping.
+struct ShmChannel {
+    int fd;
+    size_t map_size;
+    struct ShmHeader* hdr;
+    unsigned char* slots;
+    uint32_t slot_count;
+    uint32_t slot_bytes;
+    size_t slot_stride;
+    int spin_limit;
+};
+
+static size_t round_up(size_t v, size_t to) {
+    return (v + to - 1) / to * to;
+}
+
+static size_t header_bytes(void) {
+    return round_up(sizeof(struct ShmHeader), CACHE_LINE);
+}
+
+static struct SlotHeader* slot_at(const ShmChannel* ch, uint32_t pos) {
+    size_t index = pos & (ch->slot_count - 1);
+    return (struct SlotHeader*)(ch->slots + index * ch->slot_stride);
+}
+
+// ============================================================================
+// futex: sleep until *word != value, wake sleepers on word
+// ============================================================================
+// No FUTEX_PRIVATE_FLAG: the word is in memory shared between processes,
+// so the kernel must key the wait queue on the physical page.
+
+static void futex_wait(_Atomic uint32_t* word, uint32_t value) {
+    // Returns at once (EAGAIN) if *word != value already: no lost wakeups
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, value, NULL, NULL, 0);
+}
+
+static void futex_wake(_Atomic uint32_t* word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, NULL, NULL, 0);
+}
+
+// Wait while *word == value: spin first (the other side is usually only a
+// few hundred ns away), then sleep. The waiting flag and the counter are both
+// sequentially consistent, so either the sleeper sees the new counter or the
+// other side sees the flag and wakes it (the Dekker pattern).
+static void wait_while_equal(const ShmChannel* ch, _Atomic uint32_t* word, uint32_t value,
+                             _Atomic uint32_t* waiting) {
+    for (int i = 0; i < ch->spin_limit; i++) {
+        if (atomic_load_explicit(word, memory_order_acquire) != value) return;
+        CPU_RELAX();
+    }
+    atomic_store(waiting, 1);
+    while (atomic_load(word) == value) {
+        futex_wait(word, value);
+    }
+    atomic_store(waiting, 0);
+}
+
+// ============================================================================
+// Create / attach
+// ============================================================================
+
+static ShmChannel* map_channel(int fd, size_t size) {
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return NULL;
+
+    ShmChannel* ch = malloc(sizeof(ShmChannel));
+    if (!ch) {
+        munmap(base, size);
+        errno = ENOMEM;
+        return NULL;
+    }
+    ch->fd = fd;
+    ch->map_size = size;
+    ch->hdr = base;
+    ch->slots = (unsigned char*)base + header_bytes();
+    // Spinning only helps if the other process runs at the same time
+    ch->spin_limit = sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 4000 : 0;
+    return ch;
+}
+
+ShmChannel* shm_channel_create(const char* name, uint32_t slot_count, uint32_t slot_bytes) {
+    if (slot_count > UINT32_C(1) << 31) {  // no larger power of two in 32 bits
+        errno = EINVAL;
+        return NULL;
+    }
+    uint32_t count = 2;
+    while (count < slot_count) count *= 2;
+    size_t stride = round_up(sizeof(struct SlotHeader) + (size_t)slot_bytes, CACHE_LINE);
+    if (count > (SIZE_MAX - header_bytes()) / stride) {
+        errno = EINVAL;
+        return NULL;
+    }
+    size_t size = header_bytes() + (size_t)count * stride;
+
+    int fd = name ? shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600)
+                  : memfd_create("shm_channel", MFD_CLOEXEC);
+    if (fd < 0) return NULL;
+    if (ftruncate(fd, (off_t)size) != 0) {  // new pages read as zero
+        int saved = errno;
+        close(fd);
+        if (name) shm_unlink(name);
+        errno = saved;
+        return NULL;
+    }
+
+    ShmChannel* ch = map_channel(fd, size);
+    if (!ch) {
+        int saved = errno;
+        close(fd);
+        if (name) shm_unlink(name);
+        errno = saved;
+        return NULL;
+    }
+    ch->slot_count = count;
+    ch->slot_bytes = slot_bytes;
+    ch->slot_stride = stride;
+    struct ShmHeader* h = ch->hdr;
+    h->version = SHM_VERSION;
+    h->slot_count = count;
+    h->slot_bytes = slot_bytes;
+    h->slot_stride = stride;
+    atomic_init(&h->head, 0);
+    atomic_init(&h->tail, 0);
+    atomic_init(&h->consumer_waiting, 0);
+    atomic_init(&h->producer_waiting, 0);
+    // magic last, with release: a process that sees it sees a finished header
+    atomic_store_explicit((_Atomic uint32_t*)&h->magic, SHM_MAGIC, memory_order_release);
+    return ch;
+}
+
+// The layout shm_channel_create() writes, and nothing the mapping can't hold:
+// a power-of-two slot count, slots that fit their payload and keep it
+// cache-line aligned, and every slot inside the file
+static int valid_geometry(const ShmChannel* ch) {
+    uint32_t count = ch->slot_count;
+    size_t stride = ch->slot_stride;
+    if (count == 0 || (count & (count - 1)) != 0) return 0;
+    if (stride % CACHE_LINE != 0 || stride < sizeof(struct SlotHeader) + (size_t)ch->slot_bytes) return 0;
+    size_t slots = ch->map_size - header_bytes();  // from_fd checked map_size >= header_bytes()
+    return count <= slots / stride;                 // count * stride <= slots, without overflow
+}
+
+ShmChannel* shm_channel_from_fd(int fd) {
+    struct stat st;
+    if (fstat(fd, &st) != 0) return NULL;
+    if ((size_t)st.st_size < header_bytes()) {
+        errno = EINVAL;
+        return NULL;
+    }
+    ShmChannel* ch = map_channel(fd, (size_t)st.st_size);
+    if (!ch) return NULL;
+    const struct ShmHeader* h = ch->hdr;
+    int ok = atomic_load_explicit((_Atomic uint32_t*)&h->magic, memory_order_acquire) == SHM_MAGIC &&
+             h->version == SHM_VERSION;
+    if (ok) {
+        // Copy first, then check the copies: the header may change under us
+        ch->slot_count = h->slot_count;
+        ch->slot_bytes = h->slot_bytes;
+        ch->slot_stride = h->slot_stride;
+        ok = valid_geometry(ch);
+    }
+    if (!ok) {
+        munmap(ch->hdr, ch->map_size);
+        free(ch);
+        errno = EINVAL;
+        return NULL;
+    }
+    return ch;
+}
+
+ShmChannel* shm_channel_open(const char* name) {
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return NULL;
+    ShmChannel* ch = shm_channel_from_fd(fd);
+    if (!ch) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+    }
+    return ch;
+}
+
+void shm_channel_close(ShmChannel* ch) {
+    if (!ch) return;
+    munmap(ch->hdr, ch->map_size);
+    close(ch->fd);
+    free(ch);
+}
+
+int shm_channel_unlink(const char* name) {
+    return shm_unlink(name);
+}
+
+int shm_channel_fd(const ShmChannel* ch) {
+    return ch->fd;
+}
+
+uint32_t shm_channel_slot_bytes(const ShmChannel* ch) {
+    return ch->slot_bytes;
+}
+
+// ============================================================================
+// Producer
+// ============================================================================
+
+void* shm_channel_begin_write(ShmChannel* ch) {
+    struct ShmHeader* h = ch->hdr;
+    uint32_t head = atomic_load_explicit(&h->head, memory_order_relaxed);  // only we write it
+    for (;;) {
+        uint32_t tail = atomic_load_explicit(&h->tail, memory_order_acquire);
+        if (head - tail < ch->slot_count) break;
+        wait_while_equal(ch, &h->tail, tail, &h->producer_waiting);  // full
+    }
+    return slot_at(ch, head) + 1;  // payload follows the slot header
+}
+
+void shm_channel_commit(ShmChannel* ch, uint32_t kind, uint32_t count) {
+    struct ShmHeader* h = ch->hdr;
+    uint32_t head = atomic_load_explicit(&h->head, memory_order_relaxed);
+    struct SlotHeader* slot = slot_at(ch, head);
+    slot->kind = kind;
+    slot->count = count;
+    // Publishing = one store. seq_cst (not just release) so the load of the
+    // waiting flag below can't be reordered before it.
+    atomic_store(&h->head, head + 1);
+    if (atomic_load(&h->consumer_waiting)) futex_wake(&h->head);
+}
+
+int shm_channel_send(ShmChannel* ch, uint32_t kind, const void* data, uint32_t count, size_t elem_size) {
+    size_t bytes = (size_t)count * elem_size;
+    if (bytes > ch->slot_bytes) return -1;
+    void* dst = shm_channel_begin_write(ch);
+    memcpy(dst, data, bytes);
+    shm_channel_commit(ch, kind, count);
+    return 0;
+}
+
+// ============================================================================
+// Consumer
+// ============================================================================
+
+static size_t element_size(uint32_t kind) {
+    switch (kind) {
+    case SHM_BATCH_POINTS: return sizeof(struct Point);
+    case SHM_BATCH_DOUBLES: return sizeof(double);
+    default: return 1;  // SHM_BATCH_END and unknown kinds: bytes
+    }
+}
+
+// kind and count come from the producer: count is clamped to what fits in a
+// slot, so a consumer that trusts it never reads past the slot
+static void fill_batch(const ShmChannel* ch, uint32_t tail, ShmBatch* out) {
+    struct SlotHeader* slot = slot_at(ch, tail);
+    uint32_t kind = slot->kind;
+    uint32_t count = slot->count;
+    size_t fits = ch->slot_bytes / element_size(kind);
+    out->kind = kind;
+    out->count = count > fits ? (uint32_t)fits : count;
+    out->data = slot + 1;
+}
+
+int shm_channel_try_begin_read(ShmChannel* ch, ShmBatch* out) {
+    struct ShmHeader* h = ch->hdr;
+    uint32_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);  // only we write it
+    if (atomic_load_explicit(&h->head, memory_order_acquire) == tail) return 0;
+    fill_batch(ch, tail, out);
+    return 1;
+}
+
+void shm_channel_begin_read(ShmChannel* ch, ShmBatch* out) {
+    struct ShmHeader* h = ch->hdr;
+    uint32_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    while (atomic_load_explicit(&h->head, memory_order_acquire) == tail) {
+        wait_while_equal(ch, &h->head, tail, &h->consumer_waiting);  // empty
+    }
+    fill_batch(ch, tail, out);
+}
+
+void shm_channel_end_read(ShmChannel* ch) {
+    struct ShmHeader* h = ch->hdr;
+    uint32_t tail = atomic_load_explicit(&h->tail, memory_order_relaxed);
+    atomic_store(&h->tail, tail + 1);
+    if (atomic_load(&h->producer_waiting)) futex_wake(&h->tail);
+}
@@ -0,0 +1,126 @@
+/* Shared-memory channel: hand arrays of Point / double to another process without copying
+ *
+ * Both processes map the SAME physical pages. The producer writes a batch
+ * straight into a slot of a ring that lives in those pages; the consumer reads
+ * it in place. Handing a batch over is one counter update - the data itself
+ * never moves (compare a pipe: memcpy into the kernel, memcpy out, 2 syscalls).
+ *
+ *   producer process                 shared pages                 consumer process
+ *   begin_write() ─────▶ ┌───────────────────────────────────┐ ◀───── begin_read()
+ *   fill in place        │ header: head │ tail │ wait flags  │        use in place
+ *   commit() ──head++──▶ │ slot 0 │ slot 1 │ ... │ slot N-1 │ ◀─tail++─ end_read()
+ *                        └───────────────────────────────────┘
+ *
+ * One producer, one consumer (SPSC). The ring is lock-free: each side only
+ * writes its own counter. A side that has nothing to do spins briefly, then
+ * sleeps in a futex on the other side's counter; the other side wakes it only
+ * if its "waiting" flag is set, so the fast path makes no syscalls.
+ *
+ * Linux only (memfd_create, futex). Layout of Point: struct Point from
+ * c_functions.h, identical in C and C++.
+ *
+ * OWNERSHIP
+ *   - shm_channel_create/open/from_fd return a handle; shm_channel_close() it.
+ *   - Pointers from begin_write/begin_read point INTO the shared mapping and
+ *     are valid only until the matching commit/end_read.
+ *   - A named channel (shm_open) lives until shm_channel_unlink(name).
+ *     An anonymous one (memfd, name == NULL) lives while any process has it
+ *     mapped or open - share it by fork() or by passing the fd.
+ */
+#ifndef SHM_CHANNEL_H
+#define SHM_CHANNEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ShmChannel ShmChannel;  /* opaque, one per process */
+
+enum {
+    SHM_BATCH_POINTS = 1,   /* data is struct Point[count] */
+    SHM_BATCH_DOUBLES = 2,  /* data is double[count] */
+    SHM_BATCH_END = 3       /* producer is done; count is 0 */
+};
+
+typedef struct ShmBatch {
+    uint32_t kind;
+    uint32_t count;  /* number of elements, not bytes; never more than fit in a slot */
+    void* data;      /* inside the shared mapping */
+} ShmBatch;
+
+/* New channel with slot_count slots (rounded up to a power of two, at most
+ * 2^31) of slot_bytes each. name == NULL: anonymous memfd; otherwise
+ * shm_open(name), e.g. "/points". NULL on failure (errno set). */
+ShmChannel* shm_channel_create(const char* name, uint32_t slot_count, uint32_t slot_bytes);
+
+/* Attach to a channel created by another process. The header is checked
+ * against the size of the mapping: NULL with errno == EINVAL if it doesn't
+ * describe a channel that fits. The other process is not trusted - the
+ * geometry is copied on attach, and batch counts are clamped to a slot. */
+ShmChannel* shm_channel_open(const char* name);
+ShmChannel* shm_channel_from_fd(int fd);
+
+void shm_channel_close(ShmChannel* ch);
+int shm_channel_unlink(const char* name);   /* 0 or -1 (errno set) */
+int shm_channel_fd(const ShmChannel* ch);
+uint32_t shm_channel_slot_bytes(const ShmChannel* ch);
+
+/* PRODUCER: get the next free slot (waits while the ring is full), fill up
+ * to slot_bytes in place, then commit to publish it. */
+void* shm_channel_begin_write(ShmChannel* ch);
+void shm_channel_commit(ShmChannel* ch, uint32_t kind, uint32_t count);
+
+/* Producer convenience: copy count elements of elem_size bytes into a slot.
+ * 0 on success, -1 if they don't fit in one slot. */
+int shm_channel_send(ShmChannel* ch, uint32_t kind, const void* data, uint32_t count, size_t elem_size);
+
+/* CONSUMER: wait for the next batch and look at it in place; end_read
+ * gives the slot back to the producer. try_begin_read returns 0 if empty. */
+void shm_channel_begin_read(ShmChannel* ch, ShmBatch* out);
+int shm_channel_try_begin_read(ShmChannel* ch, ShmBatch* out);
+void shm_channel_end_read(ShmChannel* ch);
+
+#ifdef __cplusplus
+}
+
+/* C++ convenience: owns the handle, typed slot access, scoped reads */
+class ShmChannelRef {
+private:
+    ShmChannel* ch;
+public:
+    explicit ShmChannelRef(ShmChannel* c) : ch{c} {}
+    ~ShmChannelRef() { shm_channel_close(ch); }
+    ShmChannelRef(const ShmChannelRef&) = delete;
+    ShmChannelRef& operator=(const ShmChannelRef&) = delete;
+
+    bool valid() const { return ch != nullptr; }
+    ShmChannel* handle() { return ch; }
+
+    template <typename T>
+    uint32_t capacity() const { return static_cast<uint32_t>(shm_channel_slot_bytes(ch) / sizeof(T)); }
+
+    template <typename T>
+    T* begin_write() { return static_cast<T*>(shm_channel_begin_write(ch)); }
+    void commit(uint32_t kind, uint32_t count) { shm_channel_commit(ch, kind, count); }
+
+    // Calls f(batch) on the next batch, in place. Returns false at SHM_BATCH_END.
+    template <typename F>
+    bool consume(F&& f) {
+        struct Release {
+            ShmChannel* c;
+            ~Release() { shm_channel_end_read(c); }  // even if f throws
+        };
+        ShmBatch b;
+        shm_channel_begin_read(ch, &b);
+        Release release{ch};
+        if (b.kind == SHM_BATCH_END) return false;
+        f(b);
+        return true;
+    }
+};
+#endif
+
+#endif /* SHM_CHANNEL_H */
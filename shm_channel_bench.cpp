@@ -0,0 +1,362 @@
+// C++ consumer of the shared-memory channel: zero-copy vs copy vs pipe
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "c_functions.h"  // struct Point
+#include "shm_channel.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+// A child process (the producer) sends batches of Points to this process:
+//
+//   shm zero-copy   producer builds the batch IN the shared slot; we read it in place
+//   shm + memcpy    producer builds it locally, shm_channel_send copies it in
+//   pipe            producer write()s the bytes, we read() them into a buffer:
+//                   two copies through the kernel + at least two syscalls per batch
+//
+// Then a ping-pong of one double each way measures the HANDOFF itself: with
+// spinning on a multi-core machine that is a couple of cache-line transfers
+// (~100-200 ns); a pipe round trip needs syscalls and scheduler wakeups.
+//
+// Interactive mode with the separate C producer (shm_producer.c):
+//   ./build/shm_channel_bench --serve /points      (terminal 1)
+//   ./build/shm_producer /points 10000             (terminal 2)
+
+const std::uint32_t kSlotBytes = 64 * 1024;
+const std::uint32_t kSlots = 16;
+const std::uint32_t kPointsPerBatch = kSlotBytes / sizeof(Point);
+
+void fill_batch(Point* pts, std::uint32_t count, long batch) {
+    for (std::uint32_t i = 0; i < count; ++i) {
+        pts[i].x = int(batch);
+        pts[i].y = int(i);
+    }
+}
+
+// Every Point is read (a consumer that doesn't look at the data measures nothing)
+std::int64_t checksum(const Point* pts, std::uint32_t count) {
+    std::int64_t sum = 0;
+    for (std::uint32_t i = 0; i < count; ++i) sum += pts[i].x + pts[i].y;
+    return sum;
+}
+
+std::int64_t expected_checksum(long batches, std::uint32_t count) {
+    std::int64_t per_batch_y = std::int64_t(count) * (count - 1) / 2;
+    std::int64_t sum_x = std::int64_t(batches) * (batches - 1) / 2 * count;
+    return sum_x + per_batch_y * batches;
+}
+
+// Run `child` in a forked process; it must not return
+template <typename F>
+pid_t spawn(F&& child) {
+    std::cout.flush();  // don't let the child inherit (and re-print) buffered output
+    pid_t pid = fork();
+    if (pid == 0) {
+        child();
+        _exit(0);
+    }
+    return pid;
+}
+
+bool write_all(int fd, const void* data, std::size_t bytes) {
+    const char* p = static_cast<const char*>(data);
+    while (bytes > 0) {
+        ssize_t n = write(fd, p, bytes);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= std::size_t(n);
+    }
+    return true;
+}
+
+bool read_all(int fd, void* data, std::size_t bytes) {
+    char* p = static_cast<char*>(data);
+    while (bytes > 0) {
+        ssize_t n = read(fd, p, bytes);
+        if (n <= 0) return false;
+        p += n;
+        bytes -= std::size_t(n);
+    }
+    return true;
+}
+
+// ============================================================================
+// THROUGHPUT
+// ============================================================================
+
+void report(const char* name, double ms, long batches, bool ok) {
+    std::string padded = name;
+    padded.resize(16, ' ');
+    double bytes = double(batches) * kPointsPerBatch * sizeof(Point);
+    std::cout << "  " << padded << ms << " ms  " << bytes / (ms * 1e6) << " GB/s  "
+              << ms * 1e3 / batches << " us/batch  " << (ok ? "verified" : "CORRUPTED") << std::endl;
+}
+
+bool bench_shm(long batches, bool zero_copy, double& ms) {
+    ShmChannelRef ch(shm_channel_create(nullptr, kSlots, kSlotBytes));
+    if (!ch.valid()) {
+        std::perror("shm_channel_create");
+        return false;
+    }
+
+    std::int64_t sum = 0;
+    ms = time_ms([&] {
+        pid_t pid = spawn([&] {
+            std::vector<Point> local(zero_copy ? 0 : kPointsPerBatch);
+            for (long b = 0; b < batches; ++b) {
+                if (zero_copy) {
+                    Point* pts = ch.begin_write<Point>();
+                    fill_batch(pts, kPointsPerBatch, b);
+                    ch.commit(SHM_BATCH_POINTS, kPointsPerBatch);
+                } else {
+                    fill_batch(local.data(), kPointsPerBatch, b);
+                    shm_channel_send(ch.handle(), SHM_BATCH_POINTS, local.data(), kPointsPerBatch, sizeof(Point));
+                }
+            }
+            ch.begin_write<Point>();
+            ch.commit(SHM_BATCH_END, 0);
+        });
+
+        while (ch.consume([&](const ShmBatch& b) {
+            sum += checksum(static_cast<const Point*>(b.data), b.count);
+        })) {
+        }
+        waitpid(pid, nullptr, 0);
+    });
+    return sum == expected_checksum(batches, kPointsPerBatch);
+}
+
+bool bench_pipe(long batches, double& ms) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        std::perror("pipe");
+        return false;
+    }
+
+    std::int64_t sum = 0;
+    ms = time_ms([&] {
+        pid_t pid = spawn([&] {
+            close(fds[0]);
+            std::vector<Point> local(kPointsPerBatch);
+            for (long b = 0; b < batches; ++b) {
+                fill_batch(local.data(), kPointsPerBatch, b);
+                write_all(fds[1], local.data(), kSlotBytes);
+            }
+            close(fds[1]);
+        });
+        close(fds[1]);
+
+        std::vector<Point> buffer(kPointsPerBatch);
+        while (read_all(fds[0], buffer.data(), kSlotBytes)) {
+            sum += checksum(buffer.data(), kPointsPerBatch);
+        }
+        close(fds[0]);
+        waitpid(pid, nullptr, 0);
+    });
+    return sum == expected_checksum(batches, kPointsPerBatch);
+}
+
+// ============================================================================
+// LATENCY: ping-pong of one double
+// ============================================================================
+
+// Both return false when the value did not come back incremented `rounds`
+// times; ns is the one-way latency
+bool pingpong_shm(int rounds, double& ns) {
+    ShmChannelRef ping(shm_channel_create(nullptr, 2, sizeof(double)));
+    ShmChannelRef pong(shm_channel_create(nullptr, 2, sizeof(double)));
+    if (!ping.valid() || !pong.valid()) return false;
+
+    double v = 0;
+    double ms = time_ms([&] {
+        pid_t pid = spawn([&] {
+            for (int r = 0; r < rounds; ++r) {
+                double v = 0;
+                ping.consume([&](const ShmBatch& b) { v = *static_cast<const double*>(b.data); });
+                *pong.begin_write<double>() = v + 1;
+                pong.commit(SHM_BATCH_DOUBLES, 1);
+            }
+        });
+
+        for (int r = 0; r < rounds; ++r) {
+            *ping.begin_write<double>() = v;
+            ping.commit(SHM_BATCH_DOUBLES, 1);
+            pong.consume([&](const ShmBatch& b) { v = *static_cast<const double*>(b.data); });
+        }
+        waitpid(pid, nullptr, 0);
+    });
+    ns = ms * 1e6 / rounds / 2;
+    return v == rounds;
+}
+
+bool pingpong_pipe(int rounds, double& ns) {
+    int to_child[2], to_parent[2];
+    if (pipe(to_child) != 0 || pipe(to_parent) != 0) return false;
+
+    double v = 0;
+    double ms = time_ms([&] {
+        pid_t pid = spawn([&] {
+            double v;
+            for (int r = 0; r < rounds; ++r) {
+                read_all(to_child[0], &v, sizeof(v));
+                v += 1;
+                write_all(to_parent[1], &v, sizeof(v));
+            }
+        });
+
+        for (int r = 0; r < rounds; ++r) {
+            write_all(to_child[1], &v, sizeof(v));
+            read_all(to_parent[0], &v, sizeof(v));
+        }
+        waitpid(pid, nullptr, 0);
+    });
+    for (int fd : {to_child[0], to_child[1], to_parent[0], to_parent[1]}) close(fd);
+    ns = ms * 1e6 / rounds / 2;
+    return v == rounds;
+}
+
+// ============================================================================
+// ATTACH VALIDATION: the other process is not trusted
+// ============================================================================
+// The header and every slot's count live in pages the peer can write. A
+// consumer that believed them could be steered out of the mapping. Here the
+// test plays the hostile peer by writing the header through its own mapping:
+// ShmHeader starts with magic, version, slot_count, slot_bytes (uint32 each)
+// and slot_stride (size_t), see shm_channel.c.
+
+struct HeaderFields {
+    std::uint32_t magic, version, slot_count, slot_bytes;
+    std::size_t slot_stride;
+};
+
+// Does shm_channel_from_fd accept the channel after `corrupt` edits its header?
+template <typename F>
+bool attaches_after(F&& corrupt) {
+    ShmChannelRef ch(shm_channel_create(nullptr, 4, 256));
+    if (!ch.valid()) return true;  // reported as a failure by the caller
+    int fd = shm_channel_fd(ch.handle());
+    void* base = mmap(nullptr, sizeof(HeaderFields), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (base == MAP_FAILED) return true;
+    corrupt(*static_cast<HeaderFields*>(base));
+    munmap(base, sizeof(HeaderFields));
+    ShmChannel* peer = shm_channel_from_fd(dup(fd));
+    bool attached = peer != nullptr;
+    shm_channel_close(peer);
+    return attached || errno != EINVAL;
+}
+
+void test_attach_validation() {
+    std::cout << std::endl << "=== Attach validation ===" << std::endl;
+    check(attaches_after([](HeaderFields&) {}), "an untouched channel attaches");
+    check(!attaches_after([](HeaderFields& h) { h.slot_count = 3; }), "slot_count 3 (not a power of two): EINVAL");
+    check(!attaches_after([](HeaderFields& h) { h.slot_count = 0; }), "slot_count 0: EINVAL");
+    check(!attaches_after([](HeaderFields& h) { h.slot_count = 1u << 31; }), "2^31 slots in a 1 KiB file: EINVAL");
+    check(!attaches_after([](HeaderFields& h) { h.slot_bytes = 1u << 20; }), "slot_bytes larger than the stride: EINVAL");
+    check(!attaches_after([](HeaderFields& h) { h.slot_stride = std::size_t(1) << 62; }),
+          "stride whose total overflows size_t: EINVAL");
+
+    // A count bigger than a slot holds reaches the consumer clamped
+    ShmChannelRef ch(shm_channel_create(nullptr, 2, 256));
+    std::uint32_t seen = 0;
+    if (ch.valid()) {
+        ch.begin_write<Point>();
+        ch.commit(SHM_BATCH_POINTS, 1u << 30);
+        ch.consume([&](const ShmBatch& b) { seen = b.count; });
+    }
+    check(seen == 256 / sizeof(Point), "a batch claiming 2^30 Points is clamped to the 32 that fit in a slot");
+
+    errno = 0;
+    ShmChannel* huge = shm_channel_create(nullptr, 0x80000001u, 64);
+    check(huge == nullptr && errno == EINVAL, "create with more than 2^31 slots fails instead of looping");
+    shm_channel_close(huge);
+}
+
+// ============================================================================
+// --serve: consume from the separate C producer (shm_producer.c)
+// ============================================================================
+
+int serve(const char* name) {
+    shm_channel_unlink(name);  // remove a stale channel from a crashed run
+    ShmChannelRef ch(shm_channel_create(name, kSlots, kSlotBytes));
+    if (!ch.valid()) {
+        std::perror("shm_channel_create");
+        return 1;
+    }
+    std::cout << "Channel " << name << " ready. Run: ./build/shm_producer " << name << std::endl;
+
+    long batches = 0;
+    bool ok = true;
+    auto start = std::chrono::steady_clock::now();
+    while (ch.consume([&](const ShmBatch& b) {
+        const Point* pts = static_cast<const Point*>(b.data);
+        ok &= b.kind == SHM_BATCH_POINTS && pts[0].x == batches && pts[b.count - 1].y == int(b.count - 1);
+        if (batches == 0) start = std::chrono::steady_clock::now();  // don't count waiting for the producer
+        ++batches;
+    })) {
+    }
+    double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Received " << batches << " batches from the C producer" << std::endl;
+    report("shm (C -> C++)", ms, batches, ok);
+    shm_channel_unlink(name);
+    return ok ? 0 : 1;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 2 && std::strcmp(argv[1], "--serve") == 0) return serve(argv[2]);
+
+    std::cout << "=== Shared-Memory Zero-Copy Channel vs Pipe ===" << std::endl;
+    std::cout << std::endl;
+
+    long batches = argc > 1 ? std::atol(argv[1]) : 4000;
+    std::cout << "CPUs online: " << sysconf(_SC_NPROCESSORS_ONLN)
+              << " (with 1 CPU both processes share it: no spinning, every handoff sleeps)" << std::endl;
+
+    std::cout << std::endl << "=== Throughput: " << batches << " batches x " << kPointsPerBatch
+              << " Points (" << kSlotBytes / 1024 << " KiB) ===" << std::endl;
+    double ms = 0;
+    bool ok = bench_shm(batches, true, ms);
+    bool all_ok = ok;
+    report("shm zero-copy", ms, batches, ok);
+    ok = bench_shm(batches, false, ms);
+    all_ok &= ok;
+    report("shm + memcpy", ms, batches, ok);
+    ok = bench_pipe(batches, ms);
+    all_ok &= ok;
+    report("pipe", ms, batches, ok);
+
+    const int rounds = 100000;
+    std::cout << std::endl << "=== Handoff latency: ping-pong, " << rounds << " rounds ===" << std::endl;
+    double shm_ns = 0, pipe_ns = 0;
+    bool shm_ok = pingpong_shm(rounds, shm_ns);
+    bool pipe_ok = pingpong_pipe(rounds, pipe_ns);
+    all_ok &= shm_ok && pipe_ok;
+    std::cout << "  shm channel: " << shm_ns << " ns one-way  " << (shm_ok ? "verified" : "CORRUPTED") << std::endl;
+    std::cout << "  pipe:        " << pipe_ns << " ns one-way  " << (pipe_ok ? "verified" : "CORRUPTED") << std::endl;
+
+    test_attach_validation();
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• Same pages mapped in both processes: the data never moves" << std::endl;
+    std::cout << "• Handoff = one counter store + the consumer's cache miss on it" << std::endl;
+    std::cout << "• Identical struct Point layout in C and C++ makes the bytes directly usable" << std::endl;
+    std::cout << "• futex only when a side has to sleep: the fast path makes no syscalls" << std::endl;
+    std::cout << "• A pipe copies twice (user -> kernel -> user) and syscalls every batch" << std::endl;
+    std::cout << "• The peer is not trusted: geometry is checked and copied on attach, counts clamped" << std::endl;
+
+    all_ok &= failures == 0;
+    std::cout << std::endl << (all_ok ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return all_ok ? 0 : 1;
+}
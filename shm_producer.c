@@ -0,0 +1,39 @@
+// C producer process: writes Point batches straight into a shared-memory channel
+// Start the consumer first:  ./build/shm_channel_bench --serve /points
+// then:                      ./build/shm_producer /points [batches]
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "c_functions.h"  // struct Point - same layout as the C++ consumer's
+#include "shm_channel.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s /channel-name [batches]\n", argv[0]);
+        return 1;
+    }
+    long batches = argc > 2 ? atol(argv[2]) : 10000;
+
+    ShmChannel* ch = shm_channel_open(argv[1]);
+    if (!ch) {
+        perror("shm_channel_open (is the consumer running?)");
+        return 1;
+    }
+
+    uint32_t capacity = shm_channel_slot_bytes(ch) / sizeof(struct Point);
+    for (long b = 0; b < batches; b++) {
+        // No local buffer, no serialization: the Points are built in the shared pages
+        struct Point* pts = shm_channel_begin_write(ch);
+        for (uint32_t i = 0; i < capacity; i++) {
+            pts[i].x = (int)b;
+            pts[i].y = (int)i;
+        }
+        shm_channel_commit(ch, SHM_BATCH_POINTS, capacity);
+    }
+    shm_channel_begin_write(ch);
+    shm_channel_commit(ch, SHM_BATCH_END, 0);
+
+    printf("Sent %ld batches of %u Points\n", batches, capacity);
+    shm_channel_close(ch);
+    return 0;
+}
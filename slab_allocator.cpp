@@ -0,0 +1,394 @@
+#include <iostream>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+#include "bench_util.h"
+
+// ============================================================================
+// TYPE-SEGREGATED SLAB ALLOCATOR
+// ============================================================================
+//
+// Every `new Circle(5.0)` goes to the general-purpose malloc. malloc has to
+// serve every size, so Circles end up mixed with strings, vectors, buffers...
+//
+// General heap after many allocations:
+// ┌────────┬──────┬────────┬───────────┬────────┬─────┬────────┐
+// │ Circle │ str  │ Circle │ vector<T> │ Circle │ ... │ Circle │
+// └────────┴──────┴────────┴───────────┴────────┴─────┴────────┘
+//   -> iterating over all Circles touches many unrelated cache lines
+//
+// A SLAB is one big block carved into equal-sized slots for ONE type:
+// ┌────────┬────────┬────────┬────────┬────────┬────────┐
+// │ Circle │ Circle │ Circle │ Circle │ Circle │ Circle │  <- slab for Circle
+// └────────┴────────┴────────┴────────┴────────┴────────┘
+// ┌───────────┬───────────┬───────────┬───────────┐
+// │ Rectangle │ Rectangle │ Rectangle │ Rectangle │       <- slab for Rectangle
+// └───────────┴───────────┴───────────┴───────────┘
+//
+// Free slots are linked through their own storage (intrusive free list):
+//   free_head -> [slot 3] -> [slot 7] -> [slot 1] -> nullptr
+//   allocate():   pop the head   -> O(1)
+//   deallocate(): push a new head -> O(1)
+
+// ============================================================================
+// THE POOL: one per type T
+// ============================================================================
+//
+// Two levels:
+//   1. Per-thread cache (thread_local)  <- no lock, the common path
+//   2. Central free list (mutex)        <- only touched in batches
+//
+//   thread A cache ──┐                     ┌── thread B cache
+//                    ├─> central pool <────┤
+//   (refill/flush    │   (slabs + mutex)   │   in batches of kBatch)
+
+template <typename T>
+class SlabPool {
+private:
+    // A slot is either a live T or a link in the free list
+    union Slot {
+        Slot* next;
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    static constexpr std::size_t kSlotsPerSlab = 1024;  // slots carved per slab
+    static constexpr std::size_t kBatch = 64;           // slots moved per refill/flush
+
+    struct Central {
+        std::mutex mutex;
+        Slot* free_head = nullptr;
+        std::vector<Slot*> slabs;   // every slab ever carved (freed at exit)
+        std::size_t slots_total = 0;
+
+        ~Central() {
+            for (Slot* slab : slabs) std::free(slab);
+        }
+    };
+
+    struct LocalCache {
+        Slot* head = nullptr;
+        std::size_t count = 0;
+
+        LocalCache() { central(); }  // construct Central first so it is destroyed last
+
+        ~LocalCache() {
+            // Thread exits: hand every cached slot back to the central pool
+            while (count > 0) flush(*this, count);
+        }
+    };
+
+    static Central& central() {
+        static Central c;
+        return c;
+    }
+
+    static LocalCache& local() {
+        thread_local LocalCache cache;
+        return cache;
+    }
+
+    // Central must hold the lock. Carves a fresh slab in ADDRESS ORDER so
+    // consecutive allocations land next to each other.
+    static void grow(Central& c) {
+        Slot* slab = static_cast<Slot*>(std::malloc(sizeof(Slot) * kSlotsPerSlab));
+        if (!slab) throw std::bad_alloc{};
+        c.slabs.push_back(slab);
+        c.slots_total += kSlotsPerSlab;
+        for (std::size_t i = kSlotsPerSlab; i-- > 0;) {
+            slab[i].next = c.free_head;
+            c.free_head = &slab[i];
+        }
+    }
+
+    // Detach the first kBatch slots of the central list and hand the whole
+    // chain to the (empty) thread cache - order is kept, so a fresh slab is
+    // still handed out in address order
+    static void refill(LocalCache& cache) {
+        Central& c = central();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        if (!c.free_head) grow(c);
+        Slot* first = c.free_head;
+        Slot* last = first;
+        std::size_t n = 1;
+        while (n < kBatch && last->next) {
+            last = last->next;
+            ++n;
+        }
+        c.free_head = last->next;
+        last->next = cache.head;
+        cache.head = first;
+        cache.count += n;
+    }
+
+    // Move n slots from the thread cache back to the central list
+    static void flush(LocalCache& cache, std::size_t n) {
+        Central& c = central();
+        std::lock_guard<std::mutex> lock(c.mutex);
+        for (std::size_t i = 0; i < n && cache.head; ++i) {
+            Slot* s = cache.head;
+            cache.head = s->next;
+            s->next = c.free_head;
+            c.free_head = s;
+            --cache.count;
+        }
+    }
+
+public:
+    static void* allocate() {
+        LocalCache& cache = local();
+        if (!cache.head) refill(cache);
+        Slot* s = cache.head;
+        cache.head = s->next;
+        --cache.count;
+        return s;
+    }
+
+    static void deallocate(void* p) {
+        LocalCache& cache = local();
+        Slot* s = static_cast<Slot*>(p);
+        s->next = cache.head;
+        cache.head = s;
+        // Don't let one thread hoard slots: give a batch back when too many
+        if (++cache.count > 2 * kBatch) flush(cache, kBatch);
+    }
+
+    static std::size_t slab_count() {
+        std::lock_guard<std::mutex> lock(central().mutex);
+        return central().slabs.size();
+    }
+
+    static std::size_t slot_size() { return sizeof(Slot); }
+};
+
+// ============================================================================
+// HOOKING IT UP: class-level operator new / operator delete
+// ============================================================================
+//
+// `new Circle(5.0)` looks up operator new in Circle's scope FIRST,
+// then falls back to the global ::operator new.
+//
+// `delete shape_ptr` with a virtual destructor calls the operator delete
+// of the DYNAMIC type - so deleting through Shape* still returns the
+// memory to the right pool.
+//
+// PoolAllocated<T> is a mixin: inherit from it once per concrete type.
+
+template <typename T>
+class PoolAllocated {
+public:
+    static void* operator new(std::size_t size) {
+        // A class derived from T may be bigger - it can't use T's slots
+        if (size != sizeof(T)) return ::operator new(size);
+        return SlabPool<T>::allocate();
+    }
+
+    static void operator delete(void* p, std::size_t size) {
+        if (!p) return;
+        if (size != sizeof(T)) { ::operator delete(p); return; }
+        SlabPool<T>::deallocate(p);
+    }
+};
+
+// ============================================================================
+// SHAPES: same hierarchy as concrete_vs_abstract.cpp, plus a pool mixin
+// ============================================================================
+
+class Shape {  // Abstract type
+public:
+    virtual double area() const = 0;
+    virtual ~Shape() {}
+};
+
+class Circle : public Shape, public PoolAllocated<Circle> {
+    double radius;
+public:
+    Circle(double r) : radius{r} {}
+    double area() const override { return 3.14159 * radius * radius; }
+};
+
+class Rectangle : public Shape, public PoolAllocated<Rectangle> {
+    double width;
+    double height;
+public:
+    Rectangle(double w, double h) : width{w}, height{h} {}
+    double area() const override { return width * height; }
+};
+
+// Identical classes WITHOUT the mixin - they use the default ::operator new
+class PlainCircle : public Shape {
+    double radius;
+public:
+    PlainCircle(double r) : radius{r} {}
+    double area() const override { return 3.14159 * radius * radius; }
+};
+
+class PlainRectangle : public Shape {
+    double width;
+    double height;
+public:
+    PlainRectangle(double w, double h) : width{w}, height{h} {}
+    double area() const override { return width * height; }
+};
+
+// ============================================================================
+// DEMONSTRATION
+// ============================================================================
+
+void show_slab_layout() {
+    std::cout << "=== Slab Layout ===" << std::endl << std::endl;
+
+    Shape* c1 = new Circle(1.0);
+    Shape* c2 = new Circle(2.0);
+    Shape* r1 = new Rectangle(1.0, 2.0);
+    Shape* c3 = new Circle(3.0);
+
+    std::cout << "sizeof(Circle) = " << sizeof(Circle)
+              << " bytes, slot size = " << SlabPool<Circle>::slot_size() << " bytes" << std::endl;
+    std::cout << "Circle #1 at:    " << c1 << std::endl;
+    std::cout << "Circle #2 at:    " << c2 << "  <- next slot in the Circle slab" << std::endl;
+    std::cout << "Rectangle #1 at: " << r1 << "  <- different slab (different type)" << std::endl;
+    std::cout << "Circle #3 at:    " << c3 << "  <- still contiguous with the Circles" << std::endl;
+    std::cout << std::endl;
+
+    // Freeing through the base pointer returns the slot to the right pool
+    delete c2;
+    Shape* c4 = new Circle(4.0);
+    std::cout << "delete Circle #2, then new Circle:" << std::endl;
+    std::cout << "Circle #4 at:    " << c4 << "  <- reuses the freed slot (LIFO free list)" << std::endl;
+    std::cout << std::endl;
+
+    delete c1;
+    delete r1;
+    delete c3;
+    delete c4;
+}
+
+// ============================================================================
+// BENCHMARKS
+// ============================================================================
+
+// Allocation rate: allocate N shapes, free them all, repeat
+template <typename C, typename R>
+double bench_alloc_free(std::size_t n, int rounds) {
+    std::vector<Shape*> shapes(n);
+    return time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            for (std::size_t i = 0; i < n; ++i) {
+                if (i % 2 == 0) shapes[i] = new C(1.0);
+                else            shapes[i] = new R(1.0, 2.0);
+            }
+            for (std::size_t i = 0; i < n; ++i) delete shapes[i];
+        }
+    });
+}
+
+// Iteration locality: shapes were allocated while OTHER allocations happened
+// in between (like a real program), then we walk them and call area()
+template <typename C, typename R>
+double bench_iterate(std::size_t n, int rounds, double& checksum) {
+    std::vector<Shape*> shapes(n);
+    std::vector<void*> noise(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        if (i % 2 == 0) shapes[i] = new C(1.0 + i % 7);
+        else            shapes[i] = new R(1.0, 1.0 + i % 5);
+        noise[i] = std::malloc(16 + (i % 8) * 16);  // unrelated heap traffic
+    }
+
+    double ms = time_ms([&] {
+        for (int r = 0; r < rounds; ++r) {
+            double sum = 0.0;
+            for (Shape* s : shapes) sum += s->area();
+            checksum += sum;
+        }
+    });
+
+    for (std::size_t i = 0; i < n; ++i) {
+        delete shapes[i];
+        std::free(noise[i]);
+    }
+    return ms;
+}
+
+// Several threads allocating and freeing at once: the thread-local cache
+// means each thread only takes the pool lock once per kBatch operations
+template <typename C>
+double bench_threads(int thread_count, std::size_t n) {
+    return time_ms([&] {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < thread_count; ++t) {
+            threads.emplace_back([n] {
+                std::vector<Shape*> local(256);
+                for (std::size_t i = 0; i < n; i += local.size()) {
+                    for (auto& s : local) s = new C(1.0);
+                    for (auto* s : local) delete s;
+                }
+            });
+        }
+        for (auto& th : threads) th.join();
+    });
+}
+
+void run_benchmarks(std::size_t n) {
+    std::cout << "=== Benchmarks (N = " << n << " shapes) ===" << std::endl << std::endl;
+
+    const int rounds = 10;
+    double plain_alloc = bench_alloc_free<PlainCircle, PlainRectangle>(n, rounds);
+    double pool_alloc = bench_alloc_free<Circle, Rectangle>(n, rounds);
+    double ops = 2.0 * n * rounds;  // one new + one delete per shape per round
+
+    std::cout << "Allocation rate (new + delete):" << std::endl;
+    std::cout << "  default ::operator new: " << plain_alloc << " ms  ("
+              << (plain_alloc * 1e6 / ops) << " ns/op)" << std::endl;
+    std::cout << "  slab pool:              " << pool_alloc << " ms  ("
+              << (pool_alloc * 1e6 / ops) << " ns/op)" << std::endl;
+    std::cout << "  speedup: " << (plain_alloc / pool_alloc) << "x" << std::endl;
+    std::cout << std::endl;
+
+    double checksum = 0.0;
+    double plain_iter = bench_iterate<PlainCircle, PlainRectangle>(n, rounds, checksum);
+    double pool_iter = bench_iterate<Circle, Rectangle>(n, rounds, checksum);
+
+    std::cout << "Iteration (virtual area() over all shapes, heap interleaved with noise):" << std::endl;
+    std::cout << "  default ::operator new: " << plain_iter << " ms" << std::endl;
+    std::cout << "  slab pool:              " << pool_iter << " ms" << std::endl;
+    std::cout << "  speedup: " << (plain_iter / pool_iter) << "x" << std::endl;
+    std::cout << "  (checksum " << checksum << ")" << std::endl;
+    std::cout << std::endl;
+
+    unsigned hw = std::thread::hardware_concurrency();
+    int thread_count = hw > 1 ? static_cast<int>(hw) : 2;
+    double plain_mt = bench_threads<PlainCircle>(thread_count, n);
+    double pool_mt = bench_threads<Circle>(thread_count, n);
+
+    std::cout << "Multithreaded churn (" << thread_count << " threads):" << std::endl;
+    std::cout << "  default ::operator new: " << plain_mt << " ms" << std::endl;
+    std::cout << "  slab pool:              " << pool_mt << " ms" << std::endl;
+    std::cout << std::endl;
+
+    std::cout << "Slabs carved: Circle=" << SlabPool<Circle>::slab_count()
+              << ", Rectangle=" << SlabPool<Rectangle>::slab_count() << std::endl;
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Type-Segregated Slab Allocator for Shapes ===" << std::endl << std::endl;
+
+    show_slab_layout();
+
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    run_benchmarks(n);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Class-level operator new/delete redirect 'new Circle' to a pool" << std::endl;
+    std::cout << "• One pool per type: all Circles share slabs, all Rectangles share slabs" << std::endl;
+    std::cout << "• Free list lives inside the free slots: O(1) alloc and free, no headers" << std::endl;
+    std::cout << "• Thread-local cache: the lock is only taken once per batch" << std::endl;
+    std::cout << "• Virtual destructor -> delete through Shape* reaches the right pool" << std::endl;
+
+    return 0;
+}
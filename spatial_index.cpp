@@ -0,0 +1,821 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <climits>
+#include <functional>
+#include <future>
+#include <queue>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "bench_util.h"
+
+// ============================================================================
+// SPATIAL INDEXES FOR Point AND Line
+// ============================================================================
+//
+// The aggregates from brace_initialization.cpp:
+//   struct Point { int x; int y; };
+//   struct Line  { Point start; Point end; };
+//
+// BRUTE FORCE: "which items are inside this rectangle?" -> test all N items.
+//   Cost grows with the DATASET, even if the answer is 3 items.
+//
+// A spatial index groups nearby items so a query can skip whole groups:
+//
+// 1. UNIFORM HASH GRID              2. BVH (Bounding Volume Hierarchy)
+//   ┌───┬───┬───┬───┐                       [root box]
+//   │ • │   │•  │   │                      /          \    .
+//   ├───┼───┼───┼───┤               [left box]      [right box]
+//   │  •│ ▓▓│▓▓ │ • │                 /    \          /    \  .
+//   ├───┼─▓─┼▓▓─┼───┤              [leaf] [leaf]   [leaf] [leaf]
+//   │   │ ▓▓│▓• │   │
+//   └───┴───┴───┴───┘              Skip a subtree when its box misses
+//   ▓ = query: only visit            the query. Adapts to clustered data.
+//   the 4 cells it touches.
+//   Best for uniform data,
+//   cheap insert/erase.
+//
+// Both make query cost depend on the OUTPUT size (plus a log or a few cells),
+// not on N.
+
+struct Point {
+    int x;
+    int y;
+};
+
+struct Line {
+    Point start;
+    Point end;
+};
+
+// Axis-aligned bounding box (inclusive)
+struct Box {
+    int min_x, min_y, max_x, max_y;
+
+    bool empty() const { return min_x > max_x; }
+    bool overlaps(const Box& o) const {
+        return min_x <= o.max_x && o.min_x <= max_x && min_y <= o.max_y && o.min_y <= max_y;
+    }
+    void expand(const Box& o) {
+        min_x = std::min(min_x, o.min_x); min_y = std::min(min_y, o.min_y);
+        max_x = std::max(max_x, o.max_x); max_y = std::max(max_y, o.max_y);
+    }
+    double area() const { return empty() ? 0.0 : double(max_x - min_x) * double(max_y - min_y); }
+    // Squared distance from a point to the box (0 if inside) - lower bound for kNN
+    double distance2(const Point& p) const {
+        double dx = std::max({double(min_x) - p.x, 0.0, double(p.x) - max_x});
+        double dy = std::max({double(min_y) - p.y, 0.0, double(p.y) - max_y});
+        return dx * dx + dy * dy;
+    }
+    static Box none() { return {1, 1, 0, 0}; }
+};
+
+// ============================================================================
+// GEOMETRY TRAITS: the indexes only need these three functions per type
+// ============================================================================
+
+inline Box bounds(const Point& p) { return {p.x, p.y, p.x, p.y}; }
+inline Box bounds(const Line& l) {
+    return {std::min(l.start.x, l.end.x), std::min(l.start.y, l.end.y),
+            std::max(l.start.x, l.end.x), std::max(l.start.y, l.end.y)};
+}
+
+inline bool intersects(const Box& b, const Point& p) {
+    return p.x >= b.min_x && p.x <= b.max_x && p.y >= b.min_y && p.y <= b.max_y;
+}
+
+// Segment vs rectangle: Liang-Barsky clipping of the segment against the box
+inline bool intersects(const Box& b, const Line& l) {
+    if (!b.overlaps(bounds(l))) return false;
+    double x0 = l.start.x, y0 = l.start.y;
+    double dx = double(l.end.x) - x0, dy = double(l.end.y) - y0;
+    double t0 = 0.0, t1 = 1.0;
+    double p[4] = {-dx, dx, -dy, dy};
+    double q[4] = {x0 - b.min_x, b.max_x - x0, y0 - b.min_y, b.max_y - y0};
+    for (int i = 0; i < 4; ++i) {
+        if (p[i] == 0.0) {
+            if (q[i] < 0.0) return false;  // parallel and outside
+            continue;
+        }
+        double t = q[i] / p[i];
+        if (p[i] < 0.0) t0 = std::max(t0, t);
+        else            t1 = std::min(t1, t);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+inline double distance2(const Point& q, const Point& p) {
+    double dx = double(p.x) - q.x, dy = double(p.y) - q.y;
+    return dx * dx + dy * dy;
+}
+
+// Squared distance from q to the closest point on the segment
+inline double distance2(const Point& q, const Line& l) {
+    double ax = l.start.x, ay = l.start.y;
+    double dx = double(l.end.x) - ax, dy = double(l.end.y) - ay;
+    double len2 = dx * dx + dy * dy;
+    double t = len2 > 0.0 ? ((q.x - ax) * dx + (q.y - ay) * dy) / len2 : 0.0;
+    t = std::clamp(t, 0.0, 1.0);
+    double cx = ax + t * dx - q.x, cy = ay + t * dy - q.y;
+    return cx * cx + cy * cy;
+}
+
+// k nearest collector: keeps the k best (distance, id) pairs in a max-heap
+struct Neighbor {
+    double dist2;
+    std::uint32_t id;
+    bool operator<(const Neighbor& o) const {
+        return dist2 < o.dist2 || (dist2 == o.dist2 && id < o.id);
+    }
+};
+
+class KBest {
+private:
+    std::size_t k;
+    std::priority_queue<Neighbor> heap;  // worst of the best on top
+public:
+    KBest(std::size_t count) : k{count} {}
+    void offer(double d2, std::uint32_t id) {
+        if (k == 0) return;
+        if (heap.size() < k) heap.push({d2, id});
+        else if (Neighbor{d2, id} < heap.top()) { heap.pop(); heap.push({d2, id}); }
+    }
+    bool full() const { return heap.size() == k; }
+    double worst() const { return full() ? heap.top().dist2 : HUGE_VAL; }
+    std::vector<std::uint32_t> take() {
+        std::vector<Neighbor> v;
+        while (!heap.empty()) { v.push_back(heap.top()); heap.pop(); }
+        std::vector<std::uint32_t> ids;
+        for (auto it = v.rbegin(); it != v.rend(); ++it) ids.push_back(it->id);
+        return ids;  // nearest first
+    }
+};
+
+// ============================================================================
+// 1. UNIFORM HASH GRID
+// ============================================================================
+//
+// cell (cx, cy) = (floor(x / cell_size), floor(y / cell_size))
+// Only NON-EMPTY cells exist (hash map), so the world can be unbounded.
+// A Line is stored in every cell its bounding box touches.
+//
+// Queries keep no state in the grid, so many threads can query at once.
+// A Line found in several cells is reported only from ONE of them: the cell
+// holding the top-left corner of (query box ∩ line box).
+
+template <typename T>
+class UniformGrid {
+private:
+    int cell_size;
+    const std::vector<T>& items;   // the index stores ids, not copies
+    std::unordered_map<std::uint64_t, std::vector<std::uint32_t>> cells;
+    // Cells ever occupied lie in [min_cx, max_cx] x [min_cy, max_cy]; erase
+    // doesn't shrink it, which only makes nearest-neighbor rings go further
+    int min_cx = INT_MAX, max_cx = INT_MIN, min_cy = INT_MAX, max_cy = INT_MIN;
+
+    int cell_of(int v) const { return v >= 0 ? v / cell_size : -((-v - 1) / cell_size) - 1; }
+    static std::uint64_t key(int cx, int cy) {
+        return (std::uint64_t(std::uint32_t(cx)) << 32) | std::uint32_t(cy);
+    }
+
+    template <typename F>
+    void for_cells(const Box& b, F&& f) const {
+        for (int cy = cell_of(b.min_y); cy <= cell_of(b.max_y); ++cy) {
+            for (int cx = cell_of(b.min_x); cx <= cell_of(b.max_x); ++cx) f(cx, cy);
+        }
+    }
+
+    bool single_cell(const Box& b) const {
+        return cell_of(b.min_x) == cell_of(b.max_x) && cell_of(b.min_y) == cell_of(b.max_y);
+    }
+
+public:
+    UniformGrid(const std::vector<T>& data, int cell) : cell_size{cell}, items{data} {}
+
+    void insert(std::uint32_t id) {
+        Box b = bounds(items[id]);
+        min_cx = std::min(min_cx, cell_of(b.min_x));
+        max_cx = std::max(max_cx, cell_of(b.max_x));
+        min_cy = std::min(min_cy, cell_of(b.min_y));
+        max_cy = std::max(max_cy, cell_of(b.max_y));
+        for_cells(b, [&](int cx, int cy) { cells[key(cx, cy)].push_back(id); });
+    }
+
+    void erase(std::uint32_t id) {
+        for_cells(bounds(items[id]), [&](int cx, int cy) {
+            auto it = cells.find(key(cx, cy));
+            if (it == cells.end()) return;
+            auto& v = it->second;
+            auto pos = std::find(v.begin(), v.end(), id);
+            if (pos != v.end()) { *pos = v.back(); v.pop_back(); }
+            if (v.empty()) cells.erase(it);
+        });
+    }
+
+    void build() {
+        cells.clear();
+        min_cx = min_cy = INT_MAX;
+        max_cx = max_cy = INT_MIN;
+        cells.reserve(items.size() / 4);
+        for (std::uint32_t id = 0; id < items.size(); ++id) insert(id);
+    }
+
+    void query_range(const Box& q, std::vector<std::uint32_t>& out) const {
+        for_cells(q, [&](int cx, int cy) {
+            auto it = cells.find(key(cx, cy));
+            if (it == cells.end()) return;
+            for (std::uint32_t id : it->second) {
+                Box b = bounds(items[id]);
+                // Report only from the cell of the overlap's top-left corner
+                if (cell_of(std::max(q.min_x, b.min_x)) != cx) continue;
+                if (cell_of(std::max(q.min_y, b.min_y)) != cy) continue;
+                if (intersects(q, items[id])) out.push_back(id);
+            }
+        });
+    }
+
+    // Visit rings of cells around q until the k-th best is closer than any
+    // unvisited ring could be - or until the rings cover every occupied cell
+    // (k > size(): the k-th best never exists). Once a ring's perimeter has
+    // more cells than the map, the rest is read from the map instead.
+    //
+    //   ring 2: only the perimeter    # # # # #     rows cy = qy +- 2, then
+    //   is visited, the inside was    # . . . #     columns cx = qx +- 2
+    //   done by rings 0 and 1         # . q . #     between them; cells
+    //                                 # . . . #     outside the occupied
+    //                                 # # # # #     extent are skipped
+    std::vector<std::uint32_t> query_nearest(const Point& q, std::size_t k) const {
+        KBest best(k);
+        if (cells.empty()) return best.take();
+        std::vector<std::uint32_t> multi_cell_seen;  // only Lines spanning cells can repeat
+        std::int64_t qx = cell_of(q.x), qy = cell_of(q.y);
+        auto visit = [&](std::int64_t cx, std::int64_t cy) {
+            if (cx < min_cx || cx > max_cx || cy < min_cy || cy > max_cy) return;
+            auto it = cells.find(key(int(cx), int(cy)));
+            if (it == cells.end()) return;
+            for (std::uint32_t id : it->second) {
+                if (!single_cell(bounds(items[id]))) {
+                    if (std::find(multi_cell_seen.begin(), multi_cell_seen.end(), id) != multi_cell_seen.end()) continue;
+                    multi_cell_seen.push_back(id);
+                }
+                best.offer(distance2(q, items[id]), id);
+            }
+        };
+        // Rings closer than the occupied extent are empty; rings past its far
+        // side have nothing left to find
+        auto gap = [](std::int64_t v, std::int64_t lo, std::int64_t hi) {
+            return v < lo ? lo - v : v > hi ? v - hi : std::int64_t(0);
+        };
+        std::int64_t first = std::max(gap(qx, min_cx, max_cx), gap(qy, min_cy, max_cy));
+        std::int64_t last = std::max(std::max(qx - min_cx, max_cx - qx), std::max(qy - min_cy, max_cy - qy));
+        for (std::int64_t ring = first; ring <= last; ++ring) {
+            // Closest any point of ring r can be: (r - 1) full cells away
+            double reach = double(ring - 1) * cell_size;
+            if (ring > 0 && best.full() && reach * reach > best.worst()) break;
+            if (ring == 0) {
+                visit(qx, qy);
+                continue;
+            }
+            if (8 * ring > std::int64_t(cells.size())) {
+                // The perimeter has more cells than the grid holds: visit the
+                // remaining occupied cells (this ring and beyond) from the map
+                for (const auto& [cell, ids] : cells) {
+                    std::int64_t cx = std::int32_t(cell >> 32), cy = std::int32_t(std::uint32_t(cell));
+                    if (std::max(std::abs(cx - qx), std::abs(cy - qy)) >= ring) visit(cx, cy);
+                }
+                break;
+            }
+            // Clamp each side to the extent: a ring far wider than the data
+            // costs only the cells that can exist
+            std::int64_t x0 = std::max<std::int64_t>(qx - ring, min_cx), x1 = std::min<std::int64_t>(qx + ring, max_cx);
+            std::int64_t y0 = std::max<std::int64_t>(qy - ring + 1, min_cy), y1 = std::min<std::int64_t>(qy + ring - 1, max_cy);
+            for (std::int64_t cx = x0; cx <= x1; ++cx) {
+                visit(cx, qy - ring);
+                visit(cx, qy + ring);
+            }
+            for (std::int64_t cy = y0; cy <= y1; ++cy) {
+                visit(qx - ring, cy);
+                visit(qx + ring, cy);
+            }
+        }
+        return best.take();
+    }
+
+    std::size_t cell_count() const { return cells.size(); }
+};
+
+// ============================================================================
+// 2. BVH: bulk-loaded by median split, then incremental insert/erase
+// ============================================================================
+//
+// Bulk build: split items at the median of the longest axis, recurse.
+// The number of nodes for n items is known in advance, so every subtree can
+// be given its own slice of the node array -> subtrees build in PARALLEL
+// without locks.
+//
+//   nodes: [root][ left subtree ......... ][ right subtree ......... ]
+//           i     i+1                       i+1+node_count(left_n)
+
+template <typename T>
+class Bvh {
+private:
+    static constexpr std::size_t kLeafSize = 8;
+    // insert() never rebalances: sorted or collinear input keeps adding to
+    // one side (2000 diagonal points: depth 222). Past this many levels
+    // beyond a balanced tree's depth, insert rebuilds instead.
+    static constexpr int kDepthSlack = 16;
+
+    struct Node {
+        Box box = Box::none();
+        int parent = -1;
+        int left = -1;        // -1 -> leaf
+        int right = -1;
+        std::vector<std::uint32_t> ids;  // leaf items
+    };
+
+    const std::vector<T>& items;
+    std::vector<Node> nodes;
+    std::vector<Box> item_box;   // cached bounds per id
+    std::vector<int> leaf_of;    // id -> leaf node (-1 if not indexed)
+    std::size_t indexed = 0;     // ids with leaf_of >= 0
+
+    // Subtree sizes at one depth are only floor/ceil of n / 2^depth, so the
+    // memo keeps this O(log n) instead of visiting every future node
+    static std::size_t node_count(std::size_t n) {
+        static thread_local std::unordered_map<std::size_t, std::size_t> memo;
+        if (n <= kLeafSize) return 1;
+        auto it = memo.find(n);
+        if (it != memo.end()) return it->second;
+        std::size_t count = 1 + node_count(n / 2) + node_count(n - n / 2);
+        memo[n] = count;
+        return count;
+    }
+
+    // The build partitions copies of the boxes, not ids: comparing
+    // item_box[id] through an index would be a cache miss per comparison
+    struct BuildItem {
+        Box box;
+        std::uint32_t id;
+        std::int64_t center(bool x) const {
+            return x ? std::int64_t(box.min_x) + box.max_x : std::int64_t(box.min_y) + box.max_y;
+        }
+    };
+
+    // Builds the subtree for work[begin, end) into nodes[index ...]
+    void build_range(std::vector<BuildItem>& work, std::size_t begin, std::size_t end,
+                     int index, int parent, int parallel_depth) {
+        Node& node = nodes[index];
+        node.parent = parent;
+        node.box = work[begin].box;
+        for (std::size_t i = begin + 1; i < end; ++i) node.box.expand(work[i].box);
+
+        std::size_t n = end - begin;
+        if (n <= kLeafSize) {
+            for (std::size_t i = begin; i < end; ++i) {
+                node.ids.push_back(work[i].id);
+                leaf_of[work[i].id] = index;
+            }
+            return;
+        }
+
+        // Median split on the longest axis (nth_element: O(n), not a full sort)
+        bool split_x = std::int64_t(node.box.max_x) - node.box.min_x >= std::int64_t(node.box.max_y) - node.box.min_y;
+        std::size_t mid = begin + n / 2;
+        std::nth_element(work.begin() + begin, work.begin() + mid, work.begin() + end,
+                         [split_x](const BuildItem& a, const BuildItem& b) {
+                             return a.center(split_x) < b.center(split_x);
+                         });
+
+        int left = index + 1;
+        int right = left + static_cast<int>(node_count(mid - begin));
+        node.left = left;
+        node.right = right;
+
+        if (parallel_depth > 0 && n > 50000) {
+            auto task = std::async(std::launch::async, [&, left, index, parallel_depth] {
+                build_range(work, begin, mid, left, index, parallel_depth - 1);
+            });
+            build_range(work, mid, end, right, index, parallel_depth - 1);
+            task.get();
+        } else {
+            build_range(work, begin, mid, left, index, 0);
+            build_range(work, mid, end, right, index, 0);
+        }
+    }
+
+    // Recompute boxes from node upward after an insert or erase
+    void refit(int index) {
+        for (; index >= 0; index = nodes[index].parent) {
+            Node& node = nodes[index];
+            Box b = Box::none();
+            auto add = [&](const Box& o) {
+                if (o.empty()) return;
+                if (b.empty()) b = o; else b.expand(o);
+            };
+            if (node.left < 0) {
+                for (std::uint32_t id : node.ids) add(item_box[id]);
+            } else {
+                add(nodes[node.left].box);
+                add(nodes[node.right].box);
+            }
+            node.box = b;
+        }
+    }
+
+    // A leaf that grew too big becomes an inner node with two leaf children
+    void split_leaf(int index) {
+        std::vector<std::uint32_t> ids = std::move(nodes[index].ids);
+        nodes[index].ids.clear();
+        Box box = nodes[index].box;
+        bool split_x = std::int64_t(box.max_x) - box.min_x >= std::int64_t(box.max_y) - box.min_y;
+        std::sort(ids.begin(), ids.end(), [&](std::uint32_t a, std::uint32_t b) {
+            return BuildItem{item_box[a], a}.center(split_x) < BuildItem{item_box[b], b}.center(split_x);
+        });
+        int left = static_cast<int>(nodes.size());
+        int right = left + 1;
+        nodes.emplace_back();
+        nodes.emplace_back();
+        std::size_t mid = ids.size() / 2;
+        for (int side = 0; side < 2; ++side) {
+            Node& child = nodes[side == 0 ? left : right];
+            child.parent = index;
+            child.ids.assign(side == 0 ? ids.begin() : ids.begin() + mid,
+                             side == 0 ? ids.begin() + mid : ids.end());
+            for (std::uint32_t id : child.ids) leaf_of[id] = side == 0 ? left : right;
+        }
+        nodes[index].left = left;
+        nodes[index].right = right;
+        refit(left);
+        refit(right);
+    }
+
+public:
+    Bvh(const std::vector<T>& data) : items{data} {}
+
+private:
+    // Median-split bulk load of `ids` (item_box must be current for them)
+    void build_from(const std::vector<std::uint32_t>& ids) {
+        std::size_t n = ids.size();
+        leaf_of.assign(item_box.size(), -1);
+        indexed = n;
+        nodes.clear();
+        if (n == 0) return;
+        std::vector<BuildItem> work(n);
+        for (std::size_t i = 0; i < n; ++i) work[i] = {item_box[ids[i]], ids[i]};
+
+        nodes.resize(node_count(n));
+        unsigned hw = std::thread::hardware_concurrency();
+        int depth = 0;
+        while ((1u << depth) < hw) ++depth;   // 2^depth subtrees ~ one per thread
+        build_range(work, 0, n, 0, -1, depth);
+    }
+
+    // Depth of a median-split tree over n items, plus the slack
+    static int depth_limit(std::size_t n) {
+        int depth = 1;
+        for (std::size_t leaves = (n + kLeafSize - 1) / kLeafSize; leaves > 1; leaves = (leaves + 1) / 2) ++depth;
+        return depth + kDepthSlack;
+    }
+
+public:
+    // Parallel bulk load of every item in `items`
+    void build() {
+        std::size_t n = items.size();
+        item_box.resize(n);
+        std::vector<std::uint32_t> ids(n);
+        for (std::uint32_t i = 0; i < n; ++i) {
+            item_box[i] = bounds(items[i]);
+            ids[i] = i;
+        }
+        build_from(ids);
+    }
+
+    // Descend toward the child whose box grows least, add to that leaf
+    void insert(std::uint32_t id) {
+        if (item_box.size() <= id) {
+            item_box.resize(id + 1);
+            leaf_of.resize(id + 1, -1);
+        }
+        item_box[id] = bounds(items[id]);
+        if (nodes.empty()) nodes.emplace_back();
+
+        int index = 0;
+        int depth = 1;
+        while (nodes[index].left >= 0) {
+            const Node& node = nodes[index];
+            auto growth = [&](int child) {
+                Box b = nodes[child].box;
+                if (b.empty()) return 0.0;
+                double before = b.area();
+                b.expand(item_box[id]);
+                return b.area() - before;
+            };
+            index = growth(node.left) <= growth(node.right) ? node.left : node.right;
+            ++depth;
+        }
+        nodes[index].ids.push_back(id);
+        leaf_of[id] = index;
+        ++indexed;
+        refit(index);
+        if (nodes[index].ids.size() <= 2 * kLeafSize) return;
+        if (depth + 1 <= depth_limit(indexed)) {
+            split_leaf(index);
+            return;
+        }
+        // Too deep: rebuild from what's indexed. Each rebuild buys at least
+        // kDepthSlack more splits, so degenerate input pays O(n log n) every
+        // ~kDepthSlack * kLeafSize inserts instead of an ever deeper tree.
+        std::vector<std::uint32_t> ids;
+        ids.reserve(indexed);
+        for (std::uint32_t i = 0; i < leaf_of.size(); ++i)
+            if (leaf_of[i] >= 0) ids.push_back(i);
+        build_from(ids);
+    }
+
+    void erase(std::uint32_t id) {
+        if (id >= leaf_of.size() || leaf_of[id] < 0) return;
+        auto& v = nodes[leaf_of[id]].ids;
+        auto pos = std::find(v.begin(), v.end(), id);
+        if (pos != v.end()) { *pos = v.back(); v.pop_back(); }
+        refit(leaf_of[id]);
+        leaf_of[id] = -1;
+        --indexed;
+    }
+
+    void query_range(const Box& q, std::vector<std::uint32_t>& out) const {
+        if (nodes.empty()) return;
+        // Holds at most one pending sibling per level; the vector grows if
+        // a tree is ever deeper than the inline 64 (insert keeps it bounded)
+        int inline_stack[64];
+        std::vector<int> spill;
+        int top = 0;
+        auto push = [&](int index) {
+            if (top < 64) inline_stack[top] = index;
+            else spill.push_back(index);
+            ++top;
+        };
+        auto pop = [&] {
+            --top;
+            if (top < 64) return inline_stack[top];
+            int index = spill.back();
+            spill.pop_back();
+            return index;
+        };
+        push(0);
+        while (top > 0) {
+            const Node& node = nodes[pop()];
+            if (node.box.empty() || !node.box.overlaps(q)) continue;
+            if (node.left < 0) {
+                for (std::uint32_t id : node.ids) {
+                    if (intersects(q, items[id])) out.push_back(id);
+                }
+            } else {
+                push(node.left);
+                push(node.right);
+            }
+        }
+    }
+
+    // Best-first search: always expand the node closest to q; stop when the
+    // closest unexplored node is farther than the current k-th best
+    std::vector<std::uint32_t> query_nearest(const Point& q, std::size_t k) const {
+        KBest best(k);
+        if (nodes.empty()) return best.take();
+        using Entry = std::pair<double, int>;
+        std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> frontier;
+        frontier.push({nodes[0].box.distance2(q), 0});
+        while (!frontier.empty()) {
+            auto [d2, index] = frontier.top();
+            frontier.pop();
+            if (d2 > best.worst()) break;
+            const Node& node = nodes[index];
+            if (node.box.empty()) continue;
+            if (node.left < 0) {
+                for (std::uint32_t id : node.ids) best.offer(distance2(q, items[id]), id);
+            } else {
+                frontier.push({nodes[node.left].box.distance2(q), node.left});
+                frontier.push({nodes[node.right].box.distance2(q), node.right});
+            }
+        }
+        return best.take();
+    }
+
+    std::size_t size_in_nodes() const { return nodes.size(); }
+    int depth() const {
+        std::function<int(int)> d = [&](int i) {
+            return nodes[i].left < 0 ? 1 : 1 + std::max(d(nodes[i].left), d(nodes[i].right));
+        };
+        return nodes.empty() ? 0 : d(0);
+    }
+};
+
+// ============================================================================
+// BATCHED QUERIES: many independent queries -> spread over threads
+// ============================================================================
+
+// Works with both indexes: their queries don't modify the index
+template <typename Index>
+std::vector<std::vector<std::uint32_t>> query_range_batch(const Index& index, const std::vector<Box>& queries) {
+    std::vector<std::vector<std::uint32_t>> results(queries.size());
+    unsigned hw = std::thread::hardware_concurrency();
+    std::size_t threads = std::max(1u, std::min<unsigned>(hw, static_cast<unsigned>(queries.size() / 64 + 1)));
+    std::vector<std::thread> pool;
+    for (std::size_t t = 0; t < threads; ++t) {
+        pool.emplace_back([&, t] {
+            for (std::size_t i = t; i < queries.size(); i += threads) index.query_range(queries[i], results[i]);
+        });
+    }
+    for (auto& th : pool) th.join();
+    return results;
+}
+
+// ============================================================================
+// BRUTE FORCE (the baseline)
+// ============================================================================
+
+template <typename T>
+void brute_range(const std::vector<T>& items, const Box& q, std::vector<std::uint32_t>& out) {
+    for (std::uint32_t id = 0; id < items.size(); ++id) {
+        if (intersects(q, items[id])) out.push_back(id);
+    }
+}
+
+template <typename T>
+std::vector<std::uint32_t> brute_nearest(const std::vector<T>& items, const Point& q, std::size_t k) {
+    KBest best(k);
+    for (std::uint32_t id = 0; id < items.size(); ++id) best.offer(distance2(q, items[id]), id);
+    return best.take();
+}
+
+// ============================================================================
+// DEMONSTRATION + BENCHMARK
+// ============================================================================
+
+template <typename T>
+void run(const char* name, const std::vector<T>& items, int world, int cell) {
+    std::cout << "=== " << name << ": " << items.size() << " items in a "
+              << world << "x" << world << " world ===" << std::endl << std::endl;
+
+    UniformGrid<T> grid(items, cell);
+    Bvh<T> bvh(items);
+    double grid_build = time_ms([&] { grid.build(); });
+    double bvh_build = time_ms([&] { bvh.build(); });
+    std::cout << "Build: grid " << grid_build << " ms (" << grid.cell_count() << " cells), BVH "
+              << bvh_build << " ms (" << bvh.size_in_nodes() << " nodes, depth " << bvh.depth() << ")" << std::endl;
+
+    // Small query windows: output is tiny compared to N
+    Lcg rng{7};
+    std::vector<Box> queries(1000);
+    for (Box& q : queries) {
+        int x = rng.range(0, world), y = rng.range(0, world);
+        q = {x, y, x + world / 200, y + world / 200};
+    }
+
+    std::size_t brute_hits = 0, grid_hits = 0, bvh_hits = 0;
+    std::vector<std::uint32_t> out;
+    std::size_t brute_count = 50;  // brute force is slow - fewer queries, scaled below
+    double brute_ms = time_ms([&] {
+        for (std::size_t i = 0; i < brute_count; ++i) { out.clear(); brute_range(items, queries[i], out); brute_hits += out.size(); }
+    }) * (double(queries.size()) / brute_count);
+    double grid_ms = time_ms([&] {
+        for (const Box& q : queries) { out.clear(); grid.query_range(q, out); grid_hits += out.size(); }
+    });
+    double bvh_ms = time_ms([&] {
+        for (const Box& q : queries) { out.clear(); bvh.query_range(q, out); bvh_hits += out.size(); }
+    });
+    std::vector<std::vector<std::uint32_t>> batch_grid, batch_bvh;
+    double batch_grid_ms = time_ms([&] { batch_grid = query_range_batch(grid, queries); });
+    double batch_ms = time_ms([&] { batch_bvh = query_range_batch(bvh, queries); });
+
+    // Same answers? (compare the first brute_count queries as sorted id lists)
+    bool same = true;
+    for (std::size_t i = 0; i < brute_count; ++i) {
+        std::vector<std::uint32_t> a, b, c;
+        brute_range(items, queries[i], a);
+        grid.query_range(queries[i], b);
+        bvh.query_range(queries[i], c);
+        std::sort(a.begin(), a.end()); std::sort(b.begin(), b.end()); std::sort(c.begin(), c.end());
+        same = same && a == b && a == c;
+    }
+
+    std::cout << "1000 range queries (avg " << double(bvh_hits) / queries.size() << " hits each):" << std::endl;
+    std::cout << "  brute force: " << brute_ms << " ms (extrapolated from " << brute_count << ")" << std::endl;
+    std::cout << "  grid:        " << grid_ms << " ms" << std::endl;
+    std::cout << "  BVH:         " << bvh_ms << " ms" << std::endl;
+    std::cout << "  batched (" << std::thread::hardware_concurrency() << " hw threads): grid "
+              << batch_grid_ms << " ms, BVH " << batch_ms << " ms" << std::endl;
+    std::cout << "  results match brute force: " << (same ? "yes" : "NO") << std::endl;
+
+    // k nearest neighbors
+    const std::size_t k = 8;
+    Point q{world / 3, world / 3};
+    std::vector<std::uint32_t> kb, kg, kv;
+    double kb_ms = time_ms([&] { kb = brute_nearest(items, q, k); });
+    double kg_ms = time_ms([&] { kg = grid.query_nearest(q, k); });
+    double kv_ms = time_ms([&] { kv = bvh.query_nearest(q, k); });
+    auto dists = [&](const std::vector<std::uint32_t>& ids) {
+        std::vector<double> d;
+        for (std::uint32_t id : ids) d.push_back(distance2(q, items[id]));
+        return d;
+    };
+    std::cout << k << "-nearest to (" << q.x << ", " << q.y << "):" << std::endl;
+    std::cout << "  brute force: " << kb_ms << " ms, grid: " << kg_ms << " ms, BVH: " << kv_ms << " ms" << std::endl;
+    std::cout << "  distances match: " << (dists(kb) == dists(kg) && dists(kb) == dists(kv) ? "yes" : "NO") << std::endl;
+
+    // Incremental updates: erase the nearest item, it must disappear from answers
+    std::uint32_t victim = kb.front();
+    grid.erase(victim);
+    bvh.erase(victim);
+    bool gone = grid.query_nearest(q, 1).front() != victim && bvh.query_nearest(q, 1).front() != victim;
+    grid.insert(victim);
+    bvh.insert(victim);
+    bool back = dists(grid.query_nearest(q, 1)) == dists(bvh.query_nearest(q, 1)) &&
+                distance2(q, items[bvh.query_nearest(q, 1).front()]) == distance2(q, items[victim]);
+    std::cout << "Erase nearest -> gone: " << (gone ? "yes" : "NO")
+              << ", re-insert -> found again: " << (back ? "yes" : "NO") << std::endl;
+    std::cout << std::endl;
+}
+
+// Inputs that broke earlier versions: one-by-one inserts of sorted points
+// (the BVH only ever grew one side) and k larger than the data set (the
+// grid kept widening its ring, ~forever)
+bool edge_cases() {
+    std::cout << "=== Edge Cases ===" << std::endl << std::endl;
+    bool ok = true;
+    auto report = [&](const std::string& what, bool pass) {
+        std::cout << "  " << what << ": " << (pass ? "yes" : "NO") << std::endl;
+        ok = ok && pass;
+    };
+    auto sorted = [](std::vector<std::uint32_t> v) { std::sort(v.begin(), v.end()); return v; };
+
+    const char* shapes[] = {"diagonal", "vertical line"};
+    for (int shape = 0; shape < 2; ++shape) {
+        std::vector<Point> pts(2000);
+        for (int i = 0; i < 2000; ++i) pts[i] = shape == 0 ? Point{i * 10, i * 10} : Point{500, i * 3};
+        Bvh<Point> bvh(pts);
+        for (std::uint32_t id = 0; id < pts.size(); ++id) bvh.insert(id);
+        Box q = {0, 0, 12000, 3000};
+        std::vector<std::uint32_t> a, b;
+        brute_range(pts, q, a);
+        bvh.query_range(q, b);
+        Point near{700, 2500};
+        std::cout << "  2000 " << shapes[shape] << " points inserted one by one: BVH depth " << bvh.depth() << std::endl;
+        report("    depth stays below 64", bvh.depth() < 64);
+        report("    range query matches brute force", sorted(a) == sorted(b));
+        report("    8-nearest matches brute force", bvh.query_nearest(near, 8) == brute_nearest(pts, near, 8));
+    }
+
+    std::vector<Point> few = {{10, 10}, {50, 40}, {900, 900}};
+    UniformGrid<Point> grid(few, 16);
+    grid.build();
+    std::vector<std::uint32_t> got;
+    double ms = time_ms([&] { got = grid.query_nearest({0, 0}, 8); });
+    std::cout << "  grid, 3 points, k = 8: " << got.size() << " found in " << ms << " ms" << std::endl;
+    report("    returns all 3, nearest first", got == brute_nearest(few, {0, 0}, 8));
+
+    std::vector<Point> far = {{0, 0}, {1 << 30, 1 << 30}, {-(1 << 30), 5}};
+    UniformGrid<Point> sparse(far, 1);
+    sparse.build();
+    ms = time_ms([&] { got = sparse.query_nearest({3, 3}, 5); });
+    std::cout << "  grid with cell size 1, points 2^30 apart, k = 5: " << got.size() << " found in " << ms << " ms"
+              << std::endl;
+    report("    returns all 3, nearest first", got == brute_nearest(far, {3, 3}, 5));
+    std::cout << std::endl;
+    return ok;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Spatial Index: Uniform Grid + BVH for Point and Line ===" << std::endl << std::endl;
+
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int world = 1 << 20;
+    Lcg rng{42};
+
+    std::vector<Point> points(n);
+    for (Point& p : points) p = {rng.range(0, world), rng.range(0, world)};
+
+    std::vector<Line> lines(n / 4);
+    for (Line& l : lines) {
+        int x = rng.range(0, world), y = rng.range(0, world);
+        l = {{x, y}, {x + rng.range(-2000, 2000), y + rng.range(-2000, 2000)}};
+    }
+
+    bool edges_ok = edge_cases();
+    run("Points", points, world, 2048);
+    run("Lines", lines, world, 4096);
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• Brute force cost grows with N; index cost grows with the answer size" << std::endl;
+    std::cout << "• Grid: O(1) insert/erase, best when data is spread evenly" << std::endl;
+    std::cout << "• BVH: adapts to clustered data; bulk build splits into parallel subtrees" << std::endl;
+    std::cout << "• kNN: stop as soon as nothing unexplored can beat the current k-th best" << std::endl;
+    std::cout << "• Incremental inserts need a depth limit: sorted input turns a BVH into a list" << std::endl;
+
+    return edges_ok ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+// spsc_ring.h - single-producer/single-consumer ring buffer for trivially copyable items
+//
+// One thread pushes (the sensor feed), one thread pops (the processing stage).
+// With exactly one writer per counter no CAS is needed: the producer owns
+// `head`, the consumer owns `tail`, and an item changes hands with ONE release
+// store. The same design as shm_channel.c, but in-process and typed.
+//
+//   cache line 0:  head              written by the producer, read by the consumer
+//   cache line 1:  tail              written by the consumer, read by the producer
+//   cache line 2:  cached_tail       producer-private copy of tail
+//   cache line 3:  cached_head       consumer-private copy of head
+//   cache line 4:  consumer_waiting  (futex mode only)
+//   cache line 5:  producer_waiting  (futex mode only)
+//   slots[capacity]
+//
+// Without the padding, head and tail share a line and every push invalidates
+// the consumer's copy of it (false sharing). Without the cached copies, every
+// push reads tail - a cache miss whenever the consumer has moved it.
+//
+// Batching: push_n()/pop_n() move up to N items with one or two memcpy()s and
+// ONE counter store, so the per-item handoff cost (the cache-line transfer of
+// head/tail) is paid once per batch instead of once per item.
+//
+// Waiting, when the ring is full or empty:
+//   WaitMode::BusyPoll  spin on the counter with a pause instruction. Lowest
+//                       latency, but burns a whole core: give each side its own
+//   WaitMode::Futex     spin briefly (only with more than one CPU online), then
+//                       sleep in the kernel; the other side wakes it only if
+//                       its waiting flag is set, so the fast path makes no
+//                       syscall
+//
+// Counters are free-running 32-bit values (futex words are 32-bit); with a
+// power-of-two capacity, head - tail is correct across wrap-around.
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPSC_CPU_RELAX() _mm_pause()
+#elif defined(__aarch64__)
+#define SPSC_CPU_RELAX() asm volatile("yield")
+#else
+#define SPSC_CPU_RELAX() ((void)0)
+#endif
+
+enum class WaitMode { BusyPoll, Futex };
+
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable_v<T>, "items are moved with memcpy");
+
+public:
+    static constexpr std::size_t kCacheLine = 64;
+
+    // Capacity is rounded up to a power of two (at least 2, at most 2^31)
+    explicit SpscRing(std::size_t capacity, WaitMode mode = WaitMode::Futex) : mode_(mode) {
+        std::size_t cap = 2;
+        while (cap < capacity && cap < (std::size_t(1) << 31)) cap <<= 1;
+        cap_ = std::uint32_t(cap);
+        mask_ = cap_ - 1;
+        std::size_t bytes = (cap * sizeof(T) + kCacheLine - 1) / kCacheLine * kCacheLine;
+        slots_ = static_cast<T*>(std::aligned_alloc(kCacheLine, bytes));
+        if (!slots_) throw std::bad_alloc();
+        spin_limit_ = mode == WaitMode::Futex && sysconf(_SC_NPROCESSORS_ONLN) > 1 ? 2000 : 0;
+    }
+
+    ~SpscRing() { std::free(slots_); }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    std::size_t capacity() const { return cap_; }
+    WaitMode mode() const { return mode_; }
+
+    // Approximate (the other side may be moving): for monitoring only
+    std::size_t size() const {
+        return std::uint32_t(head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire));
+    }
+
+    // ----- Producer -----
+
+    // Push up to n items without waiting; returns how many were pushed
+    std::size_t try_push_n(const T* items, std::size_t n) {
+        const std::uint32_t h = head_.load(std::memory_order_relaxed);
+        std::size_t free = cap_ - (h - cached_tail_);
+        if (free < n) {  // looks full: only now look at the consumer's counter
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            free = cap_ - (h - cached_tail_);
+        }
+        n = std::min(n, free);
+        if (n == 0) return 0;
+
+        std::size_t first = std::min<std::size_t>(n, cap_ - (h & mask_));  // up to the end of the array
+        std::memcpy(slots_ + (h & mask_), items, first * sizeof(T));
+        std::memcpy(slots_, items + first, (n - first) * sizeof(T));
+        publish(head_, h + std::uint32_t(n), consumer_waiting_);
+        return n;
+    }
+
+    bool try_push(const T& item) { return try_push_n(&item, 1) == 1; }
+
+    // Push all n items, waiting for room as the mode says
+    void push_n(const T* items, std::size_t n) {
+        while (n > 0) {
+            std::size_t done = try_push_n(items, n);
+            items += done;
+            n -= done;
+            if (n > 0) wait_while_equal(tail_, cached_tail_, producer_waiting_);  // full: wait for the consumer
+        }
+    }
+
+    void push(const T& item) { push_n(&item, 1); }
+
+    // ----- Consumer -----
+
+    // Pop up to max items without waiting; returns how many were popped
+    std::size_t try_pop_n(T* out, std::size_t max) {
+        const std::uint32_t t = tail_.load(std::memory_order_relaxed);
+        std::size_t avail = cached_head_ - t;
+        if (avail < max) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            avail = cached_head_ - t;
+        }
+        std::size_t n = std::min(max, avail);
+        if (n == 0) return 0;
+
+        std::size_t first = std::min<std::size_t>(n, cap_ - (t & mask_));
+        std::memcpy(out, slots_ + (t & mask_), first * sizeof(T));
+        std::memcpy(out + first, slots_, (n - first) * sizeof(T));
+        publish(tail_, t + std::uint32_t(n), producer_waiting_);
+        return n;
+    }
+
+    bool try_pop(T& out) { return try_pop_n(&out, 1) == 1; }
+
+    // Wait until at least one item is available, then pop up to max
+    std::size_t pop_n(T* out, std::size_t max) {
+        while (true) {
+            std::size_t n = try_pop_n(out, max);
+            if (n > 0) return n;
+            wait_while_equal(head_, cached_head_, consumer_waiting_);  // empty: wait for the producer
+        }
+    }
+
+    T pop() {
+        T item;
+        pop_n(&item, 1);
+        return item;
+    }
+
+    // Number of futex sleeps so far (both sides): 0 means every handoff was a spin
+    std::uint64_t sleeps() const { return sleeps_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(kCacheLine) std::atomic<std::uint32_t> head_{0};
+    alignas(kCacheLine) std::atomic<std::uint32_t> tail_{0};
+    alignas(kCacheLine) std::uint32_t cached_tail_ = 0;  // producer only
+    alignas(kCacheLine) std::uint32_t cached_head_ = 0;  // consumer only
+    alignas(kCacheLine) std::atomic<std::uint32_t> consumer_waiting_{0};
+    alignas(kCacheLine) std::atomic<std::uint32_t> producer_waiting_{0};
+    alignas(kCacheLine) T* slots_ = nullptr;
+    std::uint32_t cap_ = 0;
+    std::uint32_t mask_ = 0;
+    WaitMode mode_;
+    int spin_limit_ = 0;
+    std::atomic<std::uint64_t> sleeps_{0};
+
+    // Store our counter; in futex mode wake the other side if it sleeps on it.
+    // seq_cst store + seq_cst flag load pair with the waiter's seq_cst flag
+    // store + counter load: one of the two always sees the other (Dekker).
+    void publish(std::atomic<std::uint32_t>& counter, std::uint32_t value, std::atomic<std::uint32_t>& waiting) {
+        if (mode_ == WaitMode::BusyPoll) {
+            counter.store(value, std::memory_order_release);
+            return;
+        }
+        counter.store(value, std::memory_order_seq_cst);
+        // exchange: only the first publish after the other side fell asleep
+        // pays for the syscall, not every publish until it gets to run
+        if (waiting.load(std::memory_order_seq_cst) && waiting.exchange(0, std::memory_order_seq_cst)) {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&counter), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+        }
+    }
+
+    // Wait while the other side's counter still equals `seen`
+    void wait_while_equal(std::atomic<std::uint32_t>& counter, std::uint32_t seen, std::atomic<std::uint32_t>& waiting) {
+        if (mode_ == WaitMode::BusyPoll) {
+            while (counter.load(std::memory_order_acquire) == seen) SPSC_CPU_RELAX();
+            return;
+        }
+        for (int i = 0; i < spin_limit_; ++i) {
+            if (counter.load(std::memory_order_acquire) != seen) return;
+            SPSC_CPU_RELAX();
+        }
+        while (true) {
+            waiting.store(1, std::memory_order_seq_cst);
+            if (counter.load(std::memory_order_seq_cst) != seen) break;
+            sleeps_.fetch_add(1, std::memory_order_relaxed);
+            // Returns at once (EAGAIN) if the counter already changed: no lost wakeup
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&counter), FUTEX_WAIT_PRIVATE, seen, nullptr, nullptr, 0);
+        }
+        waiting.store(0, std::memory_order_relaxed);
+    }
+};
+
+#endif  // SPSC_RING_H
@@ -0,0 +1,318 @@
+// SpscRing: streaming Point feeds from a producer thread to a processing thread
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "bench_util.h"
+#include "c_functions.h"  // struct Point
+#include "spsc_ring.h"
+
+// ============================================================================
+// WHAT IS COMPARED
+// ============================================================================
+// The sensor feed hands Points to the processing thread one at a time.
+//
+//   mutex + deque     lock, push_back, notify; the consumer locks to pop
+//   naive ring        head and tail in one cache line, no cached counters:
+//                     every push/pop reads the other side's counter
+//   SpscRing, 1       padded counters + cached copies, one item per handoff
+//   SpscRing, N       push_n/pop_n: N items per counter store
+//
+// Per-item handoff cost = moving the counter's cache line between cores.
+// Batching divides it by N; that is the only way under the floor.
+
+std::int64_t now_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+const char* mode_name(WaitMode mode) { return mode == WaitMode::BusyPoll ? "busy-poll" : "futex"; }
+
+// ============================================================================
+// BASELINES
+// ============================================================================
+
+template <typename T>
+class MutexQueue {
+public:
+    void push(const T& item) {
+        {
+            std::lock_guard<std::mutex> lock(m_);
+            q_.push_back(item);
+        }
+        cv_.notify_one();
+    }
+    T pop() {
+        std::unique_lock<std::mutex> lock(m_);
+        cv_.wait(lock, [&] { return !q_.empty(); });
+        T item = q_.front();
+        q_.pop_front();
+        return item;
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    std::deque<T> q_;
+};
+
+// The textbook ring: correct, but head and tail share a cache line and each
+// operation reads the other side's counter
+template <typename T>
+class NaiveRing {
+public:
+    explicit NaiveRing(std::uint32_t capacity) : slots_(capacity), mask_(capacity - 1) {}
+    void push(const T& item) {
+        std::uint32_t h = head_.load(std::memory_order_relaxed);
+        while (h - tail_.load(std::memory_order_acquire) == slots_.size()) std::this_thread::yield();
+        slots_[h & mask_] = item;
+        head_.store(h + 1, std::memory_order_release);
+    }
+    T pop() {
+        std::uint32_t t = tail_.load(std::memory_order_relaxed);
+        while (head_.load(std::memory_order_acquire) == t) std::this_thread::yield();
+        T item = slots_[t & mask_];
+        tail_.store(t + 1, std::memory_order_release);
+        return item;
+    }
+
+private:
+    std::atomic<std::uint32_t> head_{0};
+    std::atomic<std::uint32_t> tail_{0};
+    std::vector<T> slots_;
+    std::uint32_t mask_;
+};
+
+// ============================================================================
+// CORRECTNESS
+// ============================================================================
+
+// Small ring (lots of wrap-around and full/empty waits), ragged batch sizes
+bool stream_points(WaitMode mode, long n) {
+    SpscRing<Point> ring(64, mode);
+    std::thread producer([&] {
+        Point batch[37];
+        long next = 0;
+        std::size_t size = 1;
+        while (next < n) {
+            std::size_t k = std::min<long>(long(size), n - next);
+            for (std::size_t i = 0; i < k; ++i) batch[i] = Point{int(next + long(i)), -int(next + long(i))};
+            ring.push_n(batch, k);
+            next += long(k);
+            size = size % 37 + 1;
+        }
+    });
+    bool ok = true;
+    long expected = 0;
+    Point out[50];
+    std::size_t max = 1;
+    while (expected < n) {
+        std::size_t k = ring.pop_n(out, max);
+        for (std::size_t i = 0; i < k; ++i, ++expected) {
+            ok &= out[i].x == int(expected) && out[i].y == -int(expected);
+        }
+        max = max % 50 + 1;
+    }
+    producer.join();
+    return ok && ring.size() == 0;
+}
+
+bool stream_doubles(WaitMode mode, long n) {
+    SpscRing<double> ring(1024, mode);
+    std::thread producer([&] {
+        for (long i = 0; i < n; ++i) ring.push(0.5 * double(i));
+    });
+    double sum = 0;
+    bool in_order = true;
+    for (long i = 0; i < n; ++i) {
+        double v = ring.pop();
+        in_order &= v == 0.5 * double(i);
+        sum += v;
+    }
+    producer.join();
+    return in_order && sum == 0.25 * double(n) * double(n - 1);
+}
+
+void correctness() {
+    std::cout << "=== Correctness ===" << std::endl;
+    for (WaitMode mode : {WaitMode::Futex, WaitMode::BusyPoll}) {
+        std::string m = mode_name(mode);
+        check(stream_points(mode, 200000), m + ": 200000 Points in order through a 64-slot ring, batches 1..37 / 1..50");
+        check(stream_doubles(mode, 200000), m + ": 200000 doubles in order, sum exact");
+    }
+
+    SpscRing<Point> ring(5);
+    check(ring.capacity() == 8, "capacity rounds up to a power of two (5 -> 8)");
+    Point pts[10];
+    for (int i = 0; i < 10; ++i) pts[i] = Point{i, i};
+    check(ring.try_push_n(pts, 10) == 8, "try_push_n on an empty ring of 8 accepts 8 of 10");
+    check(!ring.try_push(pts[0]), "try_push on a full ring fails");
+    Point out[10];
+    check(ring.try_pop_n(out, 3) == 3 && out[2].x == 2, "try_pop_n takes the oldest 3");
+    check(ring.try_push_n(pts + 8, 2) == 2, "room for 2 more after popping (wraps around)");
+    check(ring.try_pop_n(out, 10) == 7 && out[0].x == 3 && out[6].x == 9, "the rest come out in order across the wrap");
+    check(!ring.try_pop(out[0]), "try_pop on an empty ring fails");
+
+    std::cout << "  sizeof(SpscRing<Point>) = " << sizeof(SpscRing<Point>) << " bytes (counters on separate "
+              << SpscRing<Point>::kCacheLine << "-byte lines)" << std::endl;
+}
+
+// ============================================================================
+// THROUGHPUT
+// ============================================================================
+
+void report(const std::string& name, long n, double ms, bool ok, std::uint64_t sleeps = 0) {
+    std::cout << "  " << name << std::string(name.size() < 32 ? 32 - name.size() : 1, ' ') << ms << " ms  "
+              << double(n) / ms / 1000.0 << " M items/s";
+    if (sleeps) std::cout << "  (" << sleeps << " futex sleeps)";
+    std::cout << (ok ? "" : "  WRONG RESULT") << std::endl;
+}
+
+template <typename Queue>
+void bench_per_item(const std::string& name, Queue& q, long n) {
+    long long sum = 0;
+    double ms = time_ms([&] {
+        std::thread producer([&] {
+            for (long i = 0; i < n; ++i) q.push(Point{int(i), 1});
+        });
+        for (long i = 0; i < n; ++i) sum += q.pop().x;
+        producer.join();
+    });
+    report(name, n, ms, sum == (long long)n * (n - 1) / 2);
+}
+
+void bench_ring(WaitMode mode, std::size_t batch, long n) {
+    SpscRing<Point> ring(4096, mode);
+    long long sum = 0;
+    double ms = time_ms([&] {
+        std::thread producer([&] {
+            std::vector<Point> buf(batch);
+            for (long i = 0; i < n;) {
+                std::size_t k = std::min<long>(long(batch), n - i);
+                for (std::size_t j = 0; j < k; ++j) buf[j] = Point{int(i + long(j)), 1};
+                ring.push_n(buf.data(), k);
+                i += long(k);
+            }
+        });
+        std::vector<Point> out(batch);
+        for (long got = 0; got < n;) {
+            std::size_t k = ring.pop_n(out.data(), batch);
+            for (std::size_t j = 0; j < k; ++j) sum += out[j].x;
+            got += long(k);
+        }
+        producer.join();
+    });
+    report(std::string("SpscRing ") + mode_name(mode) + ", batch " + std::to_string(batch), n, ms,
+           sum == (long long)n * (n - 1) / 2, ring.sleeps());
+}
+
+// ============================================================================
+// LATENCY UNDER LOAD
+// ============================================================================
+// The producer emits one Point every `gap_ns` (a steady feed, not a flood),
+// stamped with the time it was produced. The consumer records how long each
+// stamp waited. With batching the producer flushes every `batch` items, so
+// the first item of a batch also waits for the rest to be produced.
+
+struct Stamped {
+    Point p;
+    std::int64_t produced_ns;
+};
+
+void bench_latency(WaitMode mode, std::size_t batch, long n, std::int64_t gap_ns) {
+    SpscRing<Stamped> ring(4096, mode);
+    std::vector<std::int64_t> waits;
+    waits.reserve(std::size_t(n));
+
+    std::thread producer([&] {
+        std::vector<Stamped> buf(batch);
+        std::size_t filled = 0;
+        std::int64_t next = now_ns();
+        for (long i = 0; i < n; ++i) {
+            while (now_ns() < next) SPSC_CPU_RELAX();
+            next += gap_ns;
+            buf[filled++] = Stamped{Point{int(i), 0}, now_ns()};
+            if (filled == batch || i == n - 1) {
+                ring.push_n(buf.data(), filled);
+                filled = 0;
+            }
+        }
+    });
+    Stamped out[256];
+    for (long got = 0; got < n;) {
+        std::size_t k = ring.pop_n(out, 256);
+        std::int64_t now = now_ns();
+        for (std::size_t j = 0; j < k; ++j) waits.push_back(now - out[j].produced_ns);
+        got += long(k);
+    }
+    producer.join();
+
+    std::sort(waits.begin(), waits.end());
+    auto pct = [&](double p) { return waits[std::min(waits.size() - 1, std::size_t(p * double(waits.size())))]; };
+    std::string name = std::string(mode_name(mode)) + ", batch " + std::to_string(batch);
+    std::cout << "  " << name << std::string(name.size() < 20 ? 20 - name.size() : 1, ' ') << "p50 " << pct(0.50)
+              << " ns  p90 " << pct(0.90) << " ns  p99 " << pct(0.99) << " ns  p99.9 " << pct(0.999)
+              << " ns  max " << waits.back() << " ns  (" << ring.sleeps() << " sleeps)" << std::endl;
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== SPSC Ring Buffer for Streaming Point Feeds ===" << std::endl;
+    std::cout << std::endl;
+
+    long n = argc > 1 ? std::atol(argv[1]) : 5000000;
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    std::cout << "CPUs online: " << cpus << std::endl;
+    if (cpus < 2) {
+        std::cout << "(1 CPU: producer and consumer take turns, so every handoff is a context switch" << std::endl;
+        std::cout << " and busy-polling only burns the other side's time slice - run on 2+ cores" << std::endl;
+        std::cout << " for the real picture)" << std::endl;
+    }
+    std::cout << std::endl;
+
+    correctness();
+
+    std::cout << std::endl << "=== Throughput: " << n << " Points producer -> consumer ===" << std::endl;
+    {
+        MutexQueue<Point> q;
+        bench_per_item("mutex + deque, per item", q, n);
+    }
+    {
+        NaiveRing<Point> q(4096);
+        bench_per_item("naive ring, per item", q, n);
+    }
+    for (std::size_t batch : {1, 16, 256}) bench_ring(WaitMode::Futex, batch, n);
+    long spin_n = cpus < 2 ? n / 10 : n;  // each wait burns a whole time slice on 1 CPU
+    if (spin_n != n) std::cout << "  (busy-poll with " << spin_n << " Points)" << std::endl;
+    for (std::size_t batch : {1, 16, 256}) bench_ring(WaitMode::BusyPoll, batch, spin_n);
+
+    const long feed = 200000;
+    const std::int64_t gap_ns = 1000;
+    std::cout << std::endl << "=== Latency under load: " << feed << " Points, one every " << gap_ns
+              << " ns ===" << std::endl;
+    for (WaitMode mode : {WaitMode::Futex, WaitMode::BusyPoll}) {
+        for (std::size_t batch : {1, 16}) bench_latency(mode, batch, feed, gap_ns);
+    }
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• One writer per counter: a handoff is one release store, no CAS, no lock" << std::endl;
+    std::cout << "• head and tail on separate cache lines, plus cached copies: the other side's" << std::endl;
+    std::cout << "  line is read only when the ring looks full/empty" << std::endl;
+    std::cout << "• push_n/pop_n pay the cache-line handoff once per batch - the way under the" << std::endl;
+    std::cout << "  per-item floor, at the price of batching delay at low feed rates" << std::endl;
+    std::cout << "• Busy-poll: lowest latency with a dedicated core, a disaster without one" << std::endl;
+    std::cout << "• Futex: sleep only when idle, wake only a sleeper - no syscall in the fast path" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,384 @@
+#include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "bench_util.h"
+
+// ============================================================================
+// FROM "PRINT A LINE" TO "PUT PIXELS IN MEMORY"
+// ============================================================================
+//
+// In concrete_vs_abstract.cpp, draw() just prints:
+//   void draw() override { std::cout << "Circle" << std::endl; }
+//
+// Here draw() RECORDS the shape into a rasterizer. Nothing is filled yet.
+// Filling happens later, all at once, split into screen TILES:
+//
+//   Framebuffer (e.g. 1920 x 1080), cut into 64x64 tiles:
+//   ┌──────┬──────┬──────┬──────┐
+//   │ T0   │ T1   │ T2   │ T3   │   1. BIN:  each primitive's bounding box
+//   ├──────┼──────┼──────┼──────┤            is added to every tile it touches
+//   │ T4   │ T5 ● │ T6   │ T7   │   2. FILL: each worker thread grabs a tile
+//   ├──────┼──────┼──────┼──────┤            and fills its primitives in order
+//   │ T8   │ T9   │ ...  │      │
+//   └──────┴──────┴──────┴──────┘
+//
+// Why tiles?
+//   - A 64x64 tile of 32-bit pixels is 16 KB: it stays in L1/L2 while filled
+//   - Two threads never write the same tile -> no locks, no false sharing
+//   - Primitives are filled in submission order inside a tile -> same image
+//     no matter how many threads run (deterministic painter's algorithm)
+
+constexpr int kTileSize = 64;
+
+struct Color {
+    std::uint8_t r, g, b;
+    std::uint32_t packed() const { return r | (g << 8) | (b << 16) | 0xFF000000u; }
+};
+
+// ============================================================================
+// PRIMITIVES: plain data, no virtual functions
+// ============================================================================
+//
+// The per-object virtual call happens ONCE, when the shape records itself.
+// The hot loop only sees this flat struct.
+
+struct Primitive {
+    enum Kind : std::uint8_t { CIRCLE, RECT } kind;
+    float a, b, c, d;          // circle: cx, cy, radius, -   rect: x0, y0, x1, y1
+    std::uint32_t color;
+    int min_x, min_y, max_x, max_y;  // pixel bounding box (inclusive)
+};
+
+// ============================================================================
+// SPAN KERNEL: fill pixels [x0, x1) on one row with one color
+// ============================================================================
+//
+// Both circles and rectangles reduce to horizontal spans, so this is the
+// only loop that touches pixels. With SSE2 we store 4 pixels per instruction.
+
+inline void fill_span(std::uint32_t* row, int x0, int x1, std::uint32_t color) {
+    int x = x0;
+#if defined(__SSE2__)
+    __m128i v = _mm_set1_epi32(static_cast<int>(color));
+    for (; x + 4 <= x1; x += 4) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(row + x), v);
+    }
+#endif
+    for (; x < x1; ++x) row[x] = color;
+}
+
+// ============================================================================
+// FRAMEBUFFER + RASTERIZER
+// ============================================================================
+
+class Framebuffer {
+private:
+    int w;
+    int h;
+    std::vector<std::uint32_t> pixels;
+public:
+    Framebuffer(int width, int height) : w{width}, h{height}, pixels(std::size_t(width) * height) {}
+
+    int width() const { return w; }
+    int height() const { return h; }
+    std::uint32_t* row(int y) { return pixels.data() + std::size_t(y) * w; }
+
+    void clear(Color c) { std::fill(pixels.begin(), pixels.end(), c.packed()); }
+
+    // PPM (P6): tiny header + raw RGB bytes. Any image viewer opens it,
+    // and `convert out.ppm out.png` turns it into a PNG.
+    bool write_ppm(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) return false;
+        out << "P6\n" << w << " " << h << "\n255\n";
+        std::vector<char> rgb(std::size_t(w) * h * 3);
+        for (std::size_t i = 0; i < pixels.size(); ++i) {
+            rgb[i * 3 + 0] = static_cast<char>(pixels[i] & 0xFF);
+            rgb[i * 3 + 1] = static_cast<char>((pixels[i] >> 8) & 0xFF);
+            rgb[i * 3 + 2] = static_cast<char>((pixels[i] >> 16) & 0xFF);
+        }
+        out.write(rgb.data(), static_cast<std::streamsize>(rgb.size()));
+        return static_cast<bool>(out);
+    }
+
+    std::uint64_t checksum() const {
+        std::uint64_t h64 = 1469598103934665603ull;  // FNV-1a
+        for (std::uint32_t p : pixels) h64 = (h64 ^ p) * 1099511628211ull;
+        return h64;
+    }
+};
+
+class Rasterizer {
+private:
+    Framebuffer& fb;
+    int tiles_x;
+    int tiles_y;
+    std::vector<Primitive> prims;
+    std::vector<std::vector<std::uint32_t>> bins;  // per tile: indices into prims
+
+    // Clamp in float, then convert: a float outside int's range (a huge
+    // radius, a shape far off-screen) makes static_cast<int> undefined
+    static int to_pixel(float v, int lo, int hi) {
+        return static_cast<int>(std::clamp(v, static_cast<float>(lo), static_cast<float>(hi)));
+    }
+
+    // Bounding box in pixels, one pixel of slack past each edge so that
+    // record() still sees a shape entirely off-screen as empty
+    int px(float v) const { return to_pixel(v, -1, fb.width()); }
+    int py(float v) const { return to_pixel(v, -1, fb.height()); }
+
+    void record(Primitive p) {
+        p.min_x = std::max(p.min_x, 0);
+        p.min_y = std::max(p.min_y, 0);
+        p.max_x = std::min(p.max_x, fb.width() - 1);
+        p.max_y = std::min(p.max_y, fb.height() - 1);
+        if (p.min_x > p.max_x || p.min_y > p.max_y) return;  // fully off-screen
+        prims.push_back(p);
+    }
+
+    // STEP 1: BIN - add every primitive to each tile its bounding box touches
+    void bin() {
+        for (auto& b : bins) b.clear();
+        for (std::uint32_t i = 0; i < prims.size(); ++i) {
+            const Primitive& p = prims[i];
+            for (int ty = p.min_y / kTileSize; ty <= p.max_y / kTileSize; ++ty) {
+                for (int tx = p.min_x / kTileSize; tx <= p.max_x / kTileSize; ++tx) {
+                    bins[std::size_t(ty) * tiles_x + tx].push_back(i);
+                }
+            }
+        }
+    }
+
+    // STEP 2: FILL one tile - every primitive is clipped to the tile rectangle
+    void fill_tile(int tile) {
+        int tx0 = (tile % tiles_x) * kTileSize;
+        int ty0 = (tile / tiles_x) * kTileSize;
+        int tx1 = std::min(tx0 + kTileSize, fb.width());
+        int ty1 = std::min(ty0 + kTileSize, fb.height());
+
+        for (std::uint32_t idx : bins[tile]) {
+            const Primitive& p = prims[idx];
+            int y0 = std::max(ty0, p.min_y);
+            int y1 = std::min(ty1, p.max_y + 1);
+
+            if (p.kind == Primitive::RECT) {
+                int x0 = std::max(tx0, p.min_x);
+                int x1 = std::min(tx1, p.max_x + 1);
+                for (int y = y0; y < y1; ++y) fill_span(fb.row(y), x0, x1, p.color);
+                continue;
+            }
+
+            // CIRCLE: a pixel center (x+0.5, y+0.5) is inside when
+            // (x+0.5-cx)^2 + (y+0.5-cy)^2 <= r^2  -> solve for the x range per row
+            float cx = p.a, cy = p.b, r2 = p.c * p.c;
+            for (int y = y0; y < y1; ++y) {
+                float dy = (y + 0.5f) - cy;
+                float rem = r2 - dy * dy;
+                if (rem < 0.0f) continue;
+                float half = std::sqrt(rem);
+                int x0 = to_pixel(std::ceil(cx - half - 0.5f), tx0, tx1);
+                int x1 = to_pixel(std::floor(cx + half - 0.5f) + 1.0f, tx0, tx1);
+                if (x0 < x1) fill_span(fb.row(y), x0, x1, p.color);
+            }
+        }
+    }
+
+public:
+    Rasterizer(Framebuffer& target)
+        : fb{target},
+          tiles_x{(target.width() + kTileSize - 1) / kTileSize},
+          tiles_y{(target.height() + kTileSize - 1) / kTileSize},
+          bins(std::size_t(tiles_x) * tiles_y) {}
+
+    void add_circle(float cx, float cy, float r, Color c) {
+        if (!std::isfinite(cx) || !std::isfinite(cy) || !std::isfinite(r)) return;  // NaN has no clamp
+        record({Primitive::CIRCLE, cx, cy, r, 0.0f, c.packed(),
+                px(std::floor(cx - r)), py(std::floor(cy - r)),
+                px(std::ceil(cx + r)), py(std::ceil(cy + r))});
+    }
+
+    void add_rect(float x, float y, float w, float h, Color c) {
+        if (!std::isfinite(x) || !std::isfinite(y) || !std::isfinite(w) || !std::isfinite(h)) return;
+        // Pixel (px, py) is covered when its center lies inside [x, x+w) x [y, y+h)
+        int px0 = px(std::ceil(x - 0.5f));
+        int py0 = py(std::ceil(y - 0.5f));
+        int px1 = px(std::ceil(x + w - 0.5f) - 1.0f);
+        int py1 = py(std::ceil(y + h - 0.5f) - 1.0f);
+        record({Primitive::RECT, x, y, x + w, y + h, c.packed(), px0, py0, px1, py1});
+    }
+
+    std::size_t primitive_count() const { return prims.size(); }
+    void reset() { prims.clear(); }
+
+    // Bin, then let worker threads pull tiles from a shared atomic counter
+    // (work stealing in its simplest form: busy tiles don't block idle threads)
+    void flush(int thread_count) {
+        bin();
+        int tile_count = tiles_x * tiles_y;
+        std::atomic<int> next{0};
+        auto worker = [&] {
+            for (int t = next.fetch_add(1); t < tile_count; t = next.fetch_add(1)) {
+                fill_tile(t);
+            }
+        };
+
+        std::vector<std::thread> threads;
+        for (int i = 1; i < thread_count; ++i) threads.emplace_back(worker);
+        worker();  // the calling thread works too
+        for (auto& th : threads) th.join();
+    }
+};
+
+// ============================================================================
+// SHAPES: draw() now records into a Rasterizer instead of printing
+// ============================================================================
+
+class Shape {  // Abstract type
+public:
+    virtual void draw(Rasterizer& r) const = 0;
+    virtual ~Shape() {}
+};
+
+class Circle : public Shape {
+    float x, y, radius;
+    Color color;
+public:
+    Circle(float cx, float cy, float r, Color c) : x{cx}, y{cy}, radius{r}, color{c} {}
+    void draw(Rasterizer& r) const override { r.add_circle(x, y, radius, color); }
+};
+
+class Rectangle : public Shape {
+    float x, y, width, height;
+    Color color;
+public:
+    Rectangle(float px, float py, float w, float h, Color c)
+        : x{px}, y{py}, width{w}, height{h}, color{c} {}
+    void draw(Rasterizer& r) const override { r.add_rect(x, y, width, height, color); }
+};
+
+// ============================================================================
+// DEMONSTRATION
+// ============================================================================
+
+// Lcg is deterministic: every run draws the same scene
+std::vector<Circle> make_circles(std::size_t n, int w, int h, Lcg& rng) {
+    std::vector<Circle> v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Color c{static_cast<std::uint8_t>(rng.next()), static_cast<std::uint8_t>(rng.next()),
+                static_cast<std::uint8_t>(rng.next())};
+        v.emplace_back(rng.uniform(0, w), rng.uniform(0, h), rng.uniform(1, 12), c);
+    }
+    return v;
+}
+
+std::vector<Rectangle> make_rects(std::size_t n, int w, int h, Lcg& rng) {
+    std::vector<Rectangle> v;
+    v.reserve(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        Color c{static_cast<std::uint8_t>(rng.next()), static_cast<std::uint8_t>(rng.next()),
+                static_cast<std::uint8_t>(rng.next())};
+        v.emplace_back(rng.uniform(0, w), rng.uniform(0, h), rng.uniform(2, 24), rng.uniform(2, 24), c);
+    }
+    return v;
+}
+
+int main(int argc, char* argv[]) {
+    std::cout << "=== Tiled Software Rasterizer behind Shape::draw() ===" << std::endl << std::endl;
+
+    std::size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const int width = 1920, height = 1080;
+
+    Lcg rng{42};
+    std::vector<Circle> circles = make_circles(n / 2, width, height, rng);
+    std::vector<Rectangle> rects = make_rects(n - n / 2, width, height, rng);
+
+    std::vector<const Shape*> scene;
+    scene.reserve(n);
+    for (std::size_t i = 0; i < rects.size(); ++i) {
+        if (i < circles.size()) scene.push_back(&circles[i]);
+        scene.push_back(&rects[i]);
+    }
+
+    Framebuffer fb(width, height);
+    Rasterizer raster(fb);
+
+    // Phase 1: one virtual draw() per shape - just records a Primitive
+    double record_ms = time_ms([&] {
+        for (const Shape* s : scene) s->draw(raster);
+    });
+
+    std::cout << "Scene: " << raster.primitive_count() << " primitives on a "
+              << width << "x" << height << " framebuffer" << std::endl;
+    std::cout << "Tile size: " << kTileSize << "x" << kTileSize << " ("
+              << kTileSize * kTileSize * sizeof(std::uint32_t) / 1024 << " KB per tile)" << std::endl;
+#if defined(__SSE2__)
+    std::cout << "Span kernel: SSE2 (4 pixels per store)" << std::endl;
+#else
+    std::cout << "Span kernel: scalar" << std::endl;
+#endif
+    std::cout << "Recording (virtual draw calls): " << record_ms << " ms" << std::endl;
+    std::cout << std::endl;
+
+    // Phase 2: bin + fill. Fixed thread counts, not hardware_concurrency():
+    // on a 1-core machine that would compare 1 thread with itself. 7 tiles
+    // the work unevenly across threads, which is what could break ordering.
+    std::uint64_t one_sum = 0;
+    double best_ms = 0;
+    for (int threads : {1, 4, 7}) {
+        fb.clear({255, 255, 255});
+        double ms = time_ms([&] { raster.flush(threads); });
+        std::uint64_t sum = fb.checksum();
+        std::cout << "Bin + fill, " << threads << " thread" << (threads > 1 ? "s: " : ":  ") << ms << " ms" << std::endl;
+        if (threads == 1) one_sum = sum;
+        else check(sum == one_sum, "same image with " + std::to_string(threads) + " threads as with 1");
+        if (best_ms == 0 || ms < best_ms) best_ms = ms;
+    }
+    std::cout << "Throughput (best): " << (raster.primitive_count() / (best_ms / 1000.0)) / 1e6
+              << " M primitives/s" << std::endl;
+    std::cout << std::endl;
+
+    // Far off-screen and huge shapes: bounds are clamped before float -> int
+    {
+        Framebuffer small(64, 64);
+        Rasterizer edge(small);
+        edge.add_circle(3e9f, 3e9f, 5.0f, {0, 0, 0});        // off-screen, past INT_MAX
+        edge.add_rect(-1e30f, -1e30f, 10.0f, 10.0f, {0, 0, 0});
+        edge.add_circle(std::nanf(""), 10.0f, 5.0f, {0, 0, 0});
+        check(edge.primitive_count() == 0, "off-screen and NaN shapes record nothing");
+        edge.add_circle(32.0f, 32.0f, 1e30f, {0, 0, 255});   // covers everything
+        small.clear({255, 255, 255});
+        edge.flush(1);
+        Framebuffer blue(64, 64);
+        blue.clear({0, 0, 255});
+        check(edge.primitive_count() == 1 && small.checksum() == blue.checksum(),
+              "a circle of radius 1e30 fills the whole framebuffer");
+    }
+    std::cout << std::endl;
+
+    if (fb.write_ppm("rasterizer_output.ppm")) {
+        std::cout << "Wrote rasterizer_output.ppm" << std::endl << std::endl;
+    }
+
+    std::cout << "=== Key Insights ===" << std::endl;
+    std::cout << "• draw() records a flat Primitive - one virtual call per shape, none per pixel" << std::endl;
+    std::cout << "• Binning by tile lets each thread own a cache-sized piece of the image" << std::endl;
+    std::cout << "• Circles and rectangles both become spans -> one SIMD fill loop" << std::endl;
+    std::cout << "• Submission order inside each tile -> identical output on any thread count" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,207 @@
+// TRACE_SCOPE: where the time goes across the phases of a run, viewed in Perfetto
+#define ENABLE_TRACING 1  // normally -DENABLE_TRACING on the command line
+#include "bench_util.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// ============================================================================
+// WHAT A TRACE SHOWS THAT A PROFILE DOESN'T
+// ============================================================================
+// A sampling profiler says "40% in std::sort". A trace says WHEN: phase by
+// phase, thread by thread, which one waited for which.
+//
+//   main    |== construction ==|====== computation ======|== output ==|
+//             |build_points|      |sum|       |-- sort --|  |format|
+//   worker 1                      |chunk|chunk|
+//   worker 2                      |chunk|chunk|
+//
+// Each TRACE_SCOPE becomes one "complete" event (ph "X") with a start and a
+// duration; Perfetto stacks nested events on the thread's track.
+
+struct Point {
+    int x;
+    int y;
+};
+
+// ============================================================================
+// A SMALL PIPELINE: construction -> computation -> output
+// ============================================================================
+
+std::vector<Point> build_points(std::size_t n) {
+    TRACE_SCOPE("build_points");
+    std::vector<Point> points(n);
+    std::mt19937 rng(1);
+    for (Point& p : points) p = Point{int(rng() % 10000), int(rng() % 10000)};
+    return points;
+}
+
+long long sum_points(const std::vector<Point>& points) {
+    TRACE_SCOPE("sum_points");
+    long long sum = 0;
+    for (const Point& p : points) sum += p.x + p.y;
+    return sum;
+}
+
+void sort_points(std::vector<Point>& points) {
+    TRACE_SCOPE("sort_points");
+    std::sort(points.begin(), points.end(), [](Point a, Point b) { return a.x != b.x ? a.x < b.x : a.y < b.y; });
+}
+
+// Workers: each takes every k-th chunk and traces it
+void worker(const std::vector<Point>& points, int id, int workers, long long& result) {
+    TRACE_THREAD_NAME(id == 1 ? "worker 1" : "worker 2");
+    TRACE_SCOPE("worker");
+    const std::size_t chunk = 1 << 16;
+    long long sum = 0;
+    for (std::size_t begin = std::size_t(id - 1) * chunk; begin < points.size(); begin += std::size_t(workers) * chunk) {
+        TRACE_SCOPE("chunk");
+        for (std::size_t i = begin; i < std::min(points.size(), begin + chunk); ++i) sum += points[i].x;
+    }
+    result = sum;
+}
+
+std::string format_points(const std::vector<Point>& points, std::size_t count) {
+    TRACE_SCOPE("format_points");
+    std::ostringstream os;
+    for (std::size_t i = 0; i < count; ++i) os << "(" << points[i].x << ", " << points[i].y << ")\n";
+    return os.str();
+}
+
+long long run_pipeline(std::size_t n) {
+    std::vector<Point> points;
+    {
+        TRACE_SCOPE("construction");
+        points = build_points(n);
+    }
+    long long total = 0, w1 = 0, w2 = 0;
+    {
+        TRACE_SCOPE("computation");
+        std::thread t1(worker, std::cref(points), 1, 2, std::ref(w1));
+        std::thread t2(worker, std::cref(points), 2, 2, std::ref(w2));
+        total = sum_points(points);
+        t1.join();
+        t2.join();
+        sort_points(points);  // only after the workers stopped reading
+    }
+    {
+        TRACE_SCOPE("output");
+        std::string text = format_points(points, 100000);
+        do_not_optimize(text);
+    }
+    long long xs = 0;
+    for (const Point& p : points) xs += p.x;
+    return xs == w1 + w2 ? total : -1;
+}
+
+// ============================================================================
+// CHECKING THE EXPORTED TRACE
+// ============================================================================
+
+struct Span {
+    std::uint64_t start;
+    std::uint64_t end;
+    bool contains(const Span& inner) const { return start <= inner.start && inner.end <= end; }
+};
+
+std::string read_file(const char* path) {
+    std::ifstream in(path);
+    std::stringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+std::size_t count_of(const std::string& text, const std::string& what) {
+    std::size_t n = 0;
+    for (std::size_t at = text.find(what); at != std::string::npos; at = text.find(what, at + what.size())) ++n;
+    return n;
+}
+
+void check_trace(const char* path) {
+    Tracer& tracer = Tracer::instance();
+    std::map<std::string, Span> main_spans;  // first span of each name on the main thread
+    std::size_t buffers = 0;
+    tracer.for_each_buffer([&](const TraceBuffer& b) {
+        ++buffers;
+        if (b.tid() != 1) return;
+        b.for_each([&](const TraceEvent& e) { main_spans.emplace(e.name, Span{e.start, e.end}); });
+    });
+
+    bool nested = main_spans.count("construction") && main_spans.count("build_points") &&
+                  main_spans["construction"].contains(main_spans["build_points"]) &&
+                  main_spans["computation"].contains(main_spans["sort_points"]) &&
+                  main_spans["output"].contains(main_spans["format_points"]);
+    check(nested, "each function's span lies inside its phase");
+    bool ordered = main_spans["construction"].end <= main_spans["computation"].start &&
+                   main_spans["computation"].end <= main_spans["output"].start;
+    check(ordered, "phases follow each other without overlap");
+
+    std::string json = read_file(path);
+    check(!json.empty() && json.front() == '{' && json.find("\n]}\n") == json.size() - 4, "file is one JSON object");
+    check(count_of(json, "{") == count_of(json, "}") && count_of(json, "[") == count_of(json, "]"), "braces balance");
+    check(count_of(json, "\"ph\": \"X\"") == tracer.event_count(), "one complete event per recorded scope");
+    check(count_of(json, "\"thread_name\"") == buffers && json.find("\"worker 2\"") != std::string::npos,
+          "one named track per thread (" + std::to_string(buffers) + ")");
+    check(tracer.dropped() == 0, "nothing dropped");
+}
+
+int main(int argc, char** argv) {
+    std::cout << "=== Scoped Tracing with Chrome/Perfetto Export ===" << std::endl;
+    std::cout << std::endl;
+    std::size_t n = argc > 1 ? std::size_t(std::atol(argv[1])) : 2000000;
+
+    std::cout << "=== Pipeline: " << n << " Points ===" << std::endl;
+    long long total = 0;
+    double ms = time_ms([&] { total = run_pipeline(n); });
+    check(total > 0, "pipeline result (workers agree with the sorted data)");
+    std::cout << "  " << ms << " ms, " << Tracer::instance().event_count() << " events recorded" << std::endl;
+
+    std::cout << std::endl << "=== Cost per TRACE_SCOPE ===" << std::endl;
+    const int rounds = 200000;
+    long long acc = 0;
+    double empty = time_ms([&] {
+        for (int i = 0; i < rounds; ++i) {
+            acc += i;
+            do_not_optimize(acc);
+        }
+    });
+    double traced = time_ms([&] {
+        for (int i = 0; i < rounds; ++i) {
+            TRACE_SCOPE("tiny");
+            acc += i;
+            do_not_optimize(acc);
+        }
+    });
+    double per_scope = (traced - empty) * 1e6 / rounds;
+    std::cout << "  " << per_scope << " ns per scope (2 timestamps + 1 store; " << rounds / TraceBuffer::kChunkEvents
+              << " chunk allocations included)" << std::endl;
+    std::cout << "  compiled out (no -DENABLE_TRACING): the loop above without the scope, 0 ns" << std::endl;
+    check(per_scope < 200, "tens of nanoseconds, not microseconds");
+
+    std::cout << std::endl << "=== Export ===" << std::endl;
+    const char* path = "trace_demo.trace.json";
+    double export_ms = time_ms([&] { check(TRACE_EXPORT(path), std::string("wrote ") + path); });
+    std::cout << "  " << Tracer::instance().event_count() << " events in " << export_ms << " ms" << std::endl;
+    check_trace(path);
+    std::cout << "  open it at https://ui.perfetto.dev (or chrome://tracing)" << std::endl;
+
+    std::cout << std::endl << "=== Key Insights ===" << std::endl;
+    std::cout << "• A trace shows phases and threads on a timeline - what a profile averages away" << std::endl;
+    std::cout << "• Per-thread buffers: recording takes no lock and touches no shared cache line" << std::endl;
+    std::cout << "• Store the literal's pointer, format at export: the hot path never formats" << std::endl;
+    std::cout << "• Without -DENABLE_TRACING the macros are empty: markers cost nothing in release" << std::endl;
+
+    std::cout << std::endl << (failures == 0 ? "All checks passed." : "SOME CHECKS FAILED!") << std::endl;
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,89 @@
+// C++ side of the Vector handle API (see vector_handle.h for ownership rules)
+#include "vector_handle.h"
+
+#include <algorithm>
+#include <new>
+#include <numeric>
+
+// The same concrete Vector as in concrete_types.cpp, with size_t length,
+// resize, and a flag saying whether it owns its buffer
+class Vector {
+private:
+    double* elem;
+    std::size_t sz;
+    bool owns;
+
+public:
+    Vector(std::size_t s) : elem{s ? new double[s]() : nullptr}, sz{s}, owns{true} {}
+    Vector(double* data, std::size_t s) : elem{data}, sz{s}, owns{false} {}
+    ~Vector() { if (owns) delete[] elem; }
+
+    Vector(const Vector&) = delete;
+    Vector& operator=(const Vector&) = delete;
+
+    std::size_t size() const { return sz; }
+    double* data() { return elem; }
+    const double* data() const { return elem; }
+    bool owning() const { return owns; }
+
+    // Strong guarantee: allocate first, so a failure leaves the Vector unchanged
+    void resize(std::size_t n) {
+        double* fresh = n ? new double[n]() : nullptr;
+        std::copy(elem, elem + std::min(sz, n), fresh);
+        delete[] elem;
+        elem = fresh;
+        sz = n;
+    }
+};
+
+// The opaque C type IS the C++ object: C only ever holds a pointer to it
+struct VectorHandle {
+    Vector v;
+};
+
+// Every entry point catches everything: an exception unwinding into C frames
+// is undefined behavior
+
+extern "C" VectorHandle* vector_create(size_t n) {
+    try {
+        return new VectorHandle{Vector(n)};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+extern "C" VectorHandle* vector_wrap(double* data, size_t n) {
+    try {
+        return new VectorHandle{Vector(data, n)};
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+extern "C" void vector_destroy(VectorHandle* v) {
+    delete v;
+}
+
+extern "C" size_t vector_size(const VectorHandle* v) {
+    return v ? v->v.size() : 0;
+}
+
+extern "C" double* vector_data(VectorHandle* v) {
+    return v ? v->v.data() : nullptr;
+}
+
+extern "C" int vector_resize(VectorHandle* v, size_t n) {
+    if (!v || !v->v.owning()) return -1;
+    try {
+        v->v.resize(n);
+        return 0;
+    } catch (...) {
+        return -1;
+    }
+}
+
+extern "C" double vector_sum(const VectorHandle* v) {
+    if (!v) return 0.0;
+    const double* d = v->v.data();
+    return std::accumulate(d, d + v->v.size(), 0.0);
+}
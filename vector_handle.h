@@ -0,0 +1,82 @@
+/* C ABI for the C++ Vector - share buffers between C and C++ without copying
+ *
+ * C can't see a C++ class, so C code gets an OPAQUE HANDLE: a pointer to a
+ * struct whose definition only the C++ side knows. C passes the handle back
+ * to these functions, and can borrow the raw double* to work in place.
+ *
+ *   C side                          C++ side (vector_handle.cpp)
+ *   ┌──────────────────┐            ┌──────────────────────────┐
+ *   │ VectorHandle* h ─┼──────────▶ │ Vector { elem, sz, owns }│
+ *   │ double* d ───────┼──┐         └──────────┬───────────────┘
+ *   └──────────────────┘  │                    ▼
+ *                         └───────────▶ [ e0 | e1 | e2 | ... ]  (one buffer, no copies)
+ *
+ * OWNERSHIP RULES
+ *   1. vector_create() returns a handle that OWNS its buffer. The caller
+ *      must call vector_destroy() exactly once; that frees the buffer.
+ *   2. vector_wrap() returns a handle that BORROWS a buffer owned by someone
+ *      else (e.g. a C array). vector_destroy() frees only the handle; the
+ *      buffer must outlive the handle. A borrowing handle can't be resized.
+ *   3. vector_data() returns a BORROWED pointer. It is valid until the next
+ *      vector_resize() or vector_destroy() on that handle. Never free() it.
+ *   4. No function throws: failures return NULL or -1. C++ exceptions never
+ *      cross into C.
+ *   5. A handle may be used from any thread, but not from two threads at
+ *      once without external locking.
+ */
+#ifndef VECTOR_HANDLE_H
+#define VECTOR_HANDLE_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct VectorHandle VectorHandle;  /* opaque: defined only in C++ */
+
+/* New owning Vector of n doubles, all 0.0. NULL if out of memory. */
+VectorHandle* vector_create(size_t n);
+
+/* Borrowing handle over data[0..n-1]; data stays owned by the caller. NULL if out of memory. */
+VectorHandle* vector_wrap(double* data, size_t n);
+
+/* Frees the handle (and the buffer, if the handle owns it). NULL is ignored. */
+void vector_destroy(VectorHandle* v);
+
+size_t vector_size(const VectorHandle* v);
+
+/* Borrowed pointer to the elements (see rule 3). NULL for an empty Vector. */
+double* vector_data(VectorHandle* v);
+
+/* Resize, keeping the first min(old, new) elements; new elements are 0.0.
+ * Returns 0 on success, -1 if out of memory or the handle is borrowing
+ * (the Vector is unchanged on failure). Invalidates earlier vector_data(). */
+int vector_resize(VectorHandle* v, size_t n);
+
+/* Sum of the elements, computed on the C++ side (std::accumulate) */
+double vector_sum(const VectorHandle* v);
+
+#ifdef __cplusplus
+}
+
+/* C++ convenience: owns a handle, frees it in the destructor (RAII) */
+class VectorRef {
+private:
+    VectorHandle* h;
+public:
+    explicit VectorRef(size_t n) : h{vector_create(n)} {}
+    VectorRef(double* data, size_t n) : h{vector_wrap(data, n)} {}
+    ~VectorRef() { vector_destroy(h); }
+    VectorRef(const VectorRef&) = delete;
+    VectorRef& operator=(const VectorRef&) = delete;
+
+    VectorHandle* handle() { return h; }
+    size_t size() const { return vector_size(h); }
+    double* data() { return vector_data(h); }
+    double& operator[](size_t i) { return vector_data(h)[i]; }
+    bool resize(size_t n) { return vector_resize(h, n) == 0; }
+};
+#endif
+
+#endif /* VECTOR_HANDLE_H */
@@ -0,0 +1,54 @@
+// C code using a C++ Vector through an opaque handle - no copies either way
+#include <stdio.h>
+
+#include "c_functions.h"
+#include "vector_handle.h"
+
+int main(void) {
+    printf("=== C using a C++ Vector (opaque handle) ===\n\n");
+
+    // C++ owns the buffer, C works on it in place
+    VectorHandle* v = vector_create(5);
+    if (!v) {
+        printf("out of memory\n");
+        return 1;
+    }
+
+    double* d = vector_data(v);  // borrowed: valid until resize/destroy
+    for (size_t i = 0; i < vector_size(v); i++) {
+        d[i] = 1.5 + (double)i;
+    }
+    printf("C filled the C++ buffer: size = %zu\n", vector_size(v));
+    printf("  calculate_average_n (C)  = %g\n", calculate_average_n(d, vector_size(v)));
+    printf("  vector_sum          (C++) = %g\n", vector_sum(v));
+
+    // Resize keeps the old elements but may move the buffer: re-borrow
+    if (vector_resize(v, 8) != 0) {
+        printf("resize failed\n");
+        vector_destroy(v);
+        return 1;
+    }
+    d = vector_data(v);
+    printf("\nAfter vector_resize(v, 8): {");
+    for (size_t i = 0; i < vector_size(v); i++) {
+        printf("%s%g", i ? ", " : "", d[i]);
+    }
+    printf("}\n");
+
+    vector_destroy(v);  // frees the buffer too (owning handle)
+
+    // The other way round: C owns the buffer, C++ works on it in place
+    double local[] = {10.0, 20.0, 30.0};
+    VectorHandle* w = vector_wrap(local, 3);
+    if (!w) {
+        printf("out of memory\n");
+        return 1;
+    }
+    printf("\nC array wrapped for C++: vector_sum = %g\n", vector_sum(w));
+    printf("  same memory? %s\n", vector_data(w) == local ? "yes" : "no");
+    printf("  vector_resize on a borrowing handle = %d (refused)\n", vector_resize(w, 10));
+    vector_destroy(w);  // frees only the handle; local[] is still ours
+
+    printf("\nOne buffer, two languages: the handle hides the class, not the data!\n");
+    return 0;
+}